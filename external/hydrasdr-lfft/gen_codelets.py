@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Generate the straight-line FFT codelets of hydrasdr-lfft.
+
+Writes stockham_codelets.inc: one fully unrolled forward FFT per size
+N = 2..64 (split real/imag format), radix-2 decimation in frequency on
+local variables with the twiddles as literal constants. Trivial twiddles
+(1, -j) become add/sub only butterflies.
+
+Usage: python3 gen_codelets.py > stockham_codelets.inc
+
+License: MIT
+Copyright (c) 2025-2026, Benjamin Vernoux <bvernoux@hydrasdr.com>
+"""
+
+import math
+import sys
+
+MAX_LOG2N = 6
+
+HEADER = """\
+/*
+ * Stockham FFT - Straight-Line Codelets (N = 2..64)
+ *
+ * GENERATED by gen_codelets.py - do not edit, regenerate with
+ *   python3 gen_codelets.py > stockham_codelets.inc
+ *
+ * Fully unrolled forward FFTs in split format: radix-2 decimation in
+ * frequency on local variables with literal twiddles, no loops, no
+ * tables, no work buffers. All inputs are read before the first output
+ * is written, so in-place calls are fine and no alignment is required.
+ * The inverse is the forward codelet with real and imaginary swapped.
+ *
+ * Included by the stage kernel translation units, so each ISA variant
+ * gets its own compile of the codelets.
+ *
+ * License: MIT
+ * Copyright (c) 2025-2026, Benjamin Vernoux <bvernoux@hydrasdr.com>
+ */
+
+/* a' = a + b, b' = a - b */
+#define CL_BF(ar, ai, br, bi)						\\
+do {									\\
+	const float tr_ = ar - br, ti_ = ai - bi;			\\
+	ar += br;							\\
+	ai += bi;							\\
+	br = tr_;							\\
+	bi = ti_;							\\
+} while (0)
+
+/* a' = a + b, b' = (a - b) * -j */
+#define CL_BFJ(ar, ai, br, bi)						\\
+do {									\\
+	const float tr_ = ar - br, ti_ = ai - bi;			\\
+	ar += br;							\\
+	ai += bi;							\\
+	br = ti_;							\\
+	bi = -tr_;							\\
+} while (0)
+
+/* a' = a + b, b' = (a - b) * (wr + j wi) */
+#define CL_BFW(ar, ai, br, bi, wr, wi)					\\
+do {									\\
+	const float tr_ = ar - br, ti_ = ai - bi;			\\
+	ar += br;							\\
+	ai += bi;							\\
+	br = tr_ * (wr) - ti_ * (wi);					\\
+	bi = tr_ * (wi) + ti_ * (wr);					\\
+} while (0)
+"""
+
+
+def fmt(v):
+    """Float literal, exact zero/one kept short."""
+    if abs(v) < 1e-12:
+        return "0.0f"
+    return "%.9ef" % v
+
+
+def bitrev(k, bits):
+    r = 0
+    for _ in range(bits):
+        r = (r << 1) | (k & 1)
+        k >>= 1
+    return r
+
+
+def codelet(log2n):
+    n = 1 << log2n
+    out = []
+    out.append("")
+    out.append("static void codelet_%d(const float *in_re, const float *in_im," % n)
+    out.append("\t\t\tfloat *out_re, float *out_im)")
+    out.append("{")
+    for k in range(n):
+        out.append("\tfloat r%d = in_re[%d], i%d = in_im[%d];" % (k, k, k, k))
+    out.append("")
+
+    span = n
+    while span >= 2:
+        half = span // 2
+        for base in range(0, n, span):
+            for j in range(half):
+                a, b = base + j, base + j + half
+                # W_span^j = exp(-2 pi i j / span)
+                if j == 0:
+                    out.append("\tCL_BF(r%d, i%d, r%d, i%d);" % (a, a, b, b))
+                elif 4 * j == span:
+                    out.append("\tCL_BFJ(r%d, i%d, r%d, i%d);" % (a, a, b, b))
+                else:
+                    ang = -2.0 * math.pi * j / span
+                    out.append("\tCL_BFW(r%d, i%d, r%d, i%d, %s, %s);" %
+                               (a, a, b, b, fmt(math.cos(ang)), fmt(math.sin(ang))))
+        span = half
+
+    out.append("")
+    for k in range(n):
+        s = bitrev(k, log2n)
+        out.append("\tout_re[%d] = r%d;" % (k, s))
+        out.append("\tout_im[%d] = i%d;" % (k, s))
+    out.append("}")
+    return out
+
+
+def main():
+    lines = [HEADER.rstrip("\n")]
+    for log2n in range(1, MAX_LOG2N + 1):
+        lines.extend(codelet(log2n))
+    lines.append("")
+    lines.append("#undef CL_BF")
+    lines.append("#undef CL_BFJ")
+    lines.append("#undef CL_BFW")
+    lines.append("")
+    lines.append("/* Indexed by log2(N), entry 0 unused */")
+    lines.append("#define SFFT_CODELET_TABLE { \\")
+    lines.append("\tNULL, codelet_2, codelet_4, codelet_8, \\")
+    lines.append("\tcodelet_16, codelet_32, codelet_64 \\")
+    lines.append("}")
+    sys.stdout.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
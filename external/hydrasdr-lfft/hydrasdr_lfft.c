@@ -12,14 +12,26 @@
 #include "stockham_internal.h"
 #include "build_info.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
 /* ============================================================================
  * Global State
  * ========================================================================= */
 
 static int g_initialized = 0;
+static hlfft_isa_t g_isa = HLFFT_ISA_SCALAR;	/* Selected by hlfft_init() */
 
 /* ============================================================================
  * FFT Plan Structure
@@ -27,9 +39,107 @@ static int g_initialized = 0;
 
 struct hlfft_plan {
 	size_t n;		/* FFT size */
+	hlfft_isa_t isa;	/* Stage kernels in use */
+	hlfft_algo_t algo;	/* Algorithm in use */
 	sfft_plan_t *stockham;	/* Stockham FFT plan */
 };
 
+/* ============================================================================
+ * Runtime ISA Detection
+ * ========================================================================= */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+
+#if defined(__GNUC__) || defined(__clang__)
+
+/* __builtin_cpu_supports() handles CPUID + XCR0 OS checks internally */
+static hlfft_isa_t detect_isa(void)
+{
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f") &&
+	    __builtin_cpu_supports("avx512vl") &&
+	    __builtin_cpu_supports("fma"))
+		return HLFFT_ISA_AVX512;
+
+	if (__builtin_cpu_supports("avx2") &&
+	    __builtin_cpu_supports("fma"))
+		return HLFFT_ISA_AVX2;
+
+	return HLFFT_ISA_SSE2;
+}
+
+#elif defined(_MSC_VER)
+
+/* XCR0 bits: 1=SSE state, 2=YMM state, 5=opmask, 6=ZMM_Hi256, 7=Hi16_ZMM */
+static hlfft_isa_t detect_isa(void)
+{
+	int info[4];
+	unsigned long long xcr0;
+
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return HLFFT_ISA_SSE2;
+
+	/* ECX from CPUID(1): bit 12=FMA, bit 27=OSXSAVE */
+	__cpuid(info, 1);
+	if (!(info[2] & (1 << 27)))
+		return HLFFT_ISA_SSE2;
+	int has_fma = (info[2] >> 12) & 1;
+
+	xcr0 = _xgetbv(0);
+	if ((xcr0 & 0x06) != 0x06)
+		return HLFFT_ISA_SSE2;
+
+	/* CPUID(7,0): EBX bit 5=AVX2, bit 16=AVX512F, bit 31=AVX512VL */
+	__cpuidex(info, 7, 0);
+	int has_avx2 = (info[1] >> 5) & 1;
+	int has_avx512 = ((info[1] >> 16) & 1) && ((info[1] >> 31) & 1);
+
+	if (has_avx512 && has_fma && (xcr0 & 0xE0) == 0xE0)
+		return HLFFT_ISA_AVX512;
+
+	if (has_avx2 && has_fma)
+		return HLFFT_ISA_AVX2;
+
+	return HLFFT_ISA_SSE2;
+}
+
+#else
+static hlfft_isa_t detect_isa(void)
+{
+	return HLFFT_ISA_SSE2;
+}
+#endif
+
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+
+/* NEON is mandatory on AArch64, compile-time on ARMv7 */
+static hlfft_isa_t detect_isa(void)
+{
+	return HLFFT_ISA_NEON;
+}
+
+#else
+
+static hlfft_isa_t detect_isa(void)
+{
+	return HLFFT_ISA_SCALAR;
+}
+
+#endif
+
+static const sfft_kernels_t *isa_kernels(hlfft_isa_t isa)
+{
+	switch (isa) {
+	case HLFFT_ISA_SSE2:   return &sfft_kernels_sse2;
+	case HLFFT_ISA_AVX2:   return &sfft_kernels_avx2;
+	case HLFFT_ISA_AVX512: return &sfft_kernels_avx512;
+	case HLFFT_ISA_NEON:   return &sfft_kernels_neon;
+	default:               return &sfft_kernels_scalar;
+	}
+}
+
 /* ============================================================================
  * Library Initialization
  * ========================================================================= */
@@ -39,6 +149,7 @@ int hlfft_init(void)
 	if (g_initialized)
 		return HLFFT_OK;
 
+	g_isa = detect_isa();
 	g_initialized = 1;
 	return HLFFT_OK;
 }
@@ -48,14 +159,216 @@ void hlfft_shutdown(void)
 	g_initialized = 0;
 }
 
+/* ============================================================================
+ * Planner and Wisdom
+ *
+ * Wisdom maps (ISA, log2 N) to the fastest algorithm on this machine. It
+ * is learned by timing the variants (config->measure) and can be kept in
+ * a text file, one "<isa> <n> <algo>" line per entry, e.g.
+ * "AVX-512 16 codelet". Unknown or malformed lines are skipped.
+ * ========================================================================= */
+
+#define WISDOM_MAX_LOG2N 31
+#define WISDOM_HEADER "# hydrasdr-lfft wisdom"
+#define MEASURE_ROUNDS 3		/* Best of, per variant */
+#define MEASURE_ROUND_NS 300000		/* Minimum duration of a round */
+
+static hlfft_algo_t g_wisdom[HLFFT_ISA_COUNT][WISDOM_MAX_LOG2N + 1];
+
+static size_t log2_of(size_t n)
+{
+	size_t k = 0;
+	while (((size_t)1 << k) < n)
+		k++;
+	return k;
+}
+
+static uint64_t time_ns(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+	if (!freq.QuadPart)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (uint64_t)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static int algo_available(size_t n, hlfft_algo_t algo)
+{
+	return algo != HLFFT_ALGO_CODELET || n <= HLFFT_CODELET_MAX_SIZE;
+}
+
+/*
+ * Built-in choice without wisdom: codelets up to 16 points, where they
+ * beat the stages by avoiding all loop and buffer overhead, OTF stages
+ * above (the table variant saves multiplies but costs 3x the twiddle
+ * memory, it only wins on some machines, measure to find out).
+ */
+static hlfft_algo_t algo_default(size_t n)
+{
+	return n <= 16 ? HLFFT_ALGO_CODELET : HLFFT_ALGO_STAGES_OTF;
+}
+
+static int apply_algo(sfft_plan_t *sp, hlfft_algo_t algo)
+{
+	switch (algo) {
+	case HLFFT_ALGO_STAGES_OTF:   return sfft_plan_set_algo(sp, SFFT_ALGO_OTF);
+	case HLFFT_ALGO_STAGES_TABLE: return sfft_plan_set_algo(sp, SFFT_ALGO_TABLE);
+	case HLFFT_ALGO_CODELET:      return sfft_plan_set_algo(sp, SFFT_ALGO_CODELET);
+	default:                      return -1;
+	}
+}
+
+/* Time the variants on the plan's own buffers, leaves the fastest set */
+static hlfft_algo_t measure_algo(sfft_plan_t *sp, size_t n)
+{
+	float *buf = (float *)sfft_backend_scalar.aligned_alloc(4 * n * sizeof(float));
+	hlfft_algo_t best = algo_default(n);
+	uint64_t best_ns = UINT64_MAX;
+
+	if (!buf)
+		return best;
+
+	for (size_t i = 0; i < 2 * n; i++)
+		buf[i] = (float)(i % 7) - 3.0f;
+
+	for (int a = HLFFT_ALGO_AUTO + 1; a < HLFFT_ALGO_COUNT; a++) {
+		if (!algo_available(n, (hlfft_algo_t)a) ||
+		    apply_algo(sp, (hlfft_algo_t)a) != 0)
+			continue;
+
+		/* Double the calls per round until a round lasts long enough */
+		size_t calls = 1;
+		uint64_t dt;
+		do {
+			calls *= 2;
+			uint64_t t0 = time_ns();
+			for (size_t c = 0; c < calls; c++)
+				sfft_backend_scalar.forward_split(sp, buf, buf + n,
+								  buf + 2 * n, buf + 3 * n);
+			dt = time_ns() - t0;
+		} while (dt < MEASURE_ROUND_NS && calls < ((size_t)1 << 24));
+
+		uint64_t algo_ns = UINT64_MAX;
+		for (int r = 0; r < MEASURE_ROUNDS; r++) {
+			uint64_t t0 = time_ns();
+			for (size_t c = 0; c < calls; c++)
+				sfft_backend_scalar.forward_split(sp, buf, buf + n,
+								  buf + 2 * n, buf + 3 * n);
+			dt = (time_ns() - t0) / calls;
+			if (dt < algo_ns)
+				algo_ns = dt;
+		}
+		if (algo_ns < best_ns) {
+			best_ns = algo_ns;
+			best = (hlfft_algo_t)a;
+		}
+	}
+
+	sfft_backend_scalar.aligned_free(buf);
+	return best;
+}
+
+static hlfft_algo_t algo_from_name(const char *name)
+{
+	for (int a = HLFFT_ALGO_AUTO + 1; a < HLFFT_ALGO_COUNT; a++) {
+		if (!strcmp(name, hlfft_algo_name((hlfft_algo_t)a)))
+			return (hlfft_algo_t)a;
+	}
+	return HLFFT_ALGO_AUTO;
+}
+
+/* Entries already known in this process take precedence */
+static void wisdom_load(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	char line[128];
+
+	if (!f)
+		return;
+
+	while (fgets(line, sizeof(line), f)) {
+		char isa_name[32], algo_name[32];
+		unsigned long n;
+
+		if (line[0] == '#' ||
+		    sscanf(line, "%31s %lu %31s", isa_name, &n, algo_name) != 3)
+			continue;
+		if (!hlfft_size_valid((size_t)n) || log2_of((size_t)n) > WISDOM_MAX_LOG2N)
+			continue;
+
+		hlfft_algo_t algo = algo_from_name(algo_name);
+		if (algo == HLFFT_ALGO_AUTO || !algo_available((size_t)n, algo))
+			continue;
+
+		for (int isa = HLFFT_ISA_SCALAR; isa < HLFFT_ISA_COUNT; isa++) {
+			hlfft_algo_t *w = &g_wisdom[isa][log2_of((size_t)n)];
+			if (!strcmp(isa_name, hlfft_isa_name((hlfft_isa_t)isa)) &&
+			    *w == HLFFT_ALGO_AUTO)
+				*w = algo;
+		}
+	}
+	fclose(f);
+}
+
+static void wisdom_save(const char *path)
+{
+	FILE *f = fopen(path, "w");
+
+	if (!f)
+		return;
+
+	fprintf(f, "%s\n", WISDOM_HEADER);
+	for (int isa = HLFFT_ISA_SCALAR; isa < HLFFT_ISA_COUNT; isa++) {
+		for (size_t k = 1; k <= WISDOM_MAX_LOG2N; k++) {
+			if (g_wisdom[isa][k] != HLFFT_ALGO_AUTO)
+				fprintf(f, "%s %lu %s\n",
+					hlfft_isa_name((hlfft_isa_t)isa),
+					(unsigned long)1 << k,
+					hlfft_algo_name(g_wisdom[isa][k]));
+		}
+	}
+	fclose(f);
+}
+
+/* Resolve HLFFT_ALGO_AUTO for a plan, measuring if asked to */
+static hlfft_algo_t plan_algo(sfft_plan_t *sp, size_t n, hlfft_isa_t isa,
+			      const hlfft_config_t *cfg)
+{
+	const size_t k = log2_of(n);
+
+	if (k > WISDOM_MAX_LOG2N)
+		return algo_default(n);
+
+	if (g_wisdom[isa][k] == HLFFT_ALGO_AUTO && cfg && cfg->wisdom_file)
+		wisdom_load(cfg->wisdom_file);
+	if (g_wisdom[isa][k] != HLFFT_ALGO_AUTO)
+		return g_wisdom[isa][k];
+	if (!cfg || !cfg->measure)
+		return algo_default(n);
+
+	g_wisdom[isa][k] = measure_algo(sp, n);
+	if (cfg->wisdom_file)
+		wisdom_save(cfg->wisdom_file);
+	return g_wisdom[isa][k];
+}
+
 /* ============================================================================
  * FFT Plan Management
  * ========================================================================= */
 
 hlfft_plan_t *hlfft_plan_create(size_t n, const void *config)
 {
+	const hlfft_config_t *cfg = (const hlfft_config_t *)config;
+	hlfft_isa_t isa = cfg ? cfg->isa : HLFFT_ISA_AUTO;
+	hlfft_algo_t algo = cfg ? cfg->algo : HLFFT_ALGO_AUTO;
 	hlfft_plan_t *plan;
-	(void)config;  /* Unused */
 
 	if (!hlfft_size_valid(n))
 		return NULL;
@@ -63,17 +376,34 @@ hlfft_plan_t *hlfft_plan_create(size_t n, const void *config)
 	if (!g_initialized)
 		hlfft_init();
 
+	if (!hlfft_isa_supported(isa))
+		return NULL;
+	if (isa == HLFFT_ISA_AUTO)
+		isa = g_isa;
+	if ((unsigned)algo >= HLFFT_ALGO_COUNT || !algo_available(n, algo))
+		return NULL;
+
 	plan = (hlfft_plan_t *)calloc(1, sizeof(hlfft_plan_t));
 	if (!plan)
 		return NULL;
 
 	plan->n = n;
+	plan->isa = isa;
 	plan->stockham = sfft_backend_scalar.plan_create(n);
 
 	if (!plan->stockham) {
 		free(plan);
 		return NULL;
 	}
+	sfft_plan_set_kernels(plan->stockham, isa_kernels(isa));
+
+	if (algo == HLFFT_ALGO_AUTO)
+		algo = plan_algo(plan->stockham, n, isa, cfg);
+	if (apply_algo(plan->stockham, algo) != 0) {
+		hlfft_plan_destroy(plan);
+		return NULL;
+	}
+	plan->algo = algo;
 
 	return plan;
 }
@@ -94,6 +424,22 @@ size_t hlfft_plan_size(const hlfft_plan_t *plan)
 	return plan ? plan->n : 0;
 }
 
+hlfft_algo_t hlfft_plan_algo(const hlfft_plan_t *plan)
+{
+	return plan ? plan->algo : HLFFT_ALGO_AUTO;
+}
+
+const char *hlfft_algo_name(hlfft_algo_t algo)
+{
+	switch (algo) {
+	case HLFFT_ALGO_AUTO:         return "auto";
+	case HLFFT_ALGO_STAGES_OTF:   return "otf";
+	case HLFFT_ALGO_STAGES_TABLE: return "table";
+	case HLFFT_ALGO_CODELET:      return "codelet";
+	default:                      return "unknown";
+	}
+}
+
 /* ============================================================================
  * FFT Execution
  * ========================================================================= */
@@ -140,6 +486,22 @@ int hlfft_forward_soa(const hlfft_plan_t *plan,
 	return HLFFT_OK;
 }
 
+int hlfft_forward_soa_batch(const hlfft_plan_t *plan,
+			    const float *in_re, const float *in_im,
+			    float *out_re, float *out_im,
+			    size_t stride, size_t count)
+{
+	if (!plan || !in_re || !in_im || !out_re || !out_im)
+		return HLFFT_ERROR_INVALID_ARG;
+	if (stride < plan->n)
+		return HLFFT_ERROR_INVALID_ARG;
+
+	sfft_forward_split_batch(plan->stockham, in_re, in_im, out_re, out_im,
+				 stride, count);
+
+	return HLFFT_OK;
+}
+
 /* ============================================================================
  * Memory Allocation
  * ========================================================================= */
@@ -183,5 +545,49 @@ const char *hlfft_version(void)
 
 const char *hlfft_build_info(void)
 {
-	return "FFT: " BUILD_INFO_STR;
+	switch (hlfft_isa_selected()) {
+	case HLFFT_ISA_SSE2:   return "FFT: " BUILD_INFO_STR ", Stockham SSE2";
+	case HLFFT_ISA_AVX2:   return "FFT: " BUILD_INFO_STR ", Stockham AVX2+FMA";
+	case HLFFT_ISA_AVX512: return "FFT: " BUILD_INFO_STR ", Stockham AVX-512";
+	case HLFFT_ISA_NEON:   return "FFT: " BUILD_INFO_STR ", Stockham NEON";
+	default:               return "FFT: " BUILD_INFO_STR ", Stockham scalar";
+	}
+}
+
+int hlfft_isa_supported(hlfft_isa_t isa)
+{
+	hlfft_isa_t best = hlfft_isa_selected();
+
+	switch (isa) {
+	case HLFFT_ISA_AUTO:
+	case HLFFT_ISA_SCALAR:
+		return 1;
+	case HLFFT_ISA_SSE2:
+		return best == HLFFT_ISA_SSE2 || best == HLFFT_ISA_AVX2 ||
+		       best == HLFFT_ISA_AVX512;
+	case HLFFT_ISA_AVX2:
+		return best == HLFFT_ISA_AVX2 || best == HLFFT_ISA_AVX512;
+	case HLFFT_ISA_AVX512:
+		return best == HLFFT_ISA_AVX512;
+	case HLFFT_ISA_NEON:
+		return best == HLFFT_ISA_NEON;
+	default:
+		return 0;
+	}
+}
+
+hlfft_isa_t hlfft_isa_selected(void)
+{
+	if (!g_initialized)
+		hlfft_init();
+	return g_isa;
+}
+
+const char *hlfft_isa_name(hlfft_isa_t isa)
+{
+	if (isa == HLFFT_ISA_AUTO)
+		return "auto";
+	if ((unsigned)isa >= HLFFT_ISA_COUNT)
+		return "unknown";
+	return isa_kernels(isa)->name;
 }
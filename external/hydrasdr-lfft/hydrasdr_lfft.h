@@ -2,12 +2,14 @@
  * hydrasdr-lfft - Light FFT Library for Small Sizes
  *
  * Optimized for small FFT sizes (2-32 points) used in PFB channelizers.
- * Uses portable scalar Stockham algorithm with compiler auto-vectorization.
+ * Uses portable Stockham algorithm with compiler auto-vectorization, the
+ * stages run on SIMD kernels selected at runtime (SSE2/AVX2/AVX-512/NEON).
  *
  * Features:
  * - Stockham algorithm (cache-friendly, no bit-reversal)
  * - Radix-4 with radix-2 cleanup for any power-of-2 size
- * - On-the-fly twiddle factor computation (reduced memory)
+ * - On-the-fly or stored twiddles, straight-line codelets up to 64 points,
+ *   chosen per size by a planner that can measure and keep wisdom
  * - BSD/MIT license compatible (no GPL dependencies)
  *
  * License: MIT
@@ -63,6 +65,64 @@ typedef struct {
 
 typedef struct hlfft_plan hlfft_plan_t;
 
+/* ============================================================================
+ * Stage Kernel ISA
+ * ========================================================================= */
+
+/*
+ * The radix-4/radix-2 stages run on SIMD kernels selected at runtime for
+ * the CPU (HLFFT_ISA_AUTO). A plan can be pinned to another ISA through
+ * hlfft_config_t, e.g. to compare a variant against the scalar kernels.
+ */
+typedef enum {
+	HLFFT_ISA_AUTO = 0,	/* Best supported ISA (default) */
+	HLFFT_ISA_SCALAR,	/* Portable scalar kernels (reference) */
+	HLFFT_ISA_SSE2,		/* x86-64 baseline */
+	HLFFT_ISA_AVX2,		/* x86: AVX2 + FMA */
+	HLFFT_ISA_AVX512,	/* x86: AVX-512F + VL + FMA */
+	HLFFT_ISA_NEON,		/* ARM: NEON */
+	HLFFT_ISA_COUNT
+} hlfft_isa_t;
+
+/* ============================================================================
+ * Plan Algorithm
+ * ========================================================================= */
+
+/*
+ * How a plan computes its complex-to-complex transforms:
+ * - STAGES_OTF:   radix-4 stages, W^{2k} and W^{3k} computed from stored
+ *                 W^k (least memory)
+ * - STAGES_TABLE: radix-4 stages, W^k, W^{2k} and W^{3k} all stored
+ *                 (3x twiddle memory, fewer multiplies)
+ * - CODELET:      generated straight-line FFT, N = 2..64 only
+ *
+ * HLFFT_ALGO_AUTO takes the planner's choice: the wisdom learned for the
+ * size and ISA (measured in this process or loaded from the wisdom file),
+ * otherwise with measure set the variants are timed on the running
+ * machine, otherwise a built-in default.
+ */
+typedef enum {
+	HLFFT_ALGO_AUTO = 0,		/* Planner choice (default) */
+	HLFFT_ALGO_STAGES_OTF,		/* Radix-4 stages, OTF twiddles */
+	HLFFT_ALGO_STAGES_TABLE,	/* Radix-4 stages, stored twiddles */
+	HLFFT_ALGO_CODELET,		/* Straight-line codelet, N <= 64 */
+	HLFFT_ALGO_COUNT
+} hlfft_algo_t;
+
+/* Largest size with a straight-line codelet */
+#define HLFFT_CODELET_MAX_SIZE 64
+
+/*
+ * Plan options, zero-initialized fields keep the defaults, e.g.
+ * hlfft_config_t cfg = {HLFFT_ISA_AUTO, HLFFT_ALGO_AUTO, 1, "fft.wisdom"};
+ */
+typedef struct {
+	hlfft_isa_t isa;	/* Stage kernels, HLFFT_ISA_AUTO for best */
+	hlfft_algo_t algo;	/* HLFFT_ALGO_AUTO: planner choice */
+	int measure;		/* AUTO without wisdom: time the variants */
+	const char *wisdom_file;/* Optional: load choices, save measured ones */
+} hlfft_config_t;
+
 /* ============================================================================
  * Library Initialization
  * ========================================================================= */
@@ -87,10 +147,15 @@ void hlfft_shutdown(void);
  * Create FFT plan for given size
  *
  * @param n       FFT size (must be power of 2, >= 2)
- * @param config  Configuration (ignored, pass NULL)
- * @return        FFT plan or NULL on error
+ * @param config  Pointer to hlfft_config_t, or NULL for defaults
+ * @return        FFT plan or NULL on error (also if the requested ISA
+ *                is not supported by this CPU, or HLFFT_ALGO_CODELET is
+ *                requested above HLFFT_CODELET_MAX_SIZE)
  *
  * The plan pre-computes twiddle factors and allocates work buffers.
+ * Measuring (config->measure) times each variant for about a millisecond,
+ * once per size and ISA per process; with config->wisdom_file the result
+ * is saved and later plans, also in other processes, skip the timing.
  */
 hlfft_plan_t *hlfft_plan_create(size_t n, const void *config);
 
@@ -109,6 +174,21 @@ void hlfft_plan_destroy(hlfft_plan_t *plan);
  */
 size_t hlfft_plan_size(const hlfft_plan_t *plan);
 
+/**
+ * Get the algorithm a plan runs (never HLFFT_ALGO_AUTO)
+ *
+ * @param plan  FFT plan
+ * @return Algorithm, HLFFT_ALGO_AUTO if plan is NULL
+ */
+hlfft_algo_t hlfft_plan_algo(const hlfft_plan_t *plan);
+
+/**
+ * Get algorithm name
+ *
+ * @return Static string, e.g. "codelet"
+ */
+const char *hlfft_algo_name(hlfft_algo_t algo);
+
 /* ============================================================================
  * FFT Execution
  * ========================================================================= */
@@ -162,6 +242,29 @@ int hlfft_forward_soa(const hlfft_plan_t *plan,
 		      const float *in_re, const float *in_im,
 		      float *out_re, float *out_im);
 
+/**
+ * Execute forward FFT on a batch of independent frames (SoA format)
+ *
+ * @param plan   FFT plan (N points)
+ * @param in_re  Input real parts, frame k at in_re + k * stride
+ * @param in_im  Input imaginary parts, frame k at in_im + k * stride
+ * @param out_re Output real parts, frame k at out_re + k * stride
+ * @param out_im Output imaginary parts, frame k at out_im + k * stride
+ * @param stride Distance between frames in floats (>= N)
+ * @param count  Number of frames
+ * @return HLFFT_OK on success
+ *
+ * Same result as count hlfft_forward_soa() calls. Up to 64 points the
+ * frames are transformed 16 at a time with the SIMD lanes spanning the
+ * frames and the twiddles loaded once per stage, so a block of small
+ * FFTs costs a fraction of the individual calls. Input and output must
+ * not overlap.
+ */
+int hlfft_forward_soa_batch(const hlfft_plan_t *plan,
+			    const float *in_re, const float *in_im,
+			    float *out_re, float *out_im,
+			    size_t stride, size_t count);
+
 /* ============================================================================
  * Utility Functions
  * ========================================================================= */
@@ -190,12 +293,34 @@ const char *hlfft_error_string(int error);
 const char *hlfft_version(void);
 
 /**
- * Get build info string (compiler, SIMD, optimization flags)
+ * Get build info string (compiler, SIMD, optimization flags) and the
+ * stage kernels selected at runtime
  *
- * @return Static string, e.g. "FFT: Release GCC 15.2.0 AVX-512 FMA fast-math"
+ * @return Static string, e.g.
+ *         "FFT: Release GCC 15.2.0 SSE2 fast-math, Stockham AVX-512"
  */
 const char *hlfft_build_info(void);
 
+/**
+ * Check if the stage kernels of an ISA can run on this CPU
+ *
+ * @param isa  ISA to check (HLFFT_ISA_AUTO and HLFFT_ISA_SCALAR always are)
+ * @return Non-zero if supported
+ */
+int hlfft_isa_supported(hlfft_isa_t isa);
+
+/**
+ * Get the ISA that HLFFT_ISA_AUTO selects on this CPU
+ */
+hlfft_isa_t hlfft_isa_selected(void);
+
+/**
+ * Get ISA name
+ *
+ * @return Static string, e.g. "AVX2+FMA"
+ */
+const char *hlfft_isa_name(hlfft_isa_t isa);
+
 /* ============================================================================
  * Memory Allocation Helpers
  * ========================================================================= */
@@ -25,6 +25,7 @@
 /* Benchmark parameters */
 #define BENCHMARK_ITERATIONS    1000000     /* Number of FFT iterations for benchmark */
 #define WARMUP_ITERATIONS       1000        /* Warmup iterations before timing */
+#define BENCHMARK_ISA_SAMPLES   (1 << 25)   /* Samples per ISA benchmark (iterations * N) */
 
 /* Tolerance thresholds */
 #define TOLERANCE               1e-5f       /* Default numerical tolerance */
@@ -41,11 +42,25 @@
 #define RAND_SEED_LINEARITY     789         /* Seed for linearity test */
 #define RAND_SEED_TIMESHIFT     111         /* Seed for time-shift test */
 #define RAND_SEED_SYMMETRY      222         /* Seed for real-symmetry test */
+#define RAND_SEED_ISA           333         /* Seed for ISA-vs-scalar test */
+#define RAND_SEED_BATCH         444         /* Seed for batch test */
+
+/* Planner test: wisdom file written next to the test binary */
+#define WISDOM_TEST_FILE        "lfft_test.wisdom"
+
+/* Batch test layout: frame count not a multiple of the batch lanes,
+ * frames padded so the stride is not a multiple of the vector width */
+#define BATCH_FRAMES            37
+#define BATCH_PAD               3
+#define BENCHMARK_BATCH_FRAMES  256
 
 /* Linearity test coefficients */
 #define LINEARITY_COEFF_A       2.5f        /* First linear coefficient */
 #define LINEARITY_COEFF_B       (-1.3f)     /* Second linear coefficient */
 
+/* ISA kernels vs scalar kernels: max error relative to the peak bin */
+#define ISA_REL_TOLERANCE       1e-5f
+
 /* Time shift parameters */
 #define MIN_SIZE_TIME_SHIFT     4           /* Minimum FFT size for time shift test */
 #define TIME_SHIFT_AMOUNT       1           /* Number of samples to shift */
@@ -65,6 +80,7 @@
 static int g_tests_passed = 0;
 static int g_tests_failed = 0;
 static int g_verbose = 0;
+static int g_quick = 0;
 
 #define TEST_ASSERT(cond, msg) do { \
 	if (!(cond)) { \
@@ -131,7 +147,8 @@ static void reference_dft(const hlfft_complex_t *in, hlfft_complex_t *out, size_
 		out[k].re = 0.0f;
 		out[k].im = 0.0f;
 		for (size_t j = 0; j < n; j++) {
-			float angle = sign * 2.0f * (float)M_PI * (float)k * (float)j / (float)n;
+			/* Reduce k*j mod N first, a float phase loses precision for large N */
+			float angle = sign * 2.0f * (float)M_PI * (float)((k * j) % n) / (float)n;
 			float c = cosf(angle);
 			float s = sinf(angle);
 			out[k].re += in[j].re * c - in[j].im * s;
@@ -231,7 +248,7 @@ static int test_single_tones(size_t n)
 	for (size_t target_bin = 0; target_bin < n; target_bin++) {
 		/* Generate complex exponential at frequency target_bin */
 		for (size_t i = 0; i < n; i++) {
-			float phase = 2.0f * (float)M_PI * (float)target_bin * (float)i / (float)n;
+			float phase = 2.0f * (float)M_PI * (float)((target_bin * i) % n) / (float)n;
 			in[i].re = cosf(phase);
 			in[i].im = sinf(phase);
 		}
@@ -552,6 +569,233 @@ static int test_real_symmetry(size_t n)
 	return 1;
 }
 
+/*
+ * Test 10: SIMD Stage Kernels vs Scalar Kernels
+ * Same input through a plan pinned to each ISA and a scalar plan, for the
+ * forward, inverse and split (SoA) transforms.
+ */
+static float max_rel_error_soa(const float *a_re, const float *a_im,
+			       const float *b_re, const float *b_im, size_t n)
+{
+	float max_err = 0.0f, peak = 0.0f;
+	for (size_t i = 0; i < n; i++) {
+		float err = complex_mag((hlfft_complex_t){a_re[i] - b_re[i], a_im[i] - b_im[i]});
+		float mag = complex_mag((hlfft_complex_t){b_re[i], b_im[i]});
+		if (err > max_err)
+			max_err = err;
+		if (mag > peak)
+			peak = mag;
+	}
+	return peak > 0.0f ? max_err / peak : max_err;
+}
+
+static float max_rel_error(const hlfft_complex_t *a, const hlfft_complex_t *b, size_t n)
+{
+	float peak = 0.0f;
+	for (size_t i = 0; i < n; i++) {
+		if (complex_mag(b[i]) > peak)
+			peak = complex_mag(b[i]);
+	}
+	float max_err = max_abs_error(a, b, n);
+	return peak > 0.0f ? max_err / peak : max_err;
+}
+
+static int test_isa_vs_scalar(size_t n, hlfft_isa_t isa, hlfft_algo_t algo)
+{
+	hlfft_config_t isa_cfg = {isa, algo, 0, NULL};
+	hlfft_config_t ref_cfg = {HLFFT_ISA_SCALAR, HLFFT_ALGO_STAGES_OTF, 0, NULL};
+	hlfft_plan_t *plan = hlfft_plan_create(n, &isa_cfg);
+	hlfft_plan_t *ref = hlfft_plan_create(n, &ref_cfg);
+	TEST_ASSERT(plan && ref, "plan creation");
+	TEST_ASSERT(hlfft_plan_algo(plan) == algo, "plan should run the requested algorithm");
+
+	hlfft_complex_t *in = alloc_complex(n);
+	hlfft_complex_t *out = alloc_complex(n);
+	hlfft_complex_t *out_ref = alloc_complex(n);
+	/* Split arrays padded to 64 bytes, the kernels assume aligned buffers */
+	size_t pn = (n + 15) & ~(size_t)15;
+	float *soa = (float *)hlfft_aligned_alloc(6 * pn * sizeof(float));
+	TEST_ASSERT(in && out && out_ref && soa, "memory allocation");
+	float *in_re = soa, *in_im = soa + pn;
+	float *o_re = soa + 2 * pn, *o_im = soa + 3 * pn;
+	float *r_re = soa + 4 * pn, *r_im = soa + 5 * pn;
+
+	srand(RAND_SEED_ISA + (unsigned)n);
+	for (size_t i = 0; i < n; i++) {
+		in[i].re = in_re[i] = (float)(rand() % RAND_RANGE - RAND_OFFSET) / RAND_SCALE;
+		in[i].im = in_im[i] = (float)(rand() % RAND_RANGE - RAND_OFFSET) / RAND_SCALE;
+	}
+
+	hlfft_forward(plan, in, out);
+	hlfft_forward(ref, in, out_ref);
+	float fwd_err = max_rel_error(out, out_ref, n);
+
+	hlfft_inverse(plan, in, out);
+	hlfft_inverse(ref, in, out_ref);
+	float inv_err = max_rel_error(out, out_ref, n);
+
+	hlfft_forward_soa(plan, in_re, in_im, o_re, o_im);
+	hlfft_forward_soa(ref, in_re, in_im, r_re, r_im);
+	float soa_err = max_rel_error_soa(o_re, o_im, r_re, r_im, n);
+
+	if (g_verbose)
+		printf("    %s %s vs scalar rel error: fwd %.2e, inv %.2e, soa %.2e\n",
+		       hlfft_isa_name(isa), hlfft_algo_name(algo),
+		       fwd_err, inv_err, soa_err);
+
+	TEST_ASSERT(fwd_err < ISA_REL_TOLERANCE, "forward should match scalar kernels");
+	TEST_ASSERT(inv_err < ISA_REL_TOLERANCE, "inverse should match scalar kernels");
+	TEST_ASSERT(soa_err < ISA_REL_TOLERANCE, "split forward should match scalar kernels");
+
+	free_complex(in);
+	free_complex(out);
+	free_complex(out_ref);
+	hlfft_aligned_free(soa);
+	hlfft_plan_destroy(plan);
+	hlfft_plan_destroy(ref);
+	return 1;
+}
+
+/*
+ * Test 11: Batched Forward FFT
+ * hlfft_forward_soa_batch() on padded frames vs one hlfft_forward_soa()
+ * per frame, for a plan pinned to an ISA.
+ */
+static int test_batch(size_t n, hlfft_isa_t isa)
+{
+	hlfft_config_t cfg = {isa, HLFFT_ALGO_AUTO, 0, NULL};
+	hlfft_plan_t *plan = hlfft_plan_create(n, &cfg);
+	TEST_ASSERT(plan != NULL, "plan creation");
+
+	const size_t stride = n + BATCH_PAD;
+	const size_t total = stride * BATCH_FRAMES;
+	float *buf = (float *)hlfft_aligned_alloc(6 * total * sizeof(float));
+	TEST_ASSERT(buf != NULL, "memory allocation");
+	float *in_re = buf, *in_im = buf + total;
+	float *o_re = buf + 2 * total, *o_im = buf + 3 * total;
+	float *r_re = buf + 4 * total, *r_im = buf + 5 * total;
+
+	srand(RAND_SEED_BATCH + (unsigned)n);
+	for (size_t i = 0; i < total; i++) {
+		in_re[i] = (float)(rand() % RAND_RANGE - RAND_OFFSET) / RAND_SCALE;
+		in_im[i] = (float)(rand() % RAND_RANGE - RAND_OFFSET) / RAND_SCALE;
+		o_re[i] = o_im[i] = r_re[i] = r_im[i] = 0.0f;
+	}
+
+	TEST_ASSERT(hlfft_forward_soa_batch(plan, in_re, in_im, o_re, o_im,
+					    n - 1, BATCH_FRAMES) != HLFFT_OK,
+		    "stride below N should be rejected");
+	TEST_ASSERT(hlfft_forward_soa_batch(plan, in_re, in_im, o_re, o_im,
+					    stride, BATCH_FRAMES) == HLFFT_OK,
+		    "batch should succeed");
+
+	/* Reference: one call per frame, through aligned scratch buffers */
+	size_t pn = (n + 15) & ~(size_t)15;
+	float *scratch = (float *)hlfft_aligned_alloc(4 * pn * sizeof(float));
+	TEST_ASSERT(scratch != NULL, "memory allocation");
+	float *s_in_re = scratch, *s_in_im = scratch + pn;
+	float *s_out_re = scratch + 2 * pn, *s_out_im = scratch + 3 * pn;
+	for (size_t f = 0; f < BATCH_FRAMES; f++) {
+		size_t o = f * stride;
+		memcpy(s_in_re, in_re + o, n * sizeof(float));
+		memcpy(s_in_im, in_im + o, n * sizeof(float));
+		hlfft_forward_soa(plan, s_in_re, s_in_im, s_out_re, s_out_im);
+		memcpy(r_re + o, s_out_re, n * sizeof(float));
+		memcpy(r_im + o, s_out_im, n * sizeof(float));
+	}
+	hlfft_aligned_free(scratch);
+
+	float max_err = 0.0f;
+	for (size_t f = 0; f < BATCH_FRAMES; f++) {
+		size_t o = f * stride;
+		float err = max_rel_error_soa(o_re + o, o_im + o, r_re + o, r_im + o, n);
+		if (err > max_err)
+			max_err = err;
+		for (size_t i = n; i < stride; i++)
+			TEST_ASSERT(o_re[o + i] == 0.0f && o_im[o + i] == 0.0f,
+				    "padding between frames should be untouched");
+	}
+	if (g_verbose)
+		printf("    %s batch vs single rel error: %.2e\n", hlfft_isa_name(isa), max_err);
+	TEST_ASSERT(max_err < ISA_REL_TOLERANCE, "batch should match single frames");
+
+	hlfft_aligned_free(buf);
+	hlfft_plan_destroy(plan);
+	return 1;
+}
+
+/*
+ * Test 12: Planner and Wisdom
+ * Algorithm selection rules, measured choices kept in a wisdom file and
+ * loaded back, malformed wisdom lines ignored.
+ */
+static int test_planner(void)
+{
+	hlfft_config_t cfg = {HLFFT_ISA_AUTO, HLFFT_ALGO_CODELET, 0, NULL};
+	hlfft_plan_t *plan;
+
+	plan = hlfft_plan_create(HLFFT_CODELET_MAX_SIZE * 2, &cfg);
+	TEST_ASSERT(plan == NULL, "codelet above its maximum size should be rejected");
+	cfg.algo = HLFFT_ALGO_COUNT;
+	plan = hlfft_plan_create(16, &cfg);
+	TEST_ASSERT(plan == NULL, "unknown algorithm should be rejected");
+
+	for (size_t n = 2; n <= 4096; n *= 2) {
+		plan = hlfft_plan_create(n, NULL);
+		TEST_ASSERT(plan && hlfft_plan_algo(plan) != HLFFT_ALGO_AUTO,
+			    "default plan should resolve an algorithm");
+		hlfft_plan_destroy(plan);
+	}
+
+	/* Measure with the scalar kernels, the choice lands in the file */
+	remove(WISDOM_TEST_FILE);
+	hlfft_config_t measure = {HLFFT_ISA_SCALAR, HLFFT_ALGO_AUTO, 1, WISDOM_TEST_FILE};
+	plan = hlfft_plan_create(32, &measure);
+	TEST_ASSERT(plan != NULL, "measured plan creation");
+	hlfft_algo_t measured = hlfft_plan_algo(plan);
+	hlfft_plan_destroy(plan);
+
+	char line[128], expect[64];
+	int found = 0;
+	snprintf(expect, sizeof(expect), "%s 32 %s\n",
+		 hlfft_isa_name(HLFFT_ISA_SCALAR), hlfft_algo_name(measured));
+	FILE *f = fopen(WISDOM_TEST_FILE, "r");
+	TEST_ASSERT(f != NULL, "wisdom file should be written");
+	while (fgets(line, sizeof(line), f))
+		found |= !strcmp(line, expect);
+	fclose(f);
+	if (g_verbose)
+		printf("    measured scalar N=32: %s\n", hlfft_algo_name(measured));
+	TEST_ASSERT(found, "wisdom file should hold the measured choice");
+
+	/* Same size again: the learned choice, no new measurement */
+	hlfft_config_t wise = {HLFFT_ISA_SCALAR, HLFFT_ALGO_AUTO, 0, NULL};
+	plan = hlfft_plan_create(32, &wise);
+	TEST_ASSERT(plan && hlfft_plan_algo(plan) == measured, "wisdom should be reused");
+	hlfft_plan_destroy(plan);
+
+	/* Entries written by hand, one of them malformed */
+	f = fopen(WISDOM_TEST_FILE, "a");
+	TEST_ASSERT(f != NULL, "wisdom file should be writable");
+	fprintf(f, "%s 8192 table\n", hlfft_isa_name(HLFFT_ISA_SCALAR));
+	fprintf(f, "%s 16384 codelet\n", hlfft_isa_name(HLFFT_ISA_SCALAR));
+	fprintf(f, "garbage\n");
+	fclose(f);
+
+	wise.wisdom_file = WISDOM_TEST_FILE;
+	plan = hlfft_plan_create(8192, &wise);
+	TEST_ASSERT(plan && hlfft_plan_algo(plan) == HLFFT_ALGO_STAGES_TABLE,
+		    "wisdom file choice should be loaded");
+	hlfft_plan_destroy(plan);
+	plan = hlfft_plan_create(16384, &wise);
+	TEST_ASSERT(plan && hlfft_plan_algo(plan) == HLFFT_ALGO_STAGES_OTF,
+		    "impossible wisdom entry should be ignored");
+	hlfft_plan_destroy(plan);
+
+	remove(WISDOM_TEST_FILE);
+	return 1;
+}
+
 /* ============================================================================
  * Benchmark
  * ========================================================================= */
@@ -625,6 +869,77 @@ static void run_benchmark(size_t n, int iterations)
 	hlfft_plan_destroy(plan);
 }
 
+/* Forward FFT time in ns for a plan pinned to an ISA and algorithm,
+ * 0 if unsupported */
+static double bench_isa_forward(size_t n, hlfft_isa_t isa, hlfft_algo_t algo)
+{
+	hlfft_config_t cfg = {isa, algo, 0, NULL};
+	hlfft_plan_t *plan = hlfft_plan_create(n, &cfg);
+	hlfft_complex_t *in = alloc_complex(n);
+	hlfft_complex_t *out = alloc_complex(n);
+	double ns = 0.0;
+
+	if (plan && in && out) {
+		int iterations = (int)(BENCHMARK_ISA_SAMPLES / n);
+
+		for (size_t i = 0; i < n; i++) {
+			in[i].re = (float)(i % TEST_DATA_MOD_RE) / (float)TEST_DATA_MOD_RE;
+			in[i].im = (float)(i % TEST_DATA_MOD_IM) / (float)TEST_DATA_MOD_IM;
+		}
+		for (int i = 0; i < iterations / 100 + 1; i++)
+			hlfft_forward(plan, in, out);
+
+		double start = get_time_sec();
+		for (int i = 0; i < iterations; i++)
+			hlfft_forward(plan, in, out);
+		ns = (get_time_sec() - start) * NS_PER_SEC / iterations;
+	}
+
+	free_complex(in);
+	free_complex(out);
+	hlfft_plan_destroy(plan);
+	return ns;
+}
+
+/* ns per frame for BENCHMARK_BATCH_FRAMES frames, one call each or batched */
+static void bench_batch(size_t n, double *single_ns, double *batch_ns)
+{
+	hlfft_plan_t *plan = hlfft_plan_create(n, NULL);
+	size_t total = n * BENCHMARK_BATCH_FRAMES;
+	float *buf = (float *)hlfft_aligned_alloc(4 * total * sizeof(float));
+
+	*single_ns = *batch_ns = 0.0;
+	if (plan && buf) {
+		float *in_re = buf, *in_im = buf + total;
+		float *out_re = buf + 2 * total, *out_im = buf + 3 * total;
+		int iterations = (int)(BENCHMARK_ISA_SAMPLES / total) + 1;
+
+		for (size_t i = 0; i < total; i++) {
+			in_re[i] = (float)(i % TEST_DATA_MOD_RE) / (float)TEST_DATA_MOD_RE;
+			in_im[i] = (float)(i % TEST_DATA_MOD_IM) / (float)TEST_DATA_MOD_IM;
+		}
+
+		double start = get_time_sec();
+		for (int it = 0; it < iterations; it++) {
+			for (size_t f = 0; f < BENCHMARK_BATCH_FRAMES; f++)
+				hlfft_forward_soa(plan, in_re + f * n, in_im + f * n,
+						  out_re + f * n, out_im + f * n);
+		}
+		*single_ns = (get_time_sec() - start) * NS_PER_SEC /
+			     ((double)iterations * BENCHMARK_BATCH_FRAMES);
+
+		start = get_time_sec();
+		for (int it = 0; it < iterations; it++)
+			hlfft_forward_soa_batch(plan, in_re, in_im, out_re, out_im,
+						n, BENCHMARK_BATCH_FRAMES);
+		*batch_ns = (get_time_sec() - start) * NS_PER_SEC /
+			    ((double)iterations * BENCHMARK_BATCH_FRAMES);
+	}
+
+	hlfft_aligned_free(buf);
+	hlfft_plan_destroy(plan);
+}
+
 /* ============================================================================
  * Main
  * ========================================================================= */
@@ -636,7 +951,7 @@ static void run_correctness_tests(void)
 	printf("                    CORRECTNESS TESTS\n");
 	printf("=============================================================\n");
 
-	size_t sizes[] = {2, 4, 8, 16, 32};
+	size_t sizes[] = {2, 4, 8, 16, 32, 64, 128, 256, 512, 1024};
 	int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
 
 	for (int i = 0; i < num_sizes; i++) {
@@ -674,6 +989,72 @@ static void run_correctness_tests(void)
 	}
 }
 
+static void run_isa_tests(void)
+{
+	printf("\n");
+	printf("=============================================================\n");
+	printf("                 SIMD KERNELS VS SCALAR\n");
+	printf("=============================================================\n");
+	printf("\n  Runtime selection: %s\n", hlfft_isa_name(hlfft_isa_selected()));
+	printf("  Reference: scalar kernels, OTF stages\n");
+
+	for (int isa = HLFFT_ISA_SCALAR; isa < HLFFT_ISA_COUNT; isa++) {
+		if (!hlfft_isa_supported((hlfft_isa_t)isa)) {
+			printf("\n--- %s: not supported by this CPU, skipped ---\n",
+			       hlfft_isa_name((hlfft_isa_t)isa));
+			continue;
+		}
+		printf("\n--- %s ---\n", hlfft_isa_name((hlfft_isa_t)isa));
+
+		for (int algo = HLFFT_ALGO_STAGES_OTF; algo < HLFFT_ALGO_COUNT; algo++) {
+			if (isa == HLFFT_ISA_SCALAR && algo == HLFFT_ALGO_STAGES_OTF)
+				continue;
+
+			size_t max_n = algo == HLFFT_ALGO_CODELET ? HLFFT_CODELET_MAX_SIZE : 65536;
+			for (size_t n = 2; n <= max_n; n *= 2) {
+				char name[64];
+				snprintf(name, sizeof(name), "%s %s vs scalar (N=%zu)",
+					 hlfft_isa_name((hlfft_isa_t)isa),
+					 hlfft_algo_name((hlfft_algo_t)algo), n);
+				test_result(name, test_isa_vs_scalar(n, (hlfft_isa_t)isa,
+								     (hlfft_algo_t)algo));
+			}
+		}
+	}
+}
+
+static void run_planner_tests(void)
+{
+	printf("\n");
+	printf("=============================================================\n");
+	printf("                   PLANNER AND WISDOM\n");
+	printf("=============================================================\n");
+	printf("\n");
+
+	test_result("Planner rules and wisdom file", test_planner());
+}
+
+static void run_batch_tests(void)
+{
+	printf("\n");
+	printf("=============================================================\n");
+	printf("                    BATCHED FORWARD FFT\n");
+	printf("=============================================================\n");
+
+	for (int isa = HLFFT_ISA_SCALAR; isa < HLFFT_ISA_COUNT; isa++) {
+		if (!hlfft_isa_supported((hlfft_isa_t)isa))
+			continue;
+		printf("\n--- %s ---\n", hlfft_isa_name((hlfft_isa_t)isa));
+
+		for (size_t n = 2; n <= 256; n *= 2) {
+			char name[64];
+			snprintf(name, sizeof(name), "%s batch of %d (N=%zu)",
+				 hlfft_isa_name((hlfft_isa_t)isa), BATCH_FRAMES, n);
+			test_result(name, test_batch(n, (hlfft_isa_t)isa));
+		}
+	}
+}
+
 static void run_benchmarks(void)
 {
 	printf("\n");
@@ -692,14 +1073,73 @@ static void run_benchmarks(void)
 
 	for (int i = 0; i < num_sizes; i++)
 		run_benchmark(sizes[i], BENCHMARK_ITERATIONS);
+
+	printf("\n");
+	printf("  Forward FFT ns per ISA (speedup vs scalar)\n");
+	printf("\n");
+	printf("  Size  ");
+	for (int isa = HLFFT_ISA_SCALAR; isa < HLFFT_ISA_COUNT; isa++) {
+		if (hlfft_isa_supported((hlfft_isa_t)isa))
+			printf("%-20s", hlfft_isa_name((hlfft_isa_t)isa));
+	}
+	printf("\n");
+
+	for (size_t n = 64; n <= 16384; n *= 4) {
+		double scalar_ns = bench_isa_forward(n, HLFFT_ISA_SCALAR, HLFFT_ALGO_STAGES_OTF);
+		printf("  %-5zu %-20.1f", n, scalar_ns);
+		for (int isa = HLFFT_ISA_SSE2; isa < HLFFT_ISA_COUNT; isa++) {
+			if (!hlfft_isa_supported((hlfft_isa_t)isa))
+				continue;
+			double ns = bench_isa_forward(n, (hlfft_isa_t)isa, HLFFT_ALGO_STAGES_OTF);
+			char cell[32];
+			snprintf(cell, sizeof(cell), "%.1f (%.2fx)", ns, scalar_ns / ns);
+			printf("%-20s", cell);
+		}
+		printf("\n");
+	}
+
+	printf("\n");
+	printf("  Forward FFT ns per algorithm (%s)\n", hlfft_isa_name(hlfft_isa_selected()));
+	printf("\n");
+	printf("  Size  ");
+	for (int algo = HLFFT_ALGO_STAGES_OTF; algo < HLFFT_ALGO_COUNT; algo++)
+		printf("%-12s", hlfft_algo_name((hlfft_algo_t)algo));
+	printf("default\n");
+	for (size_t n = 2; n <= 4096; n *= 2) {
+		hlfft_plan_t *plan = hlfft_plan_create(n, NULL);
+		printf("  %-5zu ", n);
+		for (int algo = HLFFT_ALGO_STAGES_OTF; algo < HLFFT_ALGO_COUNT; algo++) {
+			if (algo == HLFFT_ALGO_CODELET && n > HLFFT_CODELET_MAX_SIZE)
+				printf("%-12s", "-");
+			else
+				printf("%-12.1f", bench_isa_forward(n, HLFFT_ISA_AUTO,
+								    (hlfft_algo_t)algo));
+		}
+		printf("%s\n", hlfft_algo_name(hlfft_plan_algo(plan)));
+		hlfft_plan_destroy(plan);
+	}
+
+	printf("\n");
+	printf("  Forward FFT ns per frame, %d frames (%s)\n",
+	       BENCHMARK_BATCH_FRAMES, hlfft_isa_name(hlfft_isa_selected()));
+	printf("\n");
+	printf("  Size  one call per frame  batched             speedup\n");
+	for (size_t n = 2; n <= 256; n *= 2) {
+		double single_ns, batch_ns;
+		bench_batch(n, &single_ns, &batch_ns);
+		printf("  %-5zu %-19.1f %-19.1f %.2fx\n",
+		       n, single_ns, batch_ns, single_ns / batch_ns);
+	}
 }
 
 int main(int argc, char *argv[])
 {
-	/* Check for verbose flag */
+	/* Check for verbose and quick (no benchmarks) flags */
 	for (int i = 1; i < argc; i++) {
 		if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
 			g_verbose = 1;
+		if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quick") == 0)
+			g_quick = 1;
 	}
 
 	printf("\n");
@@ -716,7 +1156,11 @@ int main(int argc, char *argv[])
 
 	/* Run tests */
 	run_correctness_tests();
-	run_benchmarks();
+	run_isa_tests();
+	run_batch_tests();
+	run_planner_tests();
+	if (!g_quick)
+		run_benchmarks();
 
 	/* Summary */
 	printf("\n");
@@ -0,0 +1,16 @@
+/*
+ * Stockham FFT - AVX2+FMA Stage Kernels
+ *
+ * Compiled with -mavx2 -mfma -ffast-math (GCC/Clang) or /arch:AVX2
+ * /fp:fast (MSVC), the stage loops are auto-vectorized to 256-bit FMA.
+ *
+ * License: MIT
+ * Copyright (c) 2025-2026, Benjamin Vernoux <bvernoux@hydrasdr.com>
+ */
+
+#include "stockham_internal.h"
+#include "compat_opt.h"
+
+#define SFFT_KERNELS_NAME sfft_kernels_avx2
+#define SFFT_KERNELS_LABEL "AVX2+FMA"
+#include "stockham_kernels.inc"
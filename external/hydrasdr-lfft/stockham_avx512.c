@@ -0,0 +1,17 @@
+/*
+ * Stockham FFT - AVX-512 Stage Kernels
+ *
+ * Compiled with -mavx512f -mavx512vl -mfma -ffast-math (GCC/Clang) or
+ * /arch:AVX512 /fp:fast (MSVC), the stage loops are auto-vectorized to
+ * 512-bit FMA.
+ *
+ * License: MIT
+ * Copyright (c) 2025-2026, Benjamin Vernoux <bvernoux@hydrasdr.com>
+ */
+
+#include "stockham_internal.h"
+#include "compat_opt.h"
+
+#define SFFT_KERNELS_NAME sfft_kernels_avx512
+#define SFFT_KERNELS_LABEL "AVX-512"
+#include "stockham_kernels.inc"
@@ -75,6 +75,102 @@ typedef struct sfft_backend_vtable {
 /* Scalar backend vtable */
 extern const sfft_backend_vtable_t sfft_backend_scalar;
 
+/* ============================================================================
+ * Stage Kernels (per-ISA, selected at runtime)
+ *
+ * The plan, twiddles, buffers and format conversions are shared, only the
+ * radix-4 and final radix-2 stages differ. Each SIMD variant is the same
+ * source (stockham_kernels.inc) compiled with its own ISA flags.
+ * ========================================================================= */
+
+typedef void (*sfft_radix4_fn)(const float *restrict src_re,
+			       const float *restrict src_im,
+			       float *restrict dst_re,
+			       float *restrict dst_im,
+			       const float *restrict tw_re,
+			       const float *restrict tw_im,
+			       size_t n,
+			       size_t stage);
+
+typedef void (*sfft_radix2_fn)(const float *restrict src_re,
+			       const float *restrict src_im,
+			       float *restrict dst_re,
+			       float *restrict dst_im,
+			       size_t n);
+
+/* Batch stages: frame-interleaved data, element e of frame f at
+ * [e * SFFT_BATCH_LANES + f] */
+typedef void (*sfft_radix4_batch_fn)(const float *restrict src_re,
+				     const float *restrict src_im,
+				     float *restrict dst_re,
+				     float *restrict dst_im,
+				     const float *restrict tw_re,
+				     const float *restrict tw_im,
+				     size_t n,
+				     size_t stage);
+
+typedef void (*sfft_radix2_batch_fn)(const float *restrict src_re,
+				     const float *restrict src_im,
+				     float *restrict dst_re,
+				     float *restrict dst_im,
+				     size_t n);
+
+/* Straight-line forward FFT of one size (stockham_codelets.inc) */
+typedef void (*sfft_codelet_fn)(const float *in_re, const float *in_im,
+				float *out_re, float *out_im);
+
+#define SFFT_CODELET_MAX_LOG2N 6	/* Codelets for N = 2..64 */
+
+typedef struct sfft_kernels {
+	const char *name;
+	sfft_radix4_fn radix4;		/* Radix-4 stage with OTF twiddles */
+	sfft_radix4_fn radix4_table;	/* Radix-4 stage, stored W^k|W^2k|W^3k */
+	sfft_radix2_fn radix2_last;	/* Final radix-2 stage */
+	sfft_radix4_batch_fn radix4_batch;	/* NULL: batches run frame by frame */
+	sfft_radix2_batch_fn radix2_batch;
+	sfft_codelet_fn codelets[SFFT_CODELET_MAX_LOG2N + 1];	/* [log2 N] */
+} sfft_kernels_t;
+
+extern const sfft_kernels_t sfft_kernels_scalar;	/* stockham_scalar.c */
+extern const sfft_kernels_t sfft_kernels_sse2;		/* stockham_sse2.c */
+extern const sfft_kernels_t sfft_kernels_avx2;		/* stockham_avx2.c */
+extern const sfft_kernels_t sfft_kernels_avx512;	/* stockham_avx512.c */
+extern const sfft_kernels_t sfft_kernels_neon;		/* stockham_neon.c */
+
+/* Select the stage kernels of a plan (scalar after plan_create) */
+void sfft_plan_set_kernels(sfft_plan_t *plan, const sfft_kernels_t *kernels);
+
+/*
+ * Execution strategy of a plan (SFFT_ALGO_OTF after plan_create):
+ * - OTF:     radix-4 stages, W^{2k} and W^{3k} computed from stored W^k
+ * - TABLE:   radix-4 stages, W^k, W^{2k} and W^{3k} all stored (3x memory)
+ * - CODELET: straight-line codelet, N <= 2^SFFT_CODELET_MAX_LOG2N only
+ * Complex-to-complex transforms only, R2C/C2R keep the OTF stages.
+ */
+typedef enum {
+	SFFT_ALGO_OTF = 0,
+	SFFT_ALGO_TABLE,
+	SFFT_ALGO_CODELET
+} sfft_algo_t;
+
+/* Returns 0, or -1 if the algorithm is not available for this size or
+ * the twiddle tables cannot be allocated (plan unchanged) */
+int sfft_plan_set_algo(sfft_plan_t *plan, sfft_algo_t algo);
+
+/*
+ * Batched split-format forward FFT: count frames, frame k at offset
+ * k * stride in each array. Sizes up to SFFT_BATCH_MAX_N are transformed
+ * SFFT_BATCH_LANES frames at a time on frame-interleaved data when the
+ * kernels have batch stages, larger sizes frame by frame.
+ */
+#define SFFT_BATCH_LANES 16
+#define SFFT_BATCH_MAX_N 64
+
+void sfft_forward_split_batch(const sfft_plan_t *plan,
+			      const float *in_re, const float *in_im,
+			      float *out_re, float *out_im,
+			      size_t stride, size_t count);
+
 /* ============================================================================
  * Public API (internal names used by hydrasdr_lfft.c)
  * ========================================================================= */
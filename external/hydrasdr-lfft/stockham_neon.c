@@ -0,0 +1,16 @@
+/*
+ * Stockham FFT - NEON Stage Kernels
+ *
+ * NEON is mandatory on AArch64. Compiled with -ffast-math only, the stage
+ * loops are auto-vectorized to 128-bit NEON.
+ *
+ * License: MIT
+ * Copyright (c) 2025-2026, Benjamin Vernoux <bvernoux@hydrasdr.com>
+ */
+
+#include "stockham_internal.h"
+#include "compat_opt.h"
+
+#define SFFT_KERNELS_NAME sfft_kernels_neon
+#define SFFT_KERNELS_LABEL "NEON"
+#include "stockham_kernels.inc"
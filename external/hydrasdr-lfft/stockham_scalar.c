@@ -7,6 +7,9 @@
  * - Computes W^{3k} = W^{2k} * W^k on-the-fly
  * - ~2x faster than Radix-2 due to better cache utilization
  *
+ * Plans can instead store W^{2k}/W^{3k} tables or, up to 64 points, run a
+ * straight-line codelet (sfft_plan_set_algo).
+ *
  * This is the portable baseline implementation that works on all platforms.
  * It relies on compiler auto-vectorization with hints for SIMD optimization.
  *
@@ -34,6 +37,7 @@
 
 struct sfft_plan {
 	const sfft_backend_vtable_t *vtable;	/* Backend that created this plan */
+	const sfft_kernels_t *kernels;		/* Stage kernels (ISA variant) */
 
 	size_t n;
 	size_t log2n;
@@ -44,6 +48,12 @@ struct sfft_plan {
 	float **tw_re;
 	float **tw_im;
 
+	/* Execution strategy (sfft_plan_set_algo) */
+	sfft_algo_t algo;
+	float **tw3_re;			/* SFFT_ALGO_TABLE: W^k|W^2k|W^3k per stage */
+	float **tw3_im;
+	sfft_codelet_fn codelet;	/* SFFT_ALGO_CODELET */
+
 	/* R2C/C2R support: twiddles for N/2-point internal FFT */
 	size_t half_log4n;		/* Number of radix-4 stages for N/2-point FFT */
 	int half_has_radix2_stage;	/* Final radix-2 for N/2-point FFT */
@@ -62,6 +72,13 @@ struct sfft_plan {
 	float *OPT_RESTRICT work_im;
 	float *OPT_RESTRICT work2_re;
 	float *OPT_RESTRICT work2_im;
+
+	/* Batch buffers, frame-interleaved (n * SFFT_BATCH_LANES floats each),
+	 * NULL if n > SFFT_BATCH_MAX_N */
+	float *batch_re;
+	float *batch_im;
+	float *batch2_re;
+	float *batch2_im;
 };
 
 /* ============================================================================
@@ -154,6 +171,64 @@ static int compute_twiddles(sfft_plan_t *plan)
 	return 0;
 }
 
+/* ============================================================================
+ * Stored Twiddle Tables (SFFT_ALGO_TABLE)
+ *
+ * Per stage W^k, W^{2k} and W^{3k} back to back, 3x the memory of the
+ * OTF twiddles and two complex multiplies less per butterfly.
+ * ========================================================================= */
+
+static void free_table_twiddles(sfft_plan_t *plan)
+{
+	for (size_t s = 0; s < plan->log4n; s++) {
+		if (plan->tw3_re)
+			scalar_aligned_free(plan->tw3_re[s]);
+		if (plan->tw3_im)
+			scalar_aligned_free(plan->tw3_im[s]);
+	}
+	free(plan->tw3_re);
+	free(plan->tw3_im);
+	plan->tw3_re = NULL;
+	plan->tw3_im = NULL;
+}
+
+static int compute_table_twiddles(sfft_plan_t *plan)
+{
+	const size_t n = plan->n;
+	const double neg_2pi_over_n = -2.0 * M_PI / (double)n;
+
+	if (plan->tw3_re || plan->log4n == 0)
+		return 0;
+
+	plan->tw3_re = (float **)calloc(plan->log4n, sizeof(float *));
+	plan->tw3_im = (float **)calloc(plan->log4n, sizeof(float *));
+	if (!plan->tw3_re || !plan->tw3_im) {
+		free_table_twiddles(plan);
+		return -1;
+	}
+
+	for (size_t s = 0; s < plan->log4n; s++) {
+		const size_t quarter_m = (n >> (s * 2)) >> 2;
+		const size_t stride = 1ULL << (s * 2);
+
+		plan->tw3_re[s] = (float *)scalar_aligned_alloc(3 * quarter_m * sizeof(float));
+		plan->tw3_im[s] = (float *)scalar_aligned_alloc(3 * quarter_m * sizeof(float));
+		if (!plan->tw3_re[s] || !plan->tw3_im[s]) {
+			free_table_twiddles(plan);
+			return -1;
+		}
+
+		for (size_t p = 1; p <= 3; p++) {
+			for (size_t j = 0; j < quarter_m; j++) {
+				double angle = neg_2pi_over_n * (double)(p * j * stride);
+				plan->tw3_re[s][(p - 1) * quarter_m + j] = (float)cos(angle);
+				plan->tw3_im[s][(p - 1) * quarter_m + j] = (float)sin(angle);
+			}
+		}
+	}
+	return 0;
+}
+
 /* ============================================================================
  * R2C Twiddle Factor Computation
  *
@@ -237,6 +312,7 @@ static sfft_plan_t *scalar_plan_create(size_t n)
 		return NULL;
 
 	plan->vtable = &sfft_backend_scalar;
+	plan->kernels = &sfft_kernels_scalar;
 	plan->n = n;
 	plan->log2n = log2_size(n);
 	plan->log4n = plan->log2n / 2;
@@ -282,6 +358,20 @@ static sfft_plan_t *scalar_plan_create(size_t n)
 		return NULL;
 	}
 
+	if (n <= SFFT_BATCH_MAX_N) {
+		const size_t batch_size = n * SFFT_BATCH_LANES * sizeof(float);
+
+		plan->batch_re = (float *)scalar_aligned_alloc(batch_size);
+		plan->batch_im = (float *)scalar_aligned_alloc(batch_size);
+		plan->batch2_re = (float *)scalar_aligned_alloc(batch_size);
+		plan->batch2_im = (float *)scalar_aligned_alloc(batch_size);
+		if (!plan->batch_re || !plan->batch_im ||
+		    !plan->batch2_re || !plan->batch2_im) {
+			scalar_plan_destroy(plan);
+			return NULL;
+		}
+	}
+
 	return plan;
 }
 
@@ -302,6 +392,8 @@ static void scalar_plan_destroy(sfft_plan_t *plan)
 		free(plan->tw_im);
 	}
 
+	free_table_twiddles(plan);
+
 	/* Free R2C twiddles for N/2-point FFT */
 	if (plan->half_tw_re) {
 		for (size_t s = 0; s < plan->half_log4n; s++)
@@ -322,6 +414,11 @@ static void scalar_plan_destroy(sfft_plan_t *plan)
 	scalar_aligned_free(plan->work_im);
 	scalar_aligned_free(plan->work2_re);
 	scalar_aligned_free(plan->work2_im);
+
+	scalar_aligned_free(plan->batch_re);
+	scalar_aligned_free(plan->batch_im);
+	scalar_aligned_free(plan->batch2_re);
+	scalar_aligned_free(plan->batch2_im);
 	free(plan);
 }
 
@@ -330,6 +427,45 @@ static size_t scalar_plan_size(const sfft_plan_t *plan)
 	return plan ? plan->n : 0;
 }
 
+void sfft_plan_set_kernels(sfft_plan_t *plan, const sfft_kernels_t *kernels)
+{
+	if (!plan || !kernels)
+		return;
+
+	plan->kernels = kernels;
+	if (plan->algo == SFFT_ALGO_CODELET)
+		plan->codelet = kernels->codelets[plan->log2n];
+}
+
+int sfft_plan_set_algo(sfft_plan_t *plan, sfft_algo_t algo)
+{
+	if (!plan)
+		return -1;
+
+	switch (algo) {
+	case SFFT_ALGO_OTF:
+		free_table_twiddles(plan);
+		plan->codelet = NULL;
+		break;
+	case SFFT_ALGO_TABLE:
+		if (compute_table_twiddles(plan) != 0)
+			return -1;
+		plan->codelet = NULL;
+		break;
+	case SFFT_ALGO_CODELET:
+		if (plan->log2n > SFFT_CODELET_MAX_LOG2N)
+			return -1;
+		free_table_twiddles(plan);
+		plan->codelet = plan->kernels->codelets[plan->log2n];
+		break;
+	default:
+		return -1;
+	}
+
+	plan->algo = algo;
+	return 0;
+}
+
 /* ============================================================================
  * Radix-4 Kernel with OTF Twiddle Computation
  *
@@ -472,6 +608,72 @@ static OPT_HOT void stockham_radix4_otf_scalar(
 
 #undef RADIX4_BUTTERFLY_OTF
 
+/* ============================================================================
+ * Radix-4 Kernel with Stored Twiddles (SFFT_ALGO_TABLE)
+ *
+ * tw holds W^k, W^{2k} and W^{3k} back to back (3 * quarter_m entries).
+ * ========================================================================= */
+
+static OPT_HOT void stockham_radix4_table_scalar(
+	const float *OPT_RESTRICT src_re,
+	const float *OPT_RESTRICT src_im,
+	float *OPT_RESTRICT dst_re,
+	float *OPT_RESTRICT dst_im,
+	const float *OPT_RESTRICT tw_re,
+	const float *OPT_RESTRICT tw_im,
+	size_t n,
+	size_t stage)
+{
+	const size_t quarter_n = n >> 2;
+	const size_t m = n >> (stage * 2);
+	const size_t quarter_m = m >> 2;
+	const size_t num_blocks = 1ULL << (stage * 2);
+
+	src_re = OPT_ASSUME_ALIGNED(src_re, SFFT_ALIGN);
+	src_im = OPT_ASSUME_ALIGNED(src_im, SFFT_ALIGN);
+	dst_re = OPT_ASSUME_ALIGNED(dst_re, SFFT_ALIGN);
+	dst_im = OPT_ASSUME_ALIGNED(dst_im, SFFT_ALIGN);
+	tw_re = OPT_ASSUME_ALIGNED(tw_re, SFFT_ALIGN);
+	tw_im = OPT_ASSUME_ALIGNED(tw_im, SFFT_ALIGN);
+
+	for (size_t b = 0; b < num_blocks; b++) {
+		const float *OPT_RESTRICT pa0_re = src_re + b * m;
+		const float *OPT_RESTRICT pa0_im = src_im + b * m;
+		float *OPT_RESTRICT pd0_re = dst_re + b * quarter_m;
+		float *OPT_RESTRICT pd0_im = dst_im + b * quarter_m;
+
+		OPT_PRAGMA_VECTORIZE
+		for (size_t j = 0; j < quarter_m; j++) {
+			const float a0r = pa0_re[j], a0i = pa0_im[j];
+			const float a1r = pa0_re[j + quarter_m], a1i = pa0_im[j + quarter_m];
+			const float a2r = pa0_re[j + 2 * quarter_m], a2i = pa0_im[j + 2 * quarter_m];
+			const float a3r = pa0_re[j + 3 * quarter_m], a3i = pa0_im[j + 3 * quarter_m];
+
+			const float w1r = tw_re[j], w1i = tw_im[j];
+			const float w2r = tw_re[j + quarter_m], w2i = tw_im[j + quarter_m];
+			const float w3r = tw_re[j + 2 * quarter_m], w3i = tw_im[j + 2 * quarter_m];
+
+			const float t0r = a0r + a2r, t0i = a0i + a2i;
+			const float t1r = a0r - a2r, t1i = a0i - a2i;
+			const float t2r = a1r + a3r, t2i = a1i + a3i;
+			const float t3r = a1r - a3r, t3i = a1i - a3i;
+
+			const float u1r = t1r + t3i, u1i = t1i - t3r;
+			const float u2r = t0r - t2r, u2i = t0i - t2i;
+			const float u3r = t1r - t3i, u3i = t1i + t3r;
+
+			pd0_re[j] = t0r + t2r;
+			pd0_im[j] = t0i + t2i;
+			pd0_re[j + quarter_n] = OPT_FMA_F32(u1r, w1r, -(u1i * w1i));
+			pd0_im[j + quarter_n] = OPT_FMA_F32(u1r, w1i, u1i * w1r);
+			pd0_re[j + 2 * quarter_n] = OPT_FMA_F32(u2r, w2r, -(u2i * w2i));
+			pd0_im[j + 2 * quarter_n] = OPT_FMA_F32(u2r, w2i, u2i * w2r);
+			pd0_re[j + 3 * quarter_n] = OPT_FMA_F32(u3r, w3r, -(u3i * w3i));
+			pd0_im[j + 3 * quarter_n] = OPT_FMA_F32(u3r, w3i, u3i * w3r);
+		}
+	}
+}
+
 /* ============================================================================
  * Final Radix-2 Stage (when log2n is odd)
  *
@@ -586,6 +788,20 @@ static OPT_HOT void stockham_radix2_last_scalar(
 	}
 }
 
+/* Radix-4 stage s of a complex-to-complex plan, OTF or stored twiddles */
+static OPT_INLINE void plan_radix4(const sfft_plan_t *plan,
+				   const float *src_re, const float *src_im,
+				   float *dst_re, float *dst_im, size_t s)
+{
+	if (plan->tw3_re)
+		plan->kernels->radix4_table(src_re, src_im, dst_re, dst_im,
+					    plan->tw3_re[s], plan->tw3_im[s],
+					    plan->n, s);
+	else
+		plan->kernels->radix4(src_re, src_im, dst_re, dst_im,
+				      plan->tw_re[s], plan->tw_im[s], plan->n, s);
+}
+
 /* ============================================================================
  * Format Conversion
  *
@@ -693,6 +909,13 @@ static void scalar_forward(const sfft_plan_t *plan,
 	/* Convert input AoS -> SoA */
 	aos_to_soa(input, plan->work_re, plan->work_im, n);
 
+	if (plan->codelet) {
+		plan->codelet(plan->work_re, plan->work_im,
+			      plan->work2_re, plan->work2_im);
+		soa_to_aos(plan->work2_re, plan->work2_im, output, n);
+		return;
+	}
+
 	/* Ping-pong between work buffers */
 	const float *src_re = plan->work_re;
 	const float *src_im = plan->work_im;
@@ -701,8 +924,7 @@ static void scalar_forward(const sfft_plan_t *plan,
 
 	/* Radix-4 stages with OTF twiddle computation */
 	for (size_t s = 0; s < log4n; s++) {
-		stockham_radix4_otf_scalar(src_re, src_im, dst_re, dst_im,
-					   plan->tw_re[s], plan->tw_im[s], n, s);
+		plan_radix4(plan, src_re, src_im, dst_re, dst_im, s);
 
 		/* Swap buffers */
 		const float *tmp;
@@ -712,7 +934,7 @@ static void scalar_forward(const sfft_plan_t *plan,
 
 	/* Final radix-2 stage if needed */
 	if (plan->has_radix2_stage) {
-		stockham_radix2_last_scalar(src_re, src_im, dst_re, dst_im, n);
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, n);
 		src_re = dst_re;
 		src_im = dst_im;
 	}
@@ -731,6 +953,15 @@ static void scalar_inverse(const sfft_plan_t *plan,
 	const size_t n = plan->n;
 	const size_t log4n = plan->log4n;
 
+	/* Codelet: IFFT(x) = swap(FFT(swap(x))), swap exchanges re and im */
+	if (plan->codelet) {
+		aos_to_soa(input, plan->work_re, plan->work_im, n);
+		plan->codelet(plan->work_im, plan->work_re,
+			      plan->work2_im, plan->work2_re);
+		soa_to_aos(plan->work2_re, plan->work2_im, output, n);
+		return;
+	}
+
 	/* Convert input AoS -> SoA with conjugation */
 	OPT_PRAGMA_VECTORIZE
 	for (size_t i = 0; i < n; i++) {
@@ -746,8 +977,7 @@ static void scalar_inverse(const sfft_plan_t *plan,
 
 	/* Radix-4 stages with OTF twiddle computation */
 	for (size_t s = 0; s < log4n; s++) {
-		stockham_radix4_otf_scalar(src_re, src_im, dst_re, dst_im,
-					   plan->tw_re[s], plan->tw_im[s], n, s);
+		plan_radix4(plan, src_re, src_im, dst_re, dst_im, s);
 
 		const float *tmp;
 		tmp = src_re; src_re = dst_re; dst_re = (float *)tmp;
@@ -756,7 +986,7 @@ static void scalar_inverse(const sfft_plan_t *plan,
 
 	/* Final radix-2 stage if needed */
 	if (plan->has_radix2_stage) {
-		stockham_radix2_last_scalar(src_re, src_im, dst_re, dst_im, n);
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, n);
 		src_re = dst_re;
 		src_im = dst_im;
 	}
@@ -828,9 +1058,9 @@ static void scalar_forward_r2c(const sfft_plan_t *plan,
 
 	/* Radix-4 stages using optimized kernel with half_n twiddles */
 	for (size_t s = 0; s < plan->half_log4n; s++) {
-		stockham_radix4_otf_scalar(src_re, src_im, dst_re, dst_im,
-					   plan->half_tw_re[s], plan->half_tw_im[s],
-					   half_n, s);
+		plan->kernels->radix4(src_re, src_im, dst_re, dst_im,
+				      plan->half_tw_re[s], plan->half_tw_im[s],
+				      half_n, s);
 
 		/* Swap buffers */
 		const float *tmp;
@@ -840,7 +1070,7 @@ static void scalar_forward_r2c(const sfft_plan_t *plan,
 
 	/* Final radix-2 stage if needed */
 	if (plan->half_has_radix2_stage) {
-		stockham_radix2_last_scalar(src_re, src_im, dst_re, dst_im, half_n);
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, half_n);
 		src_re = dst_re;
 		src_im = dst_im;
 	}
@@ -1006,9 +1236,9 @@ static void scalar_inverse_c2r(const sfft_plan_t *plan,
 
 	/* Radix-4 stages using optimized kernel */
 	for (size_t s = 0; s < plan->half_log4n; s++) {
-		stockham_radix4_otf_scalar(src_re, src_im, dst_re, dst_im,
-					   plan->half_tw_re[s], plan->half_tw_im[s],
-					   half_n, s);
+		plan->kernels->radix4(src_re, src_im, dst_re, dst_im,
+				      plan->half_tw_re[s], plan->half_tw_im[s],
+				      half_n, s);
 
 		/* Swap buffers */
 		const float *tmp;
@@ -1018,7 +1248,7 @@ static void scalar_inverse_c2r(const sfft_plan_t *plan,
 
 	/* Final radix-2 stage if needed */
 	if (plan->half_has_radix2_stage) {
-		stockham_radix2_last_scalar(src_re, src_im, dst_re, dst_im, half_n);
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, half_n);
 		src_re = dst_re;
 		src_im = dst_im;
 	}
@@ -1058,14 +1288,19 @@ void scalar_forward_split(const sfft_plan_t *plan,
 	const size_t log4n = plan->log4n;
 	const size_t total_stages = log4n + (plan->has_radix2_stage ? 1 : 0);
 
+	if (plan->codelet) {
+		plan->codelet(in_re, in_im, out_re, out_im);
+		return;
+	}
+
 	/*
 	 * N=2 special case: only a radix-2 stage, no radix-4 stages.
 	 * Read directly from input, write to output.
 	 */
 	if (OPT_UNLIKELY(log4n == 0)) {
 		if (plan->has_radix2_stage)
-			stockham_radix2_last_scalar(in_re, in_im,
-						    out_re, out_im, n);
+			plan->kernels->radix2_last(in_re, in_im,
+						   out_re, out_im, n);
 		return;
 	}
 
@@ -1087,16 +1322,14 @@ void scalar_forward_split(const sfft_plan_t *plan,
 	}
 
 	/* Stage 0: read directly from input, write to buf0 */
-	stockham_radix4_otf_scalar(in_re, in_im, buf0_re, buf0_im,
-				   plan->tw_re[0], plan->tw_im[0], n, 0);
+	plan_radix4(plan, in_re, in_im, buf0_re, buf0_im, 0);
 
 	/* Remaining radix-4 stages: ping-pong between buf0 and buf1 */
 	const float *src_re = buf0_re, *src_im = buf0_im;
 	float *dst_re = buf1_re, *dst_im = buf1_im;
 
 	for (size_t s = 1; s < log4n; s++) {
-		stockham_radix4_otf_scalar(src_re, src_im, dst_re, dst_im,
-					   plan->tw_re[s], plan->tw_im[s], n, s);
+		plan_radix4(plan, src_re, src_im, dst_re, dst_im, s);
 		const float *tmp;
 		tmp = src_re; src_re = dst_re; dst_re = (float *)tmp;
 		tmp = src_im; src_im = dst_im; dst_im = (float *)tmp;
@@ -1104,7 +1337,7 @@ void scalar_forward_split(const sfft_plan_t *plan,
 
 	/* Final radix-2 stage if needed */
 	if (plan->has_radix2_stage) {
-		stockham_radix2_last_scalar(src_re, src_im, dst_re, dst_im, n);
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, n);
 	}
 	/* Result is now in output buffer - no copy needed! */
 }
@@ -1122,6 +1355,12 @@ void scalar_inverse_split(const sfft_plan_t *plan,
 	const size_t log4n = plan->log4n;
 	const size_t total_stages = log4n + (plan->has_radix2_stage ? 1 : 0);
 
+	/* Codelet: IFFT(x) = swap(FFT(swap(x))), swap exchanges re and im */
+	if (plan->codelet) {
+		plan->codelet(in_im, in_re, out_im, out_re);
+		return;
+	}
+
 	/*
 	 * N=2 special case: only a radix-2 stage, no radix-4 stages.
 	 * Conjugate input into work, radix-2 into output, conjugate output.
@@ -1133,8 +1372,8 @@ void scalar_inverse_split(const sfft_plan_t *plan,
 				plan->work_re[i] = in_re[i];
 				plan->work_im[i] = -in_im[i];
 			}
-			stockham_radix2_last_scalar(plan->work_re, plan->work_im,
-						    out_re, out_im, n);
+			plan->kernels->radix2_last(plan->work_re, plan->work_im,
+						   out_re, out_im, n);
 			OPT_PRAGMA_VECTORIZE
 			for (size_t i = 0; i < n; i++)
 				out_im[i] = -out_im[i];
@@ -1167,17 +1406,14 @@ void scalar_inverse_split(const sfft_plan_t *plan,
 	}
 
 	/* Stage 0: read from conj_buf, write to other */
-	stockham_radix4_otf_scalar(conj_buf_re, conj_buf_im,
-				   other_re, other_im,
-				   plan->tw_re[0], plan->tw_im[0], n, 0);
+	plan_radix4(plan, conj_buf_re, conj_buf_im, other_re, other_im, 0);
 
 	/* Remaining radix-4 stages: ping-pong */
 	const float *src_re = other_re, *src_im = other_im;
 	float *dst_re = conj_buf_re, *dst_im = conj_buf_im;
 
 	for (size_t s = 1; s < log4n; s++) {
-		stockham_radix4_otf_scalar(src_re, src_im, dst_re, dst_im,
-					   plan->tw_re[s], plan->tw_im[s], n, s);
+		plan_radix4(plan, src_re, src_im, dst_re, dst_im, s);
 		const float *tmp;
 		tmp = src_re; src_re = dst_re; dst_re = (float *)tmp;
 		tmp = src_im; src_im = dst_im; dst_im = (float *)tmp;
@@ -1185,7 +1421,7 @@ void scalar_inverse_split(const sfft_plan_t *plan,
 
 	/* Final radix-2 stage if needed */
 	if (plan->has_radix2_stage) {
-		stockham_radix2_last_scalar(src_re, src_im, dst_re, dst_im, n);
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, n);
 	}
 
 	/* Result is in output buffer, conjugate in-place */
@@ -1196,9 +1432,158 @@ void scalar_inverse_split(const sfft_plan_t *plan,
 }
 
 /* ============================================================================
- * Backend VTable Export
+ * Batched Split-Format FFT
+ *
+ * Small sizes: SFFT_BATCH_LANES frames are transposed to frame-interleaved
+ * layout, every stage runs once for all of them (twiddles loaded once, the
+ * vector lanes span the frames), then transposed back. Larger sizes and
+ * kernels without batch stages run frame by frame, the frames are
+ * already wide enough to fill the vectors. So do codelet plans: the
+ * straight-line codelet is faster than the transposes.
  * ========================================================================= */
 
+/* Unused lanes of a partial batch are zeroed, they are never scattered */
+static void batch_gather(const float *OPT_RESTRICT in,
+			 float *OPT_RESTRICT dst,
+			 size_t n, size_t stride, size_t lanes)
+{
+	if (lanes < SFFT_BATCH_LANES)
+		memset(dst, 0, n * SFFT_BATCH_LANES * sizeof(float));
+
+	for (size_t f = 0; f < lanes; f++) {
+		const float *OPT_RESTRICT src = in + f * stride;
+		for (size_t e = 0; e < n; e++)
+			dst[e * SFFT_BATCH_LANES + f] = src[e];
+	}
+}
+
+static void batch_scatter(const float *OPT_RESTRICT src,
+			  float *OPT_RESTRICT out,
+			  size_t n, size_t stride, size_t lanes)
+{
+	for (size_t f = 0; f < lanes; f++) {
+		float *OPT_RESTRICT dst = out + f * stride;
+		for (size_t e = 0; e < n; e++)
+			dst[e] = src[e * SFFT_BATCH_LANES + f];
+	}
+}
+
+/* Forward FFT of work2, result in work2 (ping-pong with work) */
+static void forward_split_in_work(const sfft_plan_t *plan)
+{
+	const float *src_re = plan->work2_re;
+	const float *src_im = plan->work2_im;
+	float *dst_re = plan->work_re;
+	float *dst_im = plan->work_im;
+	size_t stages = 0;
+
+	for (size_t s = 0; s < plan->log4n; s++, stages++) {
+		plan_radix4(plan, src_re, src_im, dst_re, dst_im, s);
+		const float *tmp;
+		tmp = src_re; src_re = dst_re; dst_re = (float *)tmp;
+		tmp = src_im; src_im = dst_im; dst_im = (float *)tmp;
+	}
+
+	if (plan->has_radix2_stage) {
+		plan->kernels->radix2_last(src_re, src_im, dst_re, dst_im, plan->n);
+		src_re = dst_re;
+		src_im = dst_im;
+		stages++;
+	}
+
+	if (stages & 1) {
+		memcpy(plan->work2_re, src_re, plan->n * sizeof(float));
+		memcpy(plan->work2_im, src_im, plan->n * sizeof(float));
+	}
+}
+
+void sfft_forward_split_batch(const sfft_plan_t *plan,
+			      const float *in_re, const float *in_im,
+			      float *out_re, float *out_im,
+			      size_t stride, size_t count)
+{
+	if (OPT_UNLIKELY(!plan || !in_re || !in_im || !out_re || !out_im))
+		return;
+
+	const size_t n = plan->n;
+	const sfft_kernels_t *k = plan->kernels;
+
+	if (!k->radix4_batch || !plan->batch_re || plan->codelet) {
+		/* The stage kernels assume aligned buffers, frames that are not
+		 * go through the work buffers (codelets take any alignment) */
+		const int aligned = plan->codelet ||
+				    ((stride % (SFFT_ALIGN / sizeof(float))) == 0 &&
+				     ((uintptr_t)in_re | (uintptr_t)in_im |
+				      (uintptr_t)out_re | (uintptr_t)out_im) % SFFT_ALIGN == 0);
+
+		for (size_t f = 0; f < count; f++) {
+			const size_t offset = f * stride;
+			if (aligned) {
+				scalar_forward_split(plan,
+						     in_re + offset, in_im + offset,
+						     out_re + offset, out_im + offset);
+				continue;
+			}
+			memcpy(plan->work2_re, in_re + offset, n * sizeof(float));
+			memcpy(plan->work2_im, in_im + offset, n * sizeof(float));
+			forward_split_in_work(plan);
+			memcpy(out_re + offset, plan->work2_re, n * sizeof(float));
+			memcpy(out_im + offset, plan->work2_im, n * sizeof(float));
+		}
+		return;
+	}
+
+	for (size_t f0 = 0; f0 < count; f0 += SFFT_BATCH_LANES) {
+		const size_t lanes = count - f0 < SFFT_BATCH_LANES ?
+				     count - f0 : SFFT_BATCH_LANES;
+		const size_t offset = f0 * stride;
+
+		batch_gather(in_re + offset, plan->batch_re, n, stride, lanes);
+		batch_gather(in_im + offset, plan->batch_im, n, stride, lanes);
+
+		const float *src_re = plan->batch_re;
+		const float *src_im = plan->batch_im;
+		float *dst_re = plan->batch2_re;
+		float *dst_im = plan->batch2_im;
+
+		for (size_t s = 0; s < plan->log4n; s++) {
+			k->radix4_batch(src_re, src_im, dst_re, dst_im,
+					plan->tw_re[s], plan->tw_im[s], n, s);
+			const float *tmp;
+			tmp = src_re; src_re = dst_re; dst_re = (float *)tmp;
+			tmp = src_im; src_im = dst_im; dst_im = (float *)tmp;
+		}
+
+		if (plan->has_radix2_stage) {
+			k->radix2_batch(src_re, src_im, dst_re, dst_im, n);
+			src_re = dst_re;
+			src_im = dst_im;
+		}
+
+		batch_scatter(src_re, out_re + offset, n, stride, lanes);
+		batch_scatter(src_im, out_im + offset, n, stride, lanes);
+	}
+}
+
+/* ============================================================================
+ * Stage Kernels and Backend VTable Export
+ * ========================================================================= */
+
+/* Reference stage kernels, also the fallback when no SIMD variant applies */
+#include "stockham_codelets.inc"
+
+const sfft_kernels_t sfft_kernels_scalar = {
+	.name = "scalar",
+	.radix4 = stockham_radix4_otf_scalar,
+	.radix4_table = stockham_radix4_table_scalar,
+	.radix2_last = stockham_radix2_last_scalar,
+	.radix4_batch = NULL,
+	.radix2_batch = NULL,
+	.codelets = SFFT_CODELET_TABLE,
+};
+
+#undef SFFT_CODELET_TABLE
+
 const sfft_backend_vtable_t sfft_backend_scalar = {
 	.id = SFFT_BACKEND_SCALAR,
 	.name = "Scalar Stockham Radix-4",
@@ -0,0 +1,16 @@
+/*
+ * Stockham FFT - SSE2 Stage Kernels
+ *
+ * x86-64 baseline. Compiled with -ffast-math only, the stage loops are
+ * auto-vectorized to 128-bit SSE2.
+ *
+ * License: MIT
+ * Copyright (c) 2025-2026, Benjamin Vernoux <bvernoux@hydrasdr.com>
+ */
+
+#include "stockham_internal.h"
+#include "compat_opt.h"
+
+#define SFFT_KERNELS_NAME sfft_kernels_sse2
+#define SFFT_KERNELS_LABEL "SSE2"
+#include "stockham_kernels.inc"
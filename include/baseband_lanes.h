@@ -0,0 +1,111 @@
+/** @file
+    Cross-channel baseband filters for wideband mode.
+
+    baseband_low_pass_filter() and the low pass of baseband_demod_FM_cf32()
+    are first-order IIR filters, each output needs the previous one, so they
+    cannot be vectorized along time.  With many channels they can be
+    vectorized across channels: the state of 8 or 16 channels is held one
+    channel per vector lane and all channels advance one sample per step, on
+    channel-interleaved data (sample t of lane c at [t * lanes + c]).  The
+    lane kernels are picked by runtime ISA dispatch (SSE2/AVX2/AVX-512/NEON/SVE
+    variants of baseband_lanes.inc), as for the channelizer.
+
+    The results are bit-identical to running the single channel functions
+    on each channel, the integer arithmetic is the same.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BASEBAND_LANES_H_
+#define INCLUDE_BASEBAND_LANES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "baseband.h"
+
+/// Channels advanced together per sample step, one per vector lane.
+#define BASEBAND_LANES_MAX 16
+/// Narrow lane group, for up to 8 channels.
+#define BASEBAND_LANES_MIN 8
+
+/// First-order IIR state of up to BASEBAND_LANES_MAX channels, one per lane.
+typedef struct baseband_lanes_iir {
+    int32_t x1[BASEBAND_LANES_MAX]; ///< Last input
+    int32_t y1[BASEBAND_LANES_MAX]; ///< Last output
+    int32_t a1[BASEBAND_LANES_MAX]; ///< Feedback coeff (scaled by -1)
+    int32_t b0[BASEBAND_LANES_MAX]; ///< Feed-forward coeff, b0 == b1
+} baseband_lanes_iir_t;
+
+typedef void (*baseband_lowpass_lanes_fn_t)(baseband_lanes_iir_t *st, uint16_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+typedef void (*baseband_fm_lowpass_lanes_fn_t)(baseband_lanes_iir_t *st, int32_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+
+/// Scratch buffers and selected kernels of the cross-channel filters.
+typedef struct baseband_lanes {
+    uint32_t max_len;                         ///< Samples per channel the buffers hold
+    uint16_t *am_in;                          ///< Interleaved AM input [max_len * BASEBAND_LANES_MAX]
+    int32_t *fm_in;                           ///< Interleaved discriminator output [max_len * BASEBAND_LANES_MAX]
+    int16_t *out;                             ///< Interleaved filter output [max_len * BASEBAND_LANES_MAX]
+    baseband_lowpass_lanes_fn_t lowpass;      ///< Q15 AM low pass kernel
+    baseband_fm_lowpass_lanes_fn_t fm_lowpass; ///< Q30 FM low pass kernel
+} baseband_lanes_t;
+
+/** Allocate the scratch buffers for up to @p max_len samples per channel.
+    @return the state, or NULL on allocation failure
+*/
+baseband_lanes_t *baseband_lanes_create(uint32_t max_len);
+
+void baseband_lanes_free(baseband_lanes_t *lanes);
+
+/** Get the ISA level selected by runtime CPU dispatch. */
+const char *baseband_lanes_isa_info(void);
+
+/** Lane count used for @p channels channels: BASEBAND_LANES_MIN or BASEBAND_LANES_MAX. */
+unsigned baseband_lanes_width(unsigned channels);
+
+/** Lowpass filter several channels, same output as baseband_low_pass_filter() per channel.
+
+    @param lanes scratch buffers and kernels
+    @param[in,out] state per channel filter state
+    @param x_buf per channel input samples
+    @param[out] y_buf per channel output
+    @param len number of samples to process, the same for every channel, at most lanes->max_len
+    @param channels number of channels, any count, filtered BASEBAND_LANES_MAX at a time
+*/
+void baseband_low_pass_filter_lanes(baseband_lanes_t *lanes, filter_state_t *const *state,
+        uint16_t const *const *x_buf, int16_t *const *y_buf, uint32_t len, unsigned channels);
+
+/** FM demodulate several CF32 channels, same output as baseband_demod_FM_cf32() per channel.
+
+    The discriminator runs per channel, the low pass across channels.
+    @param lanes scratch buffers and kernels
+    @param[in,out] state per channel demodulator state
+    @param x_buf per channel input samples, interleaved float32 I/Q
+    @param[out] y_buf per channel output
+    @param len number of samples to process, the same for every channel, at most lanes->max_len
+    @param channels number of channels, any count, filtered BASEBAND_LANES_MAX at a time
+    @param samp_rate sample rate of all channels
+    @param low_pass per channel low-pass filter frequency or ratio
+*/
+void baseband_demod_FM_cf32_lanes(baseband_lanes_t *lanes, demodfm_state_t *const *state,
+        float const *const *x_buf, int16_t *const *y_buf, uint32_t len, unsigned channels,
+        uint32_t samp_rate, float const *low_pass);
+
+/* ISA-dispatched lane kernels (compiled in separate translation units) */
+void baseband_lowpass_lanes_sse2(baseband_lanes_iir_t *st, uint16_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_lowpass_lanes_avx2(baseband_lanes_iir_t *st, uint16_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_lowpass_lanes_avx512(baseband_lanes_iir_t *st, uint16_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_lowpass_lanes_neon(baseband_lanes_iir_t *st, uint16_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_lowpass_lanes_sve(baseband_lanes_iir_t *st, uint16_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+
+void baseband_fm_lowpass_lanes_sse2(baseband_lanes_iir_t *st, int32_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_fm_lowpass_lanes_avx2(baseband_lanes_iir_t *st, int32_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_fm_lowpass_lanes_avx512(baseband_lanes_iir_t *st, int32_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_fm_lowpass_lanes_neon(baseband_lanes_iir_t *st, int32_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+void baseband_fm_lowpass_lanes_sve(baseband_lanes_iir_t *st, int32_t const *x_buf, int16_t *y_buf, uint32_t len, unsigned lanes);
+
+#endif /* INCLUDE_BASEBAND_LANES_H_ */
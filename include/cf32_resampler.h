@@ -1,6 +1,24 @@
 /** @file
     CF32 Polyphase Resampler for HydraSDR.
 
+    The history is a linear buffer per channel, samples are appended and
+    the last taps are moved back to the start with one memcpy when it is
+    full, so every branch reads a contiguous window.  The branches are
+    stored reversed for forward reads, and the process function is picked
+    by runtime ISA dispatch (SSE2/AVX2/AVX-512/NEON/SVE variants of
+    cf32_resampler_process.inc), as for the channelizer.
+
+    Large decimation ratios are split by a planner: cascaded half-band
+    decimators, which skip the zero taps and filter only the odd phase,
+    then a polyphase stage at the reduced rate.  The chain with the fewest
+    MACs per output sample at RESAMPLER_STOPBAND_DB is used.
+
+    The arbitrary ratio mode replaces the L branches of the polyphase stage
+    by a fixed bank of RESAMPLER_ARB_PHASES branches, interpolated linearly
+    between neighbours for the fractional position of each output (a
+    first order Farrow structure).  Its memory does not depend on the
+    ratio, and the ratio can be trimmed at runtime without a glitch.
+
     Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
 
     This program is free software; you can redistribute it and/or modify
@@ -18,30 +36,91 @@
 /* Resampler filter design parameters */
 #define RESAMPLER_TAPS_PER_BRANCH  32     /* Taps per polyphase branch */
 #define RESAMPLER_STOPBAND_DB      60.0f  /* Kaiser stopband attenuation (dB) */
+#define RESAMPLER_HIST_BLOCK       4096   /* Samples appended between history moves */
+#define RESAMPLER_MAX_HALFBANDS    8      /* Half-band decimators in a chain at most */
+#define RESAMPLER_HALFBAND_ALIGN   8      /* Half-band odd phase padded to this many taps */
+#define RESAMPLER_ARB_PHASES       128    /* Branches of the arbitrary ratio bank, a power of 2 */
+#define RESAMPLER_ARB_MAX_TRIM     0.01   /* Ratio change allowed after an arbitrary init */
 
-/* Float32 polyphase resampler for IQ data */
+typedef struct cf32_resampler cf32_resampler_t;
+
+typedef int (*cf32_resampler_process_fn_t)(cf32_resampler_t *, const float *, int, float **, int);
+
+/* Resampling chain: half-band decimators by 2, then a polyphase stage */
+typedef struct {
+    int num_halfbands;                          /* Half-band stages K */
+    int halfband_taps[RESAMPLER_MAX_HALFBANDS]; /* Design length per stage, 4j+3 */
+    uint32_t polyphase_rate;                    /* Input rate of the polyphase stage */
+    int up_factor;                              /* Polyphase interpolation factor */
+    int down_factor;                            /* Polyphase decimation factor */
+    int taps_per_branch;                        /* Polyphase taps per branch */
+    int arbitrary;                              /* Interpolated bank, up/down factors unused */
+    double macs_per_output;                     /* Taps applied per I/Q output sample of the chain */
+    double single_stage_macs;                   /* The same for a polyphase stage only */
+} cf32_resampler_plan_t;
+
+/* Half-band decimate by 2: y[n] = h[c] E[n-j] + sum h[2m] O[n-m], with
+ * E and O the even and odd input samples and c = 2j+1 the center tap */
 typedef struct {
-    int up_factor;          /* Interpolation factor L */
-    int down_factor;        /* Decimation factor M */
-    int num_taps;           /* Total filter taps */
-    int taps_per_branch;    /* Taps per polyphase branch */
+    int num_taps;           /* Design length N = 4j+3 */
+    int branch_taps;        /* Odd phase taps, padded to RESAMPLER_HALFBAND_ALIGN */
+    int center_delay;       /* j, the delay of the center tap in outputs */
+    float center;           /* Center tap h[c] */
+    float *coeffs;          /* Odd phase taps, reversed, zeros at the oldest end */
+
+    /* Linear histories of the even and odd samples, moved together */
+    float *hist;            /* Storage for the four histories and the sums */
+    float *hist_ei, *hist_eq, *hist_oi, *hist_oq;
+    float *acc_i, *acc_q;   /* Output sums of a block, RESAMPLER_HIST_BLOCK each */
+    int hist_size;          /* branch_taps - 1 + RESAMPLER_HIST_BLOCK */
+    int write_pos;
+
+    int has_pending;        /* An even sample waits for its odd sample */
+    float pending_i, pending_q;
+
+    int max_input;          /* Input samples per call at most */
+    float *output_buf;      /* Decimated output, interleaved I/Q */
+} cf32_halfband_t;
+
+typedef int (*cf32_halfband_process_fn_t)(cf32_halfband_t *, const float *, int);
+
+/* Float32 polyphase resampler for IQ data */
+struct cf32_resampler {
+    int up_factor;          /* Overall interpolation factor L */
+    int down_factor;        /* Overall decimation factor M */
+    int num_taps;           /* Total polyphase filter taps */
+    int taps_per_branch;    /* Taps per polyphase branch, a multiple of RESAMPLER_TAPS_PER_BRANCH */
     int phase_idx;          /* Current phase index */
 
-    float **branches;       /* Polyphase filter branches [L][taps_per_branch] */
+    float **branches;       /* Polyphase filter branches [L][taps_per_branch], reversed */
     float *branch_data;     /* Contiguous storage for branches */
 
-    /* Circular buffers for I and Q channels */
+    /* Linear history buffers for I and Q channels */
     float *hist_i;
     float *hist_q;
-    int hist_size;          /* Power of 2 size */
-    int hist_mask;          /* hist_size - 1 for fast modulo */
-    int write_pos;          /* Current write position */
+    int hist_size;          /* taps_per_branch - 1 + RESAMPLER_HIST_BLOCK */
+    int write_pos;          /* Next write position, the window ends here */
 
     float *output_buf;      /* Resampled output buffer (CF32 native) */
     size_t output_buf_size; /* Output buffer size in complex samples */
 
+    /* Arbitrary ratio mode: branches holds RESAMPLER_ARB_PHASES + 1
+     * branches, an output is branch m + frac * (branch m+1 - branch m) */
+    int arbitrary;
+    float *branch_diff;     /* Branch m+1 minus branch m, reversed */
+    uint64_t arb_phase;     /* Position of the next output after the newest sample, 32.32 */
+    uint64_t arb_step;      /* Input samples per output, 32.32 */
+    uint64_t arb_step_next; /* Set by cf32_resampler_set_rate(), taken by the next call */
+    double nominal_ratio;   /* Output / input rate of the init, the filter is designed for */
+
+    cf32_resampler_plan_t plan;          /* Stages and cost of the chain */
+    cf32_halfband_t halfbands[RESAMPLER_MAX_HALFBANDS];
+
+    cf32_resampler_process_fn_t process; /* ISA variant */
+    cf32_halfband_process_fn_t halfband_process;
+
     int initialized;
-} cf32_resampler_t;
+};
 
 /** Compute greatest common divisor. */
 int cf32_resampler_gcd(int a, int b);
@@ -49,12 +128,57 @@ int cf32_resampler_gcd(int a, int b);
 /** Design lowpass filter coefficients. */
 void cf32_resampler_design_filter(float *coeffs, int num_taps, int factor);
 
+/** Plan the cheapest chain from @p input_rate to @p output_rate.
+    Returns 0 on success, -1 if the rates are zero, equal or too large. */
+int cf32_resampler_plan(uint32_t input_rate, uint32_t output_rate, cf32_resampler_plan_t *plan);
+
+/** Design a half-band lowpass of @p num_taps = 4j+3 taps, unity DC gain. */
+void cf32_resampler_design_halfband(float *coeffs, int num_taps);
+
 /** Initialize resampler. Returns 0 on success. */
 int cf32_resampler_init(cf32_resampler_t *res, uint32_t input_rate, uint32_t output_rate, size_t max_input_samples);
 
+/** Initialize in arbitrary ratio mode, for nearly coprime rates or rates
+    trimmed at runtime.  Equal rates are resampled too, ready for a trim.
+    Returns 0 on success. */
+int cf32_resampler_init_arbitrary(cf32_resampler_t *res, uint32_t input_rate, uint32_t output_rate, size_t max_input_samples);
+
+/** Change the rates of an arbitrary ratio resampler, e.g. the input rate
+    corrected by a ppm clock trim.  Safe to call from another thread than
+    the processing one, the next process call continues at the same phase
+    with the new step.  Returns -1 if not in arbitrary mode or the ratio
+    moves more than RESAMPLER_ARB_MAX_TRIM from the init ratio. */
+int cf32_resampler_set_rate(cf32_resampler_t *res, double input_rate, double output_rate);
+
 /** Process IQ samples. Returns number of output samples. */
 int cf32_resampler_process(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
 
+/** Clear the history and the phase, as after init. */
+void cf32_resampler_reset(cf32_resampler_t *res);
+
+/** Get the ISA level selected by runtime CPU dispatch. */
+const char *cf32_resampler_isa_info(void);
+
+/* ISA-dispatched process functions (compiled in separate translation units) */
+int cf32_resampler_process_sse2(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_avx2(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_avx512(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_neon(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_sve(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+
+int cf32_resampler_process_arb_sse2(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_arb_avx2(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_arb_avx512(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_arb_neon(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+int cf32_resampler_process_arb_sve(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output);
+
+/* Half-band stage variants, decimate into hb->output_buf and return the outputs */
+int cf32_halfband_process_sse2(cf32_halfband_t *hb, const float *input, int num_iq_samples);
+int cf32_halfband_process_avx2(cf32_halfband_t *hb, const float *input, int num_iq_samples);
+int cf32_halfband_process_avx512(cf32_halfband_t *hb, const float *input, int num_iq_samples);
+int cf32_halfband_process_neon(cf32_halfband_t *hb, const float *input, int num_iq_samples);
+int cf32_halfband_process_sve(cf32_halfband_t *hb, const float *input, int num_iq_samples);
+
 /** Free resampler resources. */
 void cf32_resampler_free(cf32_resampler_t *res);
 
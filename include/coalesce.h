@@ -0,0 +1,54 @@
+/** @file
+    Repeated transmission coalescing.
+
+    Most sensors repeat their packet several times per burst and every copy
+    that decodes becomes its own event.  This stage holds an event until no
+    further copy arrives within the window of the sample clock and emits one
+    event per burst, with the number of copies, the best and mean SNR and
+    the wideband channels it was seen on.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_COALESCE_H_
+#define INCLUDE_COALESCE_H_
+
+#include <stdint.h>
+
+#include "data.h"
+
+#define COALESCE_WINDOW_MS  500
+
+typedef struct coalesce coalesce_t;
+
+/// Called with each completed burst, the callee owns the data.
+typedef void (*coalesce_emit_fn)(void *ctx, data_t *data);
+
+/** Create a coalescing stage.  Returns NULL on allocation failure.
+ *  window_ms is the longest gap between two copies of a burst.
+ *  fields selects the key fields as for wb_dedup_create(), NULL for all
+ *  fields but the volatile ones. */
+coalesce_t *coalesce_create(unsigned window_ms, char const *fields);
+
+/** Free the stage and the events still held (NULL-safe). */
+void coalesce_free(coalesce_t *co);
+
+/** Add a decoded event, takes ownership of data.
+ *  channel is the wideband channel index or -1, snr_db the SNR of the copy
+ *  and time_ms the sample clock time of the transmission.
+ *  Returns 1 if merged into a held burst, 0 if a new burst was started. */
+int coalesce_add(coalesce_t *co, data_t *data, int channel, float snr_db, uint64_t time_ms);
+
+/** Emit the bursts without a copy within the window before time_ms, in the
+ *  order they started, UINT64_MAX emits all.  Returns the number emitted. */
+unsigned coalesce_flush(coalesce_t *co, uint64_t time_ms, coalesce_emit_fn emit, void *ctx);
+
+/** Return the number of events added and of bursts emitted since creation. */
+void coalesce_counts(coalesce_t const *co, uint64_t *events, uint64_t *bursts);
+
+#endif /* INCLUDE_COALESCE_H_ */
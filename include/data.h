@@ -188,6 +188,8 @@ typedef struct data_output {
     void (R_API_CALLCONV *output_print)(struct data_output *output, data_t *data);
     void (R_API_CALLCONV *output_free)(struct data_output *output);
     int log_level; ///< the maximum log level (verbosity) allowed, more verbose messages must be ignored.
+    unsigned events; ///< number of data items printed, for the /metrics endpoint
+    struct metrics_latency *latency; ///< pulse train end to printed event, allocated on the first traced event
 } data_output_t;
 
 /** Setup known field keys and start output, used by CSV only.
@@ -0,0 +1,43 @@
+/** @file
+    CBOR (RFC 8949) encoding and decoding of data_t structures.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DATA_CBOR_H_
+#define INCLUDE_DATA_CBOR_H_
+
+#include "data.h"
+
+/** Encode a data_t structure as a CBOR map.
+
+    Nested data is encoded as maps, data_array as arrays. Integers use the
+    shortest encoding, doubles are encoded as float32 if that is lossless.
+    Format strings are not encoded, like with data_print_jsons().
+
+    @param data the structure to encode
+    @param dst the output buffer
+    @param len size of the output buffer
+    @return the encoded length, 0 if the buffer is too small
+*/
+R_API size_t data_print_cbor(data_t *data, uint8_t *dst, size_t len);
+
+/** Decode one CBOR map into a data_t structure.
+
+    Accepts what data_print_cbor() produces, i.e. maps with text keys and
+    integer, float, text, array or map values. An empty map is consumed
+    but yields no data, i.e. NULL is returned with @p used set.
+
+    @param src the input buffer
+    @param len size of the input buffer
+    @param[out] used number of bytes consumed, 0 on error
+    @return the decoded data, NULL on error or if the item is truncated
+*/
+R_API data_t *data_parse_cbor(uint8_t const *src, size_t len, size_t *used);
+
+#endif /* INCLUDE_DATA_CBOR_H_ */
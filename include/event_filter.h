@@ -0,0 +1,58 @@
+/** @file
+    Event selection and rate limit of a stream client.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_FILTER_H_
+#define INCLUDE_EVENT_FILTER_H_
+
+/*
+ A client selects decoded events by lists of accepted model, id and
+ channel values and a minimum SNR, an event without an SNR never passes
+ a minimum.  Messages without a model, logs and meta data, always pass.
+
+ The rate limit is a token bucket refilled at the rate, it holds one
+ second of events but at least one, so a client may burst that much.
+*/
+
+#define EVENT_FILTER_LEN 128 ///< max length of a list of accepted values
+
+typedef struct event_filter {
+    char model[EVENT_FILTER_LEN];   ///< comma separated list, empty for any
+    char id[EVENT_FILTER_LEN];      ///< comma separated list, empty for any
+    char channel[EVENT_FILTER_LEN]; ///< comma separated list, empty for any
+    double min_snr; ///< NAN for any
+    double rate;    ///< events per second, 0 for unlimited
+    double tokens;  ///< events that may be sent right now
+    double refill;  ///< time the tokens were last refilled, seconds
+} event_filter_t;
+
+/// Set up a filter that passes everything, without a rate limit.
+void event_filter_init(event_filter_t *f);
+
+/// Limit to @p rate events per second from time @p now, 0 for unlimited.
+void event_filter_set_rate(event_filter_t *f, double rate, double now);
+
+/// Match a value against a comma separated list, an empty list matches anything.
+int event_filter_match(char const *list, char const *value);
+
+/** Check a message against the selection.
+
+    @param model the model, NULL if not a decoded event
+    @param id the id, NULL if none
+    @param channel the channel, NULL if none
+    @param snr the SNR in dB, NAN if not reported
+    @return 1 if selected, 0 otherwise
+*/
+int event_filter_wants(event_filter_t const *f, char const *model, char const *id, char const *channel, double snr);
+
+/// Take an event from the rate limit at time @p now, returns 0 if over the limit.
+int event_filter_take(event_filter_t *f, double now);
+
+#endif /* INCLUDE_EVENT_FILTER_H_ */
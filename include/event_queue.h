@@ -0,0 +1,38 @@
+/** @file
+    Lock-free event handoff queue, multiple producers and a single consumer.
+
+    A bounded ring of pointers, each slot carries a sequence number that
+    tells producers and the consumer whose turn it is.  Producers claim a
+    slot with one compare-and-swap on the head and never wait for each
+    other to finish writing, the consumer only reads and writes its own
+    tail.  A full queue rejects the push, the producer decides what to drop.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_QUEUE_H_
+#define INCLUDE_EVENT_QUEUE_H_
+
+typedef struct event_queue event_queue_t;
+
+/** Create a queue of @p capacity entries, rounded up to a power of two.
+    Returns NULL on allocation failure. */
+event_queue_t *event_queue_create(unsigned capacity);
+
+/** Free the queue (NULL-safe), entries still queued are not freed. */
+void event_queue_free(event_queue_t *q);
+
+/** Append @p item (not NULL), safe to call from any thread.
+    @return 0 on success, -1 if the queue is full */
+int event_queue_push(event_queue_t *q, void *item);
+
+/** Remove the oldest item, only to be called from the consumer thread.
+    @return the item, NULL if the queue is empty */
+void *event_queue_pop(event_queue_t *q);
+
+#endif /* INCLUDE_EVENT_QUEUE_H_ */
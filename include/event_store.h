@@ -0,0 +1,73 @@
+/** @file
+    In-memory columnar event store.
+
+    Keeps the last decoded events in columns: the time, the sensor and the
+    numeric or string fields, with model, id and keys interned and string
+    values kept in a ring with their events.  A sensor is a (model, id)
+    pair and indexes its events newest first, one-minute partitions index
+    the events by time and keep the event count per model for a day,
+    beyond the retention of the events.  The oldest events are dropped
+    when the store is full.
+
+    The store is not thread safe, feed and query it from one thread.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_EVENT_STORE_H_
+#define INCLUDE_EVENT_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "data.h"
+
+#define EVENT_STORE_DEFAULT_EVENTS 100000
+#define EVENT_STORE_AVG_VALUES     8     ///< fields per event the store is sized for
+#define EVENT_STORE_MAX_VALUES     32    ///< fields kept per event at most
+#define EVENT_STORE_AVG_TEXT       16    ///< bytes of string values per event the store is sized for
+#define EVENT_STORE_PARTITION      60    ///< seconds per time partition
+#define EVENT_STORE_PARTITIONS     1440  ///< partitions of counts kept, a day
+#define EVENT_STORE_MAX_STRINGS    65536 ///< interned models, ids and keys, new ones are dropped beyond
+#define EVENT_STORE_MAX_SENSORS    65536 ///< sensors indexed, new ones are not beyond
+
+typedef struct event_store event_store_t;
+
+/** Create a store of @p capacity events.  Returns NULL on allocation failure. */
+event_store_t *event_store_create(unsigned capacity);
+
+/** Free the store (NULL-safe). */
+void event_store_free(event_store_t *es);
+
+/** Add an event received at @p time (seconds since the epoch), events
+    without a "model" are ignored.  The top level numeric and string
+    fields are kept, except "time", "model" and "id".
+    Returns 1 if stored, 0 otherwise. */
+int event_store_add(event_store_t *es, data_t const *data, double time);
+
+/** Return the number of events held and the number of sensors. */
+void event_store_counts(event_store_t const *es, unsigned *events, unsigned *sensors);
+
+/** Write the last event of each sensor, of @p model if not NULL, as JSON
+    `{"sensors":[{"model":..,"id":..,"time":..,"count":..,"fields":{..}},..]}`.
+    Returns the length written, the list is cut short to fit @p size. */
+size_t event_store_latest(event_store_t const *es, char const *model, char *buf, size_t size);
+
+/** Write the events since @p since, newest first and at most @p limit, as
+    JSON `{"events":[{"model":..,"id":..,"time":..,"fields":{..}},..]}`.
+    @p model and @p id select the events if not NULL, the index of the
+    sensor is used if both are given.  Returns the length written. */
+size_t event_store_events(event_store_t const *es, char const *model, char const *id,
+        double since, unsigned limit, char *buf, size_t size);
+
+/** Write the event count per model per minute since @p since, oldest first,
+    as JSON `{"minutes":[{"time":..,"counts":{"model":n,..}},..]}`.
+    @p model selects one model if not NULL.  Returns the length written. */
+size_t event_store_minutes(event_store_t const *es, char const *model, double since, char *buf, size_t size);
+
+#endif /* INCLUDE_EVENT_STORE_H_ */
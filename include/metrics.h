@@ -0,0 +1,212 @@
+/** @file
+    Metrics registry and OpenMetrics text rendering.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_METRICS_H_
+#define INCLUDE_METRICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ Counters and gauges are plain fields kept by their owners (decoders, the
+ demod state, outputs), only histograms and the pipeline stage timing are
+ kept here. The writer renders metric families in the OpenMetrics text
+ format through a small buffer that is flushed to a callback whenever it
+ fills up, so the size of the exposition is not bounded by a stack buffer.
+*/
+
+/// Number of finite histogram buckets, bounds are METRICS_BUCKET_BASE * 2^k.
+#define METRICS_HISTOGRAM_BUCKETS 16
+#define METRICS_BUCKET_BASE       10e-6 ///< first bucket bound in seconds (10 us)
+
+/// Size of the writer buffer, also the maximum length of a single line.
+#define METRICS_WRITER_BUFSIZE 1024
+
+/// Fixed exponential histogram of durations.
+typedef struct metrics_histogram {
+    uint64_t bucket[METRICS_HISTOGRAM_BUCKETS + 1]; ///< non-cumulative counts, the last is +Inf
+    uint64_t count;
+    double sum; ///< seconds
+} metrics_histogram_t;
+
+/// Log-linear latency histogram: 8 sub-buckets per octave from 1 us, about 6% resolution.
+#define METRICS_LATENCY_SUBBUCKETS 8
+#define METRICS_LATENCY_OCTAVES    27 ///< up to 2^27 us, 134 s
+#define METRICS_LATENCY_BUCKETS    (1 + METRICS_LATENCY_OCTAVES * METRICS_LATENCY_SUBBUCKETS)
+
+/// Latency histogram with percentiles, see metrics_latency_percentile().
+typedef struct metrics_latency {
+    uint32_t bucket[METRICS_LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t max_ns;
+    double sum; ///< seconds
+} metrics_latency_t;
+
+/// Timestamps of the event being decoded, for the end-to-end latency.
+typedef struct metrics_trace {
+    int channel;         ///< wideband channel of the pulse train, 0 in narrowband
+    uint64_t offset;     ///< sample position of the pulse train (pulse_data.offset)
+    uint64_t stream_ms;  ///< sample clock time of the end of the pulse train
+    uint64_t burst_ns;   ///< estimated time the end of the pulse train was received, 0 if unknown
+    uint64_t decoded_ns; ///< time the decoder produced the event
+    uint64_t dedup_ns;   ///< time the event passed the deduplication
+} metrics_trace_t;
+
+/// Processing stages of the receive pipeline.
+enum metrics_stage {
+    METRICS_STAGE_FRAME,       ///< the whole sample buffer
+    METRICS_STAGE_CHANNELIZER, ///< wideband channelizer
+    METRICS_STAGE_RESAMPLER,   ///< per-channel resampler
+    METRICS_STAGE_AM_DEMOD,    ///< magnitude estimation and level tracking
+    METRICS_STAGE_LOWPASS,     ///< AM low pass filter
+    METRICS_STAGE_FM_DEMOD,    ///< FM demodulation
+    METRICS_STAGE_DETECT,      ///< pulse detection
+    METRICS_STAGE_DECODE,      ///< decoders, without the event outputs
+    METRICS_STAGE_OUTPUT,      ///< event outputs
+    METRICS_STAGE_COUNT,
+};
+
+/// Stage sums of a profiling interval, see metrics_profile_reset().
+typedef struct metrics_profile {
+    int enabled;              ///< also time each decoder, toggled at runtime
+    uint64_t since_ns;        ///< start of the interval
+    uint64_t blocks;          ///< sample buffers in the interval
+    uint64_t late_blocks;     ///< buffers processed slower than realtime
+    double input_seconds;     ///< duration of the buffers
+    double max_load;          ///< highest processing time / duration of a single buffer
+    uint64_t stage_ns[METRICS_STAGE_COUNT];
+} metrics_profile_t;
+
+/// Per-stage processing time and realtime margin of the receive pipeline.
+typedef struct metrics_pipeline {
+    metrics_histogram_t stage[METRICS_STAGE_COUNT];
+    uint64_t stage_ns[METRICS_STAGE_COUNT]; ///< time spent in the current frame
+    uint64_t frame_start_ns;
+    uint64_t frames_late;     ///< frames that took longer to process than to receive
+    double realtime_margin;   ///< 1 - processing time / frame duration, of the last frame
+    double input_seconds;     ///< total duration of the processed samples
+    double busy_seconds;      ///< total processing time
+    metrics_profile_t profile;
+    metrics_trace_t trace;    ///< the event being decoded, cleared for each frame
+    metrics_latency_t dedup_latency; ///< pulse train end to passing the deduplication
+} metrics_pipeline_t;
+
+/// Monotonic clock in nanoseconds.
+uint64_t metrics_time_ns(void);
+
+/// Upper bound of histogram bucket @p i in seconds.
+double metrics_bucket_bound(int i);
+
+/// Add one observation of @p ns nanoseconds.
+void metrics_histogram_observe(metrics_histogram_t *h, uint64_t ns);
+
+/// Add one latency of @p ns nanoseconds.
+void metrics_latency_observe(metrics_latency_t *h, uint64_t ns);
+
+/** Estimate the @p q quantile (0 to 1) of the latency histogram.
+
+    @return the upper bound of the bucket holding the quantile, capped to the maximum, in seconds
+*/
+double metrics_latency_percentile(metrics_latency_t const *h, double q);
+
+/** Note the pulse train of the package passed to the decoders.
+
+    @param channel wideband channel of the pulse train, 0 in narrowband
+    @param offset sample position of the pulse train
+    @param end_ago end of the pulse train in samples before the end of the current frame
+    @param samp_rate sample rate of the pulse train
+    @param frame_end_us sample clock time of the end of the current frame
+*/
+void metrics_trace_burst(metrics_pipeline_t *p, int channel, uint64_t offset, unsigned end_ago, uint32_t samp_rate, uint64_t frame_end_us);
+
+/** Add the latency from the traced pulse train to now to @p h.
+
+    @return the current time, 0 if there is no traced pulse train
+*/
+uint64_t metrics_trace_latency(metrics_pipeline_t *p, metrics_latency_t *h);
+
+/// Start timing a sample buffer.
+void metrics_frame_begin(metrics_pipeline_t *p);
+
+/** Account the time since @p start_ns to @p stage of the current frame.
+
+    @return the current time, to chain consecutive stages
+*/
+uint64_t metrics_stage(metrics_pipeline_t *p, int stage, uint64_t start_ns);
+
+/** Finish timing a sample buffer of @p n_samples at @p samp_rate.
+
+    The output time is taken out of the decode time, as outputs are called
+    from the decoders. Stages that did not run in this frame are not observed.
+*/
+void metrics_frame_end(metrics_pipeline_t *p, unsigned long n_samples, uint32_t samp_rate);
+
+/// Name of @p stage for the "stage" label.
+char const *metrics_stage_name(int stage);
+
+/// Start a new profiling interval, keeps the enabled state.
+void metrics_profile_reset(metrics_profile_t *prof);
+
+/* rendering */
+
+enum metrics_type {
+    METRICS_COUNTER,
+    METRICS_GAUGE,
+    METRICS_HISTOGRAM,
+    METRICS_SUMMARY,
+};
+
+typedef void (*metrics_flush_fn)(void *ctx, char const *buf, size_t len);
+
+typedef struct metrics_writer {
+    metrics_flush_fn flush;
+    void *ctx;
+    size_t len;
+    char buf[METRICS_WRITER_BUFSIZE];
+} metrics_writer_t;
+
+void metrics_writer_init(metrics_writer_t *w, metrics_flush_fn flush, void *ctx);
+
+/** Start a metric family with its TYPE, UNIT and HELP lines.
+
+    @param unit the unit the name ends with, may be NULL
+*/
+void metrics_family(metrics_writer_t *w, char const *name, int type, char const *unit, char const *help);
+
+/** Write a sample "name[suffix][{labels}] value".
+
+    @param suffix e.g. "_total" or "_created", may be NULL
+    @param labels comma separated label pairs, see metrics_label(), may be NULL
+*/
+void metrics_sample(metrics_writer_t *w, char const *name, char const *suffix, char const *labels, double value);
+
+/// Write a counter sample "name_total".
+void metrics_counter(metrics_writer_t *w, char const *name, char const *labels, double value);
+
+/// Write a gauge sample.
+void metrics_gauge(metrics_writer_t *w, char const *name, char const *labels, double value);
+
+/// Write the bucket, count and sum samples of a histogram.
+void metrics_histogram(metrics_writer_t *w, char const *name, char const *labels, metrics_histogram_t const *h);
+
+/// Write the p50, p90, p99 quantile, count and sum samples of a latency summary.
+void metrics_summary(metrics_writer_t *w, char const *name, char const *labels, metrics_latency_t const *h);
+
+/// Write the "# EOF" marker and flush the buffer.
+void metrics_finish(metrics_writer_t *w);
+
+/** Append the label pair key="value" to @p labels, escaping the value.
+
+    @return the new length of @p labels, truncated to @p size
+*/
+size_t metrics_label(char *labels, size_t size, char const *key, char const *value);
+
+#endif /* INCLUDE_METRICS_H_ */
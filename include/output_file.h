@@ -28,4 +28,16 @@ struct data_output *data_output_json_create(int log_level, FILE *file);
 
 struct data_output *data_output_kv_create(int log_level, FILE *file);
 
+/** Construct data output for CBOR printer.
+
+    Each event is written as one CBOR map, the file is a CBOR sequence (RFC 8742).
+    Use cbor2json to convert the file back to JSON lines.
+
+    @param log_level the highest log level to process
+    @param file the output stream, should be opened in binary mode
+    @return The data output, NULL on alloc failure.
+            You must release this object with data_output_free once you're done with it.
+*/
+struct data_output *data_output_cbor_create(int log_level, FILE *file);
+
 #endif /* INCLUDE_OUTPUT_FILE_H_ */
@@ -0,0 +1,32 @@
+/** @file
+    Shared-memory ring output for hydrasdr_433 events.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_SHM_H_
+#define INCLUDE_OUTPUT_SHM_H_
+
+#include "data.h"
+#include <stddef.h>
+
+/// Construct data output for a shared-memory event ring.
+///
+/// Every event is written as one record to the ring @p name, see shm_ring.h
+/// for the layout and the reader API. The decoder never waits for readers,
+/// slow readers lose the oldest events.
+///
+/// @param log_level the highest log level to process
+/// @param name POSIX shared memory name, e.g. "/hydrasdr_433"
+/// @param size ring data size in bytes, rounded up to a power of two
+/// @param format payload format, enum shm_ring_format
+/// @return The initialized data output, NULL on error.
+///         You must release this object with data_output_free once you're done with it.
+struct data_output *data_output_shm_create(int log_level, char const *name, size_t size, int format);
+
+#endif /* INCLUDE_OUTPUT_SHM_H_ */
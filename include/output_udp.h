@@ -14,6 +14,34 @@
 
 #include "data.h"
 
-struct data_output *data_output_syslog_create(int log_level, const char *host, const char *port);
+#define UDP_BATCH_MAX      64     ///< max datagrams sent with one syscall
+#define UDP_BINARY_MAGIC   "H433" ///< first 4 bytes of a binary datagram
+#define UDP_BINARY_VERSION 1
+#define UDP_BINARY_HEADER  12     ///< size of the binary datagram header
+#define UDP_BINARY_FLAG_CBOR 0x01 ///< records are CBOR maps instead of JSON objects
+
+/// Datagram formats of the UDP output.
+enum udp_format {
+    UDP_FORMAT_SYSLOG = 0, ///< one RFC 5424 syslog line per datagram
+    UDP_FORMAT_BINARY = 1, ///< several JSON records per datagram
+    UDP_FORMAT_CBOR   = 2, ///< several CBOR records per datagram
+};
+
+struct mg_mgr;
+
+/** Create a UDP output, either RFC 5424 syslog lines or binary datagrams.
+
+    Events are collected for up to @p batch datagrams or @p batch_delay_ms and
+    then sent with a single sendmmsg() where available, a batch of 1 sends
+    each event right away.
+
+    The binary format packs several events into one datagram, all integers are big-endian:
+    - magic "H433", u8 version (1), u8 flags, u16 event count, u32 unix time
+    - per event: u16 length, JSON object of that length, or a CBOR map
+      if flags has UDP_BINARY_FLAG_CBOR set
+
+    @p format is one of enum udp_format.
+*/
+struct data_output *data_output_syslog_create(struct mg_mgr *mgr, int log_level, const char *host, const char *port, int batch, int batch_delay_ms, int format);
 
 #endif /* INCLUDE_OUTPUT_UDP_H_ */
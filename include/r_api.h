@@ -65,16 +65,46 @@ void log_device_handler(struct r_device *r_dev, int level, struct data *data);
 
 void data_acquired_handler(struct r_device *r_dev, struct data *data);
 
+/** Output the coalesced bursts without a copy within the window before the
+    sample clock time @p time_ms, UINT64_MAX outputs all.
+*/
+void flush_coalesced(struct r_cfg *cfg, uint64_t time_ms);
+
 struct data *create_report_data(struct r_cfg *cfg, int level);
 
 void flush_report_data(struct r_cfg *cfg);
 
+/// Number of decoders listed in the profiler report.
+#define PERF_TOP_DECODERS 10
+
+/** Profiler report of the current interval: share of the realtime budget
+    used per stage, per wideband channel and by the slowest decoders.
+*/
+struct data *create_perf_data(struct r_cfg *cfg);
+
+/// Start a new profiler interval.
+void flush_perf_data(struct r_cfg *cfg);
+
+/// Default file of the pipeline trace.
+#define TRACE_DEFAULT_PATH "hydrasdr_433_trace.json"
+
+/** Start a pipeline trace of @p seconds of input written to @p path.
+
+    @return 0 on success, -1 if a trace is already recording or out of memory
+*/
+int start_trace(double seconds, char const *path);
+
+/// Stop the pipeline trace, if recording, and write the trace file.
+void stop_trace(void);
+
 /* setup */
 
 void add_json_output(struct r_cfg *cfg, char *param);
 
 void add_csv_output(struct r_cfg *cfg, char *param);
 
+void add_cbor_output(struct r_cfg *cfg, char *param);
+
 void add_log_output(struct r_cfg *cfg, char *param);
 
 void add_kv_output(struct r_cfg *cfg, char *param);
@@ -89,6 +119,8 @@ void add_http_output(struct r_cfg *cfg, char *param);
 
 void add_trigger_output(struct r_cfg *cfg, char *param);
 
+void add_shm_output(struct r_cfg *cfg, char *param);
+
 void add_null_output(struct r_cfg *cfg, char *param);
 
 void add_rtltcp_output(struct r_cfg *cfg, char *param);
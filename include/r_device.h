@@ -5,6 +5,8 @@
 #ifndef INCLUDE_R_DEVICE_H_
 #define INCLUDE_R_DEVICE_H_
 
+#include <stdint.h>
+
 /**
     Supported Modulation and Coding types.
 
@@ -84,6 +86,8 @@ typedef struct r_device {
     unsigned decode_ok;
     unsigned decode_messages;
     unsigned decode_fails[5];
+    uint64_t decode_ns; ///< time spent in the decoder while profiling
+    struct metrics_latency *latency; ///< pulse train end to decoded event, allocated on the first event
 
     /* private for flex decoder and output callback */
     void *decode_ctx;
@@ -9,6 +9,7 @@
 #include <time.h>
 #include "list.h"
 #include "baseband.h"
+#include "baseband_lanes.h"
 #include "pulse_detect.h"
 #include "fileformat.h"
 #include "samp_grab.h"
@@ -17,6 +18,7 @@
 #include "compat_time.h"
 #include "cf32_resampler.h"
 #include "wb_dedup.h"
+#include "metrics.h"
 
 struct dm_state {
     float auto_level;
@@ -61,6 +63,7 @@ struct dm_state {
     unsigned frame_end_ago;
     struct timeval now;
     float sample_file_pos;
+    metrics_pipeline_t metrics; ///< pipeline stage timing for the /metrics endpoint
 
     /*
      * Per-channel state for wideband mode.
@@ -84,10 +87,12 @@ struct dm_state {
     int16_t *wb_fm_bufs;                                    ///< Per-channel FM demod buffers [ch * wb_buf_len]
     uint16_t *wb_temp_bufs;                                 ///< Per-channel temp/magnitude buffers [ch * wb_buf_len]
     size_t wb_buf_len;                                      ///< Per-channel buffer length (samples)
+    baseband_lanes_t *wb_lanes;                             ///< Cross-channel low pass and FM demod scratch
     wb_dedup_t *wb_dedup;                                   ///< Wideband cross-channel deduplication
     unsigned *wb_decode_count;                               ///< Per-channel successful decode count [num_channels]
     float *wb_channel_freqs;                                 ///< Per-channel center frequencies (Hz) [num_channels]
     float *wb_smoothed_power;                                ///< Per-channel smoothed power (dB) [num_channels]
+    uint64_t *wb_busy_ns;                                    ///< Per-channel processing time in the profile interval [num_channels]
 };
 
 #endif /* INCLUDE_R_PRIVATE_H_ */
@@ -0,0 +1,97 @@
+/** @file
+    Replay speed governor for file inputs.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_REPLAY_H_
+#define INCLUDE_REPLAY_H_
+
+#include <stdint.h>
+
+/*
+ A replay delivers each sample buffer at the time a receiver running at
+ the replay speed would have received its last sample. The times are
+ computed from the sample clock, position over sample rate over speed,
+ so they do not drift with the buffer size or sleep granularity, and the
+ decoded output is the same at any speed.
+
+ Processing is synchronous, a buffer that is late stands for the buffers
+ a live receiver would have queued in the meantime: the queue depth is
+ how many buffer durations behind its due time processing of a buffer
+ started, the latency is the time from the last sample of a buffer being
+ due to its processing being done.
+
+ The auto mode finds the fastest sustainable speed: it evaluates windows
+ of REPLAY_AUTO_WINDOW buffers, doubles the speed after a window within
+ the queue and latency targets and halves it after one that exceeded
+ them, then bisects between the fastest passed and slowest failed speed
+ down to REPLAY_AUTO_RESOLUTION. The schedule restarts at each change so
+ the backlog of a failed speed does not count against the next one. While
+ the speed stays the backlog is kept: a speed only a little too fast may
+ pass a window but fails a later one, then the search starts again from
+ half that speed.
+*/
+
+#define REPLAY_AUTO_WINDOW      16   ///< sample buffers per evaluation window
+#define REPLAY_AUTO_QUEUE       4    ///< default queue depth target in buffers
+#define REPLAY_AUTO_RESOLUTION  1.1  ///< bisection stops at this failed / passed ratio
+#define REPLAY_SPEED_MIN        0.01 ///< the auto mode does not slow down further
+
+/// Replay pacing modes.
+enum replay_mode {
+    REPLAY_MAX,   ///< as fast as possible, no pacing
+    REPLAY_FIXED, ///< at a fixed speed factor
+    REPLAY_AUTO,  ///< ramp to the fastest speed within the targets
+};
+
+typedef struct replay {
+    int mode;
+    double speed;        ///< current speed factor
+    double max_queue;    ///< auto: queue depth target in buffers
+    double max_latency;  ///< auto: latency target in seconds, 0 for none
+    uint64_t anchor_ns;  ///< wall clock time of the anchor position
+    double anchor_pos;   ///< sample clock position the schedule starts at, seconds
+    unsigned blocks;     ///< buffers in the current window
+    double queue;        ///< highest queue depth in the current window
+    double latency;      ///< highest latency in the current window, seconds
+    double passed;       ///< auto: fastest speed that stayed within the targets, 0 if none
+    double failed;       ///< auto: slowest speed that exceeded the targets, 0 if none
+    double peak_queue;   ///< highest queue depth since replay_start()
+    double peak_latency; ///< highest latency since replay_start(), seconds
+} replay_t;
+
+/** Set up a replay governor.
+
+    @param mode one of enum replay_mode
+    @param speed the speed factor, the start speed of the auto mode
+    @param max_queue auto: queue depth target in buffers
+    @param max_latency auto: latency target in seconds, 0 for none
+*/
+void replay_init(replay_t *r, int mode, double speed, double max_queue, double max_latency);
+
+/// Start the schedule of a new input at sample clock position 0 and wall clock @p now_ns.
+void replay_start(replay_t *r, uint64_t now_ns);
+
+/// Wall clock time in ns the sample clock position @p pos (seconds) is due.
+uint64_t replay_due(replay_t const *r, double pos);
+
+/** Account a processed sample buffer.
+
+    @param pos sample clock position of the end of the buffer, seconds
+    @param len duration of the buffer, seconds
+    @param begin_ns wall clock time the processing started
+    @param end_ns wall clock time the processing was done
+    @return 1 if the auto mode changed the speed, 0 otherwise
+*/
+int replay_block(replay_t *r, double pos, double len, uint64_t begin_ns, uint64_t end_ns);
+
+/// Return 1 if the auto mode has narrowed the sustainable speed down to REPLAY_AUTO_RESOLUTION.
+int replay_settled(replay_t const *r);
+
+#endif /* INCLUDE_REPLAY_H_ */
@@ -78,7 +78,10 @@ typedef struct r_cfg {
     char const *test_data;
     list_t in_files;
     char const *in_filename;
-    int in_replay;
+    int in_replay;              ///< file input pacing, see enum replay_mode
+    double in_replay_speed;     ///< replay speed factor, the start speed of the auto mode
+    unsigned in_replay_queue;   ///< auto replay: queue depth target in sample buffers
+    unsigned in_replay_latency; ///< auto replay: latency target in ms, 0 for none
     volatile sig_atomic_t hop_now;
     volatile sig_atomic_t exit_async;
     volatile sig_atomic_t exit_code; ///< 0=no err, 1=params or cmd line err, 2=sdr device read error, 3=usb init error, 5=USB error (reset), other=other error
@@ -139,6 +142,15 @@ typedef struct r_cfg {
     unsigned frames_ook;    ///< counter of ook demods for report interval statistic
     unsigned frames_fsk;    ///< counter of fsk demods for report interval statistic
     unsigned frames_events; ///< counter of decoder events for report interval statistic
+    /* profiler report */
+    int perf_interval;      ///< profiler report interval in seconds, 0 is off
+    time_t perf_time;       ///< time of the next profiler report
+    time_t perf_since;      ///< time at start of the profiler interval
+    /* repeated transmission coalescing */
+    unsigned coalesce_window;   ///< longest gap between copies of a burst (ms), 0 is off
+    char *coalesce_fields;      ///< coalescing key fields, NULL = all
+    struct coalesce *coalesce;  ///< coalescing stage, NULL if off
+    struct spectrum *spectrum;  ///< live spectrum for the web UI, created by the first viewer
     struct mg_mgr *mgr;
     /* Wideband scanning */
     int wideband_mode;                  ///< 1 if wideband scanning enabled
@@ -149,6 +161,10 @@ typedef struct r_cfg {
     struct channelizer *channelizer;    ///< PFB channelizer instance
     FILE *wb_record_file;               ///< Wideband IQ recording file handle
     char *wb_record_filename;           ///< Wideband IQ recording filename
+    unsigned wb_dedup_window;           ///< Cross-channel dedup window (ms), 0 = off
+    char *wb_dedup_fields;              ///< Cross-channel dedup key fields, NULL = all
+    uint32_t wb_decoder_rate;           ///< Per-channel decoder rate (Hz), 0 = channel rate
+    int wb_resampler_arbitrary;         ///< 1 to resample channels with the arbitrary ratio resampler
     int web_ui_debug;                   ///< Enable debug tab in web UI (-M web_ui_debug)
 } r_cfg_t;
 
@@ -0,0 +1,116 @@
+/** @file
+    Shared-memory event ring, single producer and multiple consumers.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SHM_RING_H_
+#define INCLUDE_SHM_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ The ring is a POSIX shared memory object (shm_open) of a header followed by
+ a data area of `capacity` bytes. Records are written back to back, each an
+ 8 byte aligned u32 length, u32 flags, u64 sequence number and the payload.
+
+ Positions are free-running byte counts, the producer never waits: it
+ overwrites the oldest records and readers detect being lapped by checking
+ `reserve` after copying a record, like a seqlock. Each reader keeps its own
+ position, so readers attach, detach and fall behind independently.
+*/
+
+#define SHM_RING_MAGIC       "H433RING"
+#define SHM_RING_VERSION     1
+#define SHM_RING_HEADER_SIZE 256        ///< offset of the data area
+#define SHM_RING_RECORD_HDR  16         ///< size of a record header
+#define SHM_RING_DEFAULT_NAME "/hydrasdr_433"
+#define SHM_RING_DEFAULT_SIZE (1 << 20) ///< default data area size
+
+/// Payload formats, see shm_ring_format().
+enum shm_ring_format {
+    SHM_RING_FORMAT_JSON = 0, ///< one JSON object per record, no newline
+    SHM_RING_FORMAT_CBOR = 1, ///< one CBOR map per record
+};
+
+/// Result codes of shm_reader_next().
+#define SHM_RING_EMPTY  0  ///< no new record
+#define SHM_RING_CLOSED -1 ///< the producer has shut down, reopen to continue
+
+/// Shared header, all positions and sequence numbers are written by the producer only.
+typedef struct shm_ring_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;        ///< enum shm_ring_format
+    uint64_t capacity;      ///< data area size, a power of two
+    uint32_t producer_pid;
+    uint32_t closed;        ///< set when the producer shuts down
+    uint8_t pad0[96];
+    // own cache line, written for every record
+    uint64_t reserve;       ///< end of the record being written
+    uint64_t head;          ///< end of the last complete record
+    uint64_t tail;          ///< start of the oldest complete record
+    uint64_t seq;           ///< sequence number of the last complete record
+    uint8_t pad1[96];
+} shm_ring_header_t;
+
+typedef struct shm_ring shm_ring_t;
+typedef struct shm_reader shm_reader_t;
+
+/* producer */
+
+/** Create the shared memory ring @p name, replacing an existing one.
+
+    @param name POSIX shared memory name, e.g. "/hydrasdr_433"
+    @param capacity data area size, rounded up to a power of two
+    @param format payload format of the records, enum shm_ring_format
+    @return the ring, NULL on error
+*/
+shm_ring_t *shm_ring_create(char const *name, size_t capacity, int format);
+
+/** Append one record, overwriting the oldest records as needed.
+
+    Never blocks. Records larger than half the capacity are rejected.
+
+    @return the sequence number of the record, 0 on error
+*/
+uint64_t shm_ring_write(shm_ring_t *ring, void const *buf, size_t len);
+
+/// Mark the ring closed for readers, unmap and unlink it.
+void shm_ring_destroy(shm_ring_t *ring);
+
+/* consumer */
+
+/** Attach to the ring @p name.
+
+    @param name POSIX shared memory name
+    @param from_oldest start with the oldest record still in the ring instead of new records
+    @return the reader, NULL if the ring does not exist or is invalid
+*/
+shm_reader_t *shm_reader_open(char const *name, int from_oldest);
+
+/** Copy the next record to @p buf.
+
+    Records that do not fit @p size are skipped and counted as lost.
+
+    @param[out] seq the sequence number of the record, may be NULL
+    @return the record length, SHM_RING_EMPTY or SHM_RING_CLOSED
+*/
+int shm_reader_next(shm_reader_t *reader, void *buf, size_t size, uint64_t *seq);
+
+/// Number of records missed because the reader was lapped by the producer.
+uint64_t shm_reader_lost(shm_reader_t const *reader);
+
+/// Payload format of the ring, enum shm_ring_format.
+int shm_reader_format(shm_reader_t const *reader);
+
+/// Detach from the ring.
+void shm_reader_close(shm_reader_t *reader);
+
+#endif /* INCLUDE_SHM_RING_H_ */
@@ -0,0 +1,98 @@
+/** @file
+    Live spectrum frames for the web UI.
+
+    A windowed FFT of the input, averaged over a sample buffer, is computed
+    only when a frame is due.  The levels and the wideband channel power are
+    written by the receive thread and read by the HTTP server thread, each
+    through a short copy under a lock.  Frames are sent as binary websocket
+    messages of a fixed little-endian header and one byte per bin:
+
+        offset  size  field
+        0       1     version (1)
+        1       1     source, 0: FFT of the input, 1: wideband channel power
+        2       2     number of bins
+        4       4     sequence number
+        8       4     center frequency in Hz
+        12      4     span in Hz, the bins cover center +/- span / 2
+        16      2     level of value 0, signed dB
+        18      2     level step in 1/100 dB
+        20      bins  level per bin, lowest frequency first
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SPECTRUM_H_
+#define INCLUDE_SPECTRUM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPECTRUM_FFT_SIZE     2048  ///< FFT size, the finest resolution offered
+#define SPECTRUM_MIN_BINS     16
+#define SPECTRUM_DEFAULT_BINS 512
+#define SPECTRUM_MAX_FPS      30
+#define SPECTRUM_DEFAULT_FPS  10
+#define SPECTRUM_AVERAGE      8     ///< FFTs averaged per frame at most
+#define SPECTRUM_FLOOR_DB     (-128)
+#define SPECTRUM_STEP_CDB     50    ///< 0.5 dB per step, 127.5 dB range
+#define SPECTRUM_HEADER_LEN   20
+#define SPECTRUM_MAX_CHANNELS 32    ///< wideband channels kept for the channel power
+
+enum spectrum_source {
+    SPECTRUM_SOURCE_FFT      = 0,
+    SPECTRUM_SOURCE_CHANNELS = 1,
+};
+
+typedef struct spectrum spectrum_t;
+
+/** Create a spectrum of @p fft_size bins, a power of two.
+    Returns NULL on allocation failure. */
+spectrum_t *spectrum_create(unsigned fft_size);
+
+/** Free the spectrum (NULL-safe). */
+void spectrum_free(spectrum_t *sp);
+
+/** Set the time between frames in seconds, 0 stops computing frames. */
+void spectrum_set_interval(spectrum_t *sp, double seconds);
+
+/** Set the tuning of the input passed next to spectrum_feed(), kept with
+    each frame so the readers do not look at the receive configuration. */
+void spectrum_set_tuning(spectrum_t *sp, uint32_t center_hz, uint32_t samp_rate, int wideband);
+
+/** Compute a frame from a sample buffer if one is due at @p now seconds.
+    @p sample_size selects CU8 (2), CS16 (4) or CF32 (8) samples.
+    @return 1 if a new frame was computed, 0 otherwise */
+int spectrum_feed(spectrum_t *sp, void const *iq, unsigned n_samples, unsigned sample_size, double now);
+
+/** Return the FFT size, the number of levels of a frame. */
+unsigned spectrum_size(spectrum_t const *sp);
+
+/** Copy the levels in dBFS of the last frame, lowest frequency first, to
+    @p levels of spectrum_size() entries unless it is frame @p since.
+    @p center_hz and @p span_hz, if not NULL, get the tuning of that frame.
+    Returns the sequence number of the last frame, 0 if there is none yet. */
+uint32_t spectrum_read(spectrum_t *sp, float *levels, uint32_t since, uint32_t *center_hz, uint32_t *span_hz);
+
+/** Store the smoothed power in dB of @p n wideband channels. */
+void spectrum_set_channels(spectrum_t *sp, float const *freqs, float const *power, unsigned n);
+
+/** Copy the channels stored last, in order of frequency.
+    Returns the number of channels, at most SPECTRUM_MAX_CHANNELS, 0 unless
+    the tuning is wideband. */
+unsigned spectrum_read_channels(spectrum_t *sp, float *freqs, float *power);
+
+/** Reduce @p n levels to @p bins by the maximum of each group and
+    quantize them to @p out.  Returns the number of bins written. */
+unsigned spectrum_quantize(float const *levels, unsigned n, uint8_t *out, unsigned bins);
+
+/** Encode a frame of @p n levels reduced to @p bins into @p buf.
+    Returns the frame length, 0 if @p size is too small. */
+size_t spectrum_frame(uint8_t *buf, size_t size, int source, uint32_t seq,
+        uint32_t center_hz, uint32_t span_hz, float const *levels, unsigned n, unsigned bins);
+
+#endif /* INCLUDE_SPECTRUM_H_ */
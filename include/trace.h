@@ -0,0 +1,84 @@
+/** @file
+    Pipeline trace recorder writing Chrome Trace Event JSON.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_TRACE_H_
+#define INCLUDE_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ Each thread records into its own ring buffer which only that thread writes,
+ the recorder reads them after the window ended, so recording takes no lock.
+ The window is counted in seconds of processed input, a trace of a file
+ replay covers the same samples at any replay speed. The resulting file
+ loads into chrome://tracing or https://ui.perfetto.dev
+*/
+
+/// Recording threads, each has its own buffer.
+enum trace_thread {
+    TRACE_THREAD_DEMOD,   ///< the main loop: DSP, decoders and outputs
+    TRACE_THREAD_ACQUIRE, ///< the SDR acquire thread
+    TRACE_THREADS,
+};
+
+#define TRACE_DEMOD_EVENTS   (1 << 18) ///< buffer size of the demod thread
+#define TRACE_ACQUIRE_EVENTS (1 << 14) ///< buffer size of the acquire thread
+#define TRACE_DETAIL_LEN     20        ///< decoder names are truncated to fit
+
+/** Start recording for @p seconds of input.
+
+    @param path the JSON file to write, copied
+    @return 0 on success, -1 if already recording or out of memory
+*/
+int trace_start(double seconds, char const *path);
+
+/// Return 1 if recording.
+int trace_recording(void);
+
+/// Return the current time to pass to trace_span(), 0 if not recording.
+uint64_t trace_begin(void);
+
+/** Record a span from @p start_ns to now on @p thread.
+
+    @param name a static string
+    @param detail copied and truncated, may be NULL
+    @param arg an index, e.g. a channel or protocol number, -1 for none
+    @param start_ns from trace_begin() or another clock read, nothing is recorded if 0
+*/
+void trace_span(int thread, char const *name, char const *detail, int arg, uint64_t start_ns);
+
+/** Record a flow event linking a handoff between threads.
+
+    @param end 0 on the sending thread, 1 on the receiving thread
+    @param id matches the start to the end
+*/
+void trace_flow(int thread, int end, uint64_t id);
+
+/** Account @p seconds of processed input to the window.
+
+    @return 1 if the window is complete and the trace should be stopped
+*/
+int trace_input(double seconds);
+
+/** Stop recording and write the trace file.
+
+    @return the number of events written, -1 if not recording or on write error
+*/
+long trace_stop(void);
+
+/// Path of the current or last trace file, NULL if none.
+char const *trace_path(void);
+
+/// Release the buffers, must not be called while other threads may record.
+void trace_free(void);
+
+#endif /* INCLUDE_TRACE_H_ */
@@ -10,25 +10,51 @@
 #ifndef INCLUDE_WB_DEDUP_H_
 #define INCLUDE_WB_DEDUP_H_
 
+#include <stdint.h>
+
 #include "data.h"
 
-#define WB_DEDUP_CACHE_SIZE  32
-#define WB_DEDUP_WINDOW_US   500000  /* 500 ms */
+#define WB_DEDUP_SLOTS      1024  /* hash index size, power of two */
+#define WB_DEDUP_PROBES     16    /* linear probe limit before evicting */
+#define WB_DEDUP_WINDOW_MS  500
+
+/** Fields never part of the key, they differ between the channels. */
+#define WB_DEDUP_VOLATILE_FIELDS "time,rssi,snr,noise,freq,freq1,freq2,mod"
 
 typedef struct wb_dedup wb_dedup_t;
 
-/** Create a dedup context.  Returns NULL on allocation failure. */
-wb_dedup_t *wb_dedup_create(void);
+/** Lookup counters, see wb_dedup_stats(). */
+typedef struct wb_dedup_stats {
+    uint64_t hits;      /* cross-channel duplicates suppressed */
+    uint64_t repeats;   /* same-channel retransmissions passed */
+    uint64_t misses;    /* new keys */
+    uint64_t evictions; /* live entries dropped for lack of space */
+} wb_dedup_stats_t;
+
+/** Create a dedup context.  Returns NULL on allocation failure.
+ *  window_ms is the time within which a copy is a duplicate.
+ *  fields is a comma separated list of the data fields forming the key,
+ *  fields prefixed with '-' are excluded instead, NULL or "" to use all
+ *  fields.  The volatile fields are always excluded. */
+wb_dedup_t *wb_dedup_create(unsigned window_ms, char const *fields);
 
 /** Free a dedup context (NULL-safe). */
 void wb_dedup_free(wb_dedup_t *dedup);
 
 /** Check if data is a cross-channel duplicate.
  *  Returns 1 if duplicate (suppress), 0 if unique (forward).
- *  chan_freq_hz is the channel center frequency. */
-int wb_dedup_check(wb_dedup_t *dedup, data_t *data, float chan_freq_hz);
+ *  channel identifies the channel, time_ms is the sample clock time of the
+ *  transmission, so that replays dedup the same at any speed.
+ *  Safe to call concurrently from channel workers, it takes no lock. */
+int wb_dedup_check(wb_dedup_t *dedup, data_t *data, int channel, uint64_t time_ms);
+
+/** Return the 64-bit FNV-1a hash of the key fields of data. */
+uint64_t wb_dedup_key(wb_dedup_t const *dedup, data_t *data);
 
 /** Return total number of suppressed duplicates since creation. */
 unsigned wb_dedup_suppressed_count(wb_dedup_t *dedup);
 
+/** Read the lookup counters since creation. */
+void wb_dedup_stats(wb_dedup_t *dedup, wb_dedup_stats_t *stats);
+
 #endif /* INCLUDE_WB_DEDUP_H_ */
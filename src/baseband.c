@@ -16,6 +16,9 @@
 #include <string.h>
 #include <math.h>
 
+#include "baseband_lanes.h"
+#include "cpu_detect.h"
+#include "fatal.h"
 #include "logger.h"
 #include "r_util.h"
 
@@ -189,15 +192,18 @@ void baseband_low_pass_filter_reset(filter_state_t *lowpass_filter)
     - but the b coeffs are small so it won't happen
     - Q15.14>>14 = Q15.0
 */
+///  [b,a] = butter(1, 0.01) -> 3x tau (95%) ~100 samples
+//static int const lowpass_a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.96907) >> 1};
+//static int const lowpass_b[FILTER_ORDER + 1] = {FIX(0.015466) >> 1, FIX(0.015466) >> 1};
+///  [b,a] = butter(1, 0.05) -> 3x tau (95%) ~20 samples
+static int const lowpass_a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.85408) >> 1};
+static int const lowpass_b[FILTER_ORDER + 1] = {FIX(0.07296) >> 1, FIX(0.07296) >> 1};
+// note that coeffs are prescaled by div 2
+
 void baseband_low_pass_filter(filter_state_t *state, uint16_t const *x_buf, int16_t *y_buf, uint32_t len)
 {
-    ///  [b,a] = butter(1, 0.01) -> 3x tau (95%) ~100 samples
-    //static int const a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.96907) >> 1};
-    //static int const b[FILTER_ORDER + 1] = {FIX(0.015466) >> 1, FIX(0.015466) >> 1};
-    ///  [b,a] = butter(1, 0.05) -> 3x tau (95%) ~20 samples
-    static int const a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.85408) >> 1};
-    static int const b[FILTER_ORDER + 1] = {FIX(0.07296) >> 1, FIX(0.07296) >> 1};
-    // note that coeffs are prescaled by div 2
+    int const *a = lowpass_a;
+    int const *b = lowpass_b;
 
     // Prevent out of bounds access
     if (len < FILTER_ORDER) {
@@ -417,21 +423,9 @@ void baseband_demod_FM_cs16(demodfm_state_t *state, int16_t const *x_buf, int16_
     state->yf = y0f;
 }
 
-/// Fast Instantaneous frequency and Low Pass filter, CF32 samples (HydraSDR).
-/// Input: interleaved float32 I/Q in range [-1.0, 1.0]
-///
-/// Note: Uses INT16_MAX scaling to match the integer atan2 pipeline.
-/// The int32 atan2 and int16 output limit FM demod precision to ~16-bit
-/// equivalent, matching the CS16 code path. A float atan2 pipeline would
-/// give higher precision but at significant CPU cost and pipeline changes.
-void baseband_demod_FM_cf32(demodfm_state_t *state, float const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass)
+/// Select CF32 filter coeffs, [b,a] = butter(1, cutoff), on a rate change.
+static void demod_FM_cf32_coeffs(demodfm_state_t *state, uint32_t samp_rate, float low_pass)
 {
-    /* Scale float [-1,1] to int16 range for integer atan2 processing.
-     * INT16_MAX is the maximum safe value: 2 * INT16_MAX^2 < INT32_MAX,
-     * ensuring the phase difference products fit in int32_t for atan2_int32. */
-    const float scale = (float)INT16_MAX;
-
-    // Select filter coeffs, [b,a] = butter(1, cutoff)
     if (state->rate != samp_rate) {
         if (low_pass > 1e4f) {
             low_pass = low_pass / samp_rate;
@@ -448,6 +442,23 @@ void baseband_demod_FM_cf32(demodfm_state_t *state, float const *x_buf, int16_t
         state->blp_32[1] = FIX32(gain);
         state->rate      = samp_rate;
     }
+}
+
+/// Fast Instantaneous frequency and Low Pass filter, CF32 samples (HydraSDR).
+/// Input: interleaved float32 I/Q in range [-1.0, 1.0]
+///
+/// Note: Uses INT16_MAX scaling to match the integer atan2 pipeline.
+/// The int32 atan2 and int16 output limit FM demod precision to ~16-bit
+/// equivalent, matching the CS16 code path. A float atan2 pipeline would
+/// give higher precision but at significant CPU cost and pipeline changes.
+void baseband_demod_FM_cf32(demodfm_state_t *state, float const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass)
+{
+    /* Scale float [-1,1] to int16 range for integer atan2 processing.
+     * INT16_MAX is the maximum safe value: 2 * INT16_MAX^2 < INT32_MAX,
+     * ensuring the phase difference products fit in int32_t for atan2_int32. */
+    const float scale = (float)INT16_MAX;
+
+    demod_FM_cf32_coeffs(state, samp_rate, low_pass);
     int64_t const *alp = state->alp_32;
     int64_t const *blp = state->blp_32;
 
@@ -491,6 +502,223 @@ void baseband_demod_FM_cf32(demodfm_state_t *state, float const *x_buf, int16_t
     state->yf = y0f;
 }
 
+/* Cross-channel filters, see baseband_lanes.h */
+
+static baseband_lowpass_lanes_fn_t select_lanes(baseband_fm_lowpass_lanes_fn_t *fm_lowpass, const char **name)
+{
+    baseband_lowpass_lanes_fn_t fn;
+    baseband_fm_lowpass_lanes_fn_t fm_fn;
+    const char *isa_name;
+
+    switch (cpu_detect_isa()) {
+    case CPU_ISA_AVX512:
+        fn = baseband_lowpass_lanes_avx512;
+        fm_fn = baseband_fm_lowpass_lanes_avx512;
+        isa_name = "AVX-512";
+        break;
+    case CPU_ISA_AVX2:
+        fn = baseband_lowpass_lanes_avx2;
+        fm_fn = baseband_fm_lowpass_lanes_avx2;
+        isa_name = "AVX2+FMA";
+        break;
+    case CPU_ISA_SVE:
+        fn = baseband_lowpass_lanes_sve;
+        fm_fn = baseband_fm_lowpass_lanes_sve;
+        isa_name = "SVE";
+        break;
+    case CPU_ISA_NEON:
+        fn = baseband_lowpass_lanes_neon;
+        fm_fn = baseband_fm_lowpass_lanes_neon;
+        isa_name = "NEON";
+        break;
+    default:
+        fn = baseband_lowpass_lanes_sse2;
+        fm_fn = baseband_fm_lowpass_lanes_sse2;
+        isa_name = "baseline";
+        break;
+    }
+    if (fm_lowpass)
+        *fm_lowpass = fm_fn;
+    if (name)
+        *name = isa_name;
+    return fn;
+}
+
+baseband_lanes_t *baseband_lanes_create(uint32_t max_len)
+{
+    baseband_lanes_t *lanes = calloc(1, sizeof(*lanes));
+    if (!lanes) {
+        WARN_CALLOC("baseband_lanes_create()");
+        return NULL;
+    }
+    size_t n = (size_t)max_len * BASEBAND_LANES_MAX;
+    lanes->am_in = calloc(n, sizeof(*lanes->am_in));
+    if (!lanes->am_in)
+        goto fail;
+    lanes->fm_in = calloc(n, sizeof(*lanes->fm_in));
+    if (!lanes->fm_in)
+        goto fail;
+    lanes->out = calloc(n, sizeof(*lanes->out));
+    if (!lanes->out)
+        goto fail;
+    lanes->max_len = max_len;
+    lanes->lowpass = select_lanes(&lanes->fm_lowpass, NULL);
+    return lanes;
+
+fail:
+    WARN_CALLOC("baseband_lanes_create()");
+    baseband_lanes_free(lanes);
+    return NULL;
+}
+
+void baseband_lanes_free(baseband_lanes_t *lanes)
+{
+    if (!lanes)
+        return;
+    free(lanes->am_in);
+    free(lanes->fm_in);
+    free(lanes->out);
+    free(lanes);
+}
+
+const char *baseband_lanes_isa_info(void)
+{
+    const char *name;
+    select_lanes(NULL, &name);
+    return name;
+}
+
+unsigned baseband_lanes_width(unsigned channels)
+{
+    return channels <= BASEBAND_LANES_MIN ? BASEBAND_LANES_MIN : BASEBAND_LANES_MAX;
+}
+
+/// Interleave count channels into lanes, unused lanes filter silence.
+static void lanes_interleave(uint16_t const *const *x_buf, uint16_t *in, uint32_t len, unsigned count, unsigned width)
+{
+    uint16_t const *x[BASEBAND_LANES_MAX];
+    for (unsigned c = 0; c < count; c++)
+        x[c] = x_buf[c]; // local copy, the stores below may alias x_buf
+
+    for (uint32_t t = 0; t < len; t++) {
+        uint16_t *row = &in[(size_t)t * width];
+        for (unsigned c = 0; c < count; c++)
+            row[c] = x[c][t];
+        for (unsigned c = count; c < width; c++)
+            row[c] = 0;
+    }
+}
+
+/// Samples per deinterleave block: each channel is written contiguously
+/// and the block of lanes stays in L1 cache, whatever the channel strides.
+#define LANES_BLOCK 64
+
+/// Copy the interleaved output of count lanes back to the channel buffers.
+static void lanes_deinterleave(int16_t const *out, int16_t *const *y_buf, uint32_t len, unsigned count, unsigned width)
+{
+    for (uint32_t t0 = 0; t0 < len; t0 += LANES_BLOCK) {
+        uint32_t t1 = len - t0 < LANES_BLOCK ? len : t0 + LANES_BLOCK;
+        for (unsigned c = 0; c < count; c++) {
+            int16_t *y = y_buf[c];
+            for (uint32_t t = t0; t < t1; t++)
+                y[t] = out[(size_t)t * width + c];
+        }
+    }
+}
+
+void baseband_low_pass_filter_lanes(baseband_lanes_t *lanes, filter_state_t *const *state,
+        uint16_t const *const *x_buf, int16_t *const *y_buf, uint32_t len, unsigned channels)
+{
+    // Prevent out of bounds access, as baseband_low_pass_filter()
+    if (len < FILTER_ORDER || len > lanes->max_len)
+        return;
+
+    for (unsigned first = 0; first < channels; first += BASEBAND_LANES_MAX) {
+        unsigned count = channels - first < BASEBAND_LANES_MAX ? channels - first : BASEBAND_LANES_MAX;
+        unsigned width = baseband_lanes_width(count);
+        baseband_lanes_iir_t st;
+        memset(&st, 0, sizeof(st));
+
+        for (unsigned c = 0; c < width; c++) {
+            st.a1[c] = lowpass_a[1];
+            st.b0[c] = lowpass_b[0]; // note: prescaled, b[0]==b[1]
+        }
+        for (unsigned c = 0; c < count; c++) {
+            st.x1[c] = state[first + c]->x[0];
+            st.y1[c] = state[first + c]->y[0];
+        }
+        lanes_interleave(&x_buf[first], lanes->am_in, len, count, width);
+
+        lanes->lowpass(&st, lanes->am_in, lanes->out, len, width);
+
+        lanes_deinterleave(lanes->out, &y_buf[first], len, count, width);
+        for (unsigned c = 0; c < count; c++) {
+            // Save last samples
+            state[first + c]->x[0] = (int16_t)st.x1[c];
+            state[first + c]->y[0] = (int16_t)st.y1[c];
+        }
+    }
+}
+
+void baseband_demod_FM_cf32_lanes(baseband_lanes_t *lanes, demodfm_state_t *const *state,
+        float const *const *x_buf, int16_t *const *y_buf, uint32_t len, unsigned channels,
+        uint32_t samp_rate, float const *low_pass)
+{
+    // Same scaling as baseband_demod_FM_cf32()
+    const float scale = (float)INT16_MAX;
+
+    if (len > lanes->max_len)
+        return;
+
+    for (unsigned first = 0; first < channels; first += BASEBAND_LANES_MAX) {
+        unsigned count = channels - first < BASEBAND_LANES_MAX ? channels - first : BASEBAND_LANES_MAX;
+        unsigned width = baseband_lanes_width(count);
+        baseband_lanes_iir_t st;
+        memset(&st, 0, sizeof(st));
+
+        for (unsigned c = 0; c < count; c++) {
+            demodfm_state_t *s = state[first + c];
+            float const *x = x_buf[first + c];
+            int32_t *xf = &lanes->fm_in[c];
+
+            demod_FM_cf32_coeffs(s, samp_rate, low_pass[first + c]);
+            st.a1[c] = (int32_t)s->alp_32[1];
+            st.b0[c] = (int32_t)s->blp_32[0]; // note: blp[0]==blp[1]
+            st.x1[c] = s->xf;
+            st.y1[c] = s->yf;
+
+            // Discriminator, not recursive: per channel, into lane c
+            int32_t x0r = s->xr;
+            int32_t x0i = s->xi;
+            for (uint32_t t = 0; t < len; t++) {
+                int32_t x1r = x0r;
+                int32_t x1i = x0i;
+                x0r = (int32_t)(x[2 * t + 0] * scale);
+                x0i = (int32_t)(x[2 * t + 1] * scale);
+                int64_t pr = (int64_t)x0r * x1r + (int64_t)x0i * x1i;
+                int64_t pi = (int64_t)x0i * x1r - (int64_t)x0r * x1i;
+                xf[(size_t)t * width] = atan2_int32(pi, pr);
+            }
+            s->xr = x0r;
+            s->xi = x0i;
+        }
+        // Unused lanes filter silence
+        for (unsigned c = count; c < width; c++) {
+            for (uint32_t t = 0; t < len; t++)
+                lanes->fm_in[(size_t)t * width + c] = 0;
+        }
+
+        lanes->fm_lowpass(&st, lanes->fm_in, lanes->out, len, width);
+
+        lanes_deinterleave(lanes->out, &y_buf[first], len, count, width);
+        for (unsigned c = 0; c < count; c++) {
+            // Store newest sample for next run
+            state[first + c]->xf = st.x1[c];
+            state[first + c]->yf = st.y1[c];
+        }
+    }
+}
+
 void baseband_init(void)
 {
     calc_squares();
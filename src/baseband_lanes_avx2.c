@@ -0,0 +1,20 @@
+/** @file
+    AVX2 variant of the cross-channel low pass kernels.
+
+    Compiled with -mavx2 -mfma (GCC/Clang) or /arch:AVX2 (MSVC).
+    The lane loops are auto-vectorized to 256-bit integer instructions,
+    8 channels per register, widening vpmuldq for the Q30 FM filter.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "baseband_lanes.h"
+
+#define BASEBAND_LOWPASS_LANES_FN baseband_lowpass_lanes_avx2
+#define BASEBAND_FM_LOWPASS_LANES_FN baseband_fm_lowpass_lanes_avx2
+#include "baseband_lanes.inc"
@@ -0,0 +1,19 @@
+/** @file
+    AVX-512 variant of the cross-channel low pass kernels.
+
+    Compiled with -mavx512f -mavx512vl -mfma (GCC/Clang) or /arch:AVX512
+    (MSVC). The state of 16 channels fits one 512-bit register.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "baseband_lanes.h"
+
+#define BASEBAND_LOWPASS_LANES_FN baseband_lowpass_lanes_avx512
+#define BASEBAND_FM_LOWPASS_LANES_FN baseband_fm_lowpass_lanes_avx512
+#include "baseband_lanes.inc"
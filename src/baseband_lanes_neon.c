@@ -0,0 +1,20 @@
+/** @file
+    NEON variant of the cross-channel low pass kernels.
+
+    On AArch64, NEON is mandatory; GCC/Clang auto-vectorize the lane
+    loops to 4 int32 lanes per register (smull/smlal for the Q30 FM
+    filter). NEON is implicit on AArch64.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "baseband_lanes.h"
+
+#define BASEBAND_LOWPASS_LANES_FN baseband_lowpass_lanes_neon
+#define BASEBAND_FM_LOWPASS_LANES_FN baseband_fm_lowpass_lanes_neon
+#include "baseband_lanes.inc"
@@ -0,0 +1,19 @@
+/** @file
+    SSE2 (x86-64 baseline) variant of the cross-channel low pass kernels.
+
+    Compiled without explicit ISA flags, 4 int32 lanes per register.
+    This is the portable fallback.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "baseband_lanes.h"
+
+#define BASEBAND_LOWPASS_LANES_FN baseband_lowpass_lanes_sse2
+#define BASEBAND_FM_LOWPASS_LANES_FN baseband_fm_lowpass_lanes_sse2
+#include "baseband_lanes.inc"
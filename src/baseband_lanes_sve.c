@@ -0,0 +1,19 @@
+/** @file
+    SVE variant of the cross-channel low pass kernels.
+
+    Compiled with -march=armv8-a+sve (GCC/Clang). Only called when
+    runtime SVE detection confirms hardware support.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "baseband_lanes.h"
+
+#define BASEBAND_LOWPASS_LANES_FN baseband_lowpass_lanes_sve
+#define BASEBAND_FM_LOWPASS_LANES_FN baseband_fm_lowpass_lanes_sve
+#include "baseband_lanes.inc"
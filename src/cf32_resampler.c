@@ -10,6 +10,7 @@
 */
 
 #include "cf32_resampler.h"
+#include "cpu_detect.h"
 #include <string.h>
 #include <math.h>
 #include <limits.h>
@@ -18,6 +19,16 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+#ifdef _MSC_VER
+/* volatile accesses have acquire/release semantics with /volatile:ms */
+#define LOAD_ACQUIRE(p)     (*(volatile uint64_t *)(p))
+#define STORE_RELEASE(p, v) (*(volatile uint64_t *)(p) = (v))
+#else
+/* GCC/Clang __atomic builtins (works in C99 mode) */
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
 /* Modified Bessel function of the first kind, order 0.
  * Series approximation: I0(x) = sum_{k=0}^inf ((x/2)^k / k!)^2 */
 static float bessel_i0(float x)
@@ -35,6 +46,53 @@ static float bessel_i0(float x)
     return sum;
 }
 
+/* ISA dispatch: pick the best process functions for this CPU */
+static cf32_resampler_process_fn_t select_process(int arbitrary, cf32_halfband_process_fn_t *halfband,
+                                                  const char **name)
+{
+    cf32_resampler_process_fn_t fn, arb_fn;
+    cf32_halfband_process_fn_t hb_fn;
+    const char *isa_name;
+
+    switch (cpu_detect_isa()) {
+    case CPU_ISA_AVX512:
+        fn = cf32_resampler_process_avx512;
+        arb_fn = cf32_resampler_process_arb_avx512;
+        hb_fn = cf32_halfband_process_avx512;
+        isa_name = "AVX-512";
+        break;
+    case CPU_ISA_AVX2:
+        fn = cf32_resampler_process_avx2;
+        arb_fn = cf32_resampler_process_arb_avx2;
+        hb_fn = cf32_halfband_process_avx2;
+        isa_name = "AVX2+FMA";
+        break;
+    case CPU_ISA_SVE:
+        fn = cf32_resampler_process_sve;
+        arb_fn = cf32_resampler_process_arb_sve;
+        hb_fn = cf32_halfband_process_sve;
+        isa_name = "SVE";
+        break;
+    case CPU_ISA_NEON:
+        fn = cf32_resampler_process_neon;
+        arb_fn = cf32_resampler_process_arb_neon;
+        hb_fn = cf32_halfband_process_neon;
+        isa_name = "NEON";
+        break;
+    default:
+        fn = cf32_resampler_process_sse2;
+        arb_fn = cf32_resampler_process_arb_sse2;
+        hb_fn = cf32_halfband_process_sse2;
+        isa_name = "baseline";
+        break;
+    }
+    if (halfband)
+        *halfband = hb_fn;
+    if (name)
+        *name = isa_name;
+    return arbitrary ? arb_fn : fn;
+}
+
 int cf32_resampler_gcd(int a, int b)
 {
     while (b != 0) {
@@ -45,9 +103,9 @@ int cf32_resampler_gcd(int a, int b)
     return a;
 }
 
-void cf32_resampler_design_filter(float *coeffs, int num_taps, int factor)
+/* Kaiser windowed sinc, cutoff relative to the rate (1.0 = Nyquist) */
+static void design_lowpass(float *coeffs, int num_taps, float cutoff)
 {
-    float cutoff = 1.0f / (float)factor;
     float center = (float)(num_taps - 1) / 2.0f;
     float sum = 0.0f;
     float As = RESAMPLER_STOPBAND_DB;
@@ -94,156 +152,423 @@ void cf32_resampler_design_filter(float *coeffs, int num_taps, int factor)
     }
 }
 
-int cf32_resampler_init(cf32_resampler_t *res, uint32_t input_rate, uint32_t output_rate, size_t max_input_samples)
+void cf32_resampler_design_filter(float *coeffs, int num_taps, int factor)
 {
-    memset(res, 0, sizeof(*res));
+    design_lowpass(coeffs, num_taps, 1.0f / (float)factor);
+}
 
-    if (input_rate == 0 || output_rate == 0)
-        return -1;
+void cf32_resampler_design_halfband(float *coeffs, int num_taps)
+{
+    const int center = (num_taps - 1) / 2;
+    float sum = 0.0f;
 
-    if (input_rate == output_rate) {
-        res->initialized = 0;  /* No resampling needed */
+    /* Cutoff at a quarter of the rate, every other tap is zero */
+    cf32_resampler_design_filter(coeffs, num_taps, 2);
+    for (int i = 0; i < num_taps; i++) {
+        if (i != center && (i - center) % 2 == 0)
+            coeffs[i] = 0.0f;
+        sum += coeffs[i];
+    }
+    for (int i = 0; i < num_taps; i++)
+        coeffs[i] /= sum;
+}
+
+/* Half-band length from the Kaiser estimate: the passband ends at half
+ * the output rate and the image of it at rate / 2 must be suppressed */
+static int halfband_num_taps(uint32_t rate, double output_rate)
+{
+    double width = ((double)rate / 2.0 - output_rate) / (double)rate;
+    int n = (int)ceil((RESAMPLER_STOPBAND_DB - 7.95) / (14.36 * width)) + 1;
+
+    if (n < 7)
+        n = 7;
+    return 4 * (n / 4) + 3;  /* Round up to 4j+3 */
+}
+
+static int halfband_branch_taps(int num_taps)
+{
+    int odd = (num_taps + 1) / 2;
+    return (odd + RESAMPLER_HALFBAND_ALIGN - 1) / RESAMPLER_HALFBAND_ALIGN * RESAMPLER_HALFBAND_ALIGN;
+}
+
+/* Polyphase stage from rate to output_rate, the branches grow with the
+ * decimation to keep the transition band.  The arbitrary ratio bank has
+ * a fixed number of branches.  Returns -1 on overflow. */
+static int plan_polyphase(uint32_t rate, uint32_t output_rate, int arbitrary, cf32_resampler_plan_t *plan)
+{
+    if (arbitrary) {
+        uint32_t blocks = rate / output_rate;
+        if (blocks < 1)
+            blocks = 1;
+        if (blocks > (uint32_t)(INT_MAX / RESAMPLER_TAPS_PER_BRANCH / (RESAMPLER_ARB_PHASES + 1)))
+            return -1;
+        plan->polyphase_rate = rate;
+        plan->up_factor = 0;
+        plan->down_factor = 0;
+        plan->taps_per_branch = (int)blocks * RESAMPLER_TAPS_PER_BRANCH;
+        plan->arbitrary = 1;
         return 0;
     }
 
-    /* Validate sample rates fit in int for GCD computation */
+    int g = cf32_resampler_gcd((int)output_rate, (int)rate);
+    int up = (int)output_rate / g;
+    int down = (int)rate / g;
+    int blocks = down / up;
+
+    if (blocks < 1)
+        blocks = 1;
+    if (blocks > INT_MAX / RESAMPLER_TAPS_PER_BRANCH)
+        return -1;
+    int taps_per_branch = blocks * RESAMPLER_TAPS_PER_BRANCH;
+    if (up > INT_MAX / taps_per_branch)
+        return -1;
+
+    plan->polyphase_rate = rate;
+    plan->up_factor = up;
+    plan->down_factor = down;
+    plan->taps_per_branch = taps_per_branch;
+    return 0;
+}
+
+static int plan_chain(uint32_t input_rate, uint32_t output_rate, int arbitrary, cf32_resampler_plan_t *plan)
+{
+    cf32_resampler_plan_t chain;
+    /* An arbitrary ratio may be trimmed up, keep the margin */
+    const double output_max = arbitrary ? output_rate * (1.0 + RESAMPLER_ARB_MAX_TRIM) : output_rate;
+    double halfband_macs = 0.0;
+    uint32_t rate = input_rate;
+    int found = 0;
+
+    memset(plan, 0, sizeof(*plan));
+    memset(&chain, 0, sizeof(chain));
+
+    if (input_rate == 0 || output_rate == 0 || (input_rate == output_rate && !arbitrary))
+        return -1;
     if (input_rate > (uint32_t)INT_MAX || output_rate > (uint32_t)INT_MAX)
         return -1;
 
-    /* Find L/M ratio using GCD for minimal computational cost */
-    int g = cf32_resampler_gcd((int)output_rate, (int)input_rate);
-    res->up_factor = (int)output_rate / g;
-    res->down_factor = (int)input_rate / g;
+    /* Try K = 0, 1, .. half-bands while the rate halves exactly and the
+     * half-band keeps the output band, each with its polyphase stage */
+    for (int k = 0;; k++) {
+        if (plan_polyphase(rate, output_rate, arbitrary, &chain) == 0) {
+            chain.num_halfbands = k;
+            /* The arbitrary bank takes a second dot product to interpolate */
+            chain.macs_per_output = halfband_macs + (double)chain.taps_per_branch * (arbitrary ? 2 : 1);
+            if (k == 0)
+                chain.single_stage_macs = chain.macs_per_output;
+            if (!found || chain.macs_per_output < plan->macs_per_output) {
+                *plan = chain;
+                found = 1;
+            }
+        }
+        if (k == RESAMPLER_MAX_HALFBANDS || rate % 2 != 0 || rate / 2 <= output_max)
+            break;
+        chain.halfband_taps[k] = halfband_num_taps(rate, output_max);
+        rate /= 2;
+        halfband_macs += (double)(halfband_branch_taps(chain.halfband_taps[k]) + 1)
+                * (double)rate / (double)output_rate;
+    }
+    plan->single_stage_macs = chain.single_stage_macs;
 
-    /* Filter design: 32 taps per polyphase branch (Kaiser window) */
-    res->taps_per_branch = RESAMPLER_TAPS_PER_BRANCH;
+    return found ? 0 : -1;
+}
 
-    /* Check for integer overflow before multiplication */
-    if (res->up_factor > INT_MAX / res->taps_per_branch)
+int cf32_resampler_plan(uint32_t input_rate, uint32_t output_rate, cf32_resampler_plan_t *plan)
+{
+    return plan_chain(input_rate, output_rate, 0, plan);
+}
+
+/* Step of the arbitrary bank, input samples per output in 32.32 */
+static uint64_t arb_step(double stage_ratio)
+{
+    return (uint64_t)llround(ldexp(1.0, 32) / stage_ratio);
+}
+
+static int halfband_init(cf32_halfband_t *hb, int num_taps, size_t max_input)
+{
+    if (max_input > (size_t)INT_MAX)
         return -1;
-    res->num_taps = res->taps_per_branch * res->up_factor;
-    res->phase_idx = 0;
+
+    hb->num_taps = num_taps;
+    hb->branch_taps = halfband_branch_taps(num_taps);
+    hb->center_delay = (num_taps - 3) / 4;
+    hb->hist_size = hb->branch_taps - 1 + RESAMPLER_HIST_BLOCK;
+    hb->write_pos = hb->branch_taps - 1;
+    hb->max_input = (int)max_input;
+
+    float *proto = (float *)malloc((size_t)num_taps * sizeof(float));
+    if (!proto)
+        return -1;
+    cf32_resampler_design_halfband(proto, num_taps);
+
+    /* Odd phase reversed: h[2m] applies to the m-th newest odd sample */
+    const int T = hb->branch_taps;
+    hb->coeffs = (float *)calloc((size_t)T, sizeof(float));
+    if (!hb->coeffs) {
+        free(proto);
+        return -1;
+    }
+    for (int m = 0; 2 * m < num_taps; m++)
+        hb->coeffs[T - 1 - m] = proto[2 * m];
+    hb->center = proto[(num_taps - 1) / 2];
+    free(proto);
+
+    hb->hist = (float *)calloc(4 * (size_t)hb->hist_size + 2 * RESAMPLER_HIST_BLOCK, sizeof(float));
+    if (!hb->hist)
+        return -1;
+    hb->hist_ei = hb->hist;
+    hb->hist_eq = hb->hist + hb->hist_size;
+    hb->hist_oi = hb->hist + 2 * (size_t)hb->hist_size;
+    hb->hist_oq = hb->hist + 3 * (size_t)hb->hist_size;
+    hb->acc_i = hb->hist + 4 * (size_t)hb->hist_size;
+    hb->acc_q = hb->acc_i + RESAMPLER_HIST_BLOCK;
+
+    hb->output_buf = (float *)malloc(((max_input + 1) / 2 + 1) * 2 * sizeof(float));
+    if (!hb->output_buf)
+        return -1;
+    return 0;
+}
+
+static void halfband_free(cf32_halfband_t *hb)
+{
+    free(hb->coeffs);
+    free(hb->hist);
+    free(hb->output_buf);
+    memset(hb, 0, sizeof(*hb));
+}
+
+/* Rational L/M branches of the polyphase stage, reversed */
+static int init_rational_bank(cf32_resampler_t *res)
+{
+    const int L = res->plan.up_factor;
+    const int M = res->plan.down_factor;
+    const int T = res->taps_per_branch;
+    res->num_taps = T * L;
 
     /* Design prototype lowpass filter */
     float *proto_coeffs = (float *)malloc((size_t)res->num_taps * sizeof(float));
     if (!proto_coeffs)
         return -1;
 
-    int max_factor = res->up_factor > res->down_factor ? res->up_factor : res->down_factor;
-    cf32_resampler_design_filter(proto_coeffs, res->num_taps, max_factor);
+    cf32_resampler_design_filter(proto_coeffs, res->num_taps, L > M ? L : M);
 
     /* Scale by interpolation factor for gain correction */
     for (int i = 0; i < res->num_taps; i++)
-        proto_coeffs[i] *= (float)res->up_factor;
+        proto_coeffs[i] *= (float)L;
 
     /* Allocate polyphase branches (float32 for full precision) */
-    res->branches = (float **)malloc((size_t)res->up_factor * sizeof(float *));
+    res->branches = (float **)malloc((size_t)L * sizeof(float *));
     if (!res->branches) {
         free(proto_coeffs);
         return -1;
     }
-    res->branch_data = (float *)calloc((size_t)res->up_factor * (size_t)res->taps_per_branch, sizeof(float));
+    res->branch_data = (float *)calloc((size_t)L * (size_t)T, sizeof(float));
     if (!res->branch_data) {
         free(proto_coeffs);
-        free(res->branches);
         return -1;
     }
 
-    /* Decompose into polyphase branches */
-    for (int m = 0; m < res->up_factor; m++) {
-        res->branches[m] = res->branch_data + m * res->taps_per_branch;
-        for (int k = 0; k < res->taps_per_branch; k++) {
-            int idx = m + k * res->up_factor;
+    /* Decompose into polyphase branches, reversed: tap k applies to the
+     * k-th newest sample, the window is read oldest first */
+    for (int m = 0; m < L; m++) {
+        res->branches[m] = res->branch_data + (size_t)m * T;
+        for (int k = 0; k < T; k++)
+            res->branches[m][T - 1 - k] = proto_coeffs[m + k * L];
+    }
+    free(proto_coeffs);
+    return 0;
+}
+
+/* RESAMPLER_ARB_PHASES + 1 branches of the arbitrary ratio bank and their
+ * differences, the last branch is the first one a sample later */
+static int init_arbitrary_bank(cf32_resampler_t *res, double stage_ratio)
+{
+    const int P = RESAMPLER_ARB_PHASES;
+    const int T = res->taps_per_branch;
+    res->num_taps = T * P;
+
+    float *proto_coeffs = (float *)malloc((size_t)res->num_taps * sizeof(float));
+    if (!proto_coeffs)
+        return -1;
+
+    /* Cutoff at the lower of the two Nyquist rates */
+    design_lowpass(proto_coeffs, res->num_taps, (float)(stage_ratio < 1.0 ? stage_ratio : 1.0) / (float)P);
+    for (int i = 0; i < res->num_taps; i++)
+        proto_coeffs[i] *= (float)P;
+
+    res->branch_data = (float *)calloc((size_t)(P + 1) * (size_t)T, sizeof(float));
+    if (!res->branch_data) {
+        free(proto_coeffs);
+        return -1;
+    }
+    res->branch_diff = (float *)malloc((size_t)P * (size_t)T * sizeof(float));
+    if (!res->branch_diff) {
+        free(proto_coeffs);
+        return -1;
+    }
+
+    for (int m = 0; m <= P; m++) {
+        float *branch = res->branch_data + (size_t)m * T;
+        for (int k = 0; k < T; k++) {
+            int idx = m + k * P;
             if (idx < res->num_taps)
-                res->branches[m][k] = proto_coeffs[idx];
+                branch[T - 1 - k] = proto_coeffs[idx];
         }
     }
+    for (size_t i = 0; i < (size_t)P * (size_t)T; i++)
+        res->branch_diff[i] = res->branch_data[i + (size_t)T] - res->branch_data[i];
     free(proto_coeffs);
+    return 0;
+}
+
+static int resampler_init(cf32_resampler_t *res, uint32_t input_rate, uint32_t output_rate,
+                          size_t max_input_samples, int arbitrary)
+{
+    memset(res, 0, sizeof(*res));
+
+    if (input_rate == 0 || output_rate == 0)
+        return -1;
+
+    if (input_rate == output_rate && !arbitrary) {
+        res->initialized = 0;  /* No resampling needed */
+        return 0;
+    }
 
-    /* Initialize circular history buffers (power of 2 for fast modulo) */
-    res->hist_size = 64;
-    while (res->hist_size < res->taps_per_branch * 2)
-        res->hist_size *= 2;
-    res->hist_mask = res->hist_size - 1;
-    res->write_pos = 0;
+    /* Split the ratio into half-bands and a polyphase stage, this also
+     * validates the rates fit in int for the GCD computation */
+    if (plan_chain(input_rate, output_rate, arbitrary, &res->plan) != 0)
+        return -1;
+
+    /* Overall L/M ratio using GCD */
+    int g = cf32_resampler_gcd((int)output_rate, (int)input_rate);
+    res->up_factor = (int)output_rate / g;
+    res->down_factor = (int)input_rate / g;
+
+    /* Half-band stages, each halves the input of the next */
+    size_t stage_input = max_input_samples;
+    for (int k = 0; k < res->plan.num_halfbands; k++) {
+        if (halfband_init(&res->halfbands[k], res->plan.halfband_taps[k], stage_input) != 0)
+            goto fail;
+        stage_input = (stage_input + 1) / 2;
+    }
+
+    /* Polyphase filter design: 32 taps per branch and decimation (Kaiser window) */
+    res->taps_per_branch = res->plan.taps_per_branch;
+    res->phase_idx = 0;
+    if (arbitrary) {
+        double stage_ratio = (double)output_rate / (double)res->plan.polyphase_rate;
+        res->arbitrary = 1;
+        res->nominal_ratio = (double)output_rate / (double)input_rate;
+        res->arb_step = arb_step(stage_ratio);
+        res->arb_step_next = res->arb_step;
+        if (init_arbitrary_bank(res, stage_ratio) != 0)
+            goto fail;
+
+        /* Room for a trim up to RESAMPLER_ARB_MAX_TRIM */
+        double max_output = (double)stage_input * stage_ratio * (1.0 + RESAMPLER_ARB_MAX_TRIM) + 2.0;
+        if (max_output > (double)(SIZE_MAX / (2 * sizeof(float))))
+            goto fail;
+        res->output_buf_size = (size_t)max_output;
+    } else {
+        if (init_rational_bank(res) != 0)
+            goto fail;
+
+        const int L = res->plan.up_factor;
+        const int M = res->plan.down_factor;
+        res->output_buf_size = (stage_input * (size_t)L / (size_t)M) + (size_t)L + 1;
+    }
+
+    /* Initialize linear history buffers, the first window is all zeros */
+    const int T = res->taps_per_branch;
+    res->hist_size = T - 1 + RESAMPLER_HIST_BLOCK;
+    res->write_pos = T - 1;
 
     res->hist_i = (float *)calloc((size_t)res->hist_size, sizeof(float));
     if (!res->hist_i)
-        goto fail_branches;
+        goto fail;
     res->hist_q = (float *)calloc((size_t)res->hist_size, sizeof(float));
     if (!res->hist_q)
-        goto fail_hist;
+        goto fail;
 
     /* Allocate output buffer (CF32 native, interleaved I/Q) */
-    res->output_buf_size = (max_input_samples * (size_t)res->up_factor / (size_t)res->down_factor) + (size_t)res->up_factor + 1;
     /* Guard against overflow: output_buf_size * 2 * sizeof(float) must fit in size_t */
     if (res->output_buf_size > SIZE_MAX / (2 * sizeof(float)))
-        goto fail_hist;
+        goto fail;
     res->output_buf = (float *)malloc(res->output_buf_size * 2 * sizeof(float));  /* I + Q floats */
     if (!res->output_buf)
-        goto fail_hist;
+        goto fail;
 
+    res->process = select_process(arbitrary, &res->halfband_process, NULL);
     res->initialized = 1;
     return 0;
 
-fail_hist:
-    free(res->hist_i);
-    free(res->hist_q);
-    res->hist_i = NULL;
-    res->hist_q = NULL;
-fail_branches:
-    free(res->branches);
-    free(res->branch_data);
-    res->branches = NULL;
-    res->branch_data = NULL;
+fail:
+    cf32_resampler_free(res);
     return -1;
 }
 
-int cf32_resampler_process(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output)
+int cf32_resampler_init(cf32_resampler_t *res, uint32_t input_rate, uint32_t output_rate, size_t max_input_samples)
 {
-    const int L = res->up_factor;
-    const int M = res->down_factor;
-    int phase = res->phase_idx;
-    int out_idx = 0;
-
-    float *out = res->output_buf;
-    if (max_output > (int)res->output_buf_size)
-        max_output = (int)res->output_buf_size;
-
-    for (int n = 0; n < num_iq_samples && out_idx < max_output; n++) {
-        /* Write input to circular history buffers */
-        res->hist_i[res->write_pos & res->hist_mask] = input[n * 2 + 0];
-        res->hist_q[res->write_pos & res->hist_mask] = input[n * 2 + 1];
-        res->write_pos++;
-
-        /* Generate output samples for this input */
-        int base_read_pos = (res->write_pos - 1) & res->hist_mask;
-        while (phase < L && out_idx < max_output) {
-            float *branch = res->branches[phase];
-            float acc_i = 0.0f, acc_q = 0.0f;
-            int read_pos = base_read_pos;
-
-            /* FIR filter (float MAC) */
-            for (int k = 0; k < res->taps_per_branch; k++) {
-                acc_i += res->hist_i[read_pos] * branch[k];
-                acc_q += res->hist_q[read_pos] * branch[k];
-                read_pos = (read_pos - 1) & res->hist_mask;
-            }
+    return resampler_init(res, input_rate, output_rate, max_input_samples, 0);
+}
 
-            /* Output as native float32 */
-            out[out_idx * 2 + 0] = acc_i;
-            out[out_idx * 2 + 1] = acc_q;
-            out_idx++;
+int cf32_resampler_init_arbitrary(cf32_resampler_t *res, uint32_t input_rate, uint32_t output_rate, size_t max_input_samples)
+{
+    return resampler_init(res, input_rate, output_rate, max_input_samples, 1);
+}
 
-            phase += M;
-        }
+int cf32_resampler_set_rate(cf32_resampler_t *res, double input_rate, double output_rate)
+{
+    if (!res->initialized || !res->arbitrary || !(input_rate > 0.0) || !(output_rate > 0.0))
+        return -1;
+
+    double ratio = output_rate / input_rate;
+    if (fabs(ratio / res->nominal_ratio - 1.0) > RESAMPLER_ARB_MAX_TRIM)
+        return -1;
+
+    /* The half-bands are fixed, the bank takes the whole change */
+    STORE_RELEASE(&res->arb_step_next, arb_step(ldexp(ratio, res->plan.num_halfbands)));
+    return 0;
+}
+
+/*
+ * Thin dispatch wrapper — actual work done by ISA-specific variant.
+ */
+int cf32_resampler_process(cf32_resampler_t *res, const float *input, int num_iq_samples, float **output, int max_output)
+{
+    for (int k = 0; k < res->plan.num_halfbands; k++) {
+        cf32_halfband_t *hb = &res->halfbands[k];
+        num_iq_samples = res->halfband_process(hb, input, num_iq_samples);
+        input = hb->output_buf;
+    }
+    if (res->arbitrary)
+        res->arb_step = LOAD_ACQUIRE(&res->arb_step_next);
+    return res->process(res, input, num_iq_samples, output, max_output);
+}
 
-        phase -= L;
+void cf32_resampler_reset(cf32_resampler_t *res)
+{
+    if (!res->initialized)
+        return;
+    memset(res->hist_i, 0, (size_t)res->hist_size * sizeof(float));
+    memset(res->hist_q, 0, (size_t)res->hist_size * sizeof(float));
+    res->write_pos = res->taps_per_branch - 1;
+    res->phase_idx = 0;
+    res->arb_phase = 0;
+
+    for (int k = 0; k < res->plan.num_halfbands; k++) {
+        cf32_halfband_t *hb = &res->halfbands[k];
+        memset(hb->hist, 0, 4 * (size_t)hb->hist_size * sizeof(float));
+        hb->write_pos = hb->branch_taps - 1;
+        hb->has_pending = 0;
     }
+}
 
-    res->phase_idx = phase;
-    *output = res->output_buf;
-    return out_idx;
+const char *cf32_resampler_isa_info(void)
+{
+    const char *name;
+    select_process(0, NULL, &name);
+    return name;
 }
 
 void cf32_resampler_free(cf32_resampler_t *res)
@@ -252,8 +577,11 @@ void cf32_resampler_free(cf32_resampler_t *res)
         return;
     free(res->branches);
     free(res->branch_data);
+    free(res->branch_diff);
     free(res->hist_i);
     free(res->hist_q);
     free(res->output_buf);
+    for (int k = 0; k < RESAMPLER_MAX_HALFBANDS; k++)
+        halfband_free(&res->halfbands[k]);
     memset(res, 0, sizeof(*res));
 }
@@ -0,0 +1,23 @@
+/** @file
+    AVX2+FMA variant of cf32_resampler_process and cf32_halfband_process.
+
+    Compiled with -mavx2 -mfma -ffast-math (GCC/Clang) or
+    /arch:AVX2 /fp:fast (MSVC). The branch dot product is
+    auto-vectorized to 256-bit FMA instructions.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "cf32_resampler.h"
+#include "compat_opt.h"
+#include <string.h>
+
+#define CF32_RESAMPLER_PROCESS_FN cf32_resampler_process_avx2
+#define CF32_RESAMPLER_ARB_FN cf32_resampler_process_arb_avx2
+#define CF32_HALFBAND_PROCESS_FN cf32_halfband_process_avx2
+#include "cf32_resampler_process.inc"
@@ -0,0 +1,26 @@
+/** @file
+    NEON variant of cf32_resampler_process and cf32_halfband_process.
+
+    On AArch64, NEON is mandatory; GCC/Clang auto-vectorize to
+    fmla.4s with -ffast-math. Compiled with: -ffast-math only
+    (NEON is implicit on AArch64).
+
+    On ARMv7, compiled with -mfpu=neon -ffast-math when NEON
+    is available.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "cf32_resampler.h"
+#include "compat_opt.h"
+#include <string.h>
+
+#define CF32_RESAMPLER_PROCESS_FN cf32_resampler_process_neon
+#define CF32_RESAMPLER_ARB_FN cf32_resampler_process_arb_neon
+#define CF32_HALFBAND_PROCESS_FN cf32_halfband_process_neon
+#include "cf32_resampler_process.inc"
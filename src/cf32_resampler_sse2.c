@@ -0,0 +1,23 @@
+/** @file
+    SSE2 (x86-64 baseline) variant of cf32_resampler_process and cf32_halfband_process.
+
+    Compiled with -ffast-math only (no explicit ISA flags).
+    Auto-vectorized by the compiler for whatever baseline the
+    target supports. This is the portable fallback.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "cf32_resampler.h"
+#include "compat_opt.h"
+#include <string.h>
+
+#define CF32_RESAMPLER_PROCESS_FN cf32_resampler_process_sse2
+#define CF32_RESAMPLER_ARB_FN cf32_resampler_process_arb_sse2
+#define CF32_HALFBAND_PROCESS_FN cf32_halfband_process_sse2
+#include "cf32_resampler_process.inc"
@@ -0,0 +1,24 @@
+/** @file
+    SVE variant of cf32_resampler_process and cf32_halfband_process.
+
+    Compiled with -march=armv8-a+sve -ffast-math (GCC/Clang).
+    GCC/Clang auto-vectorize the branch dot product to scalable
+    fmla instructions. Only called when runtime SVE detection
+    confirms hardware support.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "cf32_resampler.h"
+#include "compat_opt.h"
+#include <string.h>
+
+#define CF32_RESAMPLER_PROCESS_FN cf32_resampler_process_sve
+#define CF32_RESAMPLER_ARB_FN cf32_resampler_process_arb_sve
+#define CF32_HALFBAND_PROCESS_FN cf32_halfband_process_sve
+#include "cf32_resampler_process.inc"
@@ -0,0 +1,160 @@
+/** @file
+    Repeated transmission coalescing.
+
+    The held bursts are a short list in the order they started, keyed by
+    the same field hash as the wideband dedup.  A burst keeps the data of
+    its first copy and is completed once the sample clock passed the window
+    after its last copy.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "coalesce.h"
+#include "wb_dedup.h"
+#include "list.h"
+
+#include <stdlib.h>
+
+typedef struct coalesce_burst {
+    uint64_t key;
+    uint64_t last_ms;  ///< sample clock time of the last copy
+    data_t *data;      ///< the first copy
+    unsigned repeats;
+    float snr_best;
+    float snr_sum;
+    uint32_t channels; ///< bit mask of the wideband channels, 0 in narrowband
+} coalesce_burst_t;
+
+struct coalesce {
+    uint64_t window_ms;
+    wb_dedup_t *keys; ///< only used for the key fields
+    list_t bursts;
+    uint64_t events;
+    uint64_t bursts_emitted;
+};
+
+static void burst_free(void *p)
+{
+    coalesce_burst_t *burst = p;
+    data_free(burst->data);
+    free(burst);
+}
+
+coalesce_t *coalesce_create(unsigned window_ms, char const *fields)
+{
+    coalesce_t *co = calloc(1, sizeof(*co));
+    if (!co)
+        return NULL;
+    co->window_ms = window_ms;
+    co->keys      = wb_dedup_create(window_ms, fields);
+    if (!co->keys) {
+        free(co);
+        return NULL;
+    }
+    return co;
+}
+
+void coalesce_free(coalesce_t *co)
+{
+    if (!co)
+        return;
+    list_free_elems(&co->bursts, burst_free);
+    wb_dedup_free(co->keys);
+    free(co);
+}
+
+/// Sample clock distance, the clock may also restart with the next input.
+static uint64_t time_distance(uint64_t a, uint64_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+int coalesce_add(coalesce_t *co, data_t *data, int channel, float snr_db, uint64_t time_ms)
+{
+    uint64_t key = wb_dedup_key(co->keys, data);
+    uint32_t chan_bit = channel >= 0 && channel < 32 ? 1u << channel : 0;
+    co->events++;
+
+    for (size_t i = 0; i < co->bursts.len; ++i) {
+        coalesce_burst_t *burst = co->bursts.elems[i];
+        if (burst->key != key || time_distance(time_ms, burst->last_ms) > co->window_ms)
+            continue;
+        burst->repeats++;
+        burst->snr_sum += snr_db;
+        if (snr_db > burst->snr_best)
+            burst->snr_best = snr_db;
+        burst->channels |= chan_bit;
+        if (time_ms > burst->last_ms)
+            burst->last_ms = time_ms;
+        data_free(data);
+        return 1;
+    }
+
+    coalesce_burst_t *burst = calloc(1, sizeof(*burst));
+    if (!burst) {
+        data_free(data);
+        return 0;
+    }
+    burst->key      = key;
+    burst->last_ms  = time_ms;
+    burst->data     = data;
+    burst->repeats  = 1;
+    burst->snr_best = snr_db;
+    burst->snr_sum  = snr_db;
+    burst->channels = chan_bit;
+    list_push(&co->bursts, burst);
+    return 0;
+}
+
+/// Append the aggregate fields to the first copy and take its data.
+static data_t *burst_data(coalesce_burst_t *burst)
+{
+    data_t *data = burst->data;
+    burst->data  = NULL;
+
+    /* clang-format off */
+    data = data_int(data, "repeats",    "Repeats",  NULL,       (int)burst->repeats);
+    data = data_dbl(data, "snr_best",   "SNR best", "%.1f dB",  burst->snr_best);
+    data = data_dbl(data, "snr_mean",   "SNR mean", "%.1f dB",  burst->snr_sum / burst->repeats);
+    /* clang-format on */
+
+    if (burst->channels) {
+        int channels[32];
+        int n = 0;
+        for (int c = 0; c < 32; ++c) {
+            if (burst->channels & (1u << c))
+                channels[n++] = c;
+        }
+        data = data_ary(data, "channels", "Channels", NULL, data_array(n, DATA_INT, channels));
+    }
+    return data;
+}
+
+unsigned coalesce_flush(coalesce_t *co, uint64_t time_ms, coalesce_emit_fn emit, void *ctx)
+{
+    unsigned emitted = 0;
+    size_t i         = 0;
+    while (i < co->bursts.len) {
+        coalesce_burst_t *burst = co->bursts.elems[i];
+        if (time_ms != UINT64_MAX && time_distance(time_ms, burst->last_ms) <= co->window_ms) {
+            ++i;
+            continue;
+        }
+        emit(ctx, burst_data(burst));
+        list_remove(&co->bursts, i, burst_free);
+        co->bursts_emitted++;
+        emitted++;
+    }
+    return emitted;
+}
+
+void coalesce_counts(coalesce_t const *co, uint64_t *events, uint64_t *bursts)
+{
+    *events = co ? co->events : 0;
+    *bursts = co ? co->bursts_emitted : 0;
+}
@@ -399,6 +399,7 @@ R_API void data_output_print(data_output_t *output, data_t *data)
 {
     if (!output)
         return;
+    output->events++;
     if (output->output_print) {
         output->output_print(output, data);
     }
@@ -418,6 +419,7 @@ R_API void data_output_free(data_output_t *output)
 {
     if (!output)
         return;
+    free(output->latency);
     output->output_free(output);
 }
 
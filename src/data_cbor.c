@@ -0,0 +1,475 @@
+/** @file
+    CBOR (RFC 8949) encoding and decoding of data_t structures.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "data_cbor.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#define UNUSED(x) (void)(x)
+
+/* CBOR major types */
+#define CBOR_UINT   0
+#define CBOR_NEGINT 1
+#define CBOR_TEXT   3
+#define CBOR_ARRAY  4
+#define CBOR_MAP    5
+#define CBOR_SIMPLE 7
+
+#define CBOR_MAX_DEPTH 16
+
+/* Encoder */
+
+typedef struct {
+    struct data_output output;
+    uint8_t *head;
+    uint8_t *tail;
+    size_t left;
+    int overflow;
+} data_print_cbor_t;
+
+static void cbor_put(data_print_cbor_t *cbor, void const *src, size_t len)
+{
+    if (len > cbor->left) {
+        cbor->overflow = 1;
+        cbor->left     = 0;
+        return;
+    }
+    memcpy(cbor->tail, src, len);
+    cbor->tail += len;
+    cbor->left -= len;
+}
+
+/// Write a major type head with the shortest argument encoding.
+static void cbor_put_head(data_print_cbor_t *cbor, unsigned major, uint64_t arg)
+{
+    uint8_t buf[9];
+    size_t len;
+    major <<= 5;
+    if (arg < 24) {
+        buf[0] = (uint8_t)(major | arg);
+        len    = 1;
+    }
+    else if (arg <= 0xff) {
+        buf[0] = (uint8_t)(major | 24);
+        buf[1] = (uint8_t)arg;
+        len    = 2;
+    }
+    else if (arg <= 0xffff) {
+        buf[0] = (uint8_t)(major | 25);
+        buf[1] = (uint8_t)(arg >> 8);
+        buf[2] = (uint8_t)arg;
+        len    = 3;
+    }
+    else if (arg <= 0xffffffff) {
+        buf[0] = (uint8_t)(major | 26);
+        for (int i = 0; i < 4; ++i)
+            buf[1 + i] = (uint8_t)(arg >> (24 - 8 * i));
+        len = 5;
+    }
+    else {
+        buf[0] = (uint8_t)(major | 27);
+        for (int i = 0; i < 8; ++i)
+            buf[1 + i] = (uint8_t)(arg >> (56 - 8 * i));
+        len = 9;
+    }
+    cbor_put(cbor, buf, len);
+}
+
+static void cbor_put_text(data_print_cbor_t *cbor, char const *str)
+{
+    size_t len = strlen(str);
+    cbor_put_head(cbor, CBOR_TEXT, len);
+    cbor_put(cbor, str, len);
+}
+
+static void R_API_CALLCONV format_cbor_array(data_output_t *output, data_array_t *array, char const *format)
+{
+    data_print_cbor_t *cbor = (data_print_cbor_t *)output;
+
+    cbor_put_head(cbor, CBOR_ARRAY, (uint64_t)array->num_values);
+    for (int c = 0; c < array->num_values; ++c) {
+        print_array_value(output, array, format, c);
+    }
+}
+
+static void R_API_CALLCONV format_cbor_object(data_output_t *output, data_t *data, char const *format)
+{
+    UNUSED(format);
+    data_print_cbor_t *cbor = (data_print_cbor_t *)output;
+
+    uint64_t count = 0;
+    for (data_t *d = data; d; d = d->next)
+        count++;
+
+    cbor_put_head(cbor, CBOR_MAP, count);
+    for (; data; data = data->next) {
+        cbor_put_text(cbor, data->key);
+        print_value(output, data->type, data->value, data->format);
+    }
+}
+
+static void R_API_CALLCONV format_cbor_string(data_output_t *output, const char *str, char const *format)
+{
+    UNUSED(format);
+    data_print_cbor_t *cbor = (data_print_cbor_t *)output;
+
+    cbor_put_text(cbor, str);
+}
+
+static void R_API_CALLCONV format_cbor_double(data_output_t *output, double data, char const *format)
+{
+    UNUSED(format);
+    data_print_cbor_t *cbor = (data_print_cbor_t *)output;
+
+    uint8_t buf[9];
+    float f = (float)data;
+    if ((double)f == data || isnan(data)) {
+        // float32 is lossless
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        buf[0] = (CBOR_SIMPLE << 5) | 26;
+        for (int i = 0; i < 4; ++i)
+            buf[1 + i] = (uint8_t)(bits >> (24 - 8 * i));
+        cbor_put(cbor, buf, 5);
+    }
+    else {
+        uint64_t bits;
+        memcpy(&bits, &data, sizeof(bits));
+        buf[0] = (CBOR_SIMPLE << 5) | 27;
+        for (int i = 0; i < 8; ++i)
+            buf[1 + i] = (uint8_t)(bits >> (56 - 8 * i));
+        cbor_put(cbor, buf, 9);
+    }
+}
+
+static void R_API_CALLCONV format_cbor_int(data_output_t *output, int data, char const *format)
+{
+    UNUSED(format);
+    data_print_cbor_t *cbor = (data_print_cbor_t *)output;
+
+    if (data >= 0)
+        cbor_put_head(cbor, CBOR_UINT, (uint64_t)data);
+    else
+        cbor_put_head(cbor, CBOR_NEGINT, (uint64_t)(-1 - (int64_t)data));
+}
+
+R_API size_t data_print_cbor(data_t *data, uint8_t *dst, size_t len)
+{
+    data_print_cbor_t cbor = {
+            .output = {
+                    .print_data   = format_cbor_object,
+                    .print_array  = format_cbor_array,
+                    .print_string = format_cbor_string,
+                    .print_double = format_cbor_double,
+                    .print_int    = format_cbor_int,
+            },
+            .head = dst,
+            .tail = dst,
+            .left = len,
+    };
+
+    format_cbor_object(&cbor.output, data, NULL);
+
+    return cbor.overflow ? 0 : len - cbor.left;
+}
+
+/* Decoder */
+
+typedef struct {
+    uint8_t const *p;
+    uint8_t const *end;
+} cbor_reader_t;
+
+typedef struct {
+    data_type_t type;
+    data_value_t value; // v_ptr owns a string, array or data
+} cbor_value_t;
+
+static void cbor_value_free(cbor_value_t *val)
+{
+    if (val->type == DATA_STRING)
+        free(val->value.v_ptr);
+    else if (val->type == DATA_ARRAY)
+        data_array_free(val->value.v_ptr);
+    else if (val->type == DATA_DATA)
+        data_free(val->value.v_ptr);
+    val->type = DATA_COUNT;
+}
+
+/// Read a head, returns the major type or -1 on error.
+static int cbor_get_head(cbor_reader_t *rd, unsigned *info, uint64_t *arg)
+{
+    if (rd->p >= rd->end)
+        return -1;
+    int major = *rd->p >> 5;
+    *info     = *rd->p & 0x1f;
+    rd->p++;
+
+    size_t n = *info < 24 ? 0 : *info == 24 ? 1 : *info == 25 ? 2 : *info == 26 ? 4 : *info == 27 ? 8 : 9;
+    if (n == 9)
+        return -1; // indefinite lengths and reserved values are not supported
+    if ((size_t)(rd->end - rd->p) < n)
+        return -1;
+    *arg = n ? 0 : *info;
+    for (size_t i = 0; i < n; ++i)
+        *arg = (*arg << 8) | *rd->p++;
+    return major;
+}
+
+static char *cbor_get_text(cbor_reader_t *rd, uint64_t len)
+{
+    if ((uint64_t)(rd->end - rd->p) < len)
+        return NULL;
+    char *str = malloc((size_t)len + 1);
+    if (!str) {
+        WARN_MALLOC("cbor_get_text()");
+        return NULL;
+    }
+    memcpy(str, rd->p, (size_t)len);
+    str[len] = '\0';
+    rd->p += len;
+    return str;
+}
+
+static double cbor_half_to_double(unsigned half)
+{
+    int exp      = (half >> 10) & 0x1f;
+    int mant     = half & 0x3ff;
+    double value = exp == 0 ? ldexp(mant, -24) : exp != 31 ? ldexp(mant + 1024, exp - 25) : mant == 0 ? INFINITY : NAN;
+    return half & 0x8000 ? -value : value;
+}
+
+static data_t *cbor_get_map(cbor_reader_t *rd, uint64_t count, int depth);
+static data_array_t *cbor_get_array(cbor_reader_t *rd, uint64_t count, int depth);
+
+static int cbor_get_value(cbor_reader_t *rd, cbor_value_t *val, int depth)
+{
+    unsigned info;
+    uint64_t arg;
+    int major = cbor_get_head(rd, &info, &arg);
+
+    val->type = DATA_COUNT;
+    switch (major) {
+    case CBOR_UINT:
+        if (arg <= INT_MAX) {
+            val->type         = DATA_INT;
+            val->value.v_int  = (int)arg;
+        }
+        else {
+            val->type         = DATA_DOUBLE;
+            val->value.v_dbl  = (double)arg;
+        }
+        return 0;
+    case CBOR_NEGINT:
+        if (arg <= (uint64_t)INT_MAX) {
+            val->type         = DATA_INT;
+            val->value.v_int  = -1 - (int)arg;
+        }
+        else {
+            val->type         = DATA_DOUBLE;
+            val->value.v_dbl  = -1.0 - (double)arg;
+        }
+        return 0;
+    case CBOR_TEXT:
+        val->value.v_ptr = cbor_get_text(rd, arg);
+        if (!val->value.v_ptr)
+            return -1;
+        val->type = DATA_STRING;
+        return 0;
+    case CBOR_ARRAY:
+        if (depth >= CBOR_MAX_DEPTH)
+            return -1;
+        val->value.v_ptr = cbor_get_array(rd, arg, depth + 1);
+        if (!val->value.v_ptr)
+            return -1;
+        val->type = DATA_ARRAY;
+        return 0;
+    case CBOR_MAP:
+        if (depth >= CBOR_MAX_DEPTH || arg == 0)
+            return -1;
+        val->value.v_ptr = cbor_get_map(rd, arg, depth + 1);
+        if (!val->value.v_ptr)
+            return -1;
+        val->type = DATA_DATA;
+        return 0;
+    case CBOR_SIMPLE:
+        val->type = DATA_DOUBLE;
+        if (info == 25) {
+            val->value.v_dbl = cbor_half_to_double((unsigned)arg);
+        }
+        else if (info == 26) {
+            uint32_t bits = (uint32_t)arg;
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            val->value.v_dbl = f;
+        }
+        else if (info == 27) {
+            memcpy(&val->value.v_dbl, &arg, sizeof(double));
+        }
+        else if (info == 20 || info == 21) {
+            // false, true
+            val->type        = DATA_INT;
+            val->value.v_int = info == 21;
+        }
+        else {
+            val->type = DATA_COUNT;
+            return -1; // null, undefined and other simple values are not supported
+        }
+        return 0;
+    default:
+        return -1; // byte strings and tags are not supported
+    }
+}
+
+static data_array_t *cbor_get_array(cbor_reader_t *rd, uint64_t count, int depth)
+{
+    if (count > (uint64_t)(rd->end - rd->p))
+        return NULL; // each element takes at least one byte
+
+    size_t n = (size_t)count;
+    cbor_value_t *vals = calloc(n ? n : 1, sizeof(*vals));
+    if (!vals) {
+        WARN_CALLOC("cbor_get_array()");
+        return NULL;
+    }
+
+    // decode all elements, then find a common type (ints widen to doubles)
+    data_type_t type = n ? DATA_COUNT : DATA_INT;
+    int ok = 1;
+    for (size_t i = 0; i < n && ok; ++i) {
+        ok = cbor_get_value(rd, &vals[i], depth) == 0;
+        if (!ok)
+            break;
+        if (type == DATA_COUNT || type == vals[i].type)
+            type = vals[i].type;
+        else if ((type == DATA_INT || type == DATA_DOUBLE) && (vals[i].type == DATA_INT || vals[i].type == DATA_DOUBLE))
+            type = DATA_DOUBLE;
+        else
+            ok = 0; // mixed types are not supported
+    }
+
+    data_array_t *array = NULL;
+    if (ok) {
+        void *values = NULL;
+        if (type == DATA_INT) {
+            int *ints = calloc(n ? n : 1, sizeof(*ints));
+            if (!ints)
+                WARN_CALLOC("cbor_get_array()");
+            for (size_t i = 0; ints && i < n; ++i)
+                ints[i] = vals[i].value.v_int;
+            values = ints;
+        }
+        else if (type == DATA_DOUBLE) {
+            double *dbls = calloc(n, sizeof(*dbls));
+            if (!dbls)
+                WARN_CALLOC("cbor_get_array()");
+            for (size_t i = 0; dbls && i < n; ++i)
+                dbls[i] = vals[i].type == DATA_INT ? vals[i].value.v_int : vals[i].value.v_dbl;
+            values = dbls;
+        }
+        else {
+            void **ptrs = calloc(n, sizeof(*ptrs));
+            if (!ptrs)
+                WARN_CALLOC("cbor_get_array()");
+            for (size_t i = 0; ptrs && i < n; ++i)
+                ptrs[i] = vals[i].value.v_ptr;
+            values = ptrs;
+        }
+        if (values) {
+            // strings are copied, arrays and data are moved
+            array = data_array((int)n, type, values);
+            if (array && (type == DATA_DATA || type == DATA_ARRAY)) {
+                for (size_t i = 0; i < n; ++i)
+                    vals[i].type = DATA_COUNT; // moved
+            }
+            free(values);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        cbor_value_free(&vals[i]);
+    free(vals);
+    return array;
+}
+
+static data_t *cbor_get_map(cbor_reader_t *rd, uint64_t count, int depth)
+{
+    data_t *data = NULL;
+    for (uint64_t i = 0; i < count; ++i) {
+        unsigned info;
+        uint64_t arg;
+        if (cbor_get_head(rd, &info, &arg) != CBOR_TEXT)
+            goto error; // keys must be text
+        char *key = cbor_get_text(rd, arg);
+        if (!key)
+            goto error;
+
+        cbor_value_t val;
+        if (cbor_get_value(rd, &val, depth) != 0) {
+            free(key);
+            goto error;
+        }
+
+        data_t *next = NULL;
+        switch (val.type) {
+        case DATA_INT:
+            next = data_int(data, key, NULL, NULL, val.value.v_int);
+            break;
+        case DATA_DOUBLE:
+            next = data_dbl(data, key, NULL, NULL, val.value.v_dbl);
+            break;
+        case DATA_STRING:
+            next = data_str(data, key, NULL, NULL, val.value.v_ptr);
+            free(val.value.v_ptr);
+            break;
+        case DATA_ARRAY:
+            next = data_ary(data, key, NULL, NULL, val.value.v_ptr);
+            break;
+        case DATA_DATA:
+            next = data_dat(data, key, NULL, NULL, val.value.v_ptr);
+            break;
+        default:
+            break;
+        }
+        free(key);
+        if (!next)
+            return NULL; // data was released on alloc failure
+        data = next;
+    }
+    return data;
+
+error:
+    data_free(data);
+    return NULL;
+}
+
+R_API data_t *data_parse_cbor(uint8_t const *src, size_t len, size_t *used)
+{
+    cbor_reader_t rd = {.p = src, .end = src + len};
+    unsigned info;
+    uint64_t arg;
+
+    *used = 0;
+    if (cbor_get_head(&rd, &info, &arg) != CBOR_MAP)
+        return NULL;
+    if (arg == 0) {
+        *used = (size_t)(rd.p - src); // empty map, e.g. a keep-alive
+        return NULL;
+    }
+    data_t *data = cbor_get_map(&rd, arg, 1);
+    if (data)
+        *used = (size_t)(rd.p - src);
+    return data;
+}
@@ -134,11 +134,17 @@ static int find_next(bitbuffer_t *bitbuffer, int cur_index)
 // max age for cache in us
 #define CACHE_MAX_AGE 800000
 
-static uint8_t cached_result[24] = {0};
-static struct timeval cached_tv  = {0};
+/// Half of a code pair, kept per decoder instance until the other half arrives.
+struct secplus_v1_context {
+    uint8_t cached_result[24];
+    struct timeval cached_tv;
+};
 
 static int secplus_v1_callback(r_device *decoder, bitbuffer_t *bitbuffer)
 {
+    struct secplus_v1_context *context = decoder_user_data(decoder);
+    uint8_t *cached_result = context->cached_result;
+    struct timeval *cached_tv = &context->cached_tv;
     uint8_t result_1[24] = {0};
     uint8_t result_2[24] = {0};
     int status           = 0;
@@ -205,11 +211,11 @@ static int secplus_v1_callback(r_device *decoder, bitbuffer_t *bitbuffer)
     }
 
     // is there data in cache?
-    if (cached_tv.tv_sec) {
+    if (cached_tv->tv_sec) {
         struct timeval cur_tv;
         struct timeval res_tv;
         gettimeofday(&cur_tv, NULL);
-        timeval_subtract(&res_tv, &cur_tv, &cached_tv);
+        timeval_subtract(&res_tv, &cur_tv, cached_tv);
 
         decoder_logf(decoder, 2, __func__, "res %12ld %8ld", (long)res_tv.tv_sec, (long)res_tv.tv_usec);
 
@@ -231,19 +237,19 @@ static int secplus_v1_callback(r_device *decoder, bitbuffer_t *bitbuffer)
         }
 
         // clear cache because it is expired or used
-        memset(cached_result, 0, sizeof(cached_result));
-        timerclear(&cached_tv);
+        memset(cached_result, 0, sizeof(context->cached_result));
+        timerclear(cached_tv);
 
     } // if cache contains data
 
     if (status == 1) {
-        gettimeofday(&cached_tv, NULL);
+        gettimeofday(cached_tv, NULL);
         memcpy(cached_result, result_1, 21);
         decoder_log(decoder, 1, __func__, "caching part 1");
         return -2; // found only 1st part
     }
     else if (status == 2) {
-        gettimeofday(&cached_tv, NULL);
+        gettimeofday(cached_tv, NULL);
         memcpy(cached_result, result_2, 21);
         decoder_log(decoder, 1, __func__, "caching part 2");
         return -2; // found only 2nd part
@@ -400,6 +406,18 @@ static char const *const output_fields[] = {
 //      Freq 310.01M
 //   -X "n=v1,m=OOK_PCM,s=500,l=500,t=40,r=10000,g=7400"
 
+r_device const secplus_v1;
+
+static r_device *secplus_v1_create(char *arg)
+{
+    (void)arg;
+    r_device *r_dev = decoder_create(&secplus_v1, sizeof(struct secplus_v1_context));
+    if (!r_dev) {
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    return r_dev;
+}
+
 r_device const secplus_v1 = {
         .name        = "Security+ (Keyfob)",
         .modulation  = OOK_PULSE_PCM,
@@ -409,5 +427,6 @@ r_device const secplus_v1 = {
         .gap_limit   = 15000,
         .reset_limit = 80000,
         .decode_fn   = &secplus_v1_callback,
+        .create_fn   = &secplus_v1_create,
         .fields      = output_fields,
 };
@@ -0,0 +1,71 @@
+/** @file
+    Event selection and rate limit of a stream client.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_filter.h"
+
+#include <string.h>
+#include <math.h>
+
+void event_filter_init(event_filter_t *f)
+{
+    memset(f, 0, sizeof(*f));
+    f->min_snr = NAN;
+}
+
+void event_filter_set_rate(event_filter_t *f, double rate, double now)
+{
+    f->rate   = rate > 0.0 ? rate : 0.0;
+    f->tokens = f->rate < 1.0 ? 1.0 : f->rate;
+    f->refill = now;
+}
+
+int event_filter_match(char const *list, char const *value)
+{
+    if (!*list)
+        return 1;
+    if (!value)
+        return 0;
+    size_t len = strlen(value);
+    for (char const *p = list;; ++p) {
+        char const *end = strchr(p, ',');
+        size_t n        = end ? (size_t)(end - p) : strlen(p);
+        if (n == len && !strncmp(p, value, n))
+            return 1;
+        if (!end)
+            return 0;
+        p = end;
+    }
+}
+
+int event_filter_wants(event_filter_t const *f, char const *model, char const *id, char const *channel, double snr)
+{
+    if (!model)
+        return 1;
+    return event_filter_match(f->model, model)
+            && event_filter_match(f->id, id)
+            && event_filter_match(f->channel, channel)
+            && (isnan(f->min_snr) || snr >= f->min_snr); // no SNR never passes
+}
+
+int event_filter_take(event_filter_t *f, double now)
+{
+    if (f->rate <= 0.0)
+        return 1;
+    double burst = f->rate < 1.0 ? 1.0 : f->rate;
+    f->tokens += (now - f->refill) * f->rate;
+    f->refill = now;
+    if (f->tokens > burst)
+        f->tokens = burst;
+    if (f->tokens < 1.0)
+        return 0;
+    f->tokens -= 1.0;
+    return 1;
+}
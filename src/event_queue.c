@@ -0,0 +1,98 @@
+/** @file
+    Lock-free event handoff queue, multiple producers and a single consumer.
+
+    This is the bounded queue by Dmitry Vyukov reduced to one consumer:
+    a slot is free for position `pos` when its sequence is `pos`, and holds
+    an item for the consumer when its sequence is `pos + 1`.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_queue.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+/* volatile accesses have acquire/release semantics with /volatile:ms */
+#define LOAD_ACQUIRE(p)     (*(volatile uint64_t *)(p))
+#define STORE_RELEASE(p, v) (*(volatile uint64_t *)(p) = (v))
+#define CAS(p, old, new)    ((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)(p), (new), (old)) == (old))
+#else
+/* GCC/Clang __atomic builtins (works in C99 mode) */
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define CAS(p, old, new)    __atomic_compare_exchange_n((p), &(old), (new), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif
+
+typedef struct {
+    uint64_t seq;
+    void *item;
+} event_queue_slot_t;
+
+struct event_queue {
+    uint64_t mask;
+    uint8_t pad0[56];
+    uint64_t head; ///< next position to write, shared by the producers
+    uint8_t pad1[56];
+    uint64_t tail; ///< next position to read, consumer only
+    uint8_t pad2[56];
+    event_queue_slot_t *slots;
+};
+
+event_queue_t *event_queue_create(unsigned capacity)
+{
+    unsigned size = 2;
+    while (size < capacity)
+        size <<= 1;
+
+    event_queue_t *q = calloc(1, sizeof(*q) + size * sizeof(event_queue_slot_t));
+    if (!q)
+        return NULL;
+    q->mask  = size - 1;
+    q->slots = (event_queue_slot_t *)(q + 1);
+    for (unsigned i = 0; i < size; ++i)
+        q->slots[i].seq = i;
+    return q;
+}
+
+void event_queue_free(event_queue_t *q)
+{
+    free(q);
+}
+
+int event_queue_push(event_queue_t *q, void *item)
+{
+    event_queue_slot_t *slot;
+    uint64_t pos = LOAD_ACQUIRE(&q->head);
+    for (;;) {
+        slot         = &q->slots[pos & q->mask];
+        int64_t diff = (int64_t)(LOAD_ACQUIRE(&slot->seq) - pos);
+        if (diff < 0)
+            return -1; // the consumer has not freed this slot yet
+        if (diff == 0 && CAS(&q->head, pos, pos + 1))
+            break;
+        pos = LOAD_ACQUIRE(&q->head); // another producer took it
+    }
+    slot->item = item;
+    STORE_RELEASE(&slot->seq, pos + 1);
+    return 0;
+}
+
+void *event_queue_pop(event_queue_t *q)
+{
+    uint64_t pos             = q->tail;
+    event_queue_slot_t *slot = &q->slots[pos & q->mask];
+    if (LOAD_ACQUIRE(&slot->seq) != pos + 1)
+        return NULL; // empty, or the producer is still writing
+    void *item = slot->item;
+    STORE_RELEASE(&slot->seq, pos + q->mask + 1);
+    q->tail = pos + 1;
+    return item;
+}
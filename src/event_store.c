@@ -0,0 +1,721 @@
+/** @file
+    In-memory columnar event store.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "event_store.h"
+#include "abuf.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define NONE         UINT32_MAX
+#define NO_SEQ       UINT64_MAX
+#define STRING_VALUE 0x80000000u ///< set on the key if the value is a string in the text ring
+#define JSON_RESERVE 16          ///< kept free for the closing brackets
+
+typedef struct {
+    uint32_t model;
+    uint32_t id;    ///< NONE if the events have no id
+    uint64_t last;  ///< sequence number of the last event
+    uint64_t count;
+} sensor_t;
+
+typedef struct {
+    uint32_t model;
+    uint32_t count;
+} model_count_t;
+
+typedef struct {
+    int64_t minute;  ///< start time / EVENT_STORE_PARTITION
+    uint64_t first;  ///< sequence number of the first event
+    unsigned num_models;
+    unsigned size;
+    model_count_t *counts;
+} partition_t;
+
+/// Open addressing hash of indices, grown at half load.
+typedef struct {
+    uint32_t *slots;
+    uint32_t mask;
+    uint32_t used;
+} hash_index_t;
+
+struct event_store {
+    unsigned capacity;
+    uint64_t first; ///< sequence number of the oldest event held
+    uint64_t next;  ///< sequence number of the next event
+    // event columns, at sequence number % capacity
+    double *time;
+    uint64_t *prev;       ///< previous event of the sensor, NO_SEQ if none
+    uint64_t *values;     ///< position of the first field
+    uint64_t *texts;      ///< position of the first string value
+    uint32_t *sensor;     ///< NONE if not indexed
+    uint8_t *num_values;
+    // field columns, at position % values_cap
+    size_t values_cap;
+    uint64_t values_next;
+    double *value;        ///< the number or the text position of the string
+    uint32_t *value_key;  ///< interned key, STRING_VALUE set for strings
+    // string values, at position % text_cap, dropped with their events
+    size_t text_cap;
+    uint64_t text_next;
+    char *text;
+    // interned model, id and key strings
+    char **strings;
+    uint32_t num_strings;
+    uint32_t strings_size;
+    hash_index_t string_index;
+    // sensors
+    sensor_t *sensors;
+    uint32_t num_sensors;
+    uint32_t sensors_size;
+    hash_index_t sensor_index;
+    // partitions, a ring starting at the oldest
+    partition_t *parts;
+    unsigned parts_head;
+    unsigned num_parts;
+};
+
+/* hash indexes */
+
+static uint32_t hash_string(char const *s)
+{
+    uint32_t h = 2166136261u; // FNV-1a
+    while (*s)
+        h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+static uint32_t hash_sensor(uint32_t model, uint32_t id)
+{
+    uint32_t h = model * 0x9e3779b1u ^ id;
+    return h ^ (h >> 15);
+}
+
+static uint32_t string_hash_of(event_store_t const *es, uint32_t idx)
+{
+    return hash_string(es->strings[idx]);
+}
+
+static uint32_t sensor_hash_of(event_store_t const *es, uint32_t idx)
+{
+    return hash_sensor(es->sensors[idx].model, es->sensors[idx].id);
+}
+
+static int hash_init(hash_index_t *h, uint32_t size)
+{
+    h->slots = malloc(size * sizeof(*h->slots));
+    if (!h->slots)
+        return -1;
+    memset(h->slots, 0xff, size * sizeof(*h->slots));
+    h->mask = size - 1;
+    h->used = 0;
+    return 0;
+}
+
+/// Double the slots and reinsert, returns -1 on allocation failure.
+static int hash_grow(hash_index_t *h, event_store_t const *es, uint32_t (*hash_of)(event_store_t const *, uint32_t))
+{
+    hash_index_t grown;
+    if (hash_init(&grown, 2 * (h->mask + 1)) < 0)
+        return -1;
+    for (uint32_t i = 0; i <= h->mask; ++i) {
+        uint32_t idx = h->slots[i];
+        if (idx == NONE)
+            continue;
+        uint32_t s = hash_of(es, idx) & grown.mask;
+        while (grown.slots[s] != NONE)
+            s = (s + 1) & grown.mask;
+        grown.slots[s] = idx;
+    }
+    grown.used = h->used;
+    free(h->slots);
+    *h = grown;
+    return 0;
+}
+
+/// Make room for one more entry, grown at half load.  Returns 1 if the
+/// slots moved, 0 if not, -1 if the index is full: one slot stays free to
+/// end the probes.
+static int hash_reserve(hash_index_t *h, event_store_t const *es, uint32_t (*hash_of)(event_store_t const *, uint32_t))
+{
+    if ((h->used + 1) * 2 <= h->mask)
+        return 0;
+    if (hash_grow(h, es, hash_of) == 0)
+        return 1;
+    return h->used + 1 > h->mask ? -1 : 0; // keeps working at a higher load on failure
+}
+
+/// Find an interned string, NONE if unknown.
+static uint32_t string_find(event_store_t const *es, char const *s, uint32_t hash, uint32_t *slot)
+{
+    hash_index_t const *h = &es->string_index;
+    uint32_t i            = hash & h->mask;
+    for (; h->slots[i] != NONE; i = (i + 1) & h->mask) {
+        if (!strcmp(es->strings[h->slots[i]], s))
+            break;
+    }
+    if (slot)
+        *slot = i;
+    return h->slots[i];
+}
+
+/// Intern a string, NONE if the table is full or on allocation failure.
+static uint32_t intern(event_store_t *es, char const *s)
+{
+    uint32_t hash = hash_string(s);
+    uint32_t slot;
+    uint32_t idx = string_find(es, s, hash, &slot);
+    if (idx != NONE)
+        return idx;
+    if (es->num_strings >= EVENT_STORE_MAX_STRINGS)
+        return NONE;
+    int moved = hash_reserve(&es->string_index, es, string_hash_of);
+    if (moved < 0)
+        return NONE;
+    if (moved)
+        string_find(es, s, hash, &slot);
+
+    if (es->num_strings == es->strings_size) {
+        uint32_t size  = es->strings_size ? 2 * es->strings_size : 256;
+        char **strings = realloc(es->strings, size * sizeof(*strings));
+        if (!strings)
+            return NONE;
+        es->strings      = strings;
+        es->strings_size = size;
+    }
+    char *dup = strdup(s);
+    if (!dup)
+        return NONE;
+    idx                        = es->num_strings++;
+    es->strings[idx]           = dup;
+    es->string_index.slots[slot] = idx;
+    es->string_index.used++;
+    return idx;
+}
+
+static uint32_t sensor_find(event_store_t const *es, uint32_t model, uint32_t id, uint32_t *slot)
+{
+    hash_index_t const *h = &es->sensor_index;
+    uint32_t i            = hash_sensor(model, id) & h->mask;
+    for (; h->slots[i] != NONE; i = (i + 1) & h->mask) {
+        sensor_t const *sn = &es->sensors[h->slots[i]];
+        if (sn->model == model && sn->id == id)
+            break;
+    }
+    if (slot)
+        *slot = i;
+    return h->slots[i];
+}
+
+/// Get or add the sensor of a (model, id), NONE if the table is full.
+static uint32_t sensor_get(event_store_t *es, uint32_t model, uint32_t id)
+{
+    uint32_t slot;
+    uint32_t idx = sensor_find(es, model, id, &slot);
+    if (idx != NONE)
+        return idx;
+    if (es->num_sensors >= EVENT_STORE_MAX_SENSORS)
+        return NONE;
+    int moved = hash_reserve(&es->sensor_index, es, sensor_hash_of);
+    if (moved < 0)
+        return NONE;
+    if (moved)
+        sensor_find(es, model, id, &slot);
+
+    if (es->num_sensors == es->sensors_size) {
+        uint32_t size     = es->sensors_size ? 2 * es->sensors_size : 256;
+        sensor_t *sensors = realloc(es->sensors, size * sizeof(*sensors));
+        if (!sensors)
+            return NONE;
+        es->sensors      = sensors;
+        es->sensors_size = size;
+    }
+    idx              = es->num_sensors++;
+    es->sensors[idx] = (sensor_t){.model = model, .id = id, .last = NO_SEQ};
+    es->sensor_index.slots[slot] = idx;
+    es->sensor_index.used++;
+    return idx;
+}
+
+/* store */
+
+event_store_t *event_store_create(unsigned capacity)
+{
+    if (!capacity)
+        return NULL;
+    event_store_t *es = calloc(1, sizeof(*es));
+    if (!es)
+        return NULL;
+    es->capacity   = capacity;
+    es->values_cap = (size_t)capacity * EVENT_STORE_AVG_VALUES;
+    es->text_cap   = (size_t)capacity * EVENT_STORE_AVG_TEXT;
+
+    // the event columns share one allocation, widest first, and so do the field columns
+    size_t wide    = (size_t)capacity * (sizeof(double) + 3 * sizeof(uint64_t));
+    uint8_t *cols  = malloc(wide + (size_t)capacity * (sizeof(uint32_t) + sizeof(uint8_t)));
+    if (!cols) {
+        free(es);
+        return NULL;
+    }
+    es->time       = (double *)cols;
+    es->prev       = (uint64_t *)(es->time + capacity);
+    es->values     = es->prev + capacity;
+    es->texts      = es->values + capacity;
+    es->sensor     = (uint32_t *)(cols + wide);
+    es->num_values = (uint8_t *)(es->sensor + capacity);
+
+    es->value = malloc(es->values_cap * (sizeof(double) + sizeof(uint32_t)));
+    if (!es->value) {
+        event_store_free(es);
+        return NULL;
+    }
+    es->value_key = (uint32_t *)(es->value + es->values_cap);
+
+    es->text = malloc(es->text_cap);
+    if (!es->text) {
+        event_store_free(es);
+        return NULL;
+    }
+
+    es->parts = calloc(EVENT_STORE_PARTITIONS, sizeof(*es->parts));
+    if (!es->parts) {
+        event_store_free(es);
+        return NULL;
+    }
+    if (hash_init(&es->string_index, 512) < 0 || hash_init(&es->sensor_index, 512) < 0) {
+        event_store_free(es);
+        return NULL;
+    }
+    return es;
+}
+
+void event_store_free(event_store_t *es)
+{
+    if (!es)
+        return;
+    for (uint32_t i = 0; i < es->num_strings; ++i)
+        free(es->strings[i]);
+    free(es->strings);
+    free(es->string_index.slots);
+    free(es->sensors);
+    free(es->sensor_index.slots);
+    if (es->parts) {
+        for (unsigned i = 0; i < EVENT_STORE_PARTITIONS; ++i)
+            free(es->parts[i].counts);
+    }
+    free(es->parts);
+    free(es->text);
+    free(es->value);
+    free(es->time);
+    free(es);
+}
+
+static partition_t *partition_at(event_store_t const *es, unsigned i)
+{
+    return &es->parts[(es->parts_head + i) % EVENT_STORE_PARTITIONS];
+}
+
+/// Count an event in the partition of its minute, a clock going back counts into the last.
+static void partition_add(event_store_t *es, double time, uint64_t seq, uint32_t model)
+{
+    int64_t minute  = (int64_t)floor(time / EVENT_STORE_PARTITION);
+    partition_t *pt = es->num_parts ? partition_at(es, es->num_parts - 1) : NULL;
+    if (!pt || minute > pt->minute) {
+        if (es->num_parts == EVENT_STORE_PARTITIONS) {
+            es->parts[es->parts_head].num_models = 0; // reused, keeps its counts buffer
+            es->parts_head = (es->parts_head + 1) % EVENT_STORE_PARTITIONS;
+            es->num_parts--;
+        }
+        pt             = partition_at(es, es->num_parts++);
+        pt->minute     = minute;
+        pt->first      = seq;
+        pt->num_models = 0;
+    }
+
+    for (unsigned i = 0; i < pt->num_models; ++i) {
+        if (pt->counts[i].model == model) {
+            pt->counts[i].count++;
+            return;
+        }
+    }
+    if (pt->num_models == pt->size) {
+        unsigned size         = pt->size ? 2 * pt->size : 8;
+        model_count_t *counts = realloc(pt->counts, size * sizeof(*counts));
+        if (!counts)
+            return; // not counted
+        pt->counts = counts;
+        pt->size   = size;
+    }
+    pt->counts[pt->num_models++] = (model_count_t){.model = model, .count = 1};
+}
+
+static char const *field_string(data_t const *d, char *buf, size_t size)
+{
+    if (d->type == DATA_STRING)
+        return d->value.v_ptr;
+    if (d->type == DATA_INT)
+        snprintf(buf, size, "%d", d->value.v_int);
+    else if (d->type == DATA_DOUBLE)
+        snprintf(buf, size, "%g", d->value.v_dbl);
+    else
+        return NULL;
+    return buf;
+}
+
+int event_store_add(event_store_t *es, data_t const *data, double time)
+{
+    data_t const *model = NULL, *id = NULL;
+    for (data_t const *d = data; d; d = d->next) {
+        if (!strcmp(d->key, "model"))
+            model = d;
+        else if (!strcmp(d->key, "id"))
+            id = d;
+    }
+    if (!model || model->type != DATA_STRING)
+        return 0;
+    uint32_t model_sid = intern(es, model->value.v_ptr);
+    if (model_sid == NONE)
+        return 0;
+    char buf[32];
+    char const *id_str = id ? field_string(id, buf, sizeof(buf)) : NULL;
+    uint32_t id_sid    = id_str ? intern(es, id_str) : NONE;
+
+    // the fields, in the order of the data, string values laid out in the
+    // text ring from text_next on, each in one piece
+    uint32_t keys[EVENT_STORE_MAX_VALUES];
+    double vals[EVENT_STORE_MAX_VALUES];
+    char const *strs[EVENT_STORE_MAX_VALUES];
+    uint64_t text_end = es->text_next;
+    unsigned n = 0;
+    for (data_t const *d = data; d && n < EVENT_STORE_MAX_VALUES; d = d->next) {
+        if (d == model || d == id || !strcmp(d->key, "time"))
+            continue;
+        if (d->type != DATA_INT && d->type != DATA_DOUBLE && d->type != DATA_STRING)
+            continue;
+        uint32_t key = intern(es, d->key);
+        if (key == NONE)
+            continue;
+        strs[n] = NULL;
+        if (d->type == DATA_STRING) {
+            size_t len   = strlen(d->value.v_ptr) + 1;
+            uint64_t pos = text_end;
+            if (pos % es->text_cap + len > es->text_cap)
+                pos += es->text_cap - pos % es->text_cap; // wrap around
+            if (pos + len - es->text_next > es->text_cap)
+                continue; // does not fit the store
+            keys[n]  = key | STRING_VALUE;
+            vals[n]  = (double)pos;
+            strs[n]  = d->value.v_ptr;
+            text_end = pos + len;
+        }
+        else {
+            keys[n] = key;
+            vals[n] = d->type == DATA_INT ? d->value.v_int : d->value.v_dbl;
+        }
+        n++;
+    }
+
+    // drop the oldest events to make room
+    while (es->first < es->next
+            && (es->next - es->first >= es->capacity
+                    || es->values_next + n - es->values[es->first % es->capacity] > es->values_cap
+                    || text_end - es->texts[es->first % es->capacity] > es->text_cap))
+        es->first++;
+
+    uint64_t seq  = es->next++;
+    unsigned slot = (unsigned)(seq % es->capacity);
+    es->time[slot]       = time;
+    es->values[slot]     = es->values_next;
+    es->texts[slot]      = es->text_next;
+    es->num_values[slot] = (uint8_t)n;
+    for (unsigned i = 0; i < n; ++i) {
+        size_t pos         = (size_t)((es->values_next + i) % es->values_cap);
+        es->value_key[pos] = keys[i];
+        es->value[pos]     = vals[i];
+        if (strs[i])
+            strcpy(es->text + (size_t)((uint64_t)vals[i] % es->text_cap), strs[i]);
+    }
+    es->values_next += n;
+    es->text_next = text_end;
+
+    uint32_t sensor  = sensor_get(es, model_sid, id_sid);
+    es->sensor[slot] = sensor;
+    es->prev[slot]   = NO_SEQ;
+    if (sensor != NONE) {
+        sensor_t *sn   = &es->sensors[sensor];
+        es->prev[slot] = sn->last;
+        sn->last       = seq;
+        sn->count++;
+    }
+
+    partition_add(es, time, seq, model_sid);
+    return 1;
+}
+
+void event_store_counts(event_store_t const *es, unsigned *events, unsigned *sensors)
+{
+    if (events)
+        *events = (unsigned)(es->next - es->first);
+    if (sensors)
+        *sensors = es->num_sensors;
+}
+
+/* queries */
+
+static uint32_t string_lookup(event_store_t const *es, char const *s)
+{
+    return string_find(es, s, hash_string(s), NULL);
+}
+
+/// Append a JSON string, escaped, empties the buffer if it does not fit.
+static void json_string(abuf_t *b, char const *s)
+{
+    static char const hex[] = "0123456789abcdef";
+    char tmp[6];
+    if (b->left < 3) {
+        b->left = 0;
+        return;
+    }
+    *b->tail++ = '"';
+    b->left--;
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char)*s;
+        char const *esc = NULL;
+        size_t len      = 1;
+        if (c == '"' || c == '\\') {
+            tmp[0] = '\\';
+            tmp[1] = (char)c;
+            esc    = tmp;
+            len    = 2;
+        }
+        else if (c < 0x20) {
+            memcpy(tmp, "\\u00", 4);
+            tmp[4] = hex[c >> 4];
+            tmp[5] = hex[c & 15];
+            esc    = tmp;
+            len    = 6;
+        }
+        if (b->left < len + 2) { // the closing quote and the NUL
+            b->left = 0;
+            return;
+        }
+        if (esc)
+            memcpy(b->tail, esc, len);
+        else
+            *b->tail = (char)c;
+        b->tail += len;
+        b->left -= len;
+    }
+    *b->tail++ = '"';
+    *b->tail   = '\0';
+    b->left--;
+}
+
+static void json_number(abuf_t *b, double v)
+{
+    if (isfinite(v))
+        abuf_printf(b, "%.10g", v);
+    else
+        abuf_printf(b, "null");
+}
+
+/// Write one event as a JSON object.
+static void json_event(event_store_t const *es, abuf_t *b, uint64_t seq, int with_count)
+{
+    unsigned slot       = (unsigned)(seq % es->capacity);
+    sensor_t const *sn  = es->sensor[slot] != NONE ? &es->sensors[es->sensor[slot]] : NULL;
+
+    abuf_printf(b, "{");
+    if (sn) {
+        abuf_printf(b, "\"model\":");
+        json_string(b, es->strings[sn->model]);
+        if (sn->id != NONE) {
+            abuf_printf(b, ",\"id\":");
+            json_string(b, es->strings[sn->id]);
+        }
+        abuf_printf(b, ",");
+    }
+    abuf_printf(b, "\"time\":%.3f", es->time[slot]);
+    if (with_count && sn)
+        abuf_printf(b, ",\"count\":%llu", (unsigned long long)sn->count);
+    abuf_printf(b, ",\"fields\":{");
+    for (unsigned i = 0; i < es->num_values[slot]; ++i) {
+        size_t pos   = (size_t)((es->values[slot] + i) % es->values_cap);
+        uint32_t key = es->value_key[pos];
+        abuf_printf(b, "%s", i ? "," : "");
+        json_string(b, es->strings[key & ~STRING_VALUE]);
+        abuf_printf(b, ":");
+        if (key & STRING_VALUE)
+            json_string(b, es->text + (size_t)((uint64_t)es->value[pos] % es->text_cap));
+        else
+            json_number(b, es->value[pos]);
+    }
+    abuf_printf(b, "}}");
+}
+
+/// Start a JSON reply, the reserve is given back by json_end().
+static int json_begin(abuf_t *b, char *buf, size_t size, char const *head)
+{
+    if (size < 2 * JSON_RESERVE) {
+        if (size)
+            buf[0] = '\0';
+        return -1;
+    }
+    abuf_init(b, buf, size - JSON_RESERVE);
+    abuf_printf(b, "%s", head);
+    return 0;
+}
+
+/// Append an entry, or drop it if it did not fit.  Returns 0 if dropped.
+static int json_entry_fits(abuf_t *b, char *mark)
+{
+    if (b->left > 1)
+        return 1;
+    abuf_pop(b, mark);
+    *b->tail = '\0';
+    return 0;
+}
+
+static size_t json_end(abuf_t *b, char *buf, char const *tail)
+{
+    b->left += JSON_RESERVE;
+    abuf_cat(b, tail);
+    return (size_t)(b->tail - buf);
+}
+
+size_t event_store_latest(event_store_t const *es, char const *model, char *buf, size_t size)
+{
+    abuf_t b;
+    if (json_begin(&b, buf, size, "{\"sensors\":[") < 0)
+        return 0;
+    uint32_t model_sid = model ? string_lookup(es, model) : NONE;
+    int n              = 0;
+    for (uint32_t s = 0; s < es->num_sensors && (!model || model_sid != NONE); ++s) {
+        sensor_t const *sn = &es->sensors[s];
+        if (sn->last == NO_SEQ || sn->last < es->first || (model && sn->model != model_sid))
+            continue; // no events held
+        char *mark = abuf_push(&b);
+        abuf_printf(&b, "%s", n ? "," : "");
+        json_event(es, &b, sn->last, 1);
+        if (!json_entry_fits(&b, mark))
+            break;
+        n++;
+    }
+    return json_end(&b, buf, "]}");
+}
+
+/// The number of events of a model in a partition.
+static uint32_t partition_count(partition_t const *pt, uint32_t model)
+{
+    for (unsigned i = 0; i < pt->num_models; ++i) {
+        if (pt->counts[i].model == model)
+            return pt->counts[i].count;
+    }
+    return 0;
+}
+
+size_t event_store_events(event_store_t const *es, char const *model, char const *id,
+        double since, unsigned limit, char *buf, size_t size)
+{
+    abuf_t b;
+    if (json_begin(&b, buf, size, "{\"events\":[") < 0)
+        return 0;
+    uint32_t model_sid = model ? string_lookup(es, model) : NONE;
+    uint32_t id_sid    = id ? string_lookup(es, id) : NONE;
+    if ((model && model_sid == NONE) || (id && id_sid == NONE))
+        return json_end(&b, buf, "]}"); // never seen
+
+    unsigned n = 0;
+    if (model && id) {
+        // follow the index of the sensor
+        uint32_t s   = sensor_find(es, model_sid, id_sid, NULL);
+        uint64_t seq = s != NONE ? es->sensors[s].last : NO_SEQ;
+        for (; seq != NO_SEQ && seq >= es->first && n < limit; ++n) {
+            unsigned slot = (unsigned)(seq % es->capacity);
+            if (es->time[slot] < since)
+                break;
+            char *mark = abuf_push(&b);
+            abuf_printf(&b, "%s", n ? "," : "");
+            json_event(es, &b, seq, 0);
+            if (!json_entry_fits(&b, mark))
+                break;
+            seq = es->prev[slot];
+        }
+        return json_end(&b, buf, "]}");
+    }
+
+    // scan back by partition, skipping those without the model
+    uint64_t end = es->next;
+    for (int p = (int)es->num_parts - 1; p >= -1 && end > es->first && n < limit; --p) {
+        partition_t const *pt = p >= 0 ? partition_at(es, (unsigned)p) : NULL;
+        uint64_t start        = pt && pt->first > es->first ? pt->first : es->first;
+        if (pt && (pt->minute + 1) * (double)EVENT_STORE_PARTITION <= since)
+            break; // older than asked for
+        if (pt && model && !partition_count(pt, model_sid)) {
+            end = start;
+            continue;
+        }
+        for (uint64_t seq = end; seq-- > start && n < limit;) {
+            unsigned slot = (unsigned)(seq % es->capacity);
+            if (es->time[slot] < since)
+                continue; // a clock going back, the partition is not in order
+            uint32_t s = es->sensor[slot];
+            if ((model || id) && s == NONE)
+                continue;
+            if ((model && es->sensors[s].model != model_sid) || (id && es->sensors[s].id != id_sid))
+                continue;
+            char *mark = abuf_push(&b);
+            abuf_printf(&b, "%s", n ? "," : "");
+            json_event(es, &b, seq, 0);
+            if (!json_entry_fits(&b, mark)) {
+                limit = n; // full
+                break;
+            }
+            n++;
+        }
+        end = start;
+    }
+    return json_end(&b, buf, "]}");
+}
+
+size_t event_store_minutes(event_store_t const *es, char const *model, double since, char *buf, size_t size)
+{
+    abuf_t b;
+    if (json_begin(&b, buf, size, "{\"minutes\":[") < 0)
+        return 0;
+    uint32_t model_sid = model ? string_lookup(es, model) : NONE;
+    int n              = 0;
+    for (unsigned p = 0; p < es->num_parts && (!model || model_sid != NONE); ++p) {
+        partition_t const *pt = partition_at(es, p);
+        if ((pt->minute + 1) * (double)EVENT_STORE_PARTITION <= since)
+            continue;
+        if (model && !partition_count(pt, model_sid))
+            continue;
+        char *mark = abuf_push(&b);
+        abuf_printf(&b, "%s{\"time\":%lld,\"counts\":{", n ? "," : "",
+                (long long)pt->minute * EVENT_STORE_PARTITION);
+        int m = 0;
+        for (unsigned i = 0; i < pt->num_models; ++i) {
+            if (model && pt->counts[i].model != model_sid)
+                continue;
+            abuf_printf(&b, "%s", m++ ? "," : "");
+            json_string(&b, es->strings[pt->counts[i].model]);
+            abuf_printf(&b, ":%u", pt->counts[i].count);
+        }
+        abuf_printf(&b, "}}");
+        if (!json_entry_fits(&b, mark))
+            break;
+        n++;
+    }
+    return json_end(&b, buf, "]}");
+}
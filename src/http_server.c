@@ -19,8 +19,9 @@ A choice of endpoints are available:
 - "/cmd": simple JSON command API
 - "/events": HTTP (chunked) streaming API, streams JSON events
 - "/stream": HTTP (plain) streaming API, streams JSON events
-- "/api": RESTful API (not implemented)
+- "/api/latest", "/api/events", "/api/counts": queries of the event store
 - "ws:": Websocket API (similar to cmd/events API)
+- "ws:/spectrum": Websocket spectrum stream, binary frames as in spectrum.h
 
 ## JSON-RPC API
 
@@ -49,6 +50,65 @@ On Events and Stream endpoints a keep-alive of CRLF will be send every 60 second
 Use e.g. httpie with `http --stream --timeout=70 :8433/events`
 or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 
+Add `?format=cbor` to the Events or Stream endpoint to receive a CBOR sequence
+(`application/cbor-seq`) instead, one CBOR map per event and an empty map as keep-alive.
+
+## Event selection
+
+The Events, Stream and Websocket endpoints take a query to select events:
+- `since=<seq>`: resume, first send the history after that sequence number
+  (Websockets get the whole history without it), implies `seq=1`
+- `seq=1`: add the sequence number as the first key `"seq"` of JSON events
+- `model=`, `id=`, `channel=`: comma separated lists of accepted values
+- `min_snr=<dB>`: only events with an `snr` of at least that (needs `-M level`)
+- `rate=<events per second>`: events over the limit are dropped for the client
+
+Filters and the rate limit apply to decoded events, log and meta messages
+are always sent.  E.g. `http --stream :8433/events since==1234 model==Acurite-Tower`
+
+## Event store queries
+
+The decoded events are kept in an in-memory store of the last 100000 events,
+the event counts per model and minute are kept for a day.  Queries are JSON
+and take the selection as a query:
+- "/api/latest": the last event of each sensor, `model=` selects a model
+- "/api/events": the events newest first, `model=` and `id=` select the
+  events, `age=<seconds>` or `since=<epoch seconds>` the time range and
+  `limit=` the number of events (100 by default, 10000 at most)
+- "/api/counts": the event count per model per minute, `model=`, `age=`
+  and `since=` select as above
+
+E.g. `http :8433/api/events model==Acurite-Tower id==1234 age==3600`.
+The same queries are available as the commands "query_latest",
+"query_events" and "query_counts" with the query as the argument, e.g.
+
+    {"cmd": "query_counts", "arg": "model=Acurite-Tower&age=86400"}
+
+## Spectrum Websocket API
+
+Connect a websocket to `/spectrum?fps=10&bins=512&source=fft` to receive
+binary spectrum frames instead of events, `source=channels` gives the power
+of the wideband channels.  Send the same query as a text message to change
+the settings, the granted settings are confirmed as JSON, e.g.
+
+    {"spectrum": {"source": "fft", "fps": 10, "bins": 512, "fft_size": 2048}}
+
+The FFT is only computed while a viewer is due a frame and shared by all
+viewers, frames are skipped for a viewer that can not keep up.
+
+## Threading
+
+The server runs its own connection manager on its own thread, slow clients
+never hold up the receiver.  Events are serialized once on the thread that
+outputs them and handed over in a lock-free queue, the server thread sends
+them and keeps them in the history, a message is freed when the last of
+these lets go.  An event is dropped if the queue is full, and for a client
+with more than 256 KiB still to send or over its rate limit
+(`http_dropped_events` in the metrics).
+Commands, the meta data of new websockets, the metrics and the event store
+queries read and change the settings or the store, they are passed to the
+main thread and the reply is sent back.
+
 ## Queries
 
 - "registered_protocols"
@@ -95,6 +155,7 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 
 #include "http_server.h"
 #include "data.h"
+#include "data_cbor.h"
 #include "rtl_433.h"
 #include "r_api.h"
 #include "r_device.h" // used for protocols
@@ -108,8 +169,17 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 #include "sdr.h"
 #include "channelizer.h"
 #include "logger.h"
+#include "metrics.h"
+#include "trace.h"
+#include "coalesce.h"
+#include "spectrum.h"
+#include "event_queue.h"
+#include "event_store.h"
+#include "event_filter.h"
+#include "compat_pthread.h"
 #include "fatal.h"
 #include <stdbool.h>
+#include <math.h>
 
 #include "webui_assets.h"
 
@@ -209,6 +279,122 @@ static void **ring_list_next(ring_list_t *ring, void **iter)
     return iter;
 }
 
+// shared messages
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define ATOMIC_ADD(p, v)  InterlockedExchangeAdd((volatile LONG *)(p), (v))
+#define ATOMIC_XCHG(p, v) InterlockedExchange((volatile LONG *)(p), (v))
+#define ATOMIC_LOAD(p)    (*(volatile LONG *)(p))
+#else
+/* GCC/Clang __atomic builtins (works in C99 mode) */
+#define ATOMIC_ADD(p, v)  __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_XCHG(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_LOAD(p)    __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#endif
+
+/// A serialized event, shared by the queue, the history and the sends.
+/// The fields the clients select on are kept aside, filters never parse the JSON.
+typedef struct {
+    long refs;
+    uint64_t seq;        ///< assigned in order of sending, 0 until sent
+    size_t len;          ///< length of the JSON
+    size_t cbor_len;     ///< length of the CBOR, 0 if not encoded
+    char const *model;   ///< NULL if not a decoded event
+    char const *id;      ///< NULL if not present
+    char const *channel; ///< NULL if not present
+    double snr;          ///< NAN if not reported
+    char data[];         ///< the JSON, a NUL, the CBOR, then the fields
+} http_msg_t;
+
+/// Format an int or string value to match it against a filter.
+static char const *http_msg_field(data_t const *d, char *buf, size_t size)
+{
+    if (!d)
+        return NULL;
+    if (d->type == DATA_STRING)
+        return d->value.v_ptr;
+    if (d->type == DATA_INT)
+        snprintf(buf, size, "%d", d->value.v_int);
+    else if (d->type == DATA_DOUBLE)
+        snprintf(buf, size, "%g", d->value.v_dbl);
+    else
+        return NULL;
+    return buf;
+}
+
+static char *http_msg_copy(char *dst, char const *src)
+{
+    size_t len = strlen(src) + 1;
+    memcpy(dst, src, len);
+    return dst + len;
+}
+
+static http_msg_t *http_msg_new(char const *json, size_t len, uint8_t const *cbor, size_t cbor_len, data_t const *data)
+{
+    data_t const *model = NULL, *id = NULL, *channel = NULL, *snr = NULL;
+    for (data_t const *d = data; d; d = d->next) {
+        if (!strcmp(d->key, "model"))
+            model = d;
+        else if (!strcmp(d->key, "id"))
+            id = d;
+        else if (!strcmp(d->key, "channel"))
+            channel = d;
+        else if (!strcmp(d->key, "snr"))
+            snr = d;
+    }
+    char model_buf[32], id_buf[32], channel_buf[32];
+    char const *model_str   = http_msg_field(model, model_buf, sizeof(model_buf));
+    char const *id_str      = model ? http_msg_field(id, id_buf, sizeof(id_buf)) : NULL;
+    char const *channel_str = model ? http_msg_field(channel, channel_buf, sizeof(channel_buf)) : NULL;
+    size_t fields_len = (model_str ? strlen(model_str) + 1 : 0)
+            + (id_str ? strlen(id_str) + 1 : 0)
+            + (channel_str ? strlen(channel_str) + 1 : 0);
+
+    http_msg_t *msg = malloc(sizeof(*msg) + len + 1 + cbor_len + fields_len);
+    if (!msg) {
+        WARN_MALLOC("http_msg_new()");
+        return NULL;
+    }
+    msg->refs     = 1;
+    msg->seq      = 0;
+    msg->len      = len;
+    msg->cbor_len = cbor_len;
+    memcpy(msg->data, json, len);
+    msg->data[len] = '\0';
+    if (cbor_len)
+        memcpy(msg->data + len + 1, cbor, cbor_len);
+
+    char *p      = msg->data + len + 1 + cbor_len;
+    msg->model   = model_str ? p : NULL;
+    p            = model_str ? http_msg_copy(p, model_str) : p;
+    msg->id      = id_str ? p : NULL;
+    p            = id_str ? http_msg_copy(p, id_str) : p;
+    msg->channel = channel_str ? p : NULL;
+    if (channel_str)
+        http_msg_copy(p, channel_str);
+    msg->snr = snr && snr->type == DATA_DOUBLE ? snr->value.v_dbl : NAN;
+    return msg;
+}
+
+static http_msg_t *http_msg_retain(http_msg_t *msg)
+{
+    ATOMIC_ADD(&msg->refs, 1);
+    return msg;
+}
+
+static void http_msg_release(void *p)
+{
+    http_msg_t *msg = p;
+    if (msg && ATOMIC_ADD(&msg->refs, -1) == 1)
+        free(msg);
+}
+
+static uint8_t const *http_msg_cbor(http_msg_t const *msg)
+{
+    return (uint8_t const *)msg->data + msg->len + 1;
+}
+
 // data helpers that could go into r_api
 
 static data_t *meta_data(r_cfg_t *cfg)
@@ -364,6 +550,7 @@ static char *jsondupq(const char *json, jsmntok_t *tok)
 }
 
 // {"cmd": "report_meta", "arg": "utc", "val": 1}
+// parsed on the main thread, the errors are logged
 static int json_parse(rpc_t *rpc, struct mg_str const *json)
 {
     int i;
@@ -422,6 +609,7 @@ static int json_parse(rpc_t *rpc, struct mg_str const *json)
 }
 
 // {"jsonrpc": "2.0", "method": "report_meta", "params": ["utc", 1], "id": 0}
+// parsed on the main thread, the errors are logged
 static int jsonrpc_parse(rpc_t *rpc, struct mg_str const *json)
 {
     int r;
@@ -577,6 +765,13 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
         }
         data_free(data);
     }
+    else if (!strcmp(rpc->method, "get_perf")) {
+        char buf[8192];
+        data_t *data = create_perf_data(cfg);
+        data_print_jsons(data, buf, sizeof(buf));
+        rpc->response(rpc, 1, buf, 0);
+        data_free(data);
+    }
     else if (!strcmp(rpc->method, "get_meta")) {
         char buf[2048]; // we expect the meta string to be around 500 bytes.
         data_t *data = meta_data(cfg);
@@ -638,6 +833,24 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
             cfg->report_meta = rpc->val;
         rpc->response(rpc, 0, "Ok", 0);
     }
+    else if (!strcmp(rpc->method, "profile")) {
+        // restart the interval, decoder times are only valid while enabled
+        cfg->demod->metrics.profile.enabled = rpc->val != 0;
+        flush_perf_data(cfg);
+        rpc->response(rpc, 0, "Ok", 0);
+    }
+    else if (!strcmp(rpc->method, "trace")) {
+        if (!rpc->val) {
+            stop_trace();
+            rpc->response(rpc, 0, "Ok", 0);
+        }
+        else if (start_trace(rpc->val, rpc->arg && *rpc->arg ? rpc->arg : TRACE_DEFAULT_PATH) < 0) {
+            rpc->response(rpc, -1, "Trace already recording", 0);
+        }
+        else {
+            rpc->response(rpc, 0, "Ok", 0);
+        }
+    }
     else if (!strcmp(rpc->method, "convert")) {
         cfg->conversion_mode = rpc->val;
         rpc->response(rpc, 0, "Ok", 0);
@@ -795,18 +1008,176 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
 
 #define KEEP_ALIVE 60 /* seconds */
 
+#define HTTP_QUEUE_SIZE 1024         ///< events and jobs in flight between the threads
+#define HTTP_SEND_LIMIT (256 * 1024) ///< events are dropped for a client with more to send
+#define HTTP_QUERY_SIZE (1024 * 1024) ///< event store query results are cut short beyond
+#define HTTP_QUERY_LIMIT 100          ///< events per query by default
+#define HTTP_QUERY_MAX_LIMIT 10000    ///< events per query at most
+
 struct http_server_context {
+    struct mg_mgr *mgr;
     struct mg_connection *conn;
     struct mg_serve_http_opts server_opts;
     r_cfg_t *cfg;
     struct data_output *output;
-    ring_list_t *history;
+    ring_list_t *history;      ///< the last events, for new websockets
+    event_store_t *store;      ///< the decoded events, for queries, on the main thread
+    list_t inflight;           ///< jobs waiting for the main thread
+    list_t spectrum_clients;
+    float *spectrum_levels;    ///< the last FFT read
+    uint32_t spectrum_levels_seq;
+    // the last FFT frame sent, shared by the viewers of the same resolution
+    uint8_t spectrum_frame[SPECTRUM_HEADER_LEN + SPECTRUM_FFT_SIZE];
+    size_t spectrum_frame_len;
+    unsigned spectrum_frame_bins;
+    uint32_t spectrum_frame_seq;
+    uint64_t last_seq;         ///< sequence number of the last message sent
+    // shared with the other threads
+    long cbor_clients;
+    long dropped_queue;   ///< events dropped on a full queue
+    long dropped_backlog; ///< events not sent to a slow client
+    long dropped_rate;    ///< events over the rate limit of a client
+#ifdef THREADS
+    struct mg_mgr server_mgr;
+    pthread_t thread;
+    long stop;
+    event_queue_t *events;  ///< any thread to the server thread
+    event_queue_t *replies; ///< main thread to the server thread
+    event_queue_t *jobs;    ///< server thread to the main thread
+    sock_t server_wake[2];  ///< written to wake the server thread
+    long server_wake_pending;
+    sock_t main_wake[2];    ///< written to wake the main thread
+    long main_wake_pending;
+    struct mg_connection *main_conn;
+#endif
 };
 
+/// Event clients, Events, Stream and Websocket, these carry an nc_context.
+#define MG_F_STREAM MG_F_USER_2
+
 struct nc_context {
+    struct http_server_context *server;
     int is_chunked;
+    int is_cbor;
+    // event selection, from the query of the request
+    int with_seq;     ///< add the sequence number to JSON events
+    event_filter_t filter;
 };
 
+static int is_websocket(const struct mg_connection *nc)
+{
+    return nc->flags & MG_F_IS_WEBSOCKET;
+}
+
+/// Get the sequence number of a `since=` query, -1 if not given.
+static int64_t query_since(struct mg_str const *query)
+{
+    char val[24];
+    if (mg_get_http_var(query, "since", val, sizeof(val)) <= 0)
+        return -1;
+    return (int64_t)strtoull(val, NULL, 10);
+}
+
+/// Set up an event client with the selection of the `seq`, `model`, `id`,
+/// `channel`, `min_snr` and `rate` query.  Returns NULL on allocation failure.
+static struct nc_context *http_client_new(struct http_server_context *ctx, struct mg_str const *query, int is_chunked, int is_cbor)
+{
+    struct nc_context *cctx = calloc(1, sizeof(*cctx));
+    if (!cctx) {
+        WARN_CALLOC("http_client_new()");
+        return NULL;
+    }
+    cctx->server     = ctx;
+    cctx->is_chunked = is_chunked;
+    cctx->is_cbor    = is_cbor;
+
+    event_filter_t *f = &cctx->filter;
+    event_filter_init(f);
+    char val[24];
+    mg_get_http_var(query, "model", f->model, sizeof(f->model));
+    mg_get_http_var(query, "id", f->id, sizeof(f->id));
+    mg_get_http_var(query, "channel", f->channel, sizeof(f->channel));
+    if (mg_get_http_var(query, "min_snr", val, sizeof(val)) > 0)
+        f->min_snr = atof(val);
+    if (mg_get_http_var(query, "rate", val, sizeof(val)) > 0)
+        event_filter_set_rate(f, atof(val), mg_time());
+    if (mg_get_http_var(query, "seq", val, sizeof(val)) > 0)
+        cctx->with_seq = atoiv(val, 1);
+    if (query_since(query) >= 0)
+        cctx->with_seq = 1;
+    return cctx;
+}
+
+/// Check an event against the filters of a client, other messages always pass.
+static int http_client_wants(struct nc_context const *cctx, http_msg_t const *msg)
+{
+    return event_filter_wants(&cctx->filter, msg->model, msg->id, msg->channel, msg->snr);
+}
+
+/// Take an event from the rate limit of a client, 0 if over the limit.
+static int http_client_take(struct nc_context *cctx, http_msg_t const *msg, double now)
+{
+    return !msg->model || event_filter_take(&cctx->filter, now);
+}
+
+/// Send a message to an event client, the JSON with the sequence number if asked for.
+static void http_client_send(struct mg_connection *nc, struct nc_context const *cctx, http_msg_t const *msg)
+{
+    char prefix[32];
+    struct mg_str parts[2] = {mg_mk_str_n(msg->data, msg->len)};
+    int num_parts          = 1;
+    if (cctx->with_seq && msg->len >= 2 && msg->data[0] == '{') {
+        // splice the sequence number in as the first key
+        int len   = snprintf(prefix, sizeof(prefix), "{\"seq\":%" PRIu64 "%s", msg->seq, msg->data[1] == '}' ? "" : ",");
+        parts[0]  = mg_mk_str_n(prefix, (size_t)len);
+        parts[1]  = mg_mk_str_n(msg->data + 1, msg->len - 1);
+        num_parts = 2;
+    }
+
+    if (is_websocket(nc)) {
+        mg_send_websocket_framev(nc, WEBSOCKET_OP_TEXT, parts, num_parts);
+        return;
+    }
+    if (cctx->is_cbor) {
+        if (!msg->cbor_len)
+            return; // event did not encode
+        if (cctx->is_chunked)
+            mg_send_http_chunk(nc, (char const *)http_msg_cbor(msg), msg->cbor_len);
+        else
+            mg_send(nc, http_msg_cbor(msg), (int)msg->cbor_len);
+    }
+    else if (cctx->is_chunked) {
+        for (int i = 0; i < num_parts; ++i)
+            mg_send_http_chunk(nc, parts[i].p, parts[i].len);
+        mg_send_http_chunk(nc, "\r\n", 2);
+    }
+    else {
+        for (int i = 0; i < num_parts; ++i)
+            mg_send(nc, parts[i].p, (int)parts[i].len);
+        mg_send(nc, "\r\n", 2);
+    }
+    mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+}
+
+/// Send the history after sequence number @p since to a new client.
+static void http_client_history(struct http_server_context *ctx, struct mg_connection *nc, int64_t since)
+{
+    struct nc_context const *cctx = nc->user_data;
+    for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter)) {
+        http_msg_t const *msg = *iter;
+        if ((int64_t)msg->seq > since && http_client_wants(cctx, msg))
+            http_client_send(nc, cctx, msg);
+    }
+}
+
+/// Check for a `format=cbor` query on the streaming endpoints.
+static int wants_cbor(struct http_message *hm)
+{
+    char format[16];
+    return mg_get_http_var(&hm->query_string, "format", format, sizeof(format)) > 0
+            && !strcmp(format, "cbor");
+}
+
 static void handle_options(struct mg_connection *nc, struct http_message *hm)
 {
     UNUSED(hm);
@@ -856,74 +1227,245 @@ static void handle_webui_asset(struct mg_connection *nc,
     nc->flags |= MG_F_SEND_AND_CLOSE;
 }
 
-static void handle_openmetrics(struct mg_connection *nc, struct http_message *hm)
+static void decoder_labels(char *labels, size_t size, r_device const *r_dev)
 {
-    if (mg_vcmp(&hm->method, "GET") != 0) {
-        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+    char num[16];
+    snprintf(num, sizeof(num), "%u", r_dev->protocol_num);
+    labels[0] = '\0';
+    metrics_label(labels, size, "protocol", num);
+    metrics_label(labels, size, "name", r_dev->name);
+}
+
+static void channel_labels(char *labels, size_t size, int chan, double freq)
+{
+    char val[32];
+    labels[0] = '\0';
+    snprintf(val, sizeof(val), "%d", chan);
+    metrics_label(labels, size, "channel", val);
+    snprintf(val, sizeof(val), "%.0f", freq);
+    metrics_label(labels, size, "freq_hz", val);
+}
+
+static void openmetrics_decoders(metrics_writer_t *w, list_t *r_devs)
+{
+    static char const *const fail_reasons[] = {
+            "fail_other",   // -DECODE_FAIL_OTHER
+            "abort_length", // -DECODE_ABORT_LENGTH
+            "abort_early",  // -DECODE_ABORT_EARLY
+            "fail_mic",     // -DECODE_FAIL_MIC
+            "fail_sanity",  // -DECODE_FAIL_SANITY
+    };
+    char labels[256];
+
+    metrics_family(w, "decoder_events", METRICS_COUNTER, NULL, "Number of pulse packages passed to the decoder.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        decoder_labels(labels, sizeof(labels), r_dev);
+        metrics_counter(w, "decoder_events", labels, r_dev->decode_events);
+    }
+    metrics_family(w, "decoder_ok", METRICS_COUNTER, NULL, "Number of pulse packages successfully decoded.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        decoder_labels(labels, sizeof(labels), r_dev);
+        metrics_counter(w, "decoder_ok", labels, r_dev->decode_ok);
+    }
+    metrics_family(w, "decoder_messages", METRICS_COUNTER, NULL, "Number of messages output by the decoder.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        decoder_labels(labels, sizeof(labels), r_dev);
+        metrics_counter(w, "decoder_messages", labels, r_dev->decode_messages);
+    }
+    metrics_family(w, "decoder_fails", METRICS_COUNTER, NULL, "Number of pulse packages rejected by the decoder, by reason.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        for (int i = 0; i < 5; ++i) {
+            decoder_labels(labels, sizeof(labels), r_dev);
+            metrics_label(labels, sizeof(labels), "reason", fail_reasons[i]);
+            metrics_counter(w, "decoder_fails", labels, r_dev->decode_fails[i]);
+        }
+    }
+}
+
+static void openmetrics_channels(metrics_writer_t *w, r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+    char labels[128];
+
+    int wideband = cfg->wideband_mode && demod->wideband_channels_allocated > 0
+            && demod->wb_noise_level && demod->wb_min_level_auto && demod->wb_channel_freqs;
+    if (!wideband) {
+        // single narrowband channel
+        channel_labels(labels, sizeof(labels), 0, cfg->center_frequency);
+        metrics_family(w, "channel_noise_level_db", METRICS_GAUGE, NULL, "Estimated noise level of the channel.");
+        metrics_gauge(w, "channel_noise_level_db", labels, demod->noise_level);
+        metrics_family(w, "channel_min_level_db", METRICS_GAUGE, NULL, "Minimum pulse detection level of the channel.");
+        metrics_gauge(w, "channel_min_level_db", labels, demod->min_level_auto);
         return;
     }
 
-    struct http_server_context *ctx = nc->user_data;
+    int channels = demod->wideband_channels_allocated;
+    metrics_family(w, "channel_noise_level_db", METRICS_GAUGE, NULL, "Estimated noise level of the channel.");
+    for (int c = 0; c < channels; ++c) {
+        channel_labels(labels, sizeof(labels), c, demod->wb_channel_freqs[c]);
+        metrics_gauge(w, "channel_noise_level_db", labels, demod->wb_noise_level[c]);
+    }
+    metrics_family(w, "channel_min_level_db", METRICS_GAUGE, NULL, "Minimum pulse detection level of the channel.");
+    for (int c = 0; c < channels; ++c) {
+        channel_labels(labels, sizeof(labels), c, demod->wb_channel_freqs[c]);
+        metrics_gauge(w, "channel_min_level_db", labels, demod->wb_min_level_auto[c]);
+    }
+    if (demod->wb_smoothed_power) {
+        metrics_family(w, "channel_power_db", METRICS_GAUGE, NULL, "Smoothed signal power of the channel.");
+        for (int c = 0; c < channels; ++c) {
+            channel_labels(labels, sizeof(labels), c, demod->wb_channel_freqs[c]);
+            metrics_gauge(w, "channel_power_db", labels, demod->wb_smoothed_power[c]);
+        }
+    }
+    if (demod->wb_decode_count) {
+        metrics_family(w, "channel_decodes", METRICS_COUNTER, NULL, "Number of successful decodes on the channel.");
+        for (int c = 0; c < channels; ++c) {
+            channel_labels(labels, sizeof(labels), c, demod->wb_channel_freqs[c]);
+            metrics_counter(w, "channel_decodes", labels, demod->wb_decode_count[c]);
+        }
+    }
+    if (demod->wb_dedup) {
+        metrics_family(w, "dedup_suppressed_events", METRICS_COUNTER, NULL, "Number of events suppressed as duplicates from adjacent channels.");
+        metrics_counter(w, "dedup_suppressed_events", NULL, wb_dedup_suppressed_count(demod->wb_dedup));
+
+        wb_dedup_stats_t stats;
+        wb_dedup_stats(demod->wb_dedup, &stats);
+        metrics_family(w, "dedup_lookups", METRICS_COUNTER, NULL, "Number of dedup lookups, by result: hit (suppressed), repeat (same channel) or miss (new).");
+        metrics_counter(w, "dedup_lookups", "result=\"hit\"", (double)stats.hits);
+        metrics_counter(w, "dedup_lookups", "result=\"repeat\"", (double)stats.repeats);
+        metrics_counter(w, "dedup_lookups", "result=\"miss\"", (double)stats.misses);
+        metrics_family(w, "dedup_evictions", METRICS_COUNTER, NULL, "Number of live dedup entries dropped for lack of space.");
+        metrics_counter(w, "dedup_evictions", NULL, (double)stats.evictions);
+    }
+}
+
+static void openmetrics_latency(metrics_writer_t *w, r_cfg_t *cfg)
+{
+    list_t *r_devs = &cfg->demod->r_devs;
+    char labels[256];
+
+    metrics_family(w, "decoder_latency_seconds", METRICS_SUMMARY, "seconds", "Time from the end of the pulse train to the decoded event.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (!r_dev->latency)
+            continue;
+        decoder_labels(labels, sizeof(labels), r_dev);
+        metrics_summary(w, "decoder_latency_seconds", labels, r_dev->latency);
+    }
+    metrics_family(w, "decoder_latency_max_seconds", METRICS_GAUGE, "seconds", "Highest time from the end of the pulse train to the decoded event.");
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        if (!r_dev->latency)
+            continue;
+        decoder_labels(labels, sizeof(labels), r_dev);
+        metrics_gauge(w, "decoder_latency_max_seconds", labels, r_dev->latency->max_ns * 1e-9);
+    }
+
+    metrics_family(w, "output_latency_seconds", METRICS_SUMMARY, "seconds", "Time from the end of the pulse train to the event passed to the output.");
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (!output || !output->latency)
+            continue;
+        snprintf(labels, sizeof(labels), "output=\"%u\"", (unsigned)i);
+        metrics_summary(w, "output_latency_seconds", labels, output->latency);
+    }
+    metrics_family(w, "output_latency_max_seconds", METRICS_GAUGE, "seconds", "Highest time from the end of the pulse train to the event passed to the output.");
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (!output || !output->latency)
+            continue;
+        snprintf(labels, sizeof(labels), "output=\"%u\"", (unsigned)i);
+        metrics_gauge(w, "output_latency_max_seconds", labels, output->latency->max_ns * 1e-9);
+    }
+
+    if (cfg->demod->wb_dedup) {
+        metrics_latency_t const *h = &cfg->demod->metrics.dedup_latency;
+        metrics_family(w, "dedup_latency_seconds", METRICS_SUMMARY, "seconds", "Time from the end of the pulse train to the event passing the deduplication.");
+        metrics_summary(w, "dedup_latency_seconds", NULL, h);
+        metrics_family(w, "dedup_latency_max_seconds", METRICS_GAUGE, "seconds", "Highest time from the end of the pulse train to the event passing the deduplication.");
+        metrics_gauge(w, "dedup_latency_max_seconds", NULL, h->max_ns * 1e-9);
+    }
+}
+
+static void openmetrics_pipeline(metrics_writer_t *w, metrics_pipeline_t const *p)
+{
+    char labels[64];
+
+    metrics_family(w, "pipeline_stage_seconds", METRICS_HISTOGRAM, "seconds", "Processing time per sample buffer of each pipeline stage.");
+    for (int i = 0; i < METRICS_STAGE_COUNT; ++i) {
+        labels[0] = '\0';
+        metrics_label(labels, sizeof(labels), "stage", metrics_stage_name(i));
+        metrics_histogram(w, "pipeline_stage_seconds", labels, &p->stage[i]);
+    }
+    metrics_family(w, "pipeline_realtime_margin", METRICS_GAUGE, NULL, "Share of the last sample buffer duration left after processing, negative if slower than realtime.");
+    metrics_gauge(w, "pipeline_realtime_margin", NULL, p->realtime_margin);
+    metrics_family(w, "pipeline_late_frames", METRICS_COUNTER, "frames", "Number of sample buffers processed slower than realtime.");
+    metrics_counter(w, "pipeline_late_frames", NULL, (double)p->frames_late);
+    metrics_family(w, "pipeline_input_seconds", METRICS_COUNTER, "seconds", "Duration of the processed samples.");
+    metrics_counter(w, "pipeline_input_seconds", NULL, p->input_seconds);
+    metrics_family(w, "pipeline_busy_seconds", METRICS_COUNTER, "seconds", "Time spent processing samples.");
+    metrics_counter(w, "pipeline_busy_seconds", NULL, p->busy_seconds);
+}
+
+static void openmetrics_write(metrics_writer_t *w, struct http_server_context *ctx)
+{
     r_cfg_t *cfg = ctx->cfg;
 
     time_t now;
     time(&now);
 
-    char buf[2000];
-    int len = snprintf(buf, sizeof(buf),
-            "# TYPE uptime_seconds counter\n"
-            "# UNIT uptime_seconds seconds\n"
-            "# HELP uptime_seconds Program uptime.\n"
-            "uptime_seconds_total %.1f\n"
-            "uptime_seconds_created %.1f\n"
-            "# TYPE decoder_enabled gauge\n"
-            "# HELP decoder_enabled Number of enabled decoders.\n"
-            "decoder_enabled %u\n"
-            "# TYPE input_uptime_seconds counter\n"
-            "# UNIT input_uptime_seconds seconds\n"
-            "# HELP input_uptime_seconds SDR Receiver uptime.\n"
-            "input_uptime_seconds_total %.1f\n"
-            "input_uptime_seconds_created %.1f\n"
-            "# TYPE input_count_frames counter\n"
-            "# UNIT input_count_frames frames\n"
-            "# HELP input_count_frames Number of SDR frames received.\n"
-            "input_count_frames_total %u\n"
-            "# TYPE input_squelch_frames counter\n"
-            "# UNIT input_squelch_frames frames\n"
-            "# HELP input_squelch_frames Number of SDR frames skipped by squelch.\n"
-            "input_squelch_frames_total %u\n"
-            "# TYPE input_ook_frames counter\n"
-            "# UNIT input_ook_frames frames\n"
-            "# HELP input_ook_frames Number of SDR frames with OOK demodulation.\n"
-            "input_ook_frames_total %u\n"
-            "# TYPE input_fsk_frames counter\n"
-            "# UNIT input_fsk_frames frames\n"
-            "# HELP input_fsk_frames Number of SDR frames with FSK demodulation.\n"
-            "input_fsk_frames_total %u\n"
-            "# TYPE input_event_frames counter\n"
-            "# UNIT input_event_frames frames\n"
-            "# HELP input_event_frames Number of SDR frames with decode events.\n"
-            "input_event_frames_total %u\n"
-            "# EOF\n",
-            (float)(now - cfg->running_since), // uptime_seconds_total,
-            (float)cfg->running_since,         // uptime_seconds_created,
-            (unsigned)cfg->demod->r_devs.len,  // decoder_enabled,
-            (float)(now - cfg->sdr_since),     // input_uptime_seconds_total,
-            (float)cfg->sdr_since,             // input_uptime_seconds_created,
-            cfg->total_frames_count,           // input_count_frames_total,
-            cfg->total_frames_squelch,         // input_squelch_frames_total,
-            cfg->total_frames_ook,             // input_ook_frames_total,
-            cfg->total_frames_fsk,             // input_fsk_frames_total,
-            cfg->total_frames_events);         // input_event_frames_total,
+    metrics_family(w, "uptime_seconds", METRICS_COUNTER, "seconds", "Program uptime.");
+    metrics_counter(w, "uptime_seconds", NULL, (float)(now - cfg->running_since));
+    metrics_sample(w, "uptime_seconds", "_created", NULL, (float)cfg->running_since);
+    metrics_family(w, "decoder_enabled", METRICS_GAUGE, NULL, "Number of enabled decoders.");
+    metrics_gauge(w, "decoder_enabled", NULL, cfg->demod->r_devs.len);
+    metrics_family(w, "input_uptime_seconds", METRICS_COUNTER, "seconds", "SDR Receiver uptime.");
+    metrics_counter(w, "input_uptime_seconds", NULL, (float)(now - cfg->sdr_since));
+    metrics_sample(w, "input_uptime_seconds", "_created", NULL, (float)cfg->sdr_since);
+    metrics_family(w, "input_count_frames", METRICS_COUNTER, "frames", "Number of SDR frames received.");
+    metrics_counter(w, "input_count_frames", NULL, cfg->total_frames_count);
+    metrics_family(w, "input_squelch_frames", METRICS_COUNTER, "frames", "Number of SDR frames skipped by squelch.");
+    metrics_counter(w, "input_squelch_frames", NULL, cfg->total_frames_squelch);
+    metrics_family(w, "input_ook_frames", METRICS_COUNTER, "frames", "Number of SDR frames with OOK demodulation.");
+    metrics_counter(w, "input_ook_frames", NULL, cfg->total_frames_ook);
+    metrics_family(w, "input_fsk_frames", METRICS_COUNTER, "frames", "Number of SDR frames with FSK demodulation.");
+    metrics_counter(w, "input_fsk_frames", NULL, cfg->total_frames_fsk);
+    metrics_family(w, "input_event_frames", METRICS_COUNTER, "frames", "Number of SDR frames with decode events.");
+    metrics_counter(w, "input_event_frames", NULL, cfg->total_frames_events);
+
+    openmetrics_decoders(w, &cfg->demod->r_devs);
+    openmetrics_channels(w, cfg);
+
+    metrics_family(w, "output_events", METRICS_COUNTER, NULL, "Number of events and log messages passed to the output.");
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (!output)
+            continue;
+        char labels[32];
+        snprintf(labels, sizeof(labels), "output=\"%u\"", (unsigned)i);
+        metrics_counter(w, "output_events", labels, output->events);
+    }
 
-    mg_printf(nc,
-            "HTTP/1.1 200 OK\r\n"
-            "Content-Length: %u\r\n"
-            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
-            "\r\n",
-            len);
-    mg_send(nc, buf, (size_t)len);
-    nc->flags |= MG_F_SEND_AND_CLOSE;
+    if (cfg->coalesce) {
+        uint64_t events, bursts;
+        coalesce_counts(cfg->coalesce, &events, &bursts);
+        metrics_family(w, "coalesce_events", METRICS_COUNTER, NULL, "Number of decoded events passed to the coalescing.");
+        metrics_counter(w, "coalesce_events", NULL, (double)events);
+        metrics_family(w, "coalesce_bursts", METRICS_COUNTER, NULL, "Number of coalesced bursts passed to the output.");
+        metrics_counter(w, "coalesce_bursts", NULL, (double)bursts);
+    }
+
+    openmetrics_latency(w, cfg);
+    openmetrics_pipeline(w, &cfg->demod->metrics);
+
+    metrics_family(w, "http_dropped_events", METRICS_COUNTER, NULL, "Number of events the HTTP server did not send, by reason.");
+    metrics_counter(w, "http_dropped_events", "reason=\"queue\"", (double)ATOMIC_LOAD(&ctx->dropped_queue));
+    metrics_counter(w, "http_dropped_events", "reason=\"backlog\"", (double)ATOMIC_LOAD(&ctx->dropped_backlog));
+    metrics_counter(w, "http_dropped_events", "reason=\"rate\"", (double)ATOMIC_LOAD(&ctx->dropped_rate));
 }
 
 // reply to ws command
@@ -1030,23 +1572,347 @@ static void rpc_response_jsoncmd(rpc_t *rpc, int ret_code, char const *message,
     mg_send_http_chunk(rpc->nc, "", 0); /* Send empty chunk, the end of response */
 }
 
+// main thread jobs
+
+enum http_job_type {
+    HTTP_JOB_RPC,
+    HTTP_JOB_META,
+    HTTP_JOB_METRICS,
+    HTTP_JOB_QUERY,
+};
+
+#define HTTP_JOB_REPLIES 4
+
+/// A command, the meta data, the metrics or a query, run on the main thread and
+/// answered from the server thread, rpc.nc is cleared if the client leaves.
+typedef struct {
+    rpc_t rpc;               ///< first member, the deferred response gets the job
+    int type;
+    rpc_response_fn respond; ///< sends the replies to the client
+    int (*parse)(rpc_t *rpc, struct mg_str const *json); ///< reads the request into rpc
+    char *request;           ///< the command as received, parsed on the main thread
+    size_t request_len;
+    unsigned num_replies;
+    struct {
+        int code;
+        char *message;
+        int arg;
+    } replies[HTTP_JOB_REPLIES];
+    char *body;              ///< the metrics text or the query result
+    size_t body_len;
+    int64_t since;           ///< the history to send after the meta data
+} http_job_t;
+
+static http_job_t *http_job_new(struct mg_connection *nc, int type, rpc_response_fn respond)
+{
+    http_job_t *job = calloc(1, sizeof(*job));
+    if (!job) {
+        WARN_CALLOC("http_job_new()");
+        return NULL;
+    }
+    job->rpc.nc  = nc;
+    job->type    = type;
+    job->respond = respond;
+    return job;
+}
+
+static void http_job_free(void *p)
+{
+    http_job_t *job = p;
+    free(job->rpc.method);
+    free(job->rpc.arg);
+    free(job->rpc.id);
+    free(job->request);
+    for (unsigned i = 0; i < job->num_replies; ++i)
+        free(job->replies[i].message);
+    free(job->body);
+    free(job);
+}
+
+/// Keep a copy of the request, the parser logs and must run on the main thread.
+static int http_job_request(http_job_t *job, int (*parse)(rpc_t *, struct mg_str const *), char const *data, size_t len)
+{
+    job->request = malloc(len + 1);
+    if (!job->request) {
+        WARN_MALLOC("http_job_request()");
+        return -1;
+    }
+    memcpy(job->request, data, len);
+    job->request[len] = '\0';
+    job->request_len  = len;
+    job->parse        = parse;
+    return 0;
+}
+
+// keep a reply for the server thread
+static void rpc_response_deferred(rpc_t *rpc, int ret_code, char const *message, int arg)
+{
+    http_job_t *job = (http_job_t *)rpc;
+    if (job->num_replies >= HTTP_JOB_REPLIES)
+        return;
+
+    char *dup = NULL;
+    if (message) {
+        dup = strdup(message);
+        if (!dup) {
+            WARN_STRDUP("rpc_response_deferred()");
+            ret_code = 0; // reply with a null result
+        }
+    }
+    job->replies[job->num_replies].code    = ret_code;
+    job->replies[job->num_replies].message = dup;
+    job->replies[job->num_replies].arg     = arg;
+    job->num_replies++;
+}
+
+static void openmetrics_append(void *ctx, char const *buf, size_t len)
+{
+    http_job_t *job = ctx;
+    char *body = realloc(job->body, job->body_len + len);
+    if (!body) {
+        WARN_REALLOC("openmetrics_append()");
+        return;
+    }
+    memcpy(body + job->body_len, buf, len);
+    job->body = body;
+    job->body_len += len;
+}
+
+/// Get the query of an event store command, NULL if the method is not one.
+static char const *store_query_name(char const *method)
+{
+    static char const *const names[] = {"latest", "events", "counts"};
+    if (!method || strncmp(method, "query_", 6))
+        return NULL;
+    for (size_t i = 0; i < sizeof(names) / sizeof(*names); ++i) {
+        if (!strcmp(method + 6, names[i]))
+            return names[i];
+    }
+    return NULL;
+}
+
+/// Run an event store query, on the main thread.  Returns the JSON result or NULL.
+static char *store_query(struct http_server_context *ctx, char const *name, char const *query, size_t *len)
+{
+    if (!ctx->store)
+        return NULL;
+    struct mg_str q = mg_mk_str(query ? query : "");
+    char model[EVENT_FILTER_LEN];
+    char id[EVENT_FILTER_LEN];
+    char val[32];
+    int has_model = mg_get_http_var(&q, "model", model, sizeof(model)) > 0;
+    int has_id    = mg_get_http_var(&q, "id", id, sizeof(id)) > 0;
+    double since  = 0.0;
+    if (mg_get_http_var(&q, "since", val, sizeof(val)) > 0)
+        since = atof(val);
+    if (mg_get_http_var(&q, "age", val, sizeof(val)) > 0)
+        since = mg_time() - atof(val);
+    unsigned limit = HTTP_QUERY_LIMIT;
+    if (mg_get_http_var(&q, "limit", val, sizeof(val)) > 0)
+        limit = (unsigned)strtoul(val, NULL, 10);
+    if (limit > HTTP_QUERY_MAX_LIMIT)
+        limit = HTTP_QUERY_MAX_LIMIT;
+
+    char *buf = malloc(HTTP_QUERY_SIZE);
+    if (!buf) {
+        WARN_MALLOC("store_query()");
+        return NULL;
+    }
+    char const *m = has_model ? model : NULL;
+    if (!strcmp(name, "latest"))
+        *len = event_store_latest(ctx->store, m, buf, HTTP_QUERY_SIZE);
+    else if (!strcmp(name, "events"))
+        *len = event_store_events(ctx->store, m, has_id ? id : NULL, since, limit, buf, HTTP_QUERY_SIZE);
+    else
+        *len = event_store_minutes(ctx->store, m, since, buf, HTTP_QUERY_SIZE);
+    return buf;
+}
+
+/// Run a job on the main thread.
+static void http_job_run(struct http_server_context *ctx, http_job_t *job)
+{
+    if (job->parse) {
+        struct mg_str json = {job->request, job->request_len};
+        if (job->parse(&job->rpc, &json) < 0) {
+            rpc_response_deferred(&job->rpc, -1, "Invalid command", 0);
+            return;
+        }
+    }
+    char const *query_name = job->type == HTTP_JOB_RPC ? store_query_name(job->rpc.method) : NULL;
+    if (query_name) {
+        job->rpc.response = rpc_response_deferred;
+        size_t len;
+        char *result = store_query(ctx, query_name, job->rpc.arg, &len);
+        if (result)
+            job->rpc.response(&job->rpc, 1, result, 0);
+        else
+            job->rpc.response(&job->rpc, -1, "Event store not available", 0);
+        free(result);
+    }
+    else if (job->type == HTTP_JOB_RPC) {
+        job->rpc.response = rpc_response_deferred;
+        rpc_exec(&job->rpc, ctx->cfg);
+    }
+    else if (job->type == HTTP_JOB_META) {
+        data_t *meta = meta_data(ctx->cfg);
+        data_output_print(ctx->output, meta);
+        data_free(meta);
+    }
+    else if (job->type == HTTP_JOB_QUERY) {
+        job->body = store_query(ctx, job->rpc.method, job->rpc.arg, &job->body_len);
+    }
+    else {
+        metrics_writer_t w;
+        metrics_writer_init(&w, openmetrics_append, job);
+        openmetrics_write(&w, ctx);
+        metrics_finish(&w);
+    }
+}
+
+/// Send the result of a job to the client, on the server thread.
+static void http_job_reply(struct http_server_context *ctx, http_job_t *job)
+{
+    struct mg_connection *nc = job->rpc.nc;
+    if (!nc)
+        return; // the client is gone
+
+    if (job->type == HTTP_JOB_RPC) {
+        job->rpc.response = job->respond;
+        for (unsigned i = 0; i < job->num_replies; ++i)
+            job->respond(&job->rpc, job->replies[i].code, job->replies[i].message, job->replies[i].arg);
+    }
+    else if (job->type == HTTP_JOB_META) {
+        /* Send history, the meta data was just broadcast */
+        http_client_history(ctx, nc, job->since);
+    }
+    else if (job->type == HTTP_JOB_QUERY) {
+        if (!job->body) {
+            mg_http_send_error(nc, 503, NULL); // 503 Service Unavailable
+            return;
+        }
+        mg_send_head(nc, 200, (int64_t)job->body_len,
+                "Content-Type: application/json\r\n"
+                "Access-Control-Allow-Origin: *");
+        mg_send(nc, job->body, (int)job->body_len);
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+    }
+    else {
+        mg_printf(nc,
+                "HTTP/1.1 200 OK\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                "\r\n");
+        if (job->body_len)
+            mg_send_http_chunk(nc, job->body, job->body_len);
+        mg_send_http_chunk(nc, "", 0); /* Send empty chunk, the end of response */
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+    }
+}
+
+#ifdef THREADS
+/// Write a byte to wake a thread, unless a wake is still pending.
+static void http_wake(sock_t sock, long *pending)
+{
+    if (!ATOMIC_XCHG(pending, 1))
+        send(sock, "", 1, 0);
+}
+#endif
+
+/// Pass a job to the main thread, the reply is sent when it is done.
+static void http_job_submit(struct http_server_context *ctx, http_job_t *job)
+{
+#ifdef THREADS
+    // the reply queue has room for every job in flight
+    if (ctx->inflight.len >= HTTP_QUEUE_SIZE || event_queue_push(ctx->jobs, job) < 0) {
+        // the main thread is stuck, answer right away
+        if (job->type == HTTP_JOB_RPC)
+            job->respond(&job->rpc, -1, "Server busy", 0);
+        else if (job->type == HTTP_JOB_METRICS || job->type == HTTP_JOB_QUERY)
+            mg_http_send_error(job->rpc.nc, 503, NULL); // 503 Service Unavailable
+        http_job_free(job);
+        return;
+    }
+    list_push(&ctx->inflight, job);
+    http_wake(ctx->main_wake[0], &ctx->main_wake_pending);
+#else
+    http_job_run(ctx, job);
+    http_job_reply(ctx, job);
+    http_job_free(job);
+#endif
+}
+
+/// Forget the client of the jobs in flight, on close.
+static void http_job_cancel(struct http_server_context *ctx, struct mg_connection *nc)
+{
+    for (size_t i = 0; i < ctx->inflight.len; ++i) {
+        http_job_t *job = ctx->inflight.elems[i];
+        if (job->rpc.nc == nc)
+            job->rpc.nc = NULL;
+    }
+}
+
+#ifdef THREADS
+/// Reply to a finished job, on the server thread.
+static void http_job_done(struct http_server_context *ctx, http_job_t *job)
+{
+    for (size_t i = 0; i < ctx->inflight.len; ++i) {
+        if (ctx->inflight.elems[i] == job) {
+            list_remove(&ctx->inflight, i, NULL);
+            break;
+        }
+    }
+    http_job_reply(ctx, job);
+    http_job_free(job);
+}
+
+/// Run the jobs passed to the main thread, on a wake from the server thread.
+static void main_wake_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    UNUSED(ev_data);
+    struct http_server_context *ctx = nc->user_data;
+    if (ev != MG_EV_RECV || !ctx)
+        return;
+    mbuf_remove(&nc->recv_mbuf, nc->recv_mbuf.len);
+    ATOMIC_XCHG(&ctx->main_wake_pending, 0);
+
+    http_job_t *job;
+    while ((job = event_queue_pop(ctx->jobs))) {
+        http_job_run(ctx, job);
+        event_queue_push(ctx->replies, job);
+        http_wake(ctx->server_wake[0], &ctx->server_wake_pending);
+    }
+}
+#endif
+
+/// Mark an event client and send the history it asked for, the query selects the events.
+static void http_client_join(struct mg_connection *nc, struct mg_str const *query, int is_chunked, int is_cbor)
+{
+    struct http_server_context *ctx = nc->user_data;
+    struct nc_context *cctx         = http_client_new(ctx, query, is_chunked, is_cbor);
+    if (!cctx)
+        return;
+    nc->user_data = cctx;
+    nc->flags |= MG_F_STREAM;
+    if (is_cbor)
+        ATOMIC_ADD(&ctx->cbor_clients, 1);
+
+    int64_t since = query_since(query);
+    if (since >= 0)
+        http_client_history(ctx, nc, since);
+}
+
 // {"cmd":"sample_rate","val":1024000}
 // http --stream --timeout=70 :8433/events
 //s.a. https://developer.twitter.com/en/docs/tutorials/consuming-streaming-data.html
 static void handle_json_events(struct mg_connection *nc, struct http_message *hm)
 {
-    UNUSED(hm);
+    int is_cbor = wants_cbor(hm);
     /* Send headers */
-    mg_printf(nc, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+    mg_printf(nc, "HTTP/1.1 200 OK\r\n%sTransfer-Encoding: chunked\r\n\r\n",
+            is_cbor ? "Content-Type: application/cbor-seq\r\n" : "");
 
     /* Mark connection */
-    struct nc_context *ctx = calloc(1, sizeof(*ctx));
-    if (!ctx) {
-        WARN_CALLOC("handle_json_events()");
-        return;
-    }
-    ctx->is_chunked = 1;
-    nc->user_data   = ctx;
+    http_client_join(nc, &hm->query_string, 1, is_cbor);
 
     mg_set_timer(nc, mg_time() + KEEP_ALIVE); // set keep alive timer
 }
@@ -1054,18 +1920,13 @@ static void handle_json_events(struct mg_connection *nc, struct http_message *hm
 // (echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433
 static void handle_json_stream(struct mg_connection *nc, struct http_message *hm)
 {
-    UNUSED(hm);
+    int is_cbor = wants_cbor(hm);
     /* Send headers */
-    mg_printf(nc, "HTTP/1.1 200 OK\r\n\r\n");
+    mg_printf(nc, "HTTP/1.1 200 OK\r\n%s\r\n",
+            is_cbor ? "Content-Type: application/cbor-seq\r\n" : "");
 
     /* Mark connection */
-    struct nc_context *ctx = calloc(1, sizeof(*ctx));
-    if (!ctx) {
-        WARN_CALLOC("handle_json_stream()");
-        return;
-    }
-    ctx->is_chunked = 0;
-    nc->user_data   = ctx;
+    http_client_join(nc, &hm->query_string, 0, is_cbor);
 
     mg_set_timer(nc, mg_time() + KEEP_ALIVE); // set keep alive timer
 }
@@ -1082,12 +1943,12 @@ static void handle_cmd_rpc(struct mg_connection *nc, struct http_message *hm)
 {
     struct http_server_context *ctx = nc->user_data;
     char cmd[100], arg[100], val[100];
-    rpc_t rpc = {
-            .nc = nc,
-            .response = rpc_response_jsoncmd,
-            .method = cmd,
-            .arg = arg,
-    };
+
+    http_job_t *job = http_job_new(nc, HTTP_JOB_RPC, rpc_response_jsoncmd);
+    if (!job) {
+        mg_http_send_error(nc, 500, NULL); // 500 Internal Server Error
+        return;
+    }
 
     /* Send headers */
     mg_printf(nc, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
@@ -1105,10 +1966,17 @@ static void handle_cmd_rpc(struct mg_connection *nc, struct http_message *hm)
         mg_get_http_var(&hm->body, "val", val, sizeof(val));
     }
     char *endptr = NULL;
-    rpc.val = strtol(val, &endptr, 10);
-    fprintf(stderr, "POST Got %s, arg %s, val %s (%u)\n", cmd, arg, val, rpc.val);
+    job->rpc.val = strtol(val, &endptr, 10);
+    fprintf(stderr, "POST Got %s, arg %s, val %s (%u)\n", cmd, arg, val, job->rpc.val);
+
+    job->rpc.method = strdup(cmd);
+    if (!job->rpc.method)
+        WARN_STRDUP("handle_cmd_rpc()");
+    job->rpc.arg = strdup(arg);
+    if (!job->rpc.arg)
+        WARN_STRDUP("handle_cmd_rpc()");
 
-    rpc_exec(&rpc, ctx->cfg);
+    http_job_submit(ctx, job);
 }
 
 // Handles POST with JSONRPC command
@@ -1117,54 +1985,262 @@ static void handle_json_rpc(struct mg_connection *nc, struct http_message *hm)
 {
     struct http_server_context *ctx = nc->user_data;
 
-    rpc_t rpc = {
-            .nc       = nc,
-            .response = rpc_response_jsonrpc,
-    };
+    http_job_t *job = http_job_new(nc, HTTP_JOB_RPC, rpc_response_jsonrpc);
+    if (!job) {
+        mg_http_send_error(nc, 500, NULL); // 500 Internal Server Error
+        return;
+    }
 
     /* Send headers */
     mg_printf(nc, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
 
-    /* Parse JSON */
-    int ret = jsonrpc_parse(&rpc, &hm->body);
-    if (!ret) {
-        rpc_exec(&rpc, ctx->cfg);
-    }
-    else {
-        char *error = "{\"error\":\"Invalid command\"}";
-        mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, error, strlen(error));
+    /* Parse JSON on the main thread */
+    if (http_job_request(job, jsonrpc_parse, hm->body.p, hm->body.len) < 0) {
+        job->respond(&job->rpc, -1, "Out of memory", 0);
+        http_job_free(job);
+        return;
     }
-
-    free(rpc.method);
-    free(rpc.id);
-    free(rpc.arg);
+    http_job_submit(ctx, job);
 }
 
 // Handles WS with JSON command
 static void handle_ws_rpc(struct mg_connection *nc, struct websocket_message *wm)
 {
+    struct nc_context *cctx         = nc->user_data;
+    struct http_server_context *ctx = cctx->server;
+
+    http_job_t *job = http_job_new(nc, HTTP_JOB_RPC, rpc_response_ws);
+    if (!job)
+        return;
+
+    /* Parse JSON on the main thread */
+    if (http_job_request(job, json_parse, (char const *)wm->data, wm->size) < 0) {
+        job->respond(&job->rpc, -1, "Out of memory", 0);
+        http_job_free(job);
+        return;
+    }
+    http_job_submit(ctx, job);
+}
+
+// Serves the metrics, collected on the main thread
+static void handle_openmetrics(struct mg_connection *nc, struct http_message *hm)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+
     struct http_server_context *ctx = nc->user_data;
+    http_job_t *job = http_job_new(nc, HTTP_JOB_METRICS, NULL);
+    if (!job) {
+        mg_http_send_error(nc, 500, NULL); // 500 Internal Server Error
+        return;
+    }
+    http_job_submit(ctx, job);
+}
 
-    rpc_t rpc = {
-            .nc       = nc,
-            .response = rpc_response_ws,
-    };
+// Serves the event store queries, run on the main thread
+static void handle_api_query(struct mg_connection *nc, struct http_message *hm)
+{
+    if (mg_vcmp(&hm->method, "GET") != 0) {
+        mg_http_send_error(nc, 405, NULL); // 405 Method Not Allowed
+        return;
+    }
+    char method[32];
+    snprintf(method, sizeof(method), "query_%.*s", (int)(hm->uri.len > 5 ? hm->uri.len - 5 : 0), hm->uri.p + 5);
+    char const *name = store_query_name(method);
+    if (!name) {
+        mg_http_send_error(nc, 404, NULL);
+        return;
+    }
 
-    struct mg_str d = {(char *)wm->data, wm->size};
+    struct http_server_context *ctx = nc->user_data;
+    http_job_t *job = http_job_new(nc, HTTP_JOB_QUERY, NULL);
+    if (!job) {
+        mg_http_send_error(nc, 500, NULL); // 500 Internal Server Error
+        return;
+    }
+    job->rpc.method = strdup(name);
+    if (!job->rpc.method) {
+        WARN_STRDUP("handle_api_query()");
+        http_job_free(job);
+        mg_http_send_error(nc, 500, NULL); // 500 Internal Server Error
+        return;
+    }
+    job->rpc.arg = malloc(hm->query_string.len + 1);
+    if (!job->rpc.arg) {
+        WARN_MALLOC("handle_api_query()");
+        http_job_free(job);
+        mg_http_send_error(nc, 500, NULL); // 500 Internal Server Error
+        return;
+    }
+    memcpy(job->rpc.arg, hm->query_string.p, hm->query_string.len);
+    job->rpc.arg[hm->query_string.len] = '\0';
+    http_job_submit(ctx, job);
+}
+
+// spectrum websocket
+
+/// Websocket connections of the spectrum endpoint, these get no events.
+#define MG_F_SPECTRUM MG_F_USER_1
+
+/// Frames are skipped for a viewer with more than this still to send.
+#define SPECTRUM_BACKLOG (4 * (SPECTRUM_HEADER_LEN + SPECTRUM_FFT_SIZE))
+/// A viewer due a frame that is not there yet checks again after this share of its interval.
+#define SPECTRUM_RETRY 0.25
 
-    /* Parse JSON */
-    int ret = json_parse(&rpc, &d);
-    if (!ret) {
-        rpc_exec(&rpc, ctx->cfg);
+typedef struct {
+    struct mg_connection *nc;
+    int source;
+    unsigned fps;
+    unsigned bins;
+    double next;  ///< time the next frame is due
+    uint32_t seq; ///< sequence number of the last frame sent
+} spectrum_client_t;
+
+static spectrum_client_t *spectrum_client(struct http_server_context *ctx, struct mg_connection *nc, size_t *idx)
+{
+    for (size_t i = 0; i < ctx->spectrum_clients.len; ++i) {
+        spectrum_client_t *cl = ctx->spectrum_clients.elems[i];
+        if (cl->nc == nc) {
+            if (idx)
+                *idx = i;
+            return cl;
+        }
+    }
+    return NULL;
+}
+
+/// Compute the FFT at the rate of the fastest viewer, not at all without one.
+static void spectrum_update_interval(struct http_server_context *ctx)
+{
+    r_cfg_t *cfg = ctx->cfg;
+    unsigned fps = 0;
+    for (size_t i = 0; i < ctx->spectrum_clients.len; ++i) {
+        spectrum_client_t *cl = ctx->spectrum_clients.elems[i];
+        if (cl->source == SPECTRUM_SOURCE_FFT && cl->fps > fps)
+            fps = cl->fps;
+    }
+    if (cfg->spectrum)
+        spectrum_set_interval(cfg->spectrum, fps ? 1.0 / fps : 0.0);
+}
+
+/// Apply a `source=&fps=&bins=` query and confirm the granted settings.
+static void spectrum_configure(struct http_server_context *ctx, spectrum_client_t *cl, struct mg_str const *query)
+{
+    char val[16];
+    if (mg_get_http_var(query, "source", val, sizeof(val)) > 0)
+        cl->source = !strcmp(val, "channels") ? SPECTRUM_SOURCE_CHANNELS : SPECTRUM_SOURCE_FFT;
+    if (mg_get_http_var(query, "fps", val, sizeof(val)) > 0) {
+        int fps = atoiv(val, SPECTRUM_DEFAULT_FPS);
+        cl->fps = fps < 1 ? 1 : fps > SPECTRUM_MAX_FPS ? SPECTRUM_MAX_FPS : (unsigned)fps;
+    }
+    if (mg_get_http_var(query, "bins", val, sizeof(val)) > 0) {
+        int bins = atoiv(val, SPECTRUM_DEFAULT_BINS);
+        cl->bins = bins < SPECTRUM_MIN_BINS ? SPECTRUM_MIN_BINS : bins > SPECTRUM_FFT_SIZE ? SPECTRUM_FFT_SIZE : (unsigned)bins;
+    }
+    cl->next = 0.0; // send the next frame right away
+    mg_set_timer(cl->nc, mg_time());
+
+    char reply[128];
+    int len = snprintf(reply, sizeof(reply), "{\"spectrum\":{\"source\":\"%s\",\"fps\":%u,\"bins\":%u,\"fft_size\":%u}}",
+            cl->source == SPECTRUM_SOURCE_CHANNELS ? "channels" : "fft", cl->fps, cl->bins, SPECTRUM_FFT_SIZE);
+    mg_send_websocket_frame(cl->nc, WEBSOCKET_OP_TEXT, reply, (size_t)len);
+
+    spectrum_update_interval(ctx);
+}
+
+static void spectrum_join(struct http_server_context *ctx, struct mg_connection *nc, struct http_message *hm)
+{
+    spectrum_client_t *cl = calloc(1, sizeof(*cl));
+    if (!cl) {
+        WARN_CALLOC("spectrum_join()");
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+        return;
+    }
+    cl->nc     = nc;
+    cl->source = SPECTRUM_SOURCE_FFT;
+    cl->fps    = SPECTRUM_DEFAULT_FPS;
+    cl->bins   = SPECTRUM_DEFAULT_BINS;
+    list_push(&ctx->spectrum_clients, cl);
+    nc->flags |= MG_F_SPECTRUM;
+    spectrum_configure(ctx, cl, &hm->query_string);
+}
+
+static void spectrum_leave(struct http_server_context *ctx, struct mg_connection *nc)
+{
+    size_t idx;
+    if (spectrum_client(ctx, nc, &idx)) {
+        list_remove(&ctx->spectrum_clients, idx, free);
+        spectrum_update_interval(ctx);
+    }
+}
+
+/// Encode the smoothed power of the wideband channels, in order of frequency.
+static size_t spectrum_channels_frame(r_cfg_t *cfg, uint8_t *buf, size_t size, unsigned bins, uint32_t seq)
+{
+    float freqs[SPECTRUM_MAX_CHANNELS];
+    float levels[SPECTRUM_MAX_CHANNELS];
+    unsigned n = cfg->spectrum ? spectrum_read_channels(cfg->spectrum, freqs, levels) : 0;
+    if (n < 2)
+        return 0;
+
+    // each channel is one bin, the span covers the outer channels in full
+    double lo = freqs[0];
+    double hi = freqs[n - 1];
+    uint32_t center = (uint32_t)((lo + hi) / 2);
+    uint32_t span   = (uint32_t)((hi - lo) * n / (n - 1));
+    return spectrum_frame(buf, size, SPECTRUM_SOURCE_CHANNELS, seq, center, span, levels, n, bins);
+}
+
+/// Send a frame to a viewer if one is due, on its timer, and arm the timer for the next.
+static void spectrum_send(struct http_server_context *ctx, struct mg_connection *nc)
+{
+    r_cfg_t *cfg          = ctx->cfg;
+    spectrum_client_t *cl = spectrum_client(ctx, nc, NULL);
+    double now            = mg_time();
+    if (!cl)
+        return;
+    double interval = 1.0 / cl->fps;
+    if (now < cl->next) {
+        mg_set_timer(nc, cl->next);
+        return;
+    }
+    // the receive thread computes frames on its own cadence, check again shortly
+    mg_set_timer(nc, now + interval * SPECTRUM_RETRY);
+
+    if (cl->source == SPECTRUM_SOURCE_CHANNELS) {
+        uint8_t buf[SPECTRUM_HEADER_LEN + SPECTRUM_MAX_CHANNELS];
+        uint32_t seq = cl->seq + 1 ? cl->seq + 1 : 1;
+        size_t len   = spectrum_channels_frame(cfg, buf, sizeof(buf), cl->bins, seq);
+        if (!len)
+            return;
+        if (nc->send_mbuf.len <= SPECTRUM_BACKLOG)
+            mg_send_websocket_frame(nc, WEBSOCKET_OP_BINARY, buf, len);
+        cl->seq = seq;
     }
     else {
-        char *error = "{\"error\":\"Invalid command\"}";
-        mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, error, strlen(error));
+        if (!cfg->spectrum || !ctx->spectrum_levels)
+            return;
+        uint32_t center, span;
+        uint32_t seq = spectrum_read(cfg->spectrum, ctx->spectrum_levels, ctx->spectrum_levels_seq, &center, &span);
+        ctx->spectrum_levels_seq = seq;
+        if (!seq || seq == cl->seq)
+            return; // no new FFT yet
+        if (seq != ctx->spectrum_frame_seq || cl->bins != ctx->spectrum_frame_bins) {
+            ctx->spectrum_frame_len  = spectrum_frame(ctx->spectrum_frame, sizeof(ctx->spectrum_frame), SPECTRUM_SOURCE_FFT,
+                    seq, center, span, ctx->spectrum_levels, spectrum_size(cfg->spectrum), cl->bins);
+            ctx->spectrum_frame_seq  = seq;
+            ctx->spectrum_frame_bins = cl->bins;
+        }
+        if (nc->send_mbuf.len <= SPECTRUM_BACKLOG)
+            mg_send_websocket_frame(nc, WEBSOCKET_OP_BINARY, ctx->spectrum_frame, ctx->spectrum_frame_len);
+        cl->seq = seq;
     }
 
-    free(rpc.method);
-    free(rpc.id);
-    free(rpc.arg);
+    // keep the cadence, unless the viewer fell behind
+    cl->next = now - cl->next > interval ? now + interval : cl->next + interval;
+    mg_set_timer(nc, cl->next);
 }
 
 static void ev_handler(struct mg_connection *nc, int ev, void *ev_data);
@@ -1178,11 +2254,14 @@ static void send_keep_alive(struct mg_connection *nc)
     if (!ctx)
         return; // this should not happen
 
+    // an empty CBOR map keeps the CBOR sequence valid
+    char const *keep_alive = ctx->is_cbor ? "\xa0" : "\r\n";
+    size_t len             = ctx->is_cbor ? 1 : 2;
     if (ctx->is_chunked) {
-        mg_send_http_chunk(nc, "\r\n", 2);
+        mg_send_http_chunk(nc, keep_alive, len);
     }
     else {
-        mg_send(nc, "\r\n", 2);
+        mg_send(nc, keep_alive, len);
     }
     mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
 }
@@ -1191,22 +2270,46 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
 {
     switch (ev) {
     case MG_EV_TIMER:
-        send_keep_alive(nc);
+        // spectrum viewers have no nc_context, their timer paces the frames
+        if (nc->flags & MG_F_SPECTRUM)
+            spectrum_send(nc->user_data, nc);
+        else
+            send_keep_alive(nc);
         break;
     case MG_EV_WEBSOCKET_HANDSHAKE_DONE: {
         struct http_server_context *ctx = nc->user_data;
-        /* New websocket connection. Send meta. */
-        data_t *meta = meta_data(ctx->cfg);
-        data_output_print(ctx->output, meta);
-        data_free(meta);
-        /* Send history */
-        for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, (char *)*iter, strlen((char *)*iter));
+        struct http_message *hm         = (struct http_message *)ev_data;
+        if (mg_vcmp(&hm->uri, "/spectrum") == 0) {
+            spectrum_join(ctx, nc, hm);
+            break;
+        }
+        /* New websocket connection. Send meta, then the history. */
+        struct nc_context *cctx = http_client_new(ctx, &hm->query_string, 0, 0);
+        if (!cctx) {
+            nc->flags |= MG_F_SEND_AND_CLOSE;
+            break;
+        }
+        nc->user_data = cctx;
+        nc->flags |= MG_F_STREAM;
+        http_job_t *job = http_job_new(nc, HTTP_JOB_META, NULL);
+        if (job) {
+            int64_t since = query_since(&hm->query_string);
+            job->since    = since < 0 ? 0 : since;
+            http_job_submit(ctx, job);
+        }
         break;
     }
     case MG_EV_WEBSOCKET_FRAME: {
         struct websocket_message *wm = (struct websocket_message *)ev_data;
 
+        if (nc->flags & MG_F_SPECTRUM) {
+            struct http_server_context *ctx = nc->user_data;
+            struct mg_str query             = {(char *)wm->data, wm->size};
+            spectrum_client_t *cl           = spectrum_client(ctx, nc, NULL);
+            if (cl)
+                spectrum_configure(ctx, cl, &query);
+            break;
+        }
         handle_ws_rpc(nc, wm);
         break;
     }
@@ -1238,8 +2341,8 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
         else if (mg_vcmp(&hm->uri, "/metrics") == 0) {
             handle_openmetrics(nc, hm);
         }
-        else if (mg_vcmp(&hm->uri, "/api") == 0) {
-            //handle_api_query(nc, hm);
+        else if (hm->uri.len > 5 && !strncmp(hm->uri.p, "/api/", 5)) {
+            handle_api_query(nc, hm);
         }
         else {
             const webui_asset_t *asset = find_webui_asset(&hm->uri);
@@ -1261,50 +2364,192 @@ static void ev_handler(struct mg_connection *nc, int ev, void *ev_data)
     }
     case MG_EV_CLOSE:
         //fprintf(stderr, "MG_EV_CLOSE %p %p %p\n", ev_data, nc, nc->user_data);
+        if (nc->flags & MG_F_STREAM) {
+            struct nc_context *cctx = nc->user_data;
+            if (cctx->is_cbor)
+                ATOMIC_ADD(&cctx->server->cbor_clients, -1);
+            http_job_cancel(cctx->server, nc);
+            free(cctx);
+            nc->user_data = NULL;
+        }
+        else if (nc->user_data) {
+            if (nc->flags & MG_F_SPECTRUM)
+                spectrum_leave(nc->user_data, nc);
+            http_job_cancel(nc->user_data, nc);
+        }
         break;
     default:
         break;
     }
 }
 
-static int is_websocket(const struct mg_connection *nc)
-{
-    return nc->flags & MG_F_IS_WEBSOCKET;
-}
-
-// event handler to broadcast to all our sockets
-static void http_broadcast_send(struct http_server_context *ctx, char const *msg, size_t len)
+// send to all our event clients that want the message, on the server thread
+static void http_broadcast_send(struct http_server_context *ctx, http_msg_t *msg)
 {
     struct mg_connection *nc;
-    struct mg_mgr *mgr = ctx->conn->mgr;
+    struct mg_mgr *mgr = ctx->mgr;
+    double now         = mg_time();
+
+    msg->seq = ++ctx->last_seq;
+    http_msg_release(ring_list_push(ctx->history, http_msg_retain(msg)));
+
+    for (nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
+        if (nc->handler != ev_handler || !(nc->flags & MG_F_STREAM))
+            continue; // spectrum viewers and requests get no events
 
-    char *dup = strdup(msg);
-    if (!dup) {
-        WARN_STRDUP("http_broadcast_send()");
+        struct nc_context *cctx = nc->user_data;
+        if (!http_client_wants(cctx, msg))
+            continue;
+        if (nc->send_mbuf.len > HTTP_SEND_LIMIT)
+            ATOMIC_ADD(&ctx->dropped_backlog, 1); // the client can not keep up
+        else if (!http_client_take(cctx, msg, now))
+            ATOMIC_ADD(&ctx->dropped_rate, 1);
+        else
+            http_client_send(nc, cctx, msg);
     }
-    else {
-        free(ring_list_push(ctx->history, dup));
+}
+
+/// Hand an event to the server thread, takes the reference of @p msg.
+static void http_server_post(struct http_server_context *ctx, http_msg_t *msg)
+{
+#ifdef THREADS
+    if (event_queue_push(ctx->events, msg) < 0) {
+        ATOMIC_ADD(&ctx->dropped_queue, 1);
+        http_msg_release(msg);
+        return;
     }
+    http_wake(ctx->server_wake[0], &ctx->server_wake_pending);
+#else
+    http_broadcast_send(ctx, msg);
+    http_msg_release(msg);
+#endif
+}
 
-    for (nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
-        if (nc->handler != ev_handler)
+#define SHUTDOWN_JSON "{\"shutdown\":\"goodbye\"}"
+
+// close the server and all connections with a goodbye, on the server thread
+static void http_server_goodbye(struct http_server_context *ctx)
+{
+    // close the server
+    ctx->conn->user_data = NULL;
+    ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+
+    struct mg_mgr *mgr = ctx->mgr;
+    for (struct mg_connection *nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
+        if (nc->handler != ev_handler || nc == ctx->conn)
             continue;
 
-        struct nc_context *cctx = nc->user_data; // might not be valid
-        if (is_websocket(nc)) {
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, msg, len);
+        // other connections carry the server context, not an nc_context
+        struct nc_context *cctx = nc->flags & MG_F_STREAM ? nc->user_data : NULL;
+        if (nc->flags & MG_F_SPECTRUM) {
+            // viewers get no goodbye
+        }
+        else if (is_websocket(nc)) {
+            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
+        }
+        else if (cctx && cctx->is_cbor) {
+            if (cctx->is_chunked)
+                mg_send_http_chunk(nc, "", 0); /* Send empty chunk, the end of response */
         }
         else if (cctx && cctx->is_chunked) {
-            mg_send_http_chunk(nc, msg, len);
+            mg_send_http_chunk(nc, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
             mg_send_http_chunk(nc, "\r\n", 2);
-            mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
+            mg_send_http_chunk(nc, "", 0);            /* Send empty chunk, the end of response */
         }
         else if (cctx && !cctx->is_chunked) {
-            mg_send(nc, msg, len);
+            mg_send(nc, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
             mg_send(nc, "\r\n", 2);
-            mg_set_timer(nc, mg_time() + KEEP_ALIVE); // reset keep alive timer
         }
+
+        // the connections are closed later, after the context is gone
+        free(cctx);
+        nc->user_data = NULL;
+        nc->flags &= ~(MG_F_STREAM | MG_F_SPECTRUM);
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+    }
+    list_free_elems(&ctx->spectrum_clients, free);
+}
+
+#ifdef THREADS
+/// Send the queued events and the replies of finished jobs, on the server thread.
+static void http_server_drain(struct http_server_context *ctx)
+{
+    http_msg_t *msg;
+    while ((msg = event_queue_pop(ctx->events))) {
+        http_broadcast_send(ctx, msg);
+        http_msg_release(msg);
+    }
+    http_job_t *job;
+    while ((job = event_queue_pop(ctx->replies)))
+        http_job_done(ctx, job);
+}
+
+static void server_wake_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    UNUSED(ev_data);
+    struct http_server_context *ctx = nc->user_data;
+    if (ev != MG_EV_RECV)
+        return;
+    mbuf_remove(&nc->recv_mbuf, nc->recv_mbuf.len);
+    ATOMIC_XCHG(&ctx->server_wake_pending, 0);
+    http_server_drain(ctx);
+}
+
+static THREAD_RETURN THREAD_CALL http_server_thread(void *arg)
+{
+    struct http_server_context *ctx = arg;
+
+    while (!ATOMIC_LOAD(&ctx->stop))
+        mg_mgr_poll(ctx->mgr, 500);
+
+    http_server_drain(ctx);
+    http_server_goodbye(ctx);
+    // give the goodbyes a moment to go out
+    for (int i = 0; i < 20; ++i) {
+        struct mg_connection *nc = mg_next(ctx->mgr, NULL);
+        while (nc && nc->handler != ev_handler)
+            nc = mg_next(ctx->mgr, nc);
+        if (!nc)
+            break;
+        mg_mgr_poll(ctx->mgr, 50);
     }
+    mg_mgr_free(ctx->mgr);
+
+    return (THREAD_RETURN)0;
+}
+#endif
+
+/// Free what the server holds, the connections are closed already.
+static void http_server_free(struct http_server_context *ctx)
+{
+#ifdef THREADS
+    void *p;
+    while ((p = event_queue_pop(ctx->events)))
+        http_msg_release(p);
+    // every job left is in flight
+    while (event_queue_pop(ctx->jobs))
+        ;
+    while (event_queue_pop(ctx->replies))
+        ;
+    event_queue_free(ctx->events);
+    event_queue_free(ctx->jobs);
+    event_queue_free(ctx->replies);
+    for (int i = 0; i < 2; ++i) {
+        if (ctx->server_wake[i] != INVALID_SOCKET)
+            closesocket(ctx->server_wake[i]);
+        if (ctx->main_wake[i] != INVALID_SOCKET)
+            closesocket(ctx->main_wake[i]);
+    }
+#endif
+    list_free_elems(&ctx->inflight, http_job_free);
+    if (ctx->history) {
+        for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
+            http_msg_release(*iter);
+        ring_list_free(ctx->history);
+    }
+    event_store_free(ctx->store);
+    free(ctx->spectrum_levels);
+    free(ctx);
 }
 
 static struct http_server_context *http_server_start(struct mg_mgr *mgr, char const *host, char const *port, r_cfg_t *cfg, struct data_output *output)
@@ -1323,6 +2568,41 @@ static struct http_server_context *http_server_start(struct mg_mgr *mgr, char co
     ctx->output  = output;
     ctx->history = ring_list_new(DEFAULT_HISTORY_SIZE);
 
+    // the receiver computes the spectrum, only while a viewer wants it
+    ctx->spectrum_levels = malloc(SPECTRUM_FFT_SIZE * sizeof(*ctx->spectrum_levels));
+    if (!ctx->spectrum_levels)
+        WARN_MALLOC("http_server_start()");
+    if (!cfg->spectrum)
+        cfg->spectrum = spectrum_create(SPECTRUM_FFT_SIZE);
+    if (!cfg->spectrum)
+        print_log(LOG_WARNING, "HTTP server", "Spectrum not available");
+    ctx->store = event_store_create(EVENT_STORE_DEFAULT_EVENTS);
+    if (!ctx->store)
+        print_log(LOG_WARNING, "HTTP server", "Event store not available");
+
+#ifdef THREADS
+    ctx->server_wake[0] = ctx->server_wake[1] = INVALID_SOCKET;
+    ctx->main_wake[0]   = ctx->main_wake[1]   = INVALID_SOCKET;
+    ctx->events  = event_queue_create(HTTP_QUEUE_SIZE);
+    ctx->jobs    = event_queue_create(HTTP_QUEUE_SIZE);
+    ctx->replies = event_queue_create(HTTP_QUEUE_SIZE);
+    if (!ctx->history || !ctx->events || !ctx->jobs || !ctx->replies
+            || !mg_socketpair(ctx->server_wake, SOCK_STREAM) || !mg_socketpair(ctx->main_wake, SOCK_STREAM)) {
+        print_log(LOG_ERROR, "HTTP server", "Error setting up the server thread");
+        http_server_free(ctx);
+        return NULL;
+    }
+    // the server has a manager of its own
+    mg_mgr_init(&ctx->server_mgr, NULL);
+    ctx->mgr = &ctx->server_mgr;
+#else
+    if (!ctx->history) {
+        http_server_free(ctx);
+        return NULL;
+    }
+    ctx->mgr = mgr;
+#endif
+
     char address[253 + 6 + 1]; // dns max + port
     // if the host is an IPv6 address it needs quoting
     if (strchr(host, ':'))
@@ -1335,12 +2615,14 @@ static struct http_server_context *http_server_start(struct mg_mgr *mgr, char co
     bind_opts.user_data = ctx;
     bind_opts.error_string = &err_str;
 
-    ctx->conn = mg_bind_opt(mgr, address, ev_handler, bind_opts);
+    ctx->conn = mg_bind_opt(ctx->mgr, address, ev_handler, bind_opts);
     if (ctx->conn == NULL) {
         print_logf(LOG_ERROR, __func__, "Error starting server on address %s: %s", address,
                 *bind_opts.error_string);
-        ring_list_free(ctx->history);
-        free(ctx);
+#ifdef THREADS
+        mg_mgr_free(ctx->mgr);
+#endif
+        http_server_free(ctx);
         return NULL;
     }
 
@@ -1348,49 +2630,52 @@ static struct http_server_context *http_server_start(struct mg_mgr *mgr, char co
     ctx->server_opts.document_root            = "."; // Serve current directory
     ctx->server_opts.enable_directory_listing = "yes";
 
+#ifdef THREADS
+    // each thread is woken by a socket in its manager, the managers own those
+    struct mg_add_sock_opts wake_opts = {.user_data = ctx};
+    mg_add_sock_opt(ctx->mgr, ctx->server_wake[1], server_wake_handler, wake_opts);
+    ctx->server_wake[1] = INVALID_SOCKET;
+    ctx->main_conn      = mg_add_sock_opt(mgr, ctx->main_wake[1], main_wake_handler, wake_opts);
+    ctx->main_wake[1]   = INVALID_SOCKET;
+    if (!ctx->main_conn || pthread_create(&ctx->thread, NULL, http_server_thread, ctx)) {
+        print_log(LOG_ERROR, "HTTP server", "Error starting the server thread");
+        if (ctx->main_conn) {
+            ctx->main_conn->user_data = NULL;
+            ctx->main_conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+        }
+        mg_mgr_free(ctx->mgr);
+        http_server_free(ctx);
+        return NULL;
+    }
+#endif
+
     print_logf(LOG_NOTICE, "HTTP server", "Serving HTTP-API on address %s, serving %s", address,
             ctx->server_opts.document_root);
 
     return ctx;
 }
 
-#define SHUTDOWN_JSON "{\"shutdown\":\"goodbye\"}"
-
 static int http_server_stop(struct http_server_context *ctx)
 {
     if (!ctx)
         return 0;
 
-    // close the server
-    ctx->conn->user_data = NULL;
-    ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
-
-    // close connections with a goodbye
-    struct mg_mgr *mgr = ctx->conn->mgr;
-    for (struct mg_connection *nc = mg_next(mgr, NULL); nc != NULL; nc = mg_next(mgr, nc)) {
-        if (nc->handler != ev_handler)
-            continue;
+#ifdef THREADS
+    // the server thread says goodbye and closes all connections
+    ATOMIC_XCHG(&ctx->stop, 1);
+    send(ctx->server_wake[0], "", 1, 0);
+    pthread_join(ctx->thread, NULL);
 
-        struct nc_context *cctx = nc->user_data; // might not be valid
-        if (is_websocket(nc)) {
-            mg_send_websocket_frame(nc, WEBSOCKET_OP_TEXT, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
-        }
-        else if (cctx && cctx->is_chunked) {
-            mg_send_http_chunk(nc, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
-            mg_send_http_chunk(nc, "\r\n", 2);
-            mg_send_http_chunk(nc, "", 0);            /* Send empty chunk, the end of response */
-        }
-        else if (cctx && !cctx->is_chunked) {
-            mg_send(nc, SHUTDOWN_JSON, sizeof(SHUTDOWN_JSON) - 1);
-            mg_send(nc, "\r\n", 2);
-        }
-    }
+    ctx->main_conn->user_data = NULL;
+    ctx->main_conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+#else
+    http_server_goodbye(ctx);
+#endif
 
-    for (void **iter = ring_list_iter(ctx->history); iter; iter = ring_list_next(ctx->history, iter))
-        free((data_t *)*iter);
-    ring_list_free(ctx->history);
+    if (ctx->cfg->spectrum)
+        spectrum_set_interval(ctx->cfg->spectrum, 0.0);
 
-    free(ctx);
+    http_server_free(ctx);
 
     return 0;
 }
@@ -1414,11 +2699,24 @@ static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data,
             data_model = d;
     }
 
+    // encode CBOR only if a client asked for it
+    uint8_t *cbor   = NULL;
+    size_t cbor_len = 0;
+    if (ATOMIC_LOAD(&http->server->cbor_clients) > 0) {
+        size_t cbor_size = data_model ? 2048 : 20000;
+        cbor             = malloc(cbor_size);
+        if (!cbor)
+            WARN_MALLOC("print_http_data()");
+        else
+            cbor_len = data_print_cbor(data, cbor, cbor_size);
+    }
+
+    http_msg_t *msg = NULL;
     if (data_model) {
         // "events"
         char buf[2048]; // we expect the biggest strings to be around 500 bytes.
         size_t len = data_print_jsons(data, buf, sizeof(buf));
-        http_broadcast_send(http->server, buf, len);
+        msg        = http_msg_new(buf, len, cbor, cbor_len, data);
     }
     else {
         // "states"
@@ -1426,12 +2724,19 @@ static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data,
         char *buf       = malloc(buf_size);
         if (!buf) {
             WARN_MALLOC("print_http_data()");
+            free(cbor);
             return; // NOTE: skip output on alloc failure.
         }
         size_t len = data_print_jsons(data, buf, buf_size);
-        http_broadcast_send(http->server, buf, len);
+        msg        = http_msg_new(buf, len, cbor, cbor_len, data);
         free(buf);
     }
+    free(cbor);
+    if (msg)
+        http_server_post(http->server, msg);
+    // the store is queried by the jobs, which run on this thread too
+    if (data_model && http->server->store)
+        event_store_add(http->server->store, data, mg_time());
 }
 
 static void R_API_CALLCONV data_output_http_free(data_output_t *output)
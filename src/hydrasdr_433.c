@@ -55,7 +55,12 @@
 #include "write_sigrok.h"
 #include "mongoose.h"
 #include "channelizer.h"
+#include "hydrasdr_lfft.h"
 #include "build_info.h"
+#include "trace.h"
+#include "coalesce.h"
+#include "replay.h"
+#include "spectrum.h"
 
 #ifdef _WIN32
 #include <io.h>
@@ -96,32 +101,15 @@
 #define usleep(us) Sleep((us) / 1000)
 #endif
 
-typedef struct timeval delay_timer_t;
-
-static void delay_timer_init(delay_timer_t *delay_timer)
-{
-    // set to current wall clock
-    get_time_now(delay_timer);
-}
-
-static void delay_timer_wait(delay_timer_t *delay_timer, unsigned delay_us)
+/// Sleep until the monotonic clock reaches @p due_ns, for replay pacing.
+static void wait_until_ns(uint64_t due_ns)
 {
-    // sync to wall clock
-    struct timeval now_tv;
-    get_time_now(&now_tv);
-
-    time_t elapsed_s  = now_tv.tv_sec - delay_timer->tv_sec;
-    time_t elapsed_us = 1000000 * elapsed_s + now_tv.tv_usec - delay_timer->tv_usec;
-
-    // set next wanted start time
-    delay_timer->tv_usec += delay_us;
-    while (delay_timer->tv_usec > 1000000) {
-        delay_timer->tv_usec -= 1000000;
-        delay_timer->tv_sec += 1;
+    uint64_t now_ns = metrics_time_ns();
+    while (due_ns > now_ns) {
+        uint64_t delay_us = (due_ns - now_ns) / 1000;
+        usleep(delay_us < 500000 ? (unsigned)delay_us : 500000); // usleep() may reject a second or more
+        now_ns = metrics_time_ns();
     }
-
-    if ((time_t)delay_us > elapsed_us)
-        usleep(delay_us - elapsed_us);
 }
 
 r_device *flex_create_device(char *spec); // maybe put this in some header file?
@@ -129,7 +117,7 @@ r_device *flex_create_device(char *spec); // maybe put this in some header file?
 static void print_version(void)
 {
     fprintf(stderr, "%s\n", version_string());
-    fprintf(stderr, "Build: " BUILD_INFO_STR ", %s\n", channelizer_build_info());
+    fprintf(stderr, "Build: " BUILD_INFO_STR ", %s, %s\n", channelizer_build_info(), hlfft_build_info());
 }
 
 _Noreturn
@@ -193,7 +181,7 @@ static void usage(int exit_code)
             "  [-w <filename> | help] Save data stream to output file (a '-' dumps samples to stdout)\n"
             "  [-W <filename> | help] Save data stream to output file, overwrite existing file\n"
             "\t\t= Data output options =\n"
-            "  [-F log | kv | json | csv | mqtt | influx | syslog | trigger | rtl_tcp | http | null | help] Produce decoded output in given format.\n"
+            "  [-F log | kv | json | csv | cbor | mqtt | influx | syslog | trigger | shm | rtl_tcp | http | null | help] Produce decoded output in given format.\n"
             "       Append output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
             "       Specify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
             "  [-M time[:<options>] | protocol | level | noise[:<secs>] | stats | bits | help] Add various meta data to each output.\n"
@@ -295,14 +283,17 @@ static void help_output(void)
 {
     term_help_fprintf(stdout,
             "\t\t= Output format option =\n"
-            "  [-F log|kv|json|csv|mqtt|influx|syslog|trigger|rtl_tcp|http|null] Produce decoded output in given format.\n"
+            "  [-F log|kv|json|csv|cbor|mqtt|influx|syslog|trigger|shm|rtl_tcp|http|null] Produce decoded output in given format.\n"
             "\tWithout this option the default is LOG and KV output. Use \"-F null\" to remove the default.\n"
             "\tAppend output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
+            "\tThe cbor format writes binary CBOR events, convert with e.g. cbor2json < events.cbor\n"
             "  [-F mqtt[s][:[//]host[:port][,<options>]] (default: localhost:1883)\n"
             "\tSpecify MQTT server with e.g. -F mqtt://localhost:1883\n"
             "\tDefault user and password are read from MQTT_USERNAME and MQTT_PASSWORD env vars.\n"
             "\tAdd MQTT options with e.g. -F \"mqtt://host:1883,opt=arg\"\n"
-            "\tMQTT options are: user=foo, pass=bar, retain[=0|1], <format>[=topic]\n"
+            "\tMQTT options are: user=foo, pass=bar, retain[=0|1], qos=<0|1|2>, <format>[=topic]\n"
+            "\tWith qos=1 or qos=2 up to inflight=<n> (default 16) messages await acknowledgement,\n"
+            "\t  further messages are queued, up to backlog=<n> (default 1024), dropping the oldest.\n"
             "\tSupported MQTT formats: (default is all)\n"
             "\t  availability: posts availability (online/offline)\n"
             "\t  events: posts JSON event data, default \"<base>/events\"\n"
@@ -319,10 +310,17 @@ static void help_output(void)
             "\tSpecify InfluxDB 2.0 server with e.g. -F \"influx://localhost:9999/api/v2/write?org=<org>&bucket=<bucket>,token=<authtoken>\"\n"
             "\tSpecify InfluxDB 1.x server with e.g. -F \"influx://localhost:8086/write?db=<db>&p=<password>&u=<user>\"\n"
             "\t  Additional parameter -M time:unix:usec:utc for correct timestamps in InfluxDB recommended\n"
+            "\tInfluxDB options are: token=<authtoken>, batch_lines=<n> (default 5000), batch_bytes=<n> (default 1048576),\n"
+            "\t  batch_delay=<ms> (default 1000), spill=<bytes> kept for retry (default 16777216), gzip[=<level>]\n"
             "  [-F syslog[:[//]host[:port] (default: localhost:514)\n"
             "\tSpecify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
+            "\tSyslog options are: batch=<n> datagrams per send (default 1), batch_delay=<ms> (default 50),\n"
+            "\t  format=binary to pack several JSON events per datagram, e.g. -F syslog:127.0.0.1:1514,batch=32\n"
+            "\t  format=cbor to pack several CBOR events per datagram\n"
             "  [-F trigger:/path/to/file]\n"
             "\tAdd an output that writes a \"1\" to the path for each event, use with a e.g. a GPIO\n"
+            "  [-F shm[:/name][,size=<bytes>][,format=json|cbor]] (default: /hydrasdr_433, 1 MiB, json)\n"
+            "\tPublish events to a shared-memory ring for local readers, see shm_ring.h\n"
             "  [-F rtl_tcp[:[//]bind[:port]] (default: localhost:1234)\n"
             "\tAdd a rtl_tcp pass-through server\n"
             "  [-F http[:[//]bind[:port]] (default: 0.0.0.0:8433)\n"
@@ -367,12 +365,22 @@ static void help_meta(void)
             "\tUse \"time:utc\" to output time in UTC.\n"
             "\t\t(this may also be accomplished by invocation with TZ environment variable set).\n"
             "\t\t\"usec\" and \"utc\" can be combined with other options, eg. \"time:iso:utc\" or \"time:unix:usec\".\n"
-            "\tUse \"replay[:N]\" to replay file inputs at (N-times) realtime.\n"
+            "\tUse \"replay[:<speed>]\" to replay file inputs at (<speed>-times) realtime, e.g. 0.5 or 3,\n"
+            "\t  paced by the sample clock. \"replay:max\" replays as fast as possible, the default.\n"
+            "\tUse \"replay:auto[:<queue>[:<latency_ms>]]\" to ramp the replay speed up to the fastest\n"
+            "\t  that keeps the queue depth (default: 4 buffers) and latency (default: none) within target.\n"
             "\tUse \"protocol\" / \"noprotocol\" to output the decoder protocol number meta data.\n"
             "\tUse \"level\" to add Modulation, Frequency, RSSI, SNR, and Noise meta data.\n"
             "\tUse \"noise[:<secs>]\" to report estimated noise level at intervals (default: 10 seconds).\n"
             "\tUse \"stats[:[<level>][:<interval>]]\" to report statistics (default: 600 seconds).\n"
             "\t  level 0: no report, 1: report successful devices, 2: report active devices, 3: report all\n"
+            "\tUse \"perf[:<secs>]\" to profile the processing and report the realtime load per stage,\n"
+            "\t  channel and decoder at intervals (default: 10 seconds).\n"
+            "\tUse \"trace[:<secs>[:<file>]]\" to record a timeline of the pipeline for <secs> of input\n"
+            "\t  (default: 10 seconds) as Chrome Trace Event JSON (default: \"" TRACE_DEFAULT_PATH "\").\n"
+            "\tUse \"coalesce[:<ms>[:<fields>]]\" to output one event per burst of repeated transmissions\n"
+            "\t  with the repeat count, best and mean SNR and wideband channels. A burst ends <ms> (default: 500)\n"
+            "\t  after its last copy, <fields> selects the key fields as for \"-B dedup\".\n"
             "\tUse \"bits\" to add bit representation to code outputs (for debug).\n");
     exit(0);
 }
@@ -450,10 +458,14 @@ static void free_wideband_channel_state(struct dm_state *demod);
  * @param channel_rate  Input sample rate per channel (from channelizer)
  * @param target_rate   Target sample rate for decoders (e.g., 250000)
  * @param max_samples   Maximum samples per channel per frame (for buffer sizing)
+ * @param arbitrary     1 to use the arbitrary ratio resampler
+ * @param dedup_window  Cross-channel dedup window in ms
+ * @param dedup_fields  Cross-channel dedup key fields, NULL for all
  */
 static int init_wideband_channel_state(struct dm_state *demod, int num_channels,
                                        uint32_t channel_rate, uint32_t target_rate,
-                                       size_t max_samples)
+                                       size_t max_samples, int arbitrary,
+                                       unsigned dedup_window, char const *dedup_fields)
 {
     if (demod->wideband_channels_allocated >= num_channels)
         return 0;  /* Already allocated */
@@ -501,7 +513,10 @@ static int init_wideband_channel_state(struct dm_state *demod, int num_channels,
 
     /* Initialize resamplers for each channel */
     for (int i = 0; i < num_channels; i++) {
-        if (cf32_resampler_init(&demod->wb_resamplers[i], channel_rate, target_rate, max_samples) != 0)
+        int r = arbitrary && channel_rate != target_rate
+                ? cf32_resampler_init_arbitrary(&demod->wb_resamplers[i], channel_rate, target_rate, max_samples)
+                : cf32_resampler_init(&demod->wb_resamplers[i], channel_rate, target_rate, max_samples);
+        if (r != 0)
             goto fail;
     }
 
@@ -544,11 +559,18 @@ static int init_wideband_channel_state(struct dm_state *demod, int num_channels,
         goto fail;
     demod->wb_buf_len = wb_buf_len;
 
-    /* Cross-channel deduplication */
-    demod->wb_dedup = wb_dedup_create();
-    if (!demod->wb_dedup)
+    /* Interleaved buffers of the cross-channel filters */
+    demod->wb_lanes = baseband_lanes_create((uint32_t)wb_buf_len);
+    if (!demod->wb_lanes)
         goto fail;
 
+    /* Cross-channel deduplication */
+    if (dedup_window) {
+        demod->wb_dedup = wb_dedup_create(dedup_window, dedup_fields);
+        if (!demod->wb_dedup)
+            goto fail;
+    }
+
     /* Per-channel decode counters and frequency map */
     demod->wb_decode_count = calloc((size_t)num_channels, sizeof(unsigned));
     if (!demod->wb_decode_count)
@@ -562,6 +584,11 @@ static int init_wideband_channel_state(struct dm_state *demod, int num_channels,
     if (!demod->wb_smoothed_power)
         goto fail;
 
+    /* Per-channel processing time for the profiler */
+    demod->wb_busy_ns = calloc((size_t)num_channels, sizeof(uint64_t));
+    if (!demod->wb_busy_ns)
+        goto fail;
+
     /* Initialize per-channel levels from global defaults */
     for (int i = 0; i < num_channels; i++) {
         demod->wb_min_level_auto[i] = demod->min_level;
@@ -577,6 +604,116 @@ fail:
     return -1;
 }
 
+/// A wideband channel that passed squelch in the current frame.
+typedef struct wideband_active {
+    int chan;          ///< Channel index
+    float *iq;         ///< Channel samples, resampled if enabled
+    int samples;       ///< Sample count
+    uint32_t rate;     ///< Sample rate
+    unsigned fpdm;     ///< FSK pulse detect mode
+    float low_pass;    ///< FM demod low pass
+} wideband_active_t;
+
+/**
+ * Account a processing stage, of wideband channel @p chan also to the
+ * busy time of that channel, and record it to a running trace.
+ */
+static uint64_t pipeline_stage(struct dm_state *demod, int stage, int chan, uint64_t start_ns)
+{
+    uint64_t now = metrics_stage(&demod->metrics, stage, start_ns);
+    if (chan >= 0 && demod->wb_busy_ns)
+        demod->wb_busy_ns[chan] += now - start_ns;
+    trace_span(TRACE_THREAD_DEMOD, metrics_stage_name(stage), NULL, chan, start_ns);
+    return now;
+}
+
+/**
+ * Account a stage run for @p n wideband channels at once, its time shared
+ * evenly between the busy times of those channels.
+ */
+static uint64_t pipeline_stage_shared(struct dm_state *demod, int stage, wideband_active_t const *active, int n, uint64_t start_ns)
+{
+    uint64_t now = metrics_stage(&demod->metrics, stage, start_ns);
+    if (demod->wb_busy_ns) {
+        for (int i = 0; i < n; i++)
+            demod->wb_busy_ns[active[i].chan] += (now - start_ns) / (uint64_t)n;
+    }
+    trace_span(TRACE_THREAD_DEMOD, metrics_stage_name(stage), NULL, -1, start_ns);
+    return now;
+}
+
+/**
+ * Low pass filter the AM and FM demodulate @p n channels with the same
+ * sample count and rate, across channels (see baseband_lanes.h).
+ */
+static void wideband_filter_lanes(struct dm_state *demod, wideband_active_t const *active, int n)
+{
+    uint16_t const *temp[BASEBAND_LANES_MAX];
+    int16_t *am[BASEBAND_LANES_MAX];
+    int16_t *fm[BASEBAND_LANES_MAX];
+    float const *iq[BASEBAND_LANES_MAX];
+    filter_state_t *lowpass[BASEBAND_LANES_MAX];
+    demodfm_state_t *fm_state[BASEBAND_LANES_MAX];
+    float low_pass[BASEBAND_LANES_MAX];
+
+    for (int i = 0; i < n; i++) {
+        size_t offset = (size_t)active[i].chan * demod->wb_buf_len;
+        temp[i] = demod->wb_temp_bufs + offset;
+        am[i] = demod->wb_am_bufs + offset;
+        fm[i] = demod->wb_fm_bufs + offset;
+        iq[i] = active[i].iq;
+        lowpass[i] = &demod->wb_lowpass_filter_state[active[i].chan];
+        fm_state[i] = &demod->wb_demod_FM_state[active[i].chan];
+        low_pass[i] = active[i].low_pass;
+    }
+
+    uint64_t t = metrics_time_ns();
+    baseband_low_pass_filter_lanes(demod->wb_lanes, lowpass, temp, am, (uint32_t)active[0].samples, (unsigned)n);
+    t = pipeline_stage_shared(demod, METRICS_STAGE_LOWPASS, active, n, t);
+    baseband_demod_FM_cf32_lanes(demod->wb_lanes, fm_state, iq, fm, (uint32_t)active[0].samples, (unsigned)n,
+            active[0].rate, low_pass);
+    pipeline_stage_shared(demod, METRICS_STAGE_FM_DEMOD, active, n, t);
+}
+
+/**
+ * Low pass filter the AM and FM demodulate the channels that passed squelch.
+ *
+ * Runs of BASEBAND_LANES_MIN or more channels with the same sample count
+ * and rate go through the cross-channel kernels, fewer would leave most
+ * lanes idle and are filtered channel by channel. The output is the same.
+ */
+static void wideband_filter_channels(struct dm_state *demod, wideband_active_t const *active, int n_active)
+{
+    for (int i = 0; i < n_active;) {
+        int n = 1;
+        while (i + n < n_active && n < BASEBAND_LANES_MAX
+                && active[i + n].samples == active[i].samples && active[i + n].rate == active[i].rate)
+            n++;
+
+        if (demod->wb_lanes && n >= BASEBAND_LANES_MIN) {
+            wideband_filter_lanes(demod, &active[i], n);
+            i += n;
+            continue;
+        }
+        for (int end = i + n; i < end; i++) {
+            int chan = active[i].chan;
+            size_t offset = (size_t)chan * demod->wb_buf_len;
+
+            /* Low-pass filter the AM signal (per-channel buffers) */
+            uint64_t t = metrics_time_ns();
+            baseband_low_pass_filter(&demod->wb_lowpass_filter_state[chan], demod->wb_temp_bufs + offset,
+                                     demod->wb_am_bufs + offset, active[i].samples);
+            t = pipeline_stage(demod, METRICS_STAGE_LOWPASS, chan, t);
+
+            /* FM demodulation - always run for wideband to provide valid fm_data
+             * for pulse_detect_package (used for carrier frequency estimation even in OOK mode) */
+            baseband_demod_FM_cf32(&demod->wb_demod_FM_state[chan], active[i].iq, demod->wb_fm_bufs + offset,
+                                   active[i].samples, active[i].rate, active[i].low_pass);
+            pipeline_stage(demod, METRICS_STAGE_FM_DEMOD, chan, t);
+        }
+    }
+}
+
 /**
  * Process wideband samples through PFB channelizer.
  *
@@ -624,27 +761,30 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
                        c, freq / 1e6f, lo, hi, note);
         }
 
-        /* Use channelizer output rate directly as decoder rate.
+        /* Use channelizer output rate directly as decoder rate by default.
          *
-         * The PFB channelizer already provides anti-aliasing (80 dB stopband).
-         * Resampling to a different rate is unnecessary and harmful: the
-         * polyphase resampler's short filter (8 taps/branch, Blackman window)
-         * attenuates signals near the channel edge by 5+ dB, killing signals
-         * that the PFB passes cleanly.
-         *
-         * Decoders work in microseconds (not sample counts), so any reasonable
-         * channel rate (156k-625k) works correctly.
+         * The PFB channelizer already provides anti-aliasing (80 dB stopband)
+         * and decoders work in microseconds (not sample counts), so any
+         * reasonable channel rate (156k-625k) works correctly.  A decoder
+         * rate can still be set with -B rate:, e.g. to match a recording,
+         * resampled per channel by the rational or arbitrary ratio resampler.
          */
-        uint32_t target_rate = ch->channel_rate;
+        uint32_t target_rate = cfg->wb_decoder_rate ? cfg->wb_decoder_rate : ch->channel_rate;
         size_t max_chan_samples = (size_t)n_samples / (size_t)ch->decimation_factor + 1;
         if (init_wideband_channel_state(demod, ch->num_channels, ch->channel_rate,
-                                        target_rate, max_chan_samples) != 0) {
+                                        target_rate, max_chan_samples, cfg->wb_resampler_arbitrary,
+                                        cfg->wb_dedup_window, cfg->wb_dedup_fields) != 0) {
             print_log(LOG_ERROR, "Wideband", "Failed to allocate per-channel state");
             cfg->wideband_mode = 0;
             return;
         }
-        print_logf(LOG_NOTICE, "Wideband", "Per-channel decoder rate: %u Hz (2x oversampled, no resampling)",
-                   target_rate);
+        if (target_rate == ch->channel_rate)
+            print_logf(LOG_NOTICE, "Wideband", "Per-channel decoder rate: %u Hz (2x oversampled, no resampling)",
+                       target_rate);
+        else
+            print_logf(LOG_NOTICE, "Wideband", "Per-channel decoder rate: %u Hz (%s resampler from %u Hz)",
+                       target_rate, demod->wb_resamplers[0].arbitrary ? "arbitrary ratio" : "rational",
+                       ch->channel_rate);
 
         /* Fill per-channel frequency map */
         if (demod->wb_channel_freqs) {
@@ -654,10 +794,12 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
     }
 
     /* Run the channelizer: split wideband input into narrowband channels */
+    uint64_t t = metrics_time_ns();
     if (channelizer_process(ch, iq_buf, n_samples, channel_out, &out_samples) != 0) {
         print_log(LOG_WARNING, "Wideband", "Channelizer processing failed");
         return;
     }
+    pipeline_stage(demod, METRICS_STAGE_CHANNELIZER, -1, t);
 
     /* Safety check: ensure out_samples doesn't exceed buffer limits */
     if (out_samples > MAXIMAL_BUF_LENGTH) {
@@ -671,6 +813,8 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
      * input_pos is in wideband samples, but pulse_detect works at channel rate.
      */
     uint64_t channel_sample_offset = cfg->input_pos / (uint64_t)ch->decimation_factor;
+    /* Sample clock time at the end of this frame, for the cross-channel dedup */
+    uint64_t frame_end_us = (cfg->input_pos + (uint64_t)n_samples) * 1000000 / cfg->samp_rate;
 
     /* Safety check: ensure channel state is allocated */
     if (ch->num_channels > demod->wideband_channels_allocated) {
@@ -679,12 +823,17 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
         return;
     }
 
-    /* Process each channel through the existing demodulation pipeline */
+    /* Process each channel through the existing demodulation pipeline:
+     * resampling, AM demod and squelch per channel first, so that the
+     * recursive filters can then run across the active channels. */
+    wideband_active_t active[WIDEBAND_MAX_CHANNELS];
+    int n_active = 0;
     for (int chan = 0; chan < ch->num_channels; chan++) {
         float *chan_iq = channel_out[chan];
         float chan_freq = channelizer_get_channel_freq(ch, chan);
         int resampled_samples = out_samples;
         uint32_t effective_rate = ch->channel_rate;
+        t = metrics_time_ns();
 
         /* Defensive check: ensure channelizer output is valid */
         if (!chan_iq) {
@@ -699,6 +848,7 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
             int max_output = (int)resampler->output_buf_size;
             resampled_samples = cf32_resampler_process(resampler, chan_iq, out_samples,
                                                         &resampled_output, max_output);
+            t = pipeline_stage(demod, METRICS_STAGE_RESAMPLER, chan, t);
             if (resampled_samples > 0 && resampled_output) {
                 chan_iq = resampled_output;
                 effective_rate = demod->wb_target_rate;
@@ -721,11 +871,10 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
 
         /* Per-channel scratch buffers (isolated from shared demod buffers) */
         uint16_t *chan_temp = demod->wb_temp_bufs + (size_t)chan * demod->wb_buf_len;
-        int16_t *chan_am = demod->wb_am_bufs + (size_t)chan * demod->wb_buf_len;
-        int16_t *chan_fm = demod->wb_fm_bufs + (size_t)chan * demod->wb_buf_len;
 
         /* AM demodulation (magnitude estimation for CF32 data) */
         float avg_db = magnitude_est_cf32(chan_iq, chan_temp, resampled_samples);
+        pipeline_stage(demod, METRICS_STAGE_AM_DEMOD, chan, t);
 
         /* Update smoothed power for spectrum display */
         if (demod->wb_smoothed_power) {
@@ -790,12 +939,6 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
             print_logf(LOG_ERROR, "Wideband", "Ch%d: filter state arrays not initialized", chan);
             continue;
         }
-        filter_state_t *chan_lowpass = &demod->wb_lowpass_filter_state[chan];
-        demodfm_state_t *chan_fm_state = &demod->wb_demod_FM_state[chan];
-
-        /* Low-pass filter the AM signal (per-channel buffers) */
-        baseband_low_pass_filter(chan_lowpass, chan_temp,
-                                 chan_am, resampled_samples);
 
         /* Select FSK pulse detect mode - force new mode for >800MHz */
         unsigned fpdm = cfg->fsk_pulse_detect_mode;
@@ -806,13 +949,28 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
                 fpdm = FSK_PULSE_DETECT_OLD;
         }
 
-        /* FM demodulation - always run for wideband to provide valid fm_data
-         * for pulse_detect_package (used for carrier frequency estimation even in OOK mode) */
-        {
-            float low_pass = demod->low_pass != 0.0f ? demod->low_pass : (fpdm ? 0.2f : 0.1f);
-            baseband_demod_FM_cf32(chan_fm_state, chan_iq, chan_fm,
-                                   resampled_samples, effective_rate, low_pass);
-        }
+        wideband_active_t *a = &active[n_active++];
+        a->chan = chan;
+        a->iq = chan_iq;
+        a->samples = resampled_samples;
+        a->rate = effective_rate;
+        a->fpdm = fpdm;
+        a->low_pass = demod->low_pass != 0.0f ? demod->low_pass : (fpdm ? 0.2f : 0.1f);
+    }
+
+    /* Low pass and FM demod of the channels that passed squelch */
+    wideband_filter_channels(demod, active, n_active);
+
+    /* Pulse detection and decoding, channel by channel */
+    for (int i = 0; i < n_active; i++) {
+        int chan = active[i].chan;
+        float chan_freq = channelizer_get_channel_freq(ch, chan);
+        int resampled_samples = active[i].samples;
+        uint32_t effective_rate = active[i].rate;
+        unsigned fpdm = active[i].fpdm;
+        int16_t *chan_am = demod->wb_am_bufs + (size_t)chan * demod->wb_buf_len;
+        int16_t *chan_fm = demod->wb_fm_bufs + (size_t)chan * demod->wb_buf_len;
+        pulse_detect_t *chan_pulse_detect = demod->wb_pulse_detect[chan];
 
         /* Per-channel pulse data - critical for multi-channel isolation */
         if (!demod->wb_pulse_data || !demod->wb_fsk_pulse_data) {
@@ -824,17 +982,21 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
 
         /* Pulse detection and decoding using per-channel state */
         int package_type = PULSE_DATA_OOK;
-        while (package_type && process_frame) {
+        while (package_type) {
             int p_events = 0;
+            t = metrics_time_ns();
             package_type = pulse_detect_package(chan_pulse_detect, chan_am,
                                                 chan_fm, resampled_samples, effective_rate,
                                                 channel_sample_offset, chan_pulse,
                                                 chan_fsk_pulse, fpdm);
+            t = pipeline_stage(demod, METRICS_STAGE_DETECT, chan, t);
 
             if (package_type) {
                 if (!demod->frame_start_ago)
                     demod->frame_start_ago = chan_pulse->start_ago;
                 demod->frame_end_ago = chan_pulse->end_ago;
+                pulse_data_t const *traced = package_type == PULSE_DATA_FSK ? chan_fsk_pulse : chan_pulse;
+                metrics_trace_burst(&demod->metrics, chan, traced->offset, traced->end_ago, effective_rate, frame_end_us);
             }
 
             if (package_type == PULSE_DATA_OOK) {
@@ -917,6 +1079,9 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
                 }
             }
 
+            if (package_type)
+                pipeline_stage(demod, METRICS_STAGE_DECODE, chan, t);
+
             /* Track per-channel decode counts */
             if (p_events > 0 && demod->wb_decode_count)
                 demod->wb_decode_count[chan] += p_events;
@@ -934,6 +1099,11 @@ static void process_wideband_channels(r_cfg_t *cfg, struct dm_state *demod,
         }
         /* No reset needed - each channel has its own persistent state */
     }
+
+    /* Channel power for the web UI spectrum, read by the HTTP server thread */
+    if (cfg->spectrum && demod->wb_smoothed_power && demod->wb_channel_freqs)
+        spectrum_set_channels(cfg->spectrum, demod->wb_channel_freqs, demod->wb_smoothed_power,
+                (unsigned)ch->num_channels);
 }
 
 /**
@@ -982,6 +1152,8 @@ static void free_wideband_channel_state(struct dm_state *demod)
     demod->wb_fm_bufs = NULL;
     free(demod->wb_temp_bufs);
     demod->wb_temp_bufs = NULL;
+    baseband_lanes_free(demod->wb_lanes);
+    demod->wb_lanes = NULL;
     wb_dedup_free(demod->wb_dedup);
     demod->wb_dedup = NULL;
     free(demod->wb_decode_count);
@@ -990,6 +1162,8 @@ static void free_wideband_channel_state(struct dm_state *demod)
     demod->wb_channel_freqs = NULL;
     free(demod->wb_smoothed_power);
     demod->wb_smoothed_power = NULL;
+    free(demod->wb_busy_ns);
+    demod->wb_busy_ns = NULL;
     demod->wb_buf_len = 0;
     demod->wideband_channels_allocated = 0;
 }
@@ -1037,6 +1211,40 @@ static void print_wideband_spectrum(r_cfg_t *cfg)
     }
 }
 
+/**
+ * Record the sample buffer to a running trace (-M trace), the trace window
+ * is counted in input time.
+ */
+static void trace_frame(r_cfg_t *cfg, unsigned long n_samples)
+{
+    if (!trace_recording())
+        return;
+    trace_span(TRACE_THREAD_DEMOD, "frame", NULL, -1, cfg->demod->metrics.frame_start_ns);
+    if (trace_input((double)n_samples / cfg->samp_rate))
+        stop_trace();
+}
+
+/**
+ * Periodic profiler report (-M perf), warns if processing fell behind realtime.
+ */
+static void perf_report(r_cfg_t *cfg)
+{
+    if (!cfg->perf_interval)
+        return;
+    time_t now;
+    time(&now);
+    if (now < cfg->perf_time)
+        return;
+
+    metrics_profile_t const *prof = &cfg->demod->metrics.profile;
+    if (prof->late_blocks)
+        print_logf(LOG_WARNING, "Profiler", "Processing was slower than realtime for %u of %u sample buffers",
+                (unsigned)prof->late_blocks, (unsigned)prof->blocks);
+    event_occurred_handler(cfg, data_dat(NULL, "perf", "", NULL, create_perf_data(cfg)));
+    flush_perf_data(cfg);
+    cfg->perf_time = now + cfg->perf_interval;
+}
+
 static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
 {
     //fprintf(stderr, "sdr_callback... %u\n", len);
@@ -1073,6 +1281,7 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         print_log(LOG_WARNING, __func__, "Sample buffer too short!");
         return; // keep the watchdog timer running
     }
+    metrics_frame_begin(&demod->metrics);
 
     // age the frame position if there is one
     if (demod->frame_start_ago)
@@ -1086,6 +1295,12 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         samp_grab_push(demod->samp_grab, iq_buf, len);
     }
 
+    // only computes a frame while a web UI viewer is due one
+    if (cfg->spectrum) {
+        spectrum_set_tuning(cfg->spectrum, cfg->center_frequency, cfg->samp_rate, cfg->wideband_mode);
+        spectrum_feed(cfg->spectrum, iq_buf, (unsigned)n_samples, (unsigned)demod->sample_size, mg_time());
+    }
+
     /* Wideband mode: route samples through PFB channelizer */
     if (cfg->wideband_mode && cfg->channelizer) {
         /* Record raw wideband IQ if enabled */
@@ -1112,10 +1327,16 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
             print_wideband_spectrum(cfg);
         }
 
+        metrics_frame_end(&demod->metrics, n_samples, cfg->samp_rate);
+        trace_frame(cfg, n_samples);
+        perf_report(cfg);
+        cfg->input_pos += n_samples;
+        flush_coalesced(cfg, cfg->input_pos * 1000 / cfg->samp_rate);
         return;  /* Wideband processing handles everything, skip normal path */
     }
 
     // AM demodulation
+    uint64_t t = metrics_time_ns();
     float avg_db;
     if (demod->sample_size == SDR_SAMPLE_SIZE_CF32) { // CF32 (native HydraSDR format)
         avg_db = magnitude_est_cf32((float const *)iq_buf, demod->buf.temp, n_samples);
@@ -1162,8 +1383,11 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                 noise_only ? "noise" : "signal", avg_db, demod->noise_level);
     }
 
+    t = pipeline_stage(demod, METRICS_STAGE_AM_DEMOD, -1, t);
+
     if (process_frame) {
         baseband_low_pass_filter(&demod->lowpass_filter_state, demod->buf.temp, demod->am_buf, n_samples);
+        t = pipeline_stage(demod, METRICS_STAGE_LOWPASS, -1, t);
     }
 
     // FM demodulation
@@ -1185,6 +1409,7 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         } else { // CS16
             baseband_demod_FM_cs16(&demod->demod_FM_state, (int16_t *)iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
         }
+        pipeline_stage(demod, METRICS_STAGE_FM_DEMOD, -1, t);
     }
 
     // Handle special input formats
@@ -1212,13 +1437,19 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         }
         while (package_type && process_frame) {
             int p_events = 0; // Sensor events successfully detected per package
+            t = metrics_time_ns();
             package_type = pulse_detect_package(demod->pulse_detect, demod->am_buf, demod->buf.fm, n_samples, cfg->samp_rate, cfg->input_pos, &demod->pulse_data, &demod->fsk_pulse_data, fpdm);
+            t = pipeline_stage(demod, METRICS_STAGE_DETECT, -1, t);
             if (package_type) {
                 // new package: set a first frame start if we are not tracking one already
                 if (!demod->frame_start_ago)
                     demod->frame_start_ago = demod->pulse_data.start_ago;
                 // always update the last frame end
                 demod->frame_end_ago = demod->pulse_data.end_ago;
+                // note the pulse train for the end-to-end event latency
+                pulse_data_t const *traced = package_type == PULSE_DATA_FSK ? &demod->fsk_pulse_data : &demod->pulse_data;
+                metrics_trace_burst(&demod->metrics, 0, traced->offset, traced->end_ago, cfg->samp_rate,
+                        (cfg->input_pos + n_samples) * 1000000 / cfg->samp_rate);
             }
             if (package_type == PULSE_DATA_OOK) {
                 calc_rssi_snr(cfg, &demod->pulse_data);
@@ -1274,6 +1505,8 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                     pulse_analyzer(&demod->fsk_pulse_data, package_type, &device);
                 }
             } // if (package_type == ...
+            if (package_type)
+                pipeline_stage(demod, METRICS_STAGE_DECODE, -1, t);
             d_events += p_events;
         } // while (package_type)...
 
@@ -1438,7 +1671,12 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         }
     }
 
+    metrics_frame_end(&demod->metrics, n_samples, cfg->samp_rate);
+    trace_frame(cfg, n_samples);
+    perf_report(cfg);
+
     cfg->input_pos += n_samples;
+    flush_coalesced(cfg, cfg->input_pos * 1000 / cfg->samp_rate);
     if (cfg->bytes_to_read > 0)
         cfg->bytes_to_read -= len;
 
@@ -1648,6 +1886,31 @@ int parse_wideband_spec(char const *arg, float *center, float *bandwidth, int *c
     return 0;
 }
 
+/**
+ * Parse "[<ms>][:<fields>]", the window is optional so a field list may
+ * follow the option directly, e.g. "model,id" or "-counter".
+ *
+ * @param arg     the parameter, may be NULL
+ * @param def     window used if none is given
+ * @param fields  set to the field list, NULL if none
+ * @return the window in ms
+ */
+static unsigned parse_window_fields(char *arg, unsigned def, char **fields)
+{
+    *fields = NULL;
+    if (!arg)
+        return def;
+    char *end;
+    long ms = strtol(arg, &end, 10);
+    if (end == arg) {
+        *fields = *arg ? arg : NULL;
+        return def;
+    }
+    if (*end == ':' && end[1])
+        *fields = end + 1;
+    return ms < 0 ? def : (unsigned)ms;
+}
+
 static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
 {
     int n;
@@ -1894,8 +2157,56 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             time(&cfg->stats_time);
             cfg->stats_time += cfg->stats_interval;
         }
-        else if (!strncasecmp(arg, "replay", 6))
-            cfg->in_replay = atobv(arg_param(arg), 1);
+        else if (!strncasecmp(arg, "perf", 4)) {
+            cfg->perf_interval = atoiv(arg_param(arg), 10);
+            cfg->demod->metrics.profile.enabled = 1;
+            time(&cfg->perf_time);
+            cfg->perf_time += cfg->perf_interval;
+        }
+        else if (!strncasecmp(arg, "trace", 5)) {
+            char *p     = arg_param(arg);
+            char *path  = arg_param(p);
+            int seconds = atoiv(p, 10);
+            start_trace(seconds, path && *path ? path : TRACE_DEFAULT_PATH);
+        }
+        else if (!strncasecmp(arg, "coalesce", 8)) {
+            char *keys;
+            cfg->coalesce_window = parse_window_fields(arg_param(arg), COALESCE_WINDOW_MS, &keys);
+            free(cfg->coalesce_fields);
+            cfg->coalesce_fields = NULL;
+            if (keys && *keys) {
+                cfg->coalesce_fields = strdup(keys);
+                if (!cfg->coalesce_fields)
+                    FATAL_STRDUP("parse_conf_option()");
+            }
+        }
+        else if (!strncasecmp(arg, "replay", 6)) {
+            char *p = arg_param(arg);
+            cfg->in_replay       = REPLAY_FIXED;
+            cfg->in_replay_speed = 1.0;
+            if (p && !strncasecmp(p, "max", 3)) {
+                cfg->in_replay = REPLAY_MAX;
+            }
+            else if (p && !strncasecmp(p, "auto", 4)) {
+                char *queue = arg_param(p);
+                cfg->in_replay         = REPLAY_AUTO;
+                cfg->in_replay_queue   = (unsigned)atoiv(queue, REPLAY_AUTO_QUEUE);
+                cfg->in_replay_latency = (unsigned)atoiv(arg_param(queue), 0);
+            }
+            else if (p && *p && (*p < '0' || *p > '9') && *p != '.' && *p != '-') {
+                if (!atobv(p, 1)) // "replay:off"
+                    cfg->in_replay = REPLAY_MAX;
+            }
+            else if (p && *p) {
+                cfg->in_replay_speed = arg_float(p, "-M replay: ");
+                if (cfg->in_replay_speed < 0.0) {
+                    fprintf(stderr, "-M replay: speed must not be negative\n");
+                    usage(1);
+                }
+                if (cfg->in_replay_speed == 0.0)
+                    cfg->in_replay = REPLAY_MAX;
+            }
+        }
         else if (!strcasecmp(arg, "web_ui_debug"))
             cfg->web_ui_debug = 1;
         else
@@ -1967,6 +2278,9 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         else if (strncmp(arg, "csv", 3) == 0) {
             add_csv_output(cfg, arg_param(arg));
         }
+        else if (strncmp(arg, "cbor", 4) == 0) {
+            add_cbor_output(cfg, arg_param(arg));
+        }
         else if (strncmp(arg, "log", 3) == 0) {
             add_log_output(cfg, arg_param(arg));
             cfg->has_logout = 1;
@@ -1990,6 +2304,9 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         else if (strncmp(arg, "trigger", 7) == 0) {
             add_trigger_output(cfg, arg_param(arg));
         }
+        else if (strncmp(arg, "shm", 3) == 0) {
+            add_shm_output(cfg, arg_param(arg));
+        }
         else if (strncmp(arg, "null", 4) == 0) {
             add_null_output(cfg, arg_param(arg));
         }
@@ -2089,6 +2406,10 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             fprintf(stderr, "Wideband option requires argument:\n");
             fprintf(stderr, "  -B <center>:<bandwidth>[:<channels>]  Wideband scanning\n");
             fprintf(stderr, "  -B record:<filename>                  Record wideband IQ to CF32 file\n");
+            fprintf(stderr, "  -B dedup:[<ms>][:<fields>]            Cross-channel dedup window (default 500, 0 = off)\n");
+            fprintf(stderr, "                                        and key fields, e.g. model,id,channel or -counter\n");
+            fprintf(stderr, "  -B rate:<rate>[:arbitrary]            Per-channel decoder rate (default: channel rate),\n");
+            fprintf(stderr, "                                        optionally with the arbitrary ratio resampler\n");
             fprintf(stderr, "  Use when ISM band wider than single-freq capture:\n");
             fprintf(stderr, "    433: band=1.74M > 250k -> -B 433.92M:2M:8  (wideband needed)\n");
             fprintf(stderr, "    868: band=600k  < 1M   -> -f 868.5M        (single-freq OK)\n");
@@ -2102,6 +2423,30 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
                 FATAL_CALLOC("wb_record_filename");
             break;
         }
+        if (strncmp(arg, "dedup:", 6) == 0) {
+            char *fields;
+            cfg->wb_dedup_window = parse_window_fields(arg + 6, WB_DEDUP_WINDOW_MS, &fields);
+            free(cfg->wb_dedup_fields);
+            cfg->wb_dedup_fields = NULL;
+            if (fields && *fields) {
+                cfg->wb_dedup_fields = strdup(fields);
+                if (!cfg->wb_dedup_fields)
+                    FATAL_STRDUP("wb_dedup_fields");
+            }
+            break;
+        }
+        if (strncmp(arg, "rate:", 5) == 0) {
+            char *mode = arg_param(arg + 5);
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.*s", mode ? (int)(mode - 1 - (arg + 5)) : 31, arg + 5);
+            cfg->wb_decoder_rate = atouint32_metric(buf, "-B rate: ");
+            cfg->wb_resampler_arbitrary = mode && (!strcmp(mode, "arbitrary") || !strcmp(mode, "arb"));
+            if (mode && *mode && !cfg->wb_resampler_arbitrary && strcmp(mode, "rational")) {
+                fprintf(stderr, "Invalid wideband resampler: %s (use rational or arbitrary)\n", mode);
+                usage(1);
+            }
+            break;
+        }
         if (parse_wideband_spec(arg, &cfg->wideband_center, &cfg->wideband_bandwidth,
                                 &cfg->wideband_channels) == 0) {
             cfg->wideband_mode = 1;
@@ -2233,6 +2578,9 @@ static void sdr_handler(struct mg_connection *nc, int ev_type, void *ev_data)
     }
 
     if (ev->ev == SDR_EV_DATA) {
+        // broadcasts arrive in order, this counts along with acquire_callback()
+        static uint64_t data_events;
+        trace_flow(TRACE_THREAD_DEMOD, 1, ++data_events);
         cfg->samp_rate        = ev->sample_rate;
         cfg->center_frequency = ev->center_frequency;
         sdr_callback((unsigned char *)ev->buf, ev->len, cfg);
@@ -2257,10 +2605,17 @@ static void acquire_callback(sdr_event_t *ev, void *ctx)
 
     // TODO: We should run the demod here to unblock the event loop
 
+    // trace the handoff to the main loop, the broadcast blocks until it is read
+    static uint64_t data_events;
+    uint64_t trace_ns = trace_begin();
+    if (ev->ev == SDR_EV_DATA)
+        trace_flow(TRACE_THREAD_ACQUIRE, 0, ++data_events);
+
     // thread-safe dispatch, ev_data is the iq buffer pointer and length
     // mg_mgr_poll() calls specified callback for each connection.
     //fprintf(stderr, "acquire_callback bc send...\n");
     mg_broadcast(mgr, sdr_handler, (void *)ev, sizeof(*ev));
+    trace_span(TRACE_THREAD_ACQUIRE, "broadcast", NULL, -1, trace_ns);
     //fprintf(stderr, "acquire_callback bc done...\n");
 }
 
@@ -2576,6 +2931,12 @@ int main(int argc, char **argv) {
                 demod->r_devs.len, cfg->num_r_devices, decoders_str);
     }
 
+    if (cfg->coalesce_window) {
+        cfg->coalesce = coalesce_create(cfg->coalesce_window, cfg->coalesce_fields);
+        if (!cfg->coalesce)
+            FATAL_CALLOC("main()");
+    }
+
     char const **well_known = well_known_output_fields(cfg);
     start_outputs(cfg, well_known);
     free((void *)well_known);
@@ -2703,6 +3064,10 @@ int main(int argc, char **argv) {
         if (!test_mode_float_buf)
             FATAL_MALLOC("test_mode_float_buf");
 
+        // the auto mode carries the speed it found over to the next file
+        replay_t replay;
+        replay_init(&replay, cfg->in_replay, cfg->in_replay_speed, cfg->in_replay_queue, cfg->in_replay_latency / 1000.0);
+
         if (cfg->duration > 0) {
             time(&cfg->stop_time);
             cfg->stop_time += cfg->duration;
@@ -2801,17 +3166,8 @@ int main(int argc, char **argv) {
             // default case for file-inputs
             int n_blocks = 0;
             unsigned long n_read;
-            delay_timer_t delay_timer;
-            delay_timer_init(&delay_timer);
+            replay_start(&replay, metrics_time_ns());
             do {
-                // Replay in realtime if requested
-                if (cfg->in_replay) {
-                    // per block delay
-                    unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
-                    if (demod->load_info.format == CF32_IQ)
-                        delay_us /= 2; // adjust for float only reading half as many samples
-                    delay_timer_wait(&delay_timer, delay_us);
-                }
                 // Convert CF32 file to CS16 buffer
                 if (demod->load_info.format == CF32_IQ) {
                     n_read = fread(test_mode_float_buf, sizeof(float), DEFAULT_BUF_LENGTH / 2, in_file);
@@ -2836,9 +3192,18 @@ int main(int argc, char **argv) {
                     }
                 }
                 if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
-                demod->sample_file_pos = ((float)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
+                double block_end = ((double)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
+                demod->sample_file_pos = (float)block_end;
                 n_blocks++; // this assumes n_read == DEFAULT_BUF_LENGTH
+                // Deliver the buffer when its last sample is due at the replay speed
+                if (replay.mode != REPLAY_MAX)
+                    wait_until_ns(replay_due(&replay, block_end));
+                uint64_t begin_ns = metrics_time_ns();
                 sdr_callback(test_mode_buf, n_read, cfg);
+                if (replay.mode != REPLAY_MAX
+                        && replay_block(&replay, block_end, (double)n_read / cfg->samp_rate / demod->sample_size, begin_ns, metrics_time_ns())) {
+                    print_logf(LOG_NOTICE, "Replay", "Speed %.3gx at %.1f s", replay.speed, block_end);
+                }
             } while (n_read != 0 && !cfg->exit_async);
 
             // Call a last time with cleared samples to ensure EOP detection
@@ -2860,6 +3225,21 @@ int main(int argc, char **argv) {
             if (cfg->verbosity >= LOG_NOTICE) {
                 print_logf(LOG_NOTICE, "Input", "Test mode file issued %d packets", n_blocks);
             }
+            if (replay.mode == REPLAY_AUTO) {
+                if (replay.passed > 0.0)
+                    print_logf(LOG_WARNING, "Replay", "Fastest sustainable speed %.3gx%s (peak queue %.1f buffers, peak latency %.0f ms)",
+                            replay.passed, replay_settled(&replay) ? "" : " so far, input too short to settle",
+                            replay.peak_queue, replay.peak_latency * 1000.0);
+                else
+                    print_logf(LOG_WARNING, "Replay", "No sustainable speed found, %s (peak queue %.1f buffers, peak latency %.0f ms)",
+                            replay.failed > 0.0 ? "targets exceeded" : "input too short",
+                            replay.peak_queue, replay.peak_latency * 1000.0);
+            }
+            else if (replay.mode == REPLAY_FIXED) {
+                // a full buffer behind would have been queued by a live receiver
+                print_logf(replay.peak_queue >= 1.0 ? LOG_WARNING : LOG_NOTICE, "Replay", "Replayed at %.3gx: peak queue %.1f buffers, peak latency %.0f ms",
+                        replay.speed, replay.peak_queue, replay.peak_latency * 1000.0);
+            }
             reset_sdr_callback(cfg);
 
             if (in_file != stdin) {
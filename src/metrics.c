@@ -0,0 +1,364 @@
+/** @file
+    Metrics registry and OpenMetrics text rendering.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "metrics.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+uint64_t metrics_time_ns(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)((double)count.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+double metrics_bucket_bound(int i)
+{
+    return METRICS_BUCKET_BASE * (double)(1u << i);
+}
+
+void metrics_histogram_observe(metrics_histogram_t *h, uint64_t ns)
+{
+    // bucket k holds (base * 2^(k-1), base * 2^k]
+    uint64_t bound = (uint64_t)(METRICS_BUCKET_BASE * 1e9);
+    int i = 0;
+    while (i < METRICS_HISTOGRAM_BUCKETS && ns > bound) {
+        bound <<= 1;
+        i++;
+    }
+    h->bucket[i]++;
+    h->count++;
+    h->sum += ns * 1e-9;
+}
+
+static int latency_bucket(uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+    if (!us)
+        return 0;
+    int oct = 0;
+    while (us >> (oct + 1))
+        oct++;
+    if (oct >= METRICS_LATENCY_OCTAVES)
+        return METRICS_LATENCY_BUCKETS - 1;
+    // the 3 bits below the leading one select the sub-bucket
+    unsigned sub = oct >= 3 ? (unsigned)(us >> (oct - 3)) & 7 : (unsigned)(us << (3 - oct)) & 7;
+    return 1 + oct * METRICS_LATENCY_SUBBUCKETS + (int)sub;
+}
+
+/// Upper bound of latency bucket @p i in seconds.
+static double latency_bound(int i)
+{
+    if (i == 0)
+        return 1e-6;
+    int oct = (i - 1) / METRICS_LATENCY_SUBBUCKETS;
+    int sub = (i - 1) % METRICS_LATENCY_SUBBUCKETS;
+    return 1e-6 * (double)(1u << oct) * (1.0 + (sub + 1) / (double)METRICS_LATENCY_SUBBUCKETS);
+}
+
+void metrics_latency_observe(metrics_latency_t *h, uint64_t ns)
+{
+    h->bucket[latency_bucket(ns)]++;
+    h->count++;
+    h->sum += ns * 1e-9;
+    if (ns > h->max_ns)
+        h->max_ns = ns;
+}
+
+double metrics_latency_percentile(metrics_latency_t const *h, double q)
+{
+    if (!h->count)
+        return 0.0;
+    uint64_t rank = (uint64_t)ceil(q * (double)h->count);
+    if (rank < 1)
+        rank = 1;
+    uint64_t cumulative = 0;
+    double max = h->max_ns * 1e-9;
+    for (int i = 0; i < METRICS_LATENCY_BUCKETS; ++i) {
+        cumulative += h->bucket[i];
+        if (cumulative >= rank) {
+            double bound = latency_bound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+void metrics_trace_burst(metrics_pipeline_t *p, int channel, uint64_t offset, unsigned end_ago, uint32_t samp_rate, uint64_t frame_end_us)
+{
+    uint64_t ago_ns = samp_rate ? (uint64_t)end_ago * 1000000000u / samp_rate : 0;
+    uint64_t ago_us = ago_ns / 1000;
+    p->trace.channel    = channel;
+    p->trace.offset     = offset;
+    p->trace.stream_ms  = frame_end_us > ago_us ? (frame_end_us - ago_us) / 1000 : 0;
+    p->trace.burst_ns   = p->frame_start_ns > ago_ns ? p->frame_start_ns - ago_ns : 0;
+    p->trace.decoded_ns = 0;
+    p->trace.dedup_ns   = 0;
+}
+
+uint64_t metrics_trace_latency(metrics_pipeline_t *p, metrics_latency_t *h)
+{
+    if (!p->trace.burst_ns)
+        return 0;
+    uint64_t now = metrics_time_ns();
+    if (h && now > p->trace.burst_ns)
+        metrics_latency_observe(h, now - p->trace.burst_ns);
+    return now;
+}
+
+static char const *const stage_names[METRICS_STAGE_COUNT] = {
+        "frame",
+        "channelizer",
+        "resampler",
+        "am_demod",
+        "lowpass",
+        "fm_demod",
+        "detect",
+        "decode",
+        "output",
+};
+
+char const *metrics_stage_name(int stage)
+{
+    if (stage < 0 || stage >= METRICS_STAGE_COUNT)
+        return "unknown";
+    return stage_names[stage];
+}
+
+void metrics_frame_begin(metrics_pipeline_t *p)
+{
+    memset(p->stage_ns, 0, sizeof(p->stage_ns));
+    memset(&p->trace, 0, sizeof(p->trace));
+    p->frame_start_ns = metrics_time_ns();
+}
+
+uint64_t metrics_stage(metrics_pipeline_t *p, int stage, uint64_t start_ns)
+{
+    uint64_t now = metrics_time_ns();
+    p->stage_ns[stage] += now - start_ns;
+    return now;
+}
+
+void metrics_frame_end(metrics_pipeline_t *p, unsigned long n_samples, uint32_t samp_rate)
+{
+    uint64_t total = metrics_time_ns() - p->frame_start_ns;
+    p->stage_ns[METRICS_STAGE_FRAME] = total;
+    if (p->stage_ns[METRICS_STAGE_DECODE] >= p->stage_ns[METRICS_STAGE_OUTPUT])
+        p->stage_ns[METRICS_STAGE_DECODE] -= p->stage_ns[METRICS_STAGE_OUTPUT];
+    for (int i = 0; i < METRICS_STAGE_COUNT; ++i) {
+        if (p->stage_ns[i])
+            metrics_histogram_observe(&p->stage[i], p->stage_ns[i]);
+    }
+
+    if (!samp_rate)
+        return;
+    double duration = (double)n_samples / samp_rate;
+    double busy     = total * 1e-9;
+    p->input_seconds += duration;
+    p->busy_seconds += busy;
+    p->realtime_margin = 1.0 - busy / duration;
+    if (busy > duration)
+        p->frames_late++;
+
+    metrics_profile_t *prof = &p->profile;
+    if (!prof->since_ns)
+        prof->since_ns = p->frame_start_ns;
+    prof->blocks++;
+    prof->late_blocks += busy > duration;
+    prof->input_seconds += duration;
+    if (busy / duration > prof->max_load)
+        prof->max_load = busy / duration;
+    for (int i = 0; i < METRICS_STAGE_COUNT; ++i)
+        prof->stage_ns[i] += p->stage_ns[i];
+}
+
+void metrics_profile_reset(metrics_profile_t *prof)
+{
+    int enabled = prof->enabled;
+    memset(prof, 0, sizeof(*prof));
+    prof->enabled = enabled;
+}
+
+/* rendering */
+
+void metrics_writer_init(metrics_writer_t *w, metrics_flush_fn flush, void *ctx)
+{
+    w->flush = flush;
+    w->ctx   = ctx;
+    w->len   = 0;
+}
+
+static void writer_flush(metrics_writer_t *w)
+{
+    if (w->len)
+        w->flush(w->ctx, w->buf, w->len);
+    w->len = 0;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static void writer_printf(metrics_writer_t *w, char const *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(w->buf + w->len, sizeof(w->buf) - w->len, fmt, ap);
+    va_end(ap);
+    if (n < 0)
+        return;
+    if ((size_t)n < sizeof(w->buf) - w->len) {
+        w->len += (size_t)n;
+        return;
+    }
+
+    // did not fit, flush and retry, overlong lines are truncated
+    writer_flush(w);
+    va_start(ap, fmt);
+    n = vsnprintf(w->buf, sizeof(w->buf), fmt, ap);
+    va_end(ap);
+    if (n < 0)
+        return;
+    w->len = (size_t)n < sizeof(w->buf) ? (size_t)n : sizeof(w->buf) - 1;
+}
+
+static char const *const type_names[] = {
+        "counter",
+        "gauge",
+        "histogram",
+        "summary",
+};
+
+void metrics_family(metrics_writer_t *w, char const *name, int type, char const *unit, char const *help)
+{
+    writer_printf(w, "# TYPE %s %s\n", name, type_names[type]);
+    if (unit)
+        writer_printf(w, "# UNIT %s %s\n", name, unit);
+    if (help)
+        writer_printf(w, "# HELP %s %s\n", name, help);
+}
+
+/// Format a sample value, integral values without exponent.
+static void format_value(char *buf, size_t size, double value)
+{
+    if (isnan(value))
+        snprintf(buf, size, "NaN");
+    else if (isinf(value))
+        snprintf(buf, size, value > 0 ? "+Inf" : "-Inf");
+    else if (value == floor(value) && fabs(value) < 1e15)
+        snprintf(buf, size, "%.0f", value);
+    else
+        snprintf(buf, size, "%.9g", value);
+}
+
+void metrics_sample(metrics_writer_t *w, char const *name, char const *suffix, char const *labels, double value)
+{
+    char val[32];
+    format_value(val, sizeof(val), value);
+    if (labels && *labels)
+        writer_printf(w, "%s%s{%s} %s\n", name, suffix ? suffix : "", labels, val);
+    else
+        writer_printf(w, "%s%s %s\n", name, suffix ? suffix : "", val);
+}
+
+void metrics_counter(metrics_writer_t *w, char const *name, char const *labels, double value)
+{
+    metrics_sample(w, name, "_total", labels, value);
+}
+
+void metrics_gauge(metrics_writer_t *w, char const *name, char const *labels, double value)
+{
+    metrics_sample(w, name, NULL, labels, value);
+}
+
+void metrics_histogram(metrics_writer_t *w, char const *name, char const *labels, metrics_histogram_t const *h)
+{
+    char const *sep = labels && *labels ? "," : "";
+    uint64_t cumulative = 0;
+    for (int i = 0; i <= METRICS_HISTOGRAM_BUCKETS; ++i) {
+        cumulative += h->bucket[i];
+        if (i < METRICS_HISTOGRAM_BUCKETS)
+            writer_printf(w, "%s_bucket{%s%sle=\"%g\"} %llu\n", name, labels ? labels : "", sep,
+                    metrics_bucket_bound(i), (unsigned long long)cumulative);
+        else
+            writer_printf(w, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels ? labels : "", sep,
+                    (unsigned long long)cumulative);
+    }
+    metrics_sample(w, name, "_count", labels, (double)h->count);
+    metrics_sample(w, name, "_sum", labels, h->sum);
+}
+
+void metrics_summary(metrics_writer_t *w, char const *name, char const *labels, metrics_latency_t const *h)
+{
+    static char const *const quantiles[] = {"0.5", "0.9", "0.99"};
+    static double const values[]         = {0.5, 0.9, 0.99};
+    char const *sep = labels && *labels ? "," : "";
+    for (int i = 0; i < 3; ++i) {
+        char val[32];
+        format_value(val, sizeof(val), metrics_latency_percentile(h, values[i]));
+        writer_printf(w, "%s{%s%squantile=\"%s\"} %s\n", name, labels ? labels : "", sep, quantiles[i], val);
+    }
+    metrics_sample(w, name, "_count", labels, (double)h->count);
+    metrics_sample(w, name, "_sum", labels, h->sum);
+}
+
+void metrics_finish(metrics_writer_t *w)
+{
+    writer_printf(w, "# EOF\n");
+    writer_flush(w);
+}
+
+size_t metrics_label(char *labels, size_t size, char const *key, char const *value)
+{
+    size_t len = strlen(labels);
+    size_t const end = size - 1;
+#define LABEL_PUT(c) do { if (len < end) labels[len++] = (c); } while (0)
+    if (len)
+        LABEL_PUT(',');
+    for (char const *p = key; *p; ++p)
+        LABEL_PUT(*p);
+    LABEL_PUT('=');
+    LABEL_PUT('"');
+    for (char const *p = value; *p; ++p) {
+        if (*p == '\\' || *p == '"') {
+            LABEL_PUT('\\');
+            LABEL_PUT(*p);
+        }
+        else if (*p == '\n') {
+            LABEL_PUT('\\');
+            LABEL_PUT('n');
+        }
+        else {
+            LABEL_PUT(*p);
+        }
+    }
+    LABEL_PUT('"');
+#undef LABEL_PUT
+    labels[len] = '\0';
+    return len;
+}
@@ -12,6 +12,7 @@
 #include "output_file.h"
 
 #include "data.h"
+#include "data_cbor.h"
 #include "term_ctl.h"
 #include "r_util.h"
 #include "logger.h"
@@ -21,6 +22,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /* JSON printer */
 
@@ -640,3 +642,75 @@ struct data_output *data_output_csv_create(int log_level, FILE *file)
 
     return (struct data_output *)csv;
 }
+
+/* CBOR printer */
+
+#define CBOR_BUF_INITIAL 4096
+#define CBOR_BUF_MAX     (1 << 24)
+
+typedef struct {
+    struct data_output output;
+    FILE *file;
+    uint8_t *buf;
+    size_t buf_size;
+} data_output_cbor_t;
+
+static void R_API_CALLCONV data_output_cbor_print(data_output_t *output, data_t *data)
+{
+    data_output_cbor_t *cbor = (data_output_cbor_t *)output;
+
+    if (!cbor || !cbor->file)
+        return;
+
+    size_t len;
+    while (!(len = data_print_cbor(data, cbor->buf, cbor->buf_size))) {
+        if (cbor->buf_size >= CBOR_BUF_MAX) {
+            WARN("event too large in data_output_cbor_print()");
+            return;
+        }
+        uint8_t *buf = realloc(cbor->buf, cbor->buf_size * 2);
+        if (!buf) {
+            WARN_REALLOC("data_output_cbor_print()");
+            return;
+        }
+        cbor->buf = buf;
+        cbor->buf_size *= 2;
+    }
+    // items are simply concatenated, a CBOR sequence (RFC 8742)
+    fwrite(cbor->buf, 1, len, cbor->file);
+    fflush(cbor->file);
+}
+
+static void R_API_CALLCONV data_output_cbor_free(data_output_t *output)
+{
+    data_output_cbor_t *cbor = (data_output_cbor_t *)output;
+
+    if (!cbor)
+        return;
+
+    free(cbor->buf);
+    free(cbor);
+}
+
+struct data_output *data_output_cbor_create(int log_level, FILE *file)
+{
+    data_output_cbor_t *cbor = calloc(1, sizeof(data_output_cbor_t));
+    if (!cbor) {
+        WARN_CALLOC("data_output_cbor_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    cbor->buf = malloc(CBOR_BUF_INITIAL);
+    if (!cbor->buf) {
+        WARN_MALLOC("data_output_cbor_create()");
+        free(cbor);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    cbor->output.log_level    = log_level;
+    cbor->output.output_print = data_output_cbor_print;
+    cbor->output.output_free  = data_output_cbor_free;
+    cbor->file                = file;
+    cbor->buf_size            = CBOR_BUF_INITIAL;
+
+    return (struct data_output *)cbor;
+}
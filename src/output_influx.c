@@ -25,8 +25,18 @@
 
 #include "mongoose.h"
 
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+
 /* InfluxDB client abstraction / printer */
 
+#define INFLUX_BATCH_LINES 5000          ///< default max lines per write
+#define INFLUX_BATCH_BYTES (1024 * 1024) ///< default max uncompressed bytes per write
+#define INFLUX_BATCH_DELAY 1000          ///< default max delay in ms before a partial batch is written
+#define INFLUX_SPILL_BYTES (16 * 1024 * 1024) ///< default max bytes kept for retry while InfluxDB is unavailable
+#define INFLUX_DRAIN_TIMEOUT 2.0         ///< max seconds spent writing the pending lines on shutdown
+
 typedef struct {
     struct data_output output;
     struct mg_mgr *mgr;
@@ -37,14 +47,31 @@ typedef struct {
     int prev_resp_code;
     char hostname[64];
     char url[400];
+    char conn_addr[300]; ///< "tcp://host:port"
+    char host_hdr[300];  ///< "host[:port]" for the Host header
+    char path[400];      ///< path and query of the write endpoint
     char extra_headers[150];
     tls_opts_t tls_opts;
     int databufidxfill;
-    struct mbuf databufs[2];
-
+    struct mbuf databufs[2]; ///< lines being filled, lines of the request in flight
+    struct mbuf gzbuf;   ///< compressed request body
+    int fill_lines;
+    int send_lines;
+    double fill_since;   ///< time the oldest line was added to the fill buffer
+    double retry_at;     ///< no requests before this time after a failure
+    int timer_armed;
+    int send_done;       ///< request was answered, no retry needed
+    int batch_lines;
+    size_t batch_bytes;
+    double batch_delay;
+    size_t spill_bytes;
+    int gzip_level;      ///< 0 to send uncompressed bodies
+    unsigned dropped_lines;
 } influx_client_t;
 
 static void influx_client_send(influx_client_t *ctx);
+static void influx_client_flush(influx_client_t *ctx);
+static void influx_client_requeue(influx_client_t *ctx);
 
 static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
 {
@@ -76,12 +103,17 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
     case MG_EV_HTTP_CHUNK: // response is normally empty (so mongoose thinks we received a chunk only)
     case MG_EV_HTTP_REPLY:
         nc->flags |= MG_F_CLOSE_IMMEDIATELY;
-        if (hm->resp_code == 204) {
+        if (hm->resp_code >= 200 && hm->resp_code < 300) {
             // mark influx data as sent
+            if (ctx)
+                ctx->send_done = 1;
         }
         else {
             if (ctx && ctx->prev_resp_code != hm->resp_code)
-                print_logf(LOG_WARNING, "InfluxDB", "InfluxDB replied HTTP code: %d with message:\n%s", hm->resp_code, hm->body.p);
+                print_logf(LOG_WARNING, "InfluxDB", "InfluxDB replied HTTP code: %d with message:\n%.*s", hm->resp_code, (int)hm->body.len, hm->body.p);
+            // client errors won't go away on retry, drop the batch
+            if (ctx && hm->resp_code >= 400 && hm->resp_code < 500 && hm->resp_code != 408 && hm->resp_code != 429)
+                ctx->send_done = 1;
         }
         if (ctx) {
             ctx->prev_resp_code = hm->resp_code;
@@ -95,8 +127,18 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
         if (!ctx->timer) {
             break; // shutting down
         }
-        // Timer for next connect attempt, sends us MG_EV_TIMER event
-        mg_set_timer(ctx->timer, mg_time() + ctx->reconnect_delay);
+        if (ctx->send_done) {
+            ctx->databufs[ctx->databufidxfill ^ 1].len = 0;
+            ctx->send_lines = 0;
+            ctx->reconnect_delay = 0;
+            influx_client_flush(ctx);
+            break;
+        }
+        // Failed, keep the lines and retry later, sends us MG_EV_TIMER event
+        influx_client_requeue(ctx);
+        ctx->retry_at = mg_time() + ctx->reconnect_delay;
+        ctx->timer_armed = 1;
+        mg_set_timer(ctx->timer, ctx->retry_at);
         if (ctx->reconnect_delay < 60) {
             // 0, 1, 3, 6, 10, 16, 25, 39, 60
             ctx->reconnect_delay = (ctx->reconnect_delay + 1) * 3 / 2;
@@ -113,8 +155,11 @@ static void influx_client_timer(struct mg_connection *nc, int ev, void *ev_data)
 
     switch (ev) {
     case MG_EV_TIMER: {
-        // Try to reconnect, ends if no data to send
-        influx_client_send(ctx);
+        // Batch delay expired or retry, ends if no data to send
+        if (ctx) {
+            ctx->timer_armed = 0;
+            influx_client_flush(ctx);
+        }
         break;
     }
     }
@@ -128,6 +173,101 @@ static influx_client_t *influx_client_init(influx_client_t *ctx, char const *url
     return ctx;
 }
 
+/// Drop the oldest lines until the fill buffer fits the spill limit.
+static void influx_client_trim(influx_client_t *ctx)
+{
+    struct mbuf *buf = &ctx->databufs[ctx->databufidxfill];
+    if (buf->len <= ctx->spill_bytes)
+        return;
+
+    char *cut = memchr(&buf->buf[buf->len - ctx->spill_bytes], '\n', ctx->spill_bytes);
+    size_t cut_len = cut ? (size_t)(cut - buf->buf) + 1 : buf->len;
+    int lines = 0;
+    for (char *p = buf->buf; p < &buf->buf[cut_len]; ++p)
+        if (*p == '\n')
+            lines++;
+    mbuf_remove(buf, cut_len);
+    ctx->fill_lines -= lines;
+    if (ctx->dropped_lines / 1000 != (ctx->dropped_lines + lines) / 1000 || !ctx->dropped_lines)
+        print_logf(LOG_WARNING, "InfluxDB", "InfluxDB unavailable, dropped %u lines", ctx->dropped_lines + lines);
+    ctx->dropped_lines += lines;
+}
+
+/// Put the lines of a failed request back in front of the fill buffer.
+static void influx_client_requeue(influx_client_t *ctx)
+{
+    struct mbuf *sent = &ctx->databufs[ctx->databufidxfill ^ 1];
+    struct mbuf *fill = &ctx->databufs[ctx->databufidxfill];
+    if (!sent->len)
+        return;
+
+    if (!fill->len)
+        ctx->fill_since = mg_time();
+    mbuf_insert(fill, 0, sent->buf, sent->len);
+    ctx->fill_lines += ctx->send_lines;
+    sent->len  = 0;
+    ctx->send_lines = 0;
+    influx_client_trim(ctx);
+}
+
+/// Send the batch if full or due, otherwise arm the timer for the batch delay.
+static void influx_client_flush(influx_client_t *ctx)
+{
+    struct mbuf *buf = &ctx->databufs[ctx->databufidxfill];
+
+    if (ctx->conn || !buf->len)
+        return;
+
+    double now = mg_time();
+    if (ctx->retry_at > now)
+        return; // backing off, the timer is armed
+
+    if (ctx->fill_lines < ctx->batch_lines && buf->len < ctx->batch_bytes
+            && now < ctx->fill_since + ctx->batch_delay) {
+        if (!ctx->timer_armed) {
+            ctx->timer_armed = 1;
+            mg_set_timer(ctx->timer, ctx->fill_since + ctx->batch_delay);
+        }
+        return;
+    }
+
+    influx_client_send(ctx);
+}
+
+/// Compress the request body, returns 0 on success.
+static int influx_client_gzip(influx_client_t *ctx, char const *data, size_t len)
+{
+#ifdef ZLIB
+    z_stream zs = {0};
+    // windowBits 15 + 16 selects the gzip wrapper
+    if (deflateInit2(&zs, ctx->gzip_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return -1;
+
+    size_t bound = deflateBound(&zs, (uLong)len);
+    mbuf_clear(&ctx->gzbuf);
+    if (ctx->gzbuf.size < bound)
+        mbuf_resize(&ctx->gzbuf, bound);
+    if (ctx->gzbuf.size < bound) {
+        deflateEnd(&zs);
+        return -1;
+    }
+
+    zs.next_in   = (Bytef *)data;
+    zs.avail_in  = (uInt)len;
+    zs.next_out  = (Bytef *)ctx->gzbuf.buf;
+    zs.avail_out = (uInt)ctx->gzbuf.size;
+    int ret = deflate(&zs, Z_FINISH);
+    ctx->gzbuf.len = zs.total_out;
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END ? 0 : -1;
+#else
+    UNUSED(ctx);
+    UNUSED(data);
+    UNUSED(len);
+    return -1;
+#endif
+}
+
 static void influx_client_send(influx_client_t *ctx)
 {
     struct mbuf *buf = &ctx->databufs[ctx->databufidxfill];
@@ -171,14 +311,54 @@ static void influx_client_send(influx_client_t *ctx)
         exit(1);
 #endif
     }
-    if ((ctx->conn = mg_connect_http_opt(ctx->mgr, influx_client_event, opts, ctx->url, ctx->extra_headers, buf->buf)) == NULL) {
-        print_logf(LOG_WARNING, "InfluxDB", "Connect to InfluxDB (%s) failed (%s)", ctx->url, error_string);
+
+    // cap the write at batch_lines and batch_bytes (but at least one line), the rest stays for the next write
+    size_t send_len = buf->len;
+    int send_lines  = ctx->fill_lines;
+    if (send_lines > ctx->batch_lines || send_len > ctx->batch_bytes) {
+        send_len   = 0;
+        send_lines = 0;
+        for (size_t i = 0; i < buf->len && send_lines < ctx->batch_lines; ++i) {
+            if (buf->buf[i] != '\n')
+                continue;
+            if (i + 1 > ctx->batch_bytes && send_lines > 0)
+                break;
+            send_len = i + 1;
+            send_lines++;
+        }
     }
-    else {
-        ctx->databufidxfill ^= 1;
-        buf->len = 0;
-        *buf->buf = '\0';
+
+    char const *body = buf->buf;
+    size_t body_len  = send_len;
+    int gzipped      = ctx->gzip_level && !influx_client_gzip(ctx, buf->buf, send_len);
+    if (gzipped) {
+        body     = ctx->gzbuf.buf;
+        body_len = ctx->gzbuf.len;
     }
+
+    if ((ctx->conn = mg_connect_opt(ctx->mgr, ctx->conn_addr, influx_client_event, opts)) == NULL) {
+        print_logf(LOG_WARNING, "InfluxDB", "Connect to InfluxDB (%s) failed (%s)", ctx->url, error_string);
+        ctx->retry_at    = mg_time() + 1;
+        ctx->timer_armed = 1;
+        mg_set_timer(ctx->timer, ctx->retry_at);
+        return;
+    }
+    mg_set_protocol_http_websocket(ctx->conn);
+    mg_printf(ctx->conn, "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Length: %lu\r\n%s%s\r\n",
+            ctx->path, ctx->host_hdr, (unsigned long)body_len,
+            gzipped ? "Content-Encoding: gzip\r\n" : "", ctx->extra_headers);
+    mg_send(ctx->conn, body, (int)body_len);
+
+    // keep the lines until the request is acknowledged
+    ctx->send_done  = 0;
+    ctx->send_lines = send_lines;
+    ctx->fill_lines -= send_lines;
+    ctx->databufidxfill ^= 1;
+    struct mbuf *fill = &ctx->databufs[ctx->databufidxfill];
+    fill->len = 0;
+    if (buf->len > send_len)
+        mbuf_append(fill, &buf->buf[send_len], buf->len - send_len);
+    buf->len = send_len;
 }
 
 /* Helper */
@@ -435,7 +615,10 @@ static void R_API_CALLCONV print_influx_data(data_output_t *output, data_t *data
     }
     mbuf_snprintf(buf, "\n");
 
-    influx_client_send(influx);
+    if (!influx->fill_lines++)
+        influx->fill_since = mg_time();
+    influx_client_trim(influx);
+    influx_client_flush(influx);
 }
 
 static void R_API_CALLCONV print_influx_double(data_output_t *output, double data, char const *format)
@@ -454,6 +637,25 @@ static void R_API_CALLCONV print_influx_int(data_output_t *output, int data, cha
     mbuf_snprintf(buf, "%d", data);
 }
 
+/// Write the pending lines before shutting down, gives up on a failure or after INFLUX_DRAIN_TIMEOUT.
+static void influx_client_drain(influx_client_t *ctx)
+{
+    double end = mg_time() + INFLUX_DRAIN_TIMEOUT;
+    ctx->batch_delay = 0.0; // partial batches are due
+    ctx->retry_at    = 0.0;
+    influx_client_flush(ctx);
+    while (ctx->conn && mg_time() < end) {
+        mg_mgr_poll(ctx->mgr, 10);
+        // an answered write sends the next batch itself, a failed one is retried unless backing off
+        if (!ctx->conn && ctx->retry_at <= mg_time())
+            influx_client_flush(ctx);
+    }
+
+    int pending = ctx->fill_lines + ctx->send_lines;
+    if (pending)
+        print_logf(LOG_WARNING, "InfluxDB", "InfluxDB unavailable on shutdown, dropped %d lines", pending);
+}
+
 static void R_API_CALLCONV data_output_influx_free(data_output_t *output)
 {
     influx_client_t *influx = (influx_client_t *)output;
@@ -461,12 +663,22 @@ static void R_API_CALLCONV data_output_influx_free(data_output_t *output)
     if (!influx)
         return;
 
+    if (influx->timer)
+        influx_client_drain(influx);
+
     // remove ctx from our connections
     if (influx->conn) {
         influx->conn->user_data = NULL;
         influx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    if (influx->timer) {
+        influx->timer->user_data = NULL;
+        influx->timer->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
 
+    mbuf_free(&influx->databufs[0]);
+    mbuf_free(&influx->databufs[1]);
+    mbuf_free(&influx->gzbuf);
     free(influx);
 }
 
@@ -507,7 +719,8 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
 
     // check if valid URL has been provided
     struct mg_str host, path, query;
-    if (mg_parse_uri(mg_mk_str(url), NULL, NULL, &host, NULL, &path,
+    unsigned int port = 0;
+    if (mg_parse_uri(mg_mk_str(url), NULL, NULL, &host, &port, &path,
                 &query, NULL) != 0
             || !host.len || !path.len || !query.len) {
         print_logf(LOG_FATAL, __func__, "Invalid URL to InfluxDB specified.%s%s%s"
@@ -517,6 +730,16 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
                 !query.len ? " No query parameters specified." : "");
         exit(1);
     }
+    if (!port)
+        port = influx->tls_opts.tls_ca_cert ? 443 : 80;
+    snprintf(influx->conn_addr, sizeof(influx->conn_addr), "tcp://%.*s:%u", (int)host.len, host.p, port);
+    snprintf(influx->host_hdr, sizeof(influx->host_hdr), "%.*s", (int)(path.p - host.p), host.p);
+    snprintf(influx->path, sizeof(influx->path), "%.*s?%.*s", (int)path.len, path.p, (int)query.len, query.p);
+
+    influx->batch_lines = INFLUX_BATCH_LINES;
+    influx->batch_bytes = INFLUX_BATCH_BYTES;
+    influx->batch_delay = INFLUX_BATCH_DELAY / 1000.0;
+    influx->spill_bytes = INFLUX_SPILL_BYTES;
 
     // parse auth and format options
     char *key, *val;
@@ -527,6 +750,16 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
             continue;
         else if (!strcasecmp(key, "t") || !strcasecmp(key, "token"))
             token = val;
+        else if (!strcasecmp(key, "batch_lines"))
+            influx->batch_lines = atoiv(val, INFLUX_BATCH_LINES);
+        else if (!strcasecmp(key, "batch_bytes"))
+            influx->batch_bytes = (size_t)atoiv(val, INFLUX_BATCH_BYTES);
+        else if (!strcasecmp(key, "batch_delay"))
+            influx->batch_delay = atoiv(val, INFLUX_BATCH_DELAY) / 1000.0;
+        else if (!strcasecmp(key, "spill"))
+            influx->spill_bytes = (size_t)atoiv(val, INFLUX_SPILL_BYTES);
+        else if (!strcasecmp(key, "gzip"))
+            influx->gzip_level = atoiv(val, 6);
         else if (!tls_param(&influx->tls_opts, key, val)) {
             // ok
         }
@@ -543,7 +776,21 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
     influx->output.print_int    = print_influx_int;
     influx->output.output_free  = data_output_influx_free;
 
+    if (influx->batch_lines < 1)
+        influx->batch_lines = 1;
+    if (influx->spill_bytes < influx->batch_bytes)
+        influx->spill_bytes = influx->batch_bytes;
+#ifndef ZLIB
+    if (influx->gzip_level) {
+        print_log(LOG_WARNING, "InfluxDB", "gzip not available (built without zlib), sending uncompressed");
+        influx->gzip_level = 0;
+    }
+#endif
+
     print_logf(LOG_CRITICAL, "InfluxDB", "Publishing data to InfluxDB (%s)", url);
+    print_logf(LOG_NOTICE, "InfluxDB", "Batching up to %d lines, %u bytes, %d ms%s",
+            influx->batch_lines, (unsigned)influx->batch_bytes, (int)(influx->batch_delay * 1000.0),
+            influx->gzip_level ? ", gzip" : "");
 
     influx->mgr = mgr;
 
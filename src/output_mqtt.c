@@ -25,6 +25,18 @@
 
 /* MQTT client abstraction */
 
+#define MQTT_DEFAULT_INFLIGHT 16   ///< default QoS>0 in-flight window (unacknowledged messages)
+#define MQTT_DEFAULT_BACKLOG  1024 ///< default QoS>0 messages held while the window is full
+#define MQTT_FLAG_DUP         0x08 ///< fixed header DUP bit (note: MG_MQTT_DUP is wrong)
+
+/// An encoded PUBLISH packet, kept until acknowledged for QoS>0.
+typedef struct mqtt_packet {
+    char *buf;
+    size_t len;
+    size_t id_offset; ///< offset of the message id in buf
+    uint16_t message_id;
+} mqtt_packet_t;
+
 typedef struct mqtt_client {
     struct mg_connect_opts connect_opts;
     struct mg_send_mqtt_handshake_opts mqtt_opts;
@@ -36,11 +48,23 @@ typedef struct mqtt_client {
     char client_id[256];
     uint16_t message_id;
     int publish_flags; // MG_MQTT_RETAIN | MG_MQTT_QOS(0)
+    struct mbuf batch; ///< encoded packets of the current event, sent with a single mg_send()
+    mqtt_packet_t *inflight; ///< QoS>0 packets awaiting PUBACK/PUBCOMP, in send order
+    int inflight_len;
+    int inflight_max;
+    mqtt_packet_t *backlog; ///< ring of QoS>0 packets waiting for a free in-flight slot
+    int backlog_head;
+    int backlog_len;
+    int backlog_max;
+    unsigned backlog_dropped;
 } mqtt_client_t;
 
 char const *mqtt_availability_online  = "online";
 char const *mqtt_availability_offline = "offline";
 
+static void mqtt_client_ack(mqtt_client_t *ctx, uint16_t message_id);
+static void mqtt_client_resend(mqtt_client_t *ctx);
+
 static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
 {
     // note that while shutting down the ctx is NULL
@@ -84,10 +108,23 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
                 ctx->message_id++;
                 mg_mqtt_publish(ctx->conn, ctx->mqtt_opts.will_topic, ctx->message_id, MG_MQTT_QOS(0) | MG_MQTT_RETAIN, mqtt_availability_online, strlen(mqtt_availability_online));
             }
+            mqtt_client_resend(ctx);
         }
         break;
     case MG_EV_MQTT_PUBACK:
-        print_logf(LOG_NOTICE, "MQTT", "MQTT Message publishing acknowledged (msg_id: %u)", msg->message_id);
+        print_logf(LOG_DEBUG, "MQTT", "MQTT Message publishing acknowledged (msg_id: %u)", msg->message_id);
+        if (ctx) {
+            mqtt_client_ack(ctx, msg->message_id);
+        }
+        break;
+    case MG_EV_MQTT_PUBREC:
+        mg_mqtt_pubrel(nc, msg->message_id);
+        break;
+    case MG_EV_MQTT_PUBCOMP:
+        print_logf(LOG_DEBUG, "MQTT", "MQTT Message publishing completed (msg_id: %u)", msg->message_id);
+        if (ctx) {
+            mqtt_client_ack(ctx, msg->message_id);
+        }
         break;
     case MG_EV_MQTT_SUBACK:
         print_log(LOG_NOTICE, "MQTT", "MQTT Subscription acknowledged.");
@@ -102,6 +139,7 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
             break; // shutting down
         }
         ctx->conn = NULL;
+        mbuf_clear(&ctx->batch); // QoS 0 packets are lost, QoS>0 are resent from the window
         if (!ctx->timer) {
             break; // shutting down
         }
@@ -143,12 +181,25 @@ static void mqtt_client_timer(struct mg_connection *nc, int ev, void *ev_data)
     }
 }
 
-static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, char const *availability)
+static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, int inflight, int backlog, char const *availability)
 {
     mqtt_client_t *ctx = calloc(1, sizeof(*ctx));
     if (!ctx)
         FATAL_CALLOC("mqtt_client_init()");
 
+    mbuf_init(&ctx->batch, 0);
+    if (qos > 0) {
+        ctx->inflight_max = inflight > 0 ? inflight : MQTT_DEFAULT_INFLIGHT;
+        ctx->backlog_max  = backlog > 0 ? backlog : MQTT_DEFAULT_BACKLOG;
+        ctx->inflight = calloc((size_t)ctx->inflight_max, sizeof(*ctx->inflight));
+        if (!ctx->inflight)
+            FATAL_CALLOC("mqtt_client_init()");
+        ctx->backlog = calloc((size_t)ctx->backlog_max, sizeof(*ctx->backlog));
+        if (!ctx->backlog)
+            FATAL_CALLOC("mqtt_client_init()");
+        print_logf(LOG_NOTICE, "MQTT", "QoS %d with %d messages in-flight, %d backlog", qos, ctx->inflight_max, ctx->backlog_max);
+    }
+
     ctx->mqtt_opts.user_name = user;
     ctx->mqtt_opts.password  = pass;
     ctx->mqtt_opts.will_topic = availability;
@@ -215,21 +266,178 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
     return ctx;
 }
 
-static void mqtt_client_publish(mqtt_client_t *ctx, char const *topic, char const *str)
+static int mqtt_client_connected(mqtt_client_t *ctx)
 {
-    if (!ctx->conn || !ctx->conn->proto_handler)
+    return ctx->conn && ctx->conn->proto_handler;
+}
+
+/// Encode a PUBLISH packet, returns the offset of the message id (0 if QoS 0).
+static size_t mqtt_encode_publish(struct mbuf *mb, char const *topic, int flags, uint16_t message_id, char const *payload, size_t payload_len)
+{
+    size_t topic_len = strlen(topic);
+    size_t total_len = 2 + topic_len + payload_len;
+    if (MG_MQTT_GET_QOS(flags) > 0) {
+        total_len += 2;
+    }
+
+    // fixed header with variable length encoding
+    uint8_t hdr[1 + 4];
+    uint8_t *vlen = &hdr[1];
+    hdr[0] = (uint8_t)((MG_MQTT_CMD_PUBLISH << 4) | flags);
+    do {
+        *vlen = total_len % 0x80;
+        total_len /= 0x80;
+        if (total_len > 0)
+            *vlen |= 0x80;
+        vlen++;
+    } while (total_len > 0 && vlen < hdr + sizeof(hdr));
+    mbuf_append(mb, hdr, vlen - hdr);
+
+    uint8_t netbytes[2] = {(uint8_t)(topic_len >> 8), (uint8_t)topic_len};
+    mbuf_append(mb, netbytes, 2);
+    mbuf_append(mb, topic, topic_len);
+
+    size_t id_offset = 0;
+    if (MG_MQTT_GET_QOS(flags) > 0) {
+        id_offset   = mb->len;
+        netbytes[0] = (uint8_t)(message_id >> 8);
+        netbytes[1] = (uint8_t)message_id;
+        mbuf_append(mb, netbytes, 2);
+    }
+
+    mbuf_append(mb, payload, payload_len);
+    return id_offset;
+}
+
+/// Send all queued packets of the current event with a single write to the connection buffer.
+static void mqtt_client_flush(mqtt_client_t *ctx)
+{
+    if (!ctx->batch.len)
+        return;
+    if (!mqtt_client_connected(ctx)) {
+        mbuf_clear(&ctx->batch);
         return;
+    }
 
+    mg_send(ctx->conn, ctx->batch.buf, (int)ctx->batch.len);
+    mbuf_clear(&ctx->batch);
+    // we bypassed mg_mqtt_publish(), keep the keep-alive timer current
+    struct mg_mqtt_proto_data *pd = (struct mg_mqtt_proto_data *)ctx->conn->proto_data;
+    if (pd)
+        pd->last_control_time = mg_time();
+}
+
+static uint16_t mqtt_client_next_id(mqtt_client_t *ctx)
+{
     ctx->message_id++;
-    mg_mqtt_publish(ctx->conn, topic, ctx->message_id, ctx->publish_flags, str, strlen(str));
+    if (!ctx->message_id)
+        ctx->message_id++; // zero is not a valid message id
+    return ctx->message_id;
+}
+
+/// Move a QoS>0 packet into the in-flight window and queue it for sending.
+static void mqtt_client_send_packet(mqtt_client_t *ctx, mqtt_packet_t pkt)
+{
+    pkt.message_id = mqtt_client_next_id(ctx);
+    pkt.buf[pkt.id_offset]     = (char)(pkt.message_id >> 8);
+    pkt.buf[pkt.id_offset + 1] = (char)pkt.message_id;
+    mbuf_append(&ctx->batch, pkt.buf, pkt.len);
+    ctx->inflight[ctx->inflight_len++] = pkt;
+}
+
+/// Fill the in-flight window from the backlog.
+static void mqtt_client_drain(mqtt_client_t *ctx)
+{
+    while (ctx->backlog_len && ctx->inflight_len < ctx->inflight_max && mqtt_client_connected(ctx)) {
+        mqtt_packet_t pkt = ctx->backlog[ctx->backlog_head];
+        ctx->backlog_head = (ctx->backlog_head + 1) % ctx->backlog_max;
+        ctx->backlog_len--;
+        mqtt_client_send_packet(ctx, pkt);
+    }
+}
+
+static void mqtt_client_ack(mqtt_client_t *ctx, uint16_t message_id)
+{
+    for (int i = 0; i < ctx->inflight_len; ++i) {
+        if (ctx->inflight[i].message_id == message_id) {
+            free(ctx->inflight[i].buf);
+            ctx->inflight_len--;
+            memmove(&ctx->inflight[i], &ctx->inflight[i + 1], (size_t)(ctx->inflight_len - i) * sizeof(*ctx->inflight));
+            break;
+        }
+    }
+    mqtt_client_drain(ctx);
+    mqtt_client_flush(ctx);
+}
+
+/// Retransmit unacknowledged packets after a reconnect, then continue with the backlog.
+static void mqtt_client_resend(mqtt_client_t *ctx)
+{
+    for (int i = 0; i < ctx->inflight_len; ++i) {
+        mqtt_packet_t *pkt = &ctx->inflight[i];
+        pkt->buf[0] |= MQTT_FLAG_DUP;
+        mbuf_append(&ctx->batch, pkt->buf, pkt->len);
+    }
+    mqtt_client_drain(ctx);
+    mqtt_client_flush(ctx);
+}
+
+static void mqtt_client_publish(mqtt_client_t *ctx, char const *topic, char const *str)
+{
+    // QoS 0: encode straight into the batch, drop while disconnected
+    if (!ctx->inflight_max) {
+        if (!mqtt_client_connected(ctx))
+            return;
+        mqtt_encode_publish(&ctx->batch, topic, ctx->publish_flags, mqtt_client_next_id(ctx), str, strlen(str));
+        return;
+    }
+
+    // QoS>0: keep an owned copy until acknowledged
+    struct mbuf mb;
+    mbuf_init(&mb, 0);
+    mqtt_packet_t pkt = {0};
+    pkt.id_offset = mqtt_encode_publish(&mb, topic, ctx->publish_flags, 0, str, strlen(str));
+    if (!mb.buf || mb.len < pkt.id_offset + 2) {
+        mbuf_free(&mb);
+        WARN_MALLOC("mqtt_client_publish()");
+        return; // NOTE: skip output on alloc failure.
+    }
+    pkt.buf = mb.buf; // take ownership
+    pkt.len = mb.len;
+
+    if (ctx->inflight_len < ctx->inflight_max && !ctx->backlog_len && mqtt_client_connected(ctx)) {
+        mqtt_client_send_packet(ctx, pkt);
+        return;
+    }
+
+    // window full or disconnected: spill to the bounded backlog, dropping the oldest
+    if (ctx->backlog_len == ctx->backlog_max) {
+        free(ctx->backlog[ctx->backlog_head].buf);
+        ctx->backlog_head = (ctx->backlog_head + 1) % ctx->backlog_max;
+        ctx->backlog_len--;
+        if (ctx->backlog_dropped++ % 1000 == 0)
+            print_logf(LOG_WARNING, "MQTT", "MQTT backlog full, dropped %u messages", ctx->backlog_dropped);
+    }
+    ctx->backlog[(ctx->backlog_head + ctx->backlog_len) % ctx->backlog_max] = pkt;
+    ctx->backlog_len++;
 }
 
 static void mqtt_client_free(mqtt_client_t *ctx)
 {
-    if (ctx && ctx->conn) {
+    if (!ctx)
+        return;
+
+    if (ctx->conn) {
         ctx->conn->user_data = NULL;
         ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    for (int i = 0; i < ctx->inflight_len; ++i)
+        free(ctx->inflight[i].buf);
+    for (int i = 0; i < ctx->backlog_len; ++i)
+        free(ctx->backlog[(ctx->backlog_head + i) % ctx->backlog_max].buf);
+    free(ctx->inflight);
+    free(ctx->backlog);
+    mbuf_free(&ctx->batch);
     free(ctx);
 }
 
@@ -247,6 +455,18 @@ static char *mqtt_sanitize_topic(char *topic)
 
 /* MQTT printer */
 
+/* Topic cache */
+
+#define MQTT_TOPIC_CACHE_SIZE 128 ///< direct-mapped, must be a power of two
+
+/// Expanded "devices" and "events" topics for one set of token values.
+typedef struct mqtt_topic_entry {
+    uint32_t hash;
+    char *key;
+    char *devices;
+    char *events;
+} mqtt_topic_entry_t;
+
 typedef struct {
     struct data_output output;
     mqtt_client_t *mqc;
@@ -258,6 +478,9 @@ typedef struct {
     char *states;
     //char *homie;
     //char *hass;
+    char *states_buf; ///< reused message buffer for the large "states" JSON
+    mqtt_topic_entry_t topic_cache[MQTT_TOPIC_CACHE_SIZE];
+    mqtt_topic_entry_t topic_scratch; ///< used for tokens that can't be cached
 } data_output_mqtt_t;
 
 static void R_API_CALLCONV print_mqtt_array(data_output_t *output, data_array_t *array, char const *format)
@@ -290,30 +513,37 @@ static char *append_topic(char *topic, data_t *data)
     return topic;
 }
 
-static char *expand_topic(char *topic, char const *format, data_t *data, char const *hostname)
+/// Well-known top level keys used in topic format strings.
+typedef struct mqtt_tokens {
+    data_t *type;
+    data_t *model;
+    data_t *subtype;
+    data_t *channel;
+    data_t *id;
+    data_t *protocol;
+} mqtt_tokens_t;
+
+static void collect_tokens(mqtt_tokens_t *tokens, data_t *data)
 {
-    // collect well-known top level keys
-    data_t *data_type    = NULL;
-    data_t *data_model   = NULL;
-    data_t *data_subtype = NULL;
-    data_t *data_channel = NULL;
-    data_t *data_id      = NULL;
-    data_t *data_protocol = NULL;
+    *tokens = (mqtt_tokens_t){0};
     for (data_t *d = data; d; d = d->next) {
         if (!strcmp(d->key, "type"))
-            data_type = d;
+            tokens->type = d;
         else if (!strcmp(d->key, "model"))
-            data_model = d;
+            tokens->model = d;
         else if (!strcmp(d->key, "subtype"))
-            data_subtype = d;
+            tokens->subtype = d;
         else if (!strcmp(d->key, "channel"))
-            data_channel = d;
+            tokens->channel = d;
         else if (!strcmp(d->key, "id"))
-            data_id = d;
+            tokens->id = d;
         else if (!strcmp(d->key, "protocol")) // NOTE: needs "-M protocol"
-            data_protocol = d;
+            tokens->protocol = d;
     }
+}
 
+static char *expand_topic(char *topic, char const *format, mqtt_tokens_t const *tokens, char const *hostname)
+{
     // consume entire format string
     while (format && *format) {
         data_t *data_token  = NULL;
@@ -356,17 +586,17 @@ static char *expand_topic(char *topic, char const *format, data_t *data, char co
         if (!strncmp(t_start, "hostname", t_end - t_start))
             string_token = hostname;
         else if (!strncmp(t_start, "type", t_end - t_start))
-            data_token = data_type;
+            data_token = tokens->type;
         else if (!strncmp(t_start, "model", t_end - t_start))
-            data_token = data_model;
+            data_token = tokens->model;
         else if (!strncmp(t_start, "subtype", t_end - t_start))
-            data_token = data_subtype;
+            data_token = tokens->subtype;
         else if (!strncmp(t_start, "channel", t_end - t_start))
-            data_token = data_channel;
+            data_token = tokens->channel;
         else if (!strncmp(t_start, "id", t_end - t_start))
-            data_token = data_id;
+            data_token = tokens->id;
         else if (!strncmp(t_start, "protocol", t_end - t_start))
-            data_token = data_protocol;
+            data_token = tokens->protocol;
         else {
             print_logf(LOG_FATAL, __func__, "unknown token \"%.*s\"", (int)(t_end - t_start), t_start);
             exit(1);
@@ -389,6 +619,82 @@ static char *expand_topic(char *topic, char const *format, data_t *data, char co
     return topic;
 }
 
+static void topic_entry_free(mqtt_topic_entry_t *entry)
+{
+    free(entry->key);
+    free(entry->devices);
+    free(entry->events);
+    *entry = (mqtt_topic_entry_t){0};
+}
+
+static uint32_t fnv1a_hash(char const *str)
+{
+    uint32_t hash = 0x811c9dc5u; // FNV offset basis
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= 0x01000193u; // FNV prime
+    }
+    return hash;
+}
+
+/// Pack all token values into a cache key, a missing token is distinct from an empty one.
+static int topic_cache_key(char *key, size_t size, mqtt_tokens_t const *tokens)
+{
+    data_t const *list[] = {tokens->type, tokens->model, tokens->subtype, tokens->channel, tokens->id, tokens->protocol};
+    size_t pos = 0;
+    for (unsigned i = 0; i < sizeof(list) / sizeof(*list); ++i) {
+        data_t const *d = list[i];
+        int n;
+        if (!d)
+            n = snprintf(key + pos, size - pos, "\x1e");
+        else if (d->type == DATA_STRING)
+            n = snprintf(key + pos, size - pos, "%s\x1f", (char const *)d->value.v_ptr);
+        else if (d->type == DATA_INT)
+            n = snprintf(key + pos, size - pos, "%d\x1f", d->value.v_int);
+        else
+            return -1; // not cacheable, expand_topic() will complain
+        if (n < 0 || (size_t)n >= size - pos)
+            return -1; // too long, don't cache
+        pos += (size_t)n;
+    }
+    return 0;
+}
+
+/// Return the cached topics for these tokens, expanding and caching on a miss.
+static mqtt_topic_entry_t const *topic_cache_lookup(data_output_mqtt_t *mqtt, mqtt_tokens_t const *tokens)
+{
+    char key[256];
+    char topic[sizeof(mqtt->topic)];
+
+    int cacheable = topic_cache_key(key, sizeof(key), tokens) == 0;
+    uint32_t hash = cacheable ? fnv1a_hash(key) : 0;
+    mqtt_topic_entry_t *entry = cacheable ? &mqtt->topic_cache[hash & (MQTT_TOPIC_CACHE_SIZE - 1)] : &mqtt->topic_scratch;
+
+    if (cacheable && entry->key && entry->hash == hash && !strcmp(entry->key, key))
+        return entry; // hit
+
+    topic_entry_free(entry);
+    if (mqtt->devices) {
+        expand_topic(topic, mqtt->devices, tokens, mqtt->hostname);
+        entry->devices = strdup(topic);
+        if (!entry->devices)
+            WARN_STRDUP("topic_cache_lookup()");
+    }
+    if (mqtt->events) {
+        expand_topic(topic, mqtt->events, tokens, mqtt->hostname);
+        entry->events = strdup(topic);
+        if (!entry->events)
+            WARN_STRDUP("topic_cache_lookup()");
+    }
+    if (cacheable) {
+        entry->hash = hash;
+        entry->key  = strdup(key);
+        if (!entry->key)
+            WARN_STRDUP("topic_cache_lookup()");
+    }
+    return entry;
+}
+
 // <prefix>[/type][/model][/subtype][/channel][/id]/battery: "OK"|"LOW"
 static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data, char const *format)
 {
@@ -401,45 +707,44 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
     // top-level only
     if (!*mqtt->topic) {
         // collect well-known top level keys
-        data_t *data_model = NULL;
-        for (data_t *d = data; d; d = d->next) {
-            if (!strcmp(d->key, "model"))
-                data_model = d;
-        }
+        mqtt_tokens_t tokens;
+        collect_tokens(&tokens, data);
 
         // "states" topic
-        if (!data_model) {
+        if (!tokens.model) {
             if (mqtt->states) {
                 size_t message_size = 20000; // state message need a large buffer
-                char *message       = malloc(message_size);
-                if (!message) {
-                    WARN_MALLOC("print_mqtt_data()");
-                    return; // NOTE: skip output on alloc failure.
+                if (!mqtt->states_buf) {
+                    mqtt->states_buf = malloc(message_size);
+                    if (!mqtt->states_buf) {
+                        WARN_MALLOC("print_mqtt_data()");
+                        return; // NOTE: skip output on alloc failure.
+                    }
                 }
-                data_print_jsons(data, message, message_size);
-                expand_topic(mqtt->topic, mqtt->states, data, mqtt->hostname);
-                mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
+                data_print_jsons(data, mqtt->states_buf, message_size);
+                expand_topic(mqtt->topic, mqtt->states, &tokens, mqtt->hostname);
+                mqtt_client_publish(mqtt->mqc, mqtt->topic, mqtt->states_buf);
                 *mqtt->topic = '\0'; // clear topic
-                free(message);
             }
             return;
         }
 
+        mqtt_topic_entry_t const *topics = topic_cache_lookup(mqtt, &tokens);
+
         // "events" topic
-        if (mqtt->events) {
+        if (topics->events) {
             char message[2048]; // we expect the biggest strings to be around 500 bytes.
             data_print_jsons(data, message, sizeof(message));
-            expand_topic(mqtt->topic, mqtt->events, data, mqtt->hostname);
-            mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
-            *mqtt->topic = '\0'; // clear topic
+            mqtt_client_publish(mqtt->mqc, topics->events, message);
         }
 
         // "devices" topic
-        if (!mqtt->devices) {
+        if (!topics->devices) {
             return;
         }
 
-        end = expand_topic(mqtt->topic, mqtt->devices, data, mqtt->hostname);
+        strcpy(mqtt->topic, topics->devices); // NOLINT
+        end = mqtt->topic + strlen(mqtt->topic);
     }
 
     while (data) {
@@ -493,6 +798,15 @@ static void R_API_CALLCONV print_mqtt_int(data_output_t *output, int data, char
     print_mqtt_string(output, str, format);
 }
 
+static void R_API_CALLCONV data_output_mqtt_print(data_output_t *output, data_t *data)
+{
+    data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
+
+    // collect all topics of this event, then hand them to the connection at once
+    print_mqtt_data(output, data, NULL);
+    mqtt_client_flush(mqtt->mqc);
+}
+
 static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
 {
     data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
@@ -500,6 +814,11 @@ static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
     if (!mqtt)
         return;
 
+    for (int i = 0; i < MQTT_TOPIC_CACHE_SIZE; ++i)
+        topic_entry_free(&mqtt->topic_cache[i]);
+    topic_entry_free(&mqtt->topic_scratch);
+    free(mqtt->states_buf);
+
     free(mqtt->availability);
     free(mqtt->devices);
     free(mqtt->events);
@@ -571,6 +890,8 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     char const *pass = getenv("MQTT_PASSWORD");
     int retain       = 0;
     int qos          = 0;
+    int inflight     = 0;
+    int backlog      = 0;
 
     // parse host and port
     tls_opts_t tls_opts = {0};
@@ -598,6 +919,10 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
             retain = atobv(val, 1);
         else if (!strcasecmp(key, "q") || !strcasecmp(key, "qos"))
             qos = atoiv(val, 1);
+        else if (!strcasecmp(key, "inflight"))
+            inflight = atoiv(val, MQTT_DEFAULT_INFLIGHT);
+        else if (!strcasecmp(key, "backlog"))
+            backlog = atoiv(val, MQTT_DEFAULT_BACKLOG);
         else if (!strcasecmp(key, "b") || !strcasecmp(key, "base"))
             base_topic = val;
         // LWT availability status topic
@@ -659,9 +984,10 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     mqtt->output.print_string = print_mqtt_string;
     mqtt->output.print_double = print_mqtt_double;
     mqtt->output.print_int    = print_mqtt_int;
+    mqtt->output.output_print = data_output_mqtt_print;
     mqtt->output.output_free  = data_output_mqtt_free;
 
-    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos, mqtt->availability);
+    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos, inflight, backlog, mqtt->availability);
 
     return (struct data_output *)mqtt;
 }
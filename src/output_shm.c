@@ -0,0 +1,83 @@
+/** @file
+    Shared-memory ring output for hydrasdr_433 events.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "output_shm.h"
+
+#include "data.h"
+#include "data_cbor.h"
+#include "shm_ring.h"
+#include "r_util.h"
+#include "fatal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define SHM_RECORD_MAX 20000 ///< state messages need a large buffer
+
+/* Shared-memory ring printer */
+
+typedef struct {
+    struct data_output output;
+    shm_ring_t *ring;
+    int format;
+    uint8_t buf[SHM_RECORD_MAX];
+} data_output_shm_t;
+
+static void R_API_CALLCONV data_output_shm_print(data_output_t *output, data_t *data)
+{
+    data_output_shm_t *shm = (data_output_shm_t *)output;
+
+    size_t len;
+    if (shm->format == SHM_RING_FORMAT_CBOR) {
+        len = data_print_cbor(data, shm->buf, sizeof(shm->buf));
+    }
+    else {
+        len = data_print_jsons(data, (char *)shm->buf, sizeof(shm->buf));
+        if (len >= sizeof(shm->buf) - 1)
+            len = 0; // truncated
+    }
+    if (len)
+        shm_ring_write(shm->ring, shm->buf, len);
+}
+
+static void R_API_CALLCONV data_output_shm_free(data_output_t *output)
+{
+    data_output_shm_t *shm = (data_output_shm_t *)output;
+
+    if (!shm)
+        return;
+
+    shm_ring_destroy(shm->ring);
+    free(shm);
+}
+
+struct data_output *data_output_shm_create(int log_level, char const *name, size_t size, int format)
+{
+    data_output_shm_t *shm = calloc(1, sizeof(data_output_shm_t));
+    if (!shm) {
+        WARN_CALLOC("data_output_shm_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    shm->ring = shm_ring_create(name, size, format);
+    if (!shm->ring) {
+        free(shm);
+        return NULL;
+    }
+
+    shm->output.log_level    = log_level;
+    shm->output.output_print = data_output_shm_print;
+    shm->output.output_free  = data_output_shm_free;
+    shm->format              = format;
+
+    return (struct data_output *)shm;
+}
@@ -9,9 +9,15 @@
     (at your option) any later version.
 */
 
+// sendmmsg() needs _GNU_SOURCE on Linux
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "output_udp.h"
 
 #include "data.h"
+#include "data_cbor.h"
 #include "abuf.h"
 #include "r_util.h"
 #include "logger.h"
@@ -53,6 +59,8 @@
 
 #include <time.h>
 
+#include "mongoose.h"
+
 #ifdef _WIN32
     #define _POSIX_HOST_NAME_MAX  128
     #define perror(str)           ws2_perror(str)
@@ -167,15 +175,157 @@ static void datagram_client_send(datagram_client_t *client, const char *message,
     }
 }
 
+/// Send count datagrams stored stride bytes apart, with a single syscall where available.
+static void datagram_client_send_batch(datagram_client_t *client, const char *messages, size_t stride, size_t const *message_len, int count)
+{
+#if defined(__linux__)
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    struct iovec iov[UDP_BATCH_MAX];
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < count; ++i) {
+        iov[i].iov_base = (void *)&messages[i * stride];
+        iov[i].iov_len  = message_len[i];
+        msgs[i].msg_hdr.msg_name    = &client->addr;
+        msgs[i].msg_hdr.msg_namelen = client->addr_len;
+        msgs[i].msg_hdr.msg_iov     = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+    int sent = 0;
+    while (sent < count) {
+        int r = sendmmsg(client->sock, &msgs[sent], (unsigned)(count - sent), 0);
+        if (r <= 0) {
+            perror("sendmmsg");
+            return;
+        }
+        sent += r;
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        datagram_client_send(client, &messages[i * stride], message_len[i]);
+    }
+#endif
+}
+
 /* Syslog UDP printer, RFC 5424 (IETF-syslog protocol) */
 
+#define UDP_DATAGRAM_MAX 1472 ///< max payload for a 1500 byte MTU without fragmentation
+
 typedef struct {
     struct data_output output;
     datagram_client_t client;
     int pri;
     char hostname[_POSIX_HOST_NAME_MAX + 1];
+    int binary;           ///< send the compact multi-event format instead of syslog lines
+    int cbor;             ///< binary records are CBOR instead of JSON
+    int batch_max;        ///< datagrams per send, 1 sends each event right away
+    double batch_delay;   ///< max seconds an event waits in the batch
+    double batch_since;   ///< time the oldest pending event was added
+    struct mg_connection *timer;
+    char *slots;          ///< batch_max datagrams, UDP_DATAGRAM_MAX bytes apart
+    size_t slot_len[UDP_BATCH_MAX];
+    int slot_count;       ///< datagrams in use, the last one may take more binary events
+    int slot_events;      ///< events in the last binary datagram
 } data_output_syslog_t;
 
+static void syslog_flush(data_output_syslog_t *syslog)
+{
+    if (!syslog->slot_count)
+        return;
+
+    datagram_client_send_batch(&syslog->client, syslog->slots, UDP_DATAGRAM_MAX, syslog->slot_len, syslog->slot_count);
+    syslog->slot_count  = 0;
+    syslog->slot_events = 0;
+}
+
+static void syslog_timer(struct mg_connection *nc, int ev, void *ev_data)
+{
+    // note that while shutting down the syslog is NULL
+    data_output_syslog_t *syslog = (data_output_syslog_t *)nc->user_data;
+    (void)ev_data;
+
+    if (ev == MG_EV_TIMER && syslog) {
+        syslog_flush(syslog);
+    }
+}
+
+/// Get the datagram for the next event, flushing the batch if it is full.
+static char *syslog_next_slot(data_output_syslog_t *syslog)
+{
+    if (syslog->slot_count == syslog->batch_max)
+        syslog_flush(syslog);
+
+    if (!syslog->slot_count) {
+        syslog->batch_since = mg_time();
+        if (syslog->timer && (syslog->binary || syslog->batch_max > 1))
+            mg_set_timer(syslog->timer, syslog->batch_since + syslog->batch_delay);
+    }
+    syslog->slot_len[syslog->slot_count] = 0;
+    return &syslog->slots[syslog->slot_count++ * UDP_DATAGRAM_MAX];
+}
+
+/// Send a full text batch, binary datagrams are sent once the next event does not fit.
+static void syslog_batch_done(data_output_syslog_t *syslog)
+{
+    if (syslog->slot_count == syslog->batch_max && !syslog->binary)
+        syslog_flush(syslog);
+    else if ((syslog->binary || syslog->batch_max > 1) && mg_time() >= syslog->batch_since + syslog->batch_delay)
+        syslog_flush(syslog);
+}
+
+static void put_be16(uint8_t *p, unsigned v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void R_API_CALLCONV data_output_binary_print(data_output_t *output, data_t *data)
+{
+    data_output_syslog_t *syslog = (data_output_syslog_t *)output;
+
+    char record[UDP_DATAGRAM_MAX];
+    size_t len;
+    if (syslog->cbor)
+        len = data_print_cbor(data, (uint8_t *)record, sizeof(record));
+    else
+        len = data_print_jsons(data, record, sizeof(record));
+    if (len == 0 || len >= UDP_DATAGRAM_MAX - UDP_BINARY_HEADER - 2)
+        return; // abort on overflow, a record must fit a datagram
+
+    // start a new datagram if this record doesn't fit the current one
+    uint8_t *dgram = NULL;
+    if (syslog->slot_count) {
+        int last = syslog->slot_count - 1;
+        if (syslog->slot_len[last] + 2 + len <= UDP_DATAGRAM_MAX)
+            dgram = (uint8_t *)&syslog->slots[last * UDP_DATAGRAM_MAX];
+    }
+    if (!dgram) {
+        dgram = (uint8_t *)syslog_next_slot(syslog);
+        memcpy(dgram, UDP_BINARY_MAGIC, 4);
+        dgram[4] = UDP_BINARY_VERSION;
+        dgram[5] = syslog->cbor ? UDP_BINARY_FLAG_CBOR : 0;
+        put_be16(&dgram[6], 0);
+        put_be32(&dgram[8], (uint32_t)time(NULL));
+        syslog->slot_len[syslog->slot_count - 1] = UDP_BINARY_HEADER;
+        syslog->slot_events = 0;
+    }
+
+    size_t *dgram_len = &syslog->slot_len[syslog->slot_count - 1];
+    put_be16(&dgram[*dgram_len], (unsigned)len);
+    memcpy(&dgram[*dgram_len + 2], record, len);
+    *dgram_len += 2 + len;
+    put_be16(&dgram[6], (unsigned)++syslog->slot_events);
+
+    syslog_batch_done(syslog);
+}
+
 static void R_API_CALLCONV data_output_syslog_print(data_output_t *output, data_t *data)
 {
     data_output_syslog_t *syslog = (data_output_syslog_t *)output;
@@ -204,7 +354,15 @@ static void R_API_CALLCONV data_output_syslog_print(data_output_t *output, data_
         return; // abort on overflow, we don't actually want to send more than fits the MTU
 
     size_t abuf_len = msg.tail - msg.head;
-    datagram_client_send(&syslog->client, message, abuf_len);
+    if (syslog->batch_max <= 1) {
+        datagram_client_send(&syslog->client, message, abuf_len);
+        return;
+    }
+
+    char *slot = syslog_next_slot(syslog);
+    memcpy(slot, message, abuf_len);
+    syslog->slot_len[syslog->slot_count - 1] = abuf_len;
+    syslog_batch_done(syslog);
 }
 
 static void R_API_CALLCONV data_output_syslog_free(data_output_t *output)
@@ -214,18 +372,46 @@ static void R_API_CALLCONV data_output_syslog_free(data_output_t *output)
     if (!syslog)
         return;
 
+    syslog_flush(syslog);
+    if (syslog->timer) {
+        syslog->timer->user_data = NULL;
+        syslog->timer->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+
     datagram_client_close(&syslog->client);
 
+    free(syslog->slots);
     free(syslog);
 }
 
-struct data_output *data_output_syslog_create(int log_level, const char *host, const char *port)
+struct data_output *data_output_syslog_create(struct mg_mgr *mgr, int log_level, const char *host, const char *port, int batch, int batch_delay_ms, int format)
 {
     data_output_syslog_t *syslog = calloc(1, sizeof(data_output_syslog_t));
     if (!syslog) {
         WARN_CALLOC("data_output_syslog_create()");
         return NULL; // NOTE: returns NULL on alloc failure.
     }
+
+    // binary datagrams always collect events up to the MTU or the batch delay,
+    // a batch of one is a single datagram
+    int binary          = format == UDP_FORMAT_BINARY || format == UDP_FORMAT_CBOR;
+    syslog->binary      = binary;
+    syslog->cbor        = format == UDP_FORMAT_CBOR;
+    syslog->batch_max   = batch < 1 ? 1 : batch > UDP_BATCH_MAX ? UDP_BATCH_MAX : batch;
+    syslog->batch_delay = batch_delay_ms / 1000.0;
+    if (binary || syslog->batch_max > 1) {
+        syslog->slots = malloc((size_t)syslog->batch_max * UDP_DATAGRAM_MAX);
+        if (!syslog->slots) {
+            WARN_MALLOC("data_output_syslog_create()");
+            free(syslog);
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+        if (mgr) {
+            // add dummy socket to receive timer events
+            struct mg_add_sock_opts timer_opts = {.user_data = syslog};
+            syslog->timer = mg_add_sock_opt(mgr, INVALID_SOCKET, syslog_timer, timer_opts);
+        }
+    }
 #ifdef _WIN32
     WSADATA wsa;
 
@@ -237,7 +423,7 @@ struct data_output *data_output_syslog_create(int log_level, const char *host, c
 #endif
 
     syslog->output.log_level    = log_level;
-    syslog->output.output_print = data_output_syslog_print;
+    syslog->output.output_print = binary ? data_output_binary_print : data_output_syslog_print;
     syslog->output.output_free  = data_output_syslog_free;
     // Severity 5 "Notice", Facility 20 "local use 4"
     syslog->pri = 20 * 8 + 5;
@@ -29,6 +29,8 @@
 #include "data.h"
 #include "data_tag.h"
 #include "wb_dedup.h"
+#include "coalesce.h"
+#include "spectrum.h"
 #include "list.h"
 #include "optparse.h"
 #include "output_file.h"
@@ -38,6 +40,9 @@
 #include "output_influx.h"
 #include "output_trigger.h"
 #include "output_rtltcp.h"
+#include "output_shm.h"
+#include "shm_ring.h"
+#include "trace.h"
 #include "write_sigrok.h"
 #include "mongoose.h"
 #include "compat_time.h"
@@ -157,6 +162,7 @@ void r_init_cfg(r_cfg_t *cfg)
     cfg->samp_rate       = DEFAULT_SAMPLE_RATE;
     cfg->conversion_mode = CONVERT_NATIVE;
     cfg->fsk_pulse_detect_mode = FSK_PULSE_DETECT_AUTO;
+    cfg->wb_dedup_window = WB_DEDUP_WINDOW_MS;
     // Default log level is to show all LOG_FATAL, LOG_ERROR, LOG_WARNING
     // abnormal messages and LOG_CRITICAL information.
     cfg->verbosity = LOG_WARNING;
@@ -198,6 +204,7 @@ void r_init_cfg(r_cfg_t *cfg)
 
     time(&cfg->running_since);
     time(&cfg->frames_since);
+    time(&cfg->perf_since);
     get_time_now(&cfg->demod->now);
 
     list_ensure_size(&cfg->demod->r_devs, 100);
@@ -223,6 +230,17 @@ void r_free_cfg(r_cfg_t *cfg)
         cfg->dev = NULL;
     }
 
+    // output the bursts still held
+    flush_coalesced(cfg, UINT64_MAX);
+    coalesce_free(cfg->coalesce);
+    cfg->coalesce = NULL;
+    free(cfg->coalesce_fields);
+    cfg->coalesce_fields = NULL;
+
+    // write a trace cut short by the end of the input, the acquire thread is gone now
+    stop_trace();
+    trace_free();
+
     free(cfg->gain_str);
     cfg->gain_str = NULL;
 
@@ -275,6 +293,8 @@ void r_free_cfg(r_cfg_t *cfg)
     cfg->demod->wb_fm_bufs = NULL;
     free(cfg->demod->wb_temp_bufs);
     cfg->demod->wb_temp_bufs = NULL;
+    baseband_lanes_free(cfg->demod->wb_lanes);
+    cfg->demod->wb_lanes = NULL;
     cfg->demod->wb_buf_len = 0;
     free(cfg->demod->wb_decode_count);
     cfg->demod->wb_decode_count = NULL;
@@ -303,6 +323,9 @@ void r_free_cfg(r_cfg_t *cfg)
     free(cfg->mgr);
     cfg->mgr = NULL;
 
+    spectrum_free(cfg->spectrum);
+    cfg->spectrum = NULL;
+
     /* Free wideband channelizer */
     if (cfg->channelizer) {
         channelizer_free(cfg->channelizer);
@@ -317,6 +340,8 @@ void r_free_cfg(r_cfg_t *cfg)
     }
     free(cfg->wb_record_filename);
     cfg->wb_record_filename = NULL;
+    free(cfg->wb_dedup_fields);
+    cfg->wb_dedup_fields = NULL;
 
     //free(cfg);
 }
@@ -368,6 +393,7 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
 void free_protocol(r_device *r_dev)
 {
     // free(r_dev->name);
+    free(r_dev->latency);
     free(r_dev->decode_ctx);
     free(r_dev);
 }
@@ -489,6 +515,13 @@ char const **well_known_output_fields(r_cfg_t *cfg)
         list_push(&field_list, "protocol");
     if (cfg->report_description)
         list_push(&field_list, "description");
+    if (cfg->coalesce_window) {
+        list_push(&field_list, "repeats");
+        list_push(&field_list, "snr_best");
+        list_push(&field_list, "snr_mean");
+        if (cfg->wideband_mode)
+            list_push(&field_list, "channels");
+    }
     if (cfg->report_meta) {
         list_push(&field_list, "mod");
         list_push(&field_list, "freq");
@@ -558,9 +591,18 @@ char const **determine_csv_fields(r_cfg_t *cfg, char const *const *well_known, i
     return (char const **)field_list.elems;
 }
 
+/// Decoders are timed only while the profiler is enabled.
+static int decoder_profiling(list_t *r_devs)
+{
+    r_device *r_dev = r_devs->len ? r_devs->elems[0] : NULL;
+    r_cfg_t *cfg    = r_dev ? r_dev->output_ctx : NULL;
+    return cfg && cfg->demod && cfg->demod->metrics.profile.enabled;
+}
+
 int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
 {
     int p_events = 0;
+    int profiling = decoder_profiling(r_devs);
 
     unsigned next_priority = 0; // next smallest on each loop through decoders
     // run all decoders of each priority, stop if an event is produced
@@ -576,6 +618,7 @@ int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
             if (r_dev->priority != priority)
                 continue;
 
+            uint64_t start_ns = profiling ? metrics_time_ns() : trace_begin();
             switch (r_dev->modulation) {
             case OOK_PULSE_PCM:
             // case OOK_PULSE_RZ:
@@ -613,6 +656,9 @@ int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
             default:
                 fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
             }
+            if (profiling)
+                r_dev->decode_ns += metrics_time_ns() - start_ns;
+            trace_span(TRACE_THREAD_DEMOD, "decode", r_dev->name, (int)r_dev->protocol_num, start_ns);
         }
     }
 
@@ -622,6 +668,7 @@ int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
 int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
 {
     int p_events = 0;
+    int profiling = decoder_profiling(r_devs);
 
     unsigned next_priority = 0; // next smallest on each loop through decoders
     // run all decoders of each priority, stop if an event is produced
@@ -637,6 +684,7 @@ int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
             if (r_dev->priority != priority)
                 continue;
 
+            uint64_t start_ns = profiling ? metrics_time_ns() : trace_begin();
             switch (r_dev->modulation) {
             // OOK decoders
             case OOK_PULSE_PCM:
@@ -662,6 +710,9 @@ int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
             default:
                 fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
             }
+            if (profiling)
+                r_dev->decode_ns += metrics_time_ns() - start_ns;
+            trace_span(TRACE_THREAD_DEMOD, "decode", r_dev->name, (int)r_dev->protocol_num, start_ns);
         }
     }
 
@@ -747,10 +798,43 @@ void log_device_handler(r_device *r_dev, int level, data_t *data)
     data_free(data);
 }
 
+/** Pass a decoded event to all output handlers. Frees data afterwards.
+    The latency is observed only for an event of the current pulse train. */
+static void output_event(r_cfg_t *cfg, data_t *data, int traced)
+{
+    metrics_pipeline_t *metrics = &cfg->demod->metrics;
+
+    uint64_t start_ns = metrics_time_ns();
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        uint64_t trace_ns     = trace_begin();
+        data_output_print(output, data);
+        trace_span(TRACE_THREAD_DEMOD, "output", NULL, (int)i, trace_ns);
+        if (output && traced) {
+            if (!output->latency)
+                output->latency = calloc(1, sizeof(*output->latency));
+            if (!output->latency)
+                WARN_CALLOC("output_event()"); // continue anyway
+            metrics_trace_latency(metrics, output->latency);
+        }
+    }
+    metrics_stage(metrics, METRICS_STAGE_OUTPUT, start_ns);
+    data_free(data);
+}
+
 /** Pass the data structure to all output handlers. Frees data afterwards. */
 void data_acquired_handler(r_device *r_dev, data_t *data)
 {
     r_cfg_t *cfg = r_dev->output_ctx;
+    metrics_pipeline_t *metrics = &cfg->demod->metrics;
+
+    if (metrics->trace.burst_ns) {
+        if (!r_dev->latency)
+            r_dev->latency = calloc(1, sizeof(*r_dev->latency));
+        if (!r_dev->latency)
+            WARN_CALLOC("data_acquired_handler()"); // continue anyway
+        metrics->trace.decoded_ns = metrics_trace_latency(metrics, r_dev->latency);
+    }
 
 #ifndef NDEBUG
     // check for undeclared csv fields
@@ -900,12 +984,14 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
     }
 
     /* Wideband cross-channel deduplication */
-    if (cfg->wideband_mode && cfg->demod->wb_dedup) {
-        float chan_freq = cfg->demod->pulse_data.centerfreq_hz;
-        if (wb_dedup_check(cfg->demod->wb_dedup, data, chan_freq)) {
+    // coalescing also merges the copies from adjacent channels
+    if (cfg->wideband_mode && cfg->demod->wb_dedup && !cfg->coalesce) {
+        metrics_trace_t const *pkt = &metrics->trace;
+        if (wb_dedup_check(cfg->demod->wb_dedup, data, pkt->channel, pkt->stream_ms)) {
             data_free(data);
             return;
         }
+        metrics->trace.dedup_ns = metrics_trace_latency(metrics, &metrics->dedup_latency);
     }
 
     // prepend "description" if requested
@@ -950,11 +1036,37 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
         data            = data_tag_apply(tag, data, cfg->in_filename);
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        data_output_print(output, data);
+    // hold repeated transmissions, the burst is output once complete
+    if (cfg->coalesce) {
+        pulse_data_t const *pulse = cfg->demod->fsk_pulse_data.fsk_f2_est ? &cfg->demod->fsk_pulse_data : &cfg->demod->pulse_data;
+        metrics_trace_t const *pkt = &metrics->trace;
+        coalesce_add(cfg->coalesce, data, cfg->wideband_mode ? pkt->channel : -1, pulse->snr_db, pkt->stream_ms);
+        return;
     }
-    data_free(data);
+
+    output_event(cfg, data, metrics->trace.burst_ns != 0);
+}
+
+static void coalesce_emit(void *ctx, data_t *data)
+{
+    output_event(ctx, data, 0);
+}
+
+void flush_coalesced(r_cfg_t *cfg, uint64_t time_ms)
+{
+    if (cfg->coalesce)
+        coalesce_flush(cfg->coalesce, time_ms, coalesce_emit, cfg);
+}
+
+/// Append the p50, p99 and max latency in milliseconds, nothing if there is none.
+static data_t *latency_data(data_t *data, metrics_latency_t const *h)
+{
+    if (!h || !h->count)
+        return data;
+    data = data_dbl(data, "latency_p50_ms", "", NULL, metrics_latency_percentile(h, 0.5) * 1e3);
+    data = data_dbl(data, "latency_p99_ms", "", NULL, metrics_latency_percentile(h, 0.99) * 1e3);
+    data = data_dbl(data, "latency_max_ms", "", NULL, h->max_ns * 1e-6);
+    return data;
 }
 
 // level 0: do not report (don't call this), 1: report successful devices, 2: report active devices, 3: report all
@@ -992,6 +1104,7 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
             data = data_int(data, "fail_mic",     "", NULL, r_dev->decode_fails[-DECODE_FAIL_MIC]);
         if (r_dev->decode_fails[-DECODE_FAIL_SANITY])
             data = data_int(data, "fail_sanity",  "", NULL, r_dev->decode_fails[-DECODE_FAIL_SANITY]);
+        data = latency_data(data, r_dev->latency);
 
         list_push(&dev_data_list, data);
     }
@@ -1014,6 +1127,22 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
 
     list_free_elems(&dev_data_list, NULL);
 
+    /* Append the end-to-end latency of each output */
+    list_t out_list = {0};
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (!output || !output->latency || !output->latency->count)
+            continue;
+        data_t *out_data = data_make(
+                "output",   "", DATA_INT, (int)i,
+                "events",   "", DATA_INT, (int)output->events,
+                NULL);
+        list_push(&out_list, latency_data(out_data, output->latency));
+    }
+    if (out_list.len)
+        data = data_ary(data, "outputs", "", NULL, data_array(out_list.len, DATA_DATA, out_list.elems));
+    list_free_elems(&out_list, NULL);
+
     /* Append wideband per-channel stats when in wideband mode */
     if (cfg->wideband_mode && cfg->demod->wb_channel_freqs) {
         int nch = cfg->demod->wideband_channels_allocated;
@@ -1031,19 +1160,153 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
                     NULL);
             list_push(&ch_list, ch_data);
         }
+        wb_dedup_stats_t dedup;
+        wb_dedup_stats(cfg->demod->wb_dedup, &dedup);
         data_t *wb = data_make(
                 "dedup_suppressed", "", DATA_INT,
                     (int)wb_dedup_suppressed_count(cfg->demod->wb_dedup),
+                "dedup_repeats",    "", DATA_INT,    (int)dedup.repeats,
+                "dedup_misses",     "", DATA_INT,    (int)dedup.misses,
+                "dedup_evictions",  "", DATA_INT,    (int)dedup.evictions,
                 "channels",         "", DATA_ARRAY,
                     data_array(ch_list.len, DATA_DATA, ch_list.elems),
                 NULL);
+        wb = latency_data(wb, &cfg->demod->metrics.dedup_latency);
         data = data_dat(data, "wb_stats", "", NULL, wb);
         list_free_elems(&ch_list, NULL);
     }
 
+    if (cfg->demod->metrics.profile.enabled)
+        data = data_dat(data, "perf", "", NULL, create_perf_data(cfg));
+
+    return data;
+}
+
+static int compare_decode_ns(void const *a, void const *b)
+{
+    r_device const *da = *(r_device *const *)a;
+    r_device const *db = *(r_device *const *)b;
+    return (da->decode_ns < db->decode_ns) - (da->decode_ns > db->decode_ns);
+}
+
+data_t *create_perf_data(r_cfg_t *cfg)
+{
+    struct dm_state *demod  = cfg->demod;
+    metrics_profile_t *prof = &demod->metrics.profile;
+    // percent of the realtime budget, i.e. the duration of the processed samples
+    double budget_ns = prof->input_seconds * 1e9;
+    double scale     = budget_ns > 0.0 ? 100.0 / budget_ns : 0.0;
+
+    list_t stage_list = {0};
+    list_ensure_size(&stage_list, METRICS_STAGE_COUNT);
+    for (int i = METRICS_STAGE_FRAME + 1; i < METRICS_STAGE_COUNT; ++i) {
+        if (!prof->stage_ns[i])
+            continue;
+        data_t *stage = data_make(
+                "stage",    "", DATA_STRING, metrics_stage_name(i),
+                "load_pct", "", DATA_FORMAT, "%.3f %%", DATA_DOUBLE, prof->stage_ns[i] * scale,
+                "avg_us",   "", DATA_FORMAT, "%.1f us", DATA_DOUBLE, prof->stage_ns[i] * 1e-3 / prof->blocks,
+                NULL);
+        list_push(&stage_list, stage);
+    }
+
+    char since_str[LOCAL_TIME_BUFLEN];
+    format_time_str(since_str, "%Y-%m-%dT%H:%M:%S", cfg->report_time_tz, cfg->perf_since);
+
+    data_t *data = data_make(
+            "since",        "", DATA_STRING, since_str,
+            "blocks",       "", DATA_INT,    (int)prof->blocks,
+            "late_blocks",  "", DATA_INT,    (int)prof->late_blocks,
+            "load_pct",     "", DATA_FORMAT, "%.3f %%", DATA_DOUBLE, prof->stage_ns[METRICS_STAGE_FRAME] * scale,
+            "max_load_pct", "", DATA_FORMAT, "%.3f %%", DATA_DOUBLE, prof->max_load * 100.0,
+            "stages",       "", DATA_ARRAY,  data_array(stage_list.len, DATA_DATA, stage_list.elems),
+            NULL);
+    list_free_elems(&stage_list, NULL);
+
+    if (cfg->wideband_mode && demod->wb_busy_ns && demod->wb_channel_freqs) {
+        int nch = demod->wideband_channels_allocated;
+        list_t ch_list = {0};
+        list_ensure_size(&ch_list, nch);
+        for (int c = 0; c < nch; c++) {
+            data_t *ch_data = data_make(
+                    "channel",  "", DATA_INT,    c,
+                    "freq_MHz", "", DATA_DOUBLE, (double)(demod->wb_channel_freqs[c] / 1e6f),
+                    "load_pct", "", DATA_FORMAT, "%.3f %%", DATA_DOUBLE, demod->wb_busy_ns[c] * scale,
+                    NULL);
+            list_push(&ch_list, ch_data);
+        }
+        data = data_ary(data, "channels", "", NULL, data_array(ch_list.len, DATA_DATA, ch_list.elems));
+        list_free_elems(&ch_list, NULL);
+    }
+
+    // the decoders using the most time, includes their event outputs
+    list_t *r_devs = &demod->r_devs;
+    if (prof->enabled && r_devs->len) {
+        r_device **sorted = malloc(r_devs->len * sizeof(*sorted));
+        if (!sorted) {
+            WARN_MALLOC("create_perf_data()");
+            return data;
+        }
+        memcpy(sorted, r_devs->elems, r_devs->len * sizeof(*sorted));
+        qsort(sorted, r_devs->len, sizeof(*sorted), compare_decode_ns);
+
+        list_t dev_list = {0};
+        list_ensure_size(&dev_list, PERF_TOP_DECODERS);
+        for (size_t i = 0; i < r_devs->len && i < PERF_TOP_DECODERS && sorted[i]->decode_ns; ++i) {
+            data_t *dev_data = data_make(
+                    "device",   "", DATA_INT,    sorted[i]->protocol_num,
+                    "name",     "", DATA_STRING, sorted[i]->name,
+                    "load_pct", "", DATA_FORMAT, "%.3f %%", DATA_DOUBLE, sorted[i]->decode_ns * scale,
+                    NULL);
+            list_push(&dev_list, dev_data);
+        }
+        free(sorted);
+        data = data_ary(data, "decoders", "", NULL, data_array(dev_list.len, DATA_DATA, dev_list.elems));
+        list_free_elems(&dev_list, NULL);
+    }
+
     return data;
 }
 
+void flush_perf_data(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+
+    time(&cfg->perf_since);
+    metrics_profile_reset(&demod->metrics.profile);
+
+    for (void **iter = demod->r_devs.elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        r_dev->decode_ns = 0;
+    }
+
+    if (demod->wb_busy_ns) {
+        for (int c = 0; c < demod->wideband_channels_allocated; c++)
+            demod->wb_busy_ns[c] = 0;
+    }
+}
+
+int start_trace(double seconds, char const *path)
+{
+    if (trace_start(seconds, path) < 0) {
+        print_log(LOG_WARNING, "Trace", "Trace already recording or out of memory");
+        return -1;
+    }
+    print_logf(LOG_NOTICE, "Trace", "Recording %.1f s of input to \"%s\"", seconds, path);
+    return 0;
+}
+
+void stop_trace(void)
+{
+    if (!trace_recording())
+        return;
+    long events = trace_stop();
+    if (events < 0)
+        print_logf(LOG_ERROR, "Trace", "Failed to write \"%s\"", trace_path());
+    else
+        print_logf(LOG_NOTICE, "Trace", "Wrote %ld events to \"%s\"", events, trace_path());
+}
+
 void flush_report_data(r_cfg_t *cfg)
 {
     list_t *r_devs = &cfg->demod->r_devs;
@@ -1113,7 +1376,7 @@ static int lvlarg_param(char **param, int default_verb)
 }
 
 /// Opens the path @p param (or STDOUT if empty or `-`) for append writing, removes leading `,` and `:` from path name.
-static FILE *fopen_output(char const *param)
+static FILE *fopen_output_mode(char const *param, char const *mode)
 {
     if (!param || !*param) {
         return stdout; // No path given
@@ -1127,7 +1390,7 @@ static FILE *fopen_output(char const *param)
     if (*param == '-' && param[1] == '\0') {
         return stdout; // STDOUT requested
     }
-    FILE *file = fopen(param, "a");
+    FILE *file = fopen(param, mode);
     if (!file) {
         fprintf(stderr, "hydrasdr_433: failed to open output file\n");
         exit(1);
@@ -1135,6 +1398,11 @@ static FILE *fopen_output(char const *param)
     return file;
 }
 
+static FILE *fopen_output(char const *param)
+{
+    return fopen_output_mode(param, "a");
+}
+
 void add_json_output(r_cfg_t *cfg, char *param)
 {
     int log_level = lvlarg_param(&param, 0);
@@ -1147,6 +1415,17 @@ void add_csv_output(r_cfg_t *cfg, char *param)
     list_push(&cfg->output_handler, data_output_csv_create(log_level, fopen_output(param)));
 }
 
+void add_cbor_output(r_cfg_t *cfg, char *param)
+{
+    int log_level = lvlarg_param(&param, 0);
+    FILE *file    = fopen_output_mode(param, "ab");
+#ifdef _WIN32
+    if (file == stdout)
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    list_push(&cfg->output_handler, data_output_cbor_create(log_level, file));
+}
+
 void start_outputs(r_cfg_t *cfg, char const *const *well_known)
 {
     int num_output_fields;
@@ -1187,13 +1466,38 @@ void add_syslog_output(r_cfg_t *cfg, char *param)
     int log_level = lvlarg_param(&param, LOG_WARNING);
     char const *host = "localhost";
     char const *port = "514";
-    char const *extra = hostport_param(param, &host, &port);
-    if (extra && *extra) {
-        print_logf(LOG_FATAL, "Syslog UDP", "Unknown parameters \"%s\"", extra);
+    char *extra = hostport_param(param, &host, &port);
+    int batch = 1;
+    int batch_delay = 50;
+    int format = UDP_FORMAT_SYSLOG;
+
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "batch"))
+            batch = atoiv(val, UDP_BATCH_MAX);
+        else if (!strcasecmp(key, "batch_delay"))
+            batch_delay = atoiv(val, 50);
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "binary"))
+            format = UDP_FORMAT_BINARY;
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "cbor"))
+            format = UDP_FORMAT_CBOR;
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "syslog"))
+            format = UDP_FORMAT_SYSLOG;
+        else {
+            print_logf(LOG_FATAL, "Syslog UDP", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
     }
-    print_logf(LOG_CRITICAL, "Syslog UDP", "Sending datagrams to %s port %s", host, port);
+    print_logf(LOG_CRITICAL, "Syslog UDP", "Sending %s datagrams to %s port %s",
+            format == UDP_FORMAT_CBOR ? "CBOR" : format == UDP_FORMAT_BINARY ? "binary" : "syslog", host, port);
+    if (batch > 1)
+        print_logf(LOG_NOTICE, "Syslog UDP", "Batching up to %d datagrams, %d ms", batch, batch_delay);
 
-    list_push(&cfg->output_handler, data_output_syslog_create(log_level, host, port));
+    list_push(&cfg->output_handler, data_output_syslog_create(get_mgr(cfg), log_level, host, port, batch, batch_delay, format));
 }
 
 void add_http_output(r_cfg_t *cfg, char *param)
@@ -1216,6 +1520,52 @@ void add_trigger_output(r_cfg_t *cfg, char *param)
     list_push(&cfg->output_handler, data_output_trigger_create(fopen_output(param)));
 }
 
+void add_shm_output(r_cfg_t *cfg, char *param)
+{
+    int log_level    = 0;
+    char const *name = SHM_RING_DEFAULT_NAME;
+    int size         = SHM_RING_DEFAULT_SIZE;
+    int format       = SHM_RING_FORMAT_JSON;
+
+    char *extra = param;
+    if (param && *param && *param != ',') {
+        name  = param;
+        extra = strchr(param, ',');
+        if (extra)
+            *extra++ = '\0';
+    }
+
+    char *key, *val;
+    while (getkwargs(&extra, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "v"))
+            log_level = atoiv(val, 0);
+        else if (!strcasecmp(key, "size"))
+            size = atoiv(val, SHM_RING_DEFAULT_SIZE);
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "json"))
+            format = SHM_RING_FORMAT_JSON;
+        else if (!strcasecmp(key, "format") && val && !strcasecmp(val, "cbor"))
+            format = SHM_RING_FORMAT_CBOR;
+        else {
+            print_logf(LOG_FATAL, "Shared memory", "Unknown parameters \"%s\"", key);
+            exit(1);
+        }
+    }
+    if (*name != '/') {
+        print_logf(LOG_FATAL, "Shared memory", "Name \"%s\" must start with a slash", name);
+        exit(1);
+    }
+
+    struct data_output *output = data_output_shm_create(log_level, name, (size_t)size, format);
+    if (!output)
+        exit(1);
+    print_logf(LOG_CRITICAL, "Shared memory", "Publishing %s events to %s", format == SHM_RING_FORMAT_CBOR ? "CBOR" : "JSON", name);
+    list_push(&cfg->output_handler, output);
+}
+
 void add_null_output(r_cfg_t *cfg, char *param)
 {
     UNUSED(param);
@@ -0,0 +1,103 @@
+/** @file
+    Replay speed governor for file inputs.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "replay.h"
+
+#include <string.h>
+
+void replay_init(replay_t *r, int mode, double speed, double max_queue, double max_latency)
+{
+    memset(r, 0, sizeof(*r));
+    r->mode        = mode;
+    r->speed       = speed > 0.0 ? speed : 1.0;
+    r->max_queue   = max_queue;
+    r->max_latency = max_latency;
+}
+
+void replay_start(replay_t *r, uint64_t now_ns)
+{
+    // the auto mode window carries on over consecutive inputs
+    r->anchor_ns    = now_ns;
+    r->anchor_pos   = 0.0;
+    r->peak_queue   = 0.0;
+    r->peak_latency = 0.0;
+}
+
+uint64_t replay_due(replay_t const *r, double pos)
+{
+    if (r->mode == REPLAY_MAX || pos <= r->anchor_pos)
+        return r->anchor_ns;
+    return r->anchor_ns + (uint64_t)((pos - r->anchor_pos) / r->speed * 1e9);
+}
+
+int replay_settled(replay_t const *r)
+{
+    return r->passed > 0.0 && r->failed > 0.0 && r->failed <= r->passed * REPLAY_AUTO_RESOLUTION;
+}
+
+int replay_block(replay_t *r, double pos, double len, uint64_t begin_ns, uint64_t end_ns)
+{
+    if (r->mode == REPLAY_MAX)
+        return 0;
+
+    uint64_t due    = replay_due(r, pos);
+    double wall_len = len / r->speed;
+    double queue    = begin_ns > due && wall_len > 0.0 ? (begin_ns - due) * 1e-9 / wall_len : 0.0;
+    double latency  = end_ns > due ? (end_ns - due) * 1e-9 : 0.0;
+
+    if (queue > r->queue)
+        r->queue = queue;
+    if (latency > r->latency)
+        r->latency = latency;
+    if (queue > r->peak_queue)
+        r->peak_queue = queue;
+    if (latency > r->peak_latency)
+        r->peak_latency = latency;
+
+    if (r->mode != REPLAY_AUTO || ++r->blocks < REPLAY_AUTO_WINDOW)
+        return 0;
+
+    int exceeded = r->queue > r->max_queue
+            || (r->max_latency > 0.0 && r->latency > r->max_latency);
+    r->blocks  = 0;
+    r->queue   = 0.0;
+    r->latency = 0.0;
+
+    double speed = r->speed;
+    if (exceeded) {
+        r->failed = speed;
+        if (r->passed >= speed)
+            r->passed = 0.0; // slower input than before, search again
+    }
+    else {
+        r->passed = speed;
+        if (r->failed <= speed)
+            r->failed = 0.0;
+    }
+
+    if (replay_settled(r))
+        speed = r->passed;
+    else if (r->passed > 0.0 && r->failed > 0.0)
+        speed = (r->passed + r->failed) / 2;
+    else if (r->failed > 0.0)
+        speed = speed / 2 > REPLAY_SPEED_MIN ? speed / 2 : REPLAY_SPEED_MIN;
+    else
+        speed = speed * 2;
+
+    if (speed == r->speed)
+        return 0;
+
+    // restart the schedule, the backlog of the last speed is dropped
+    r->speed      = speed;
+    r->anchor_ns  = end_ns;
+    r->anchor_pos = pos;
+    return 1;
+}
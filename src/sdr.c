@@ -390,6 +390,9 @@ typedef struct {
     cf32_resampler_t resampler;
     uint32_t requested_samplerate;    /* Rate requested by hydrasdr_433 */
     int needs_resampling;        /* 1 if actual != requested */
+    int resampler_arbitrary;     /* 1 to use the arbitrary ratio resampler (-t resampler=arbitrary) */
+    int clock_ppm;               /* Sample clock trim applied by the arbitrary resampler (-t clock_ppm=) */
+    int freq_ppm;                /* Tuner frequency correction (-p) */
 
     int manual_gain_set;         /* 1 if gain was manually set via settings */
     uint32_t agc_enabled;        /* bitmask: bit N = AGC type N is enabled */
@@ -956,7 +959,9 @@ static int sdr_set_center_freq_hydrasdr(sdr_dev_t *dev, uint32_t freq, int verbo
 
     hydrasdr_ctx_t *ctx = (hydrasdr_ctx_t *)dev->hydrasdr_ctx;
 
-    int r = hydrasdr_set_freq(ctx->dev, (uint64_t)freq);
+    /* A clock running fast by ppm tunes high by as much, ask for less */
+    double hw_freq = freq / (1.0 + ctx->freq_ppm * 1e-6);
+    int r = hydrasdr_set_freq(ctx->dev, (uint64_t)(hw_freq + 0.5));
     if (r != HYDRASDR_SUCCESS) {
         if (verbose)
             print_logf(LOG_WARNING, "HydraSDR", "Failed to set frequency: %s",
@@ -981,6 +986,51 @@ static uint32_t sdr_get_center_freq_hydrasdr(sdr_dev_t *dev)
     return ctx->current_frequency;
 }
 
+/**
+ * Initialize the resampler from the HW rate to the requested rate.
+ * The rational L/M resampler is used unless the arbitrary one is asked
+ * for, the ratio needs too many branches, or a clock trim is set.
+ */
+static int hydrasdr_init_resampler(hydrasdr_ctx_t *ctx, uint32_t actual_rate, uint32_t rate,
+                                   size_t max_samples, int verbose)
+{
+    int arbitrary = ctx->resampler_arbitrary || ctx->clock_ppm;
+    int r = -1;
+
+    if (!arbitrary) {
+        r = cf32_resampler_init(&ctx->resampler, actual_rate, rate, max_samples);
+        if (r != 0)
+            print_logf(LOG_NOTICE, "HydraSDR",
+                       "No rational resampler for %u Hz -> %u Hz, using the arbitrary ratio one",
+                       actual_rate, rate);
+    }
+    if (r != 0) {
+        arbitrary = 1;
+        r = cf32_resampler_init_arbitrary(&ctx->resampler, actual_rate, rate, max_samples);
+    }
+    if (r != 0)
+        return r;
+
+    if (ctx->clock_ppm
+            && cf32_resampler_set_rate(&ctx->resampler, actual_rate * (1.0 + ctx->clock_ppm * 1e-6), rate) != 0) {
+        print_logf(LOG_WARNING, "HydraSDR", "Clock trim of %d ppm out of range, not applied", ctx->clock_ppm);
+        ctx->clock_ppm = 0;
+    }
+
+    if (verbose && arbitrary)
+        print_logf(LOG_NOTICE, "HydraSDR",
+                   "Arbitrary ratio resampler initialized: %u Hz -> %u Hz (%d phases, %d ppm, %d half-bands, %.1f MACs/sample)",
+                   actual_rate, rate, RESAMPLER_ARB_PHASES, ctx->clock_ppm,
+                   ctx->resampler.plan.num_halfbands, ctx->resampler.plan.macs_per_output);
+    else if (verbose)
+        print_logf(LOG_NOTICE, "HydraSDR",
+                   "Polyphase resampler initialized: %u Hz -> %u Hz (L=%d, M=%d, %d half-bands, %.1f MACs/sample)",
+                   actual_rate, rate,
+                   ctx->resampler.up_factor, ctx->resampler.down_factor,
+                   ctx->resampler.plan.num_halfbands, ctx->resampler.plan.macs_per_output);
+    return 0;
+}
+
 static int sdr_set_sample_rate_hydrasdr(sdr_dev_t *dev, uint32_t rate, int verbose)
 {
     if (!dev || !dev->hydrasdr_ctx)
@@ -1022,20 +1072,15 @@ static int sdr_set_sample_rate_hydrasdr(sdr_dev_t *dev, uint32_t rate, int verbo
     }
 
     /* Initialize polyphase resampler if rate conversion needed */
-    if (actual_rate != rate) {
+    if (actual_rate != rate || ctx->clock_ppm) {
         /* Calculate max samples per callback (based on buffer size) */
         size_t max_samples = ctx->buffer_size / ctx->sample_size;
         if (max_samples < 16384)
             max_samples = 16384;
 
-        r = cf32_resampler_init(&ctx->resampler, actual_rate, rate, max_samples);
+        r = hydrasdr_init_resampler(ctx, actual_rate, rate, max_samples, verbose);
         if (r == 0) {
             ctx->needs_resampling = 1;
-            if (verbose)
-                print_logf(LOG_NOTICE, "HydraSDR",
-                           "Polyphase resampler initialized: %u Hz -> %u Hz (L=%d, M=%d)",
-                           actual_rate, rate,
-                           ctx->resampler.up_factor, ctx->resampler.down_factor);
         } else {
             print_log(LOG_WARNING, "HydraSDR", "Failed to initialize resampler, using raw rate");
             ctx->needs_resampling = 0;
@@ -1073,6 +1118,44 @@ static uint32_t sdr_get_sample_rate_hydrasdr(sdr_dev_t *dev)
     return ctx->current_samplerate;
 }
 
+/**
+ * Trim the sample clock by @p ppm: the arbitrary ratio resampler takes the
+ * corrected HW rate.  A running arbitrary resampler is trimmed in place
+ * without a glitch, otherwise the resampler is set up again.  A trim
+ * beyond RESAMPLER_ARB_MAX_TRIM is refused.
+ */
+static int hydrasdr_set_clock_trim(sdr_dev_t *dev, int ppm)
+{
+    hydrasdr_ctx_t *ctx = (hydrasdr_ctx_t *)dev->hydrasdr_ctx;
+    if (fabs(ppm * 1e-6) > RESAMPLER_ARB_MAX_TRIM) {
+        print_logf(LOG_WARNING, "HydraSDR", "Clock trim of %d ppm out of range (max %.0f ppm)",
+                   ppm, RESAMPLER_ARB_MAX_TRIM * 1e6);
+        return -1;
+    }
+    ctx->clock_ppm = ppm;
+
+    if (ctx->needs_resampling && ctx->resampler.arbitrary)
+        return cf32_resampler_set_rate(&ctx->resampler, ctx->current_samplerate * (1.0 + ppm * 1e-6),
+                                       ctx->requested_samplerate);
+
+    if (!ctx->requested_samplerate)
+        return 0;  /* Applied with the sample rate */
+    return sdr_set_sample_rate_hydrasdr(dev, ctx->requested_samplerate, 0);
+}
+
+/**
+ * Correct the tuner frequency by @p ppm, the tuner is set again if tuned.
+ */
+static int sdr_set_freq_correction_hydrasdr(sdr_dev_t *dev, int ppm)
+{
+    hydrasdr_ctx_t *ctx = (hydrasdr_ctx_t *)dev->hydrasdr_ctx;
+    ctx->freq_ppm = ppm;
+
+    if (!ctx->current_frequency)
+        return 0;  /* Applied with the frequency */
+    return sdr_set_center_freq_hydrasdr(dev, ctx->current_frequency, 0);
+}
+
 static int sdr_set_auto_gain_hydrasdr(sdr_dev_t *dev, int verbose)
 {
     if (!dev || !dev->hydrasdr_ctx)
@@ -1134,6 +1217,25 @@ static int sdr_apply_settings_hydrasdr(sdr_dev_t *dev, char const *sdr_settings,
             if (r == HYDRASDR_SUCCESS && verbose)
                 print_logf(LOG_NOTICE, "HydraSDR", "Decimation mode: %s",
                            mode ? "high definition (10 MSPS IQ)" : "low bandwidth");
+        } else if (strcmp(name, "resampler") == 0) {
+            /* Takes effect with the next sample rate, settings come first */
+            if (value && (!strcmp(value, "arbitrary") || !strcmp(value, "arb"))) {
+                ctx->resampler_arbitrary = 1;
+            } else if (value && !strcmp(value, "rational")) {
+                ctx->resampler_arbitrary = 0;
+            } else {
+                print_logf(LOG_WARNING, "HydraSDR", "Unknown resampler \"%s\", use rational or arbitrary",
+                           value ? value : "");
+                continue;
+            }
+            if (verbose)
+                print_logf(LOG_NOTICE, "HydraSDR", "Resampler: %s",
+                           ctx->resampler_arbitrary ? "arbitrary ratio" : "rational");
+        } else if (strcmp(name, "clock_ppm") == 0) {
+            int ppm = atoiv(value, 0);
+            r = hydrasdr_set_clock_trim(dev, ppm);
+            if (r == 0 && verbose)
+                print_logf(LOG_NOTICE, "HydraSDR", "Sample clock trimmed by %d ppm", ppm);
         } else if (strcmp(name, "bandwidth") == 0) {
             if (ctx->info.features & HYDRASDR_CAP_BANDWIDTH) {
                 uint32_t bw = atouint32_metric(value, "-t bandwidth= ");
@@ -1424,6 +1526,11 @@ int sdr_set_freq_correction(sdr_dev_t *dev, int ppm, int verbose)
 
     int r = -1;
 
+#ifdef HYDRASDR
+    if (dev->hydrasdr_ctx)
+        r = sdr_set_freq_correction_hydrasdr(dev, ppm);
+#endif
+
     if (dev->rtl_tcp)
         r = rtltcp_command(dev, RTLTCP_SET_FREQ_CORRECTION, ppm);
 
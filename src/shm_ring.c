@@ -0,0 +1,388 @@
+/** @file
+    Shared-memory event ring, single producer and multiple consumers.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "shm_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef _WIN32
+
+/* GCC/Clang __atomic builtins (works in C99 mode) */
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define LOAD_RELAXED(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+
+#define ALIGN8(n) (((n) + 7) & ~(uint64_t)7)
+
+struct shm_ring {
+    shm_ring_header_t *hdr;
+    uint8_t *data;
+    size_t map_size;
+    uint64_t mask;
+    char *name;
+};
+
+struct shm_reader {
+    shm_ring_header_t *hdr;
+    uint8_t const *data;
+    size_t map_size;
+    uint64_t mask;
+    uint64_t pos;
+    uint64_t last_seq;      ///< sequence number of the record before pos
+    uint64_t lost;
+};
+
+/// Copy into the data area, wrapping at the end.
+static void ring_put(uint8_t *data, uint64_t mask, uint64_t pos, void const *src, size_t len)
+{
+    size_t off   = (size_t)(pos & mask);
+    size_t first = (size_t)(mask + 1) - off;
+    if (first >= len) {
+        memcpy(data + off, src, len);
+    }
+    else {
+        memcpy(data + off, src, first);
+        memcpy(data, (uint8_t const *)src + first, len - first);
+    }
+}
+
+/// Copy from the data area, wrapping at the end.
+static void ring_get(uint8_t const *data, uint64_t mask, uint64_t pos, void *dst, size_t len)
+{
+    size_t off   = (size_t)(pos & mask);
+    size_t first = (size_t)(mask + 1) - off;
+    if (first >= len) {
+        memcpy(dst, data + off, len);
+    }
+    else {
+        memcpy(dst, data + off, first);
+        memcpy((uint8_t *)dst + first, data, len - first);
+    }
+}
+
+shm_ring_t *shm_ring_create(char const *name, size_t capacity, int format)
+{
+    uint64_t cap = 4096;
+    while (cap < capacity)
+        cap <<= 1;
+
+    shm_ring_t *ring = calloc(1, sizeof(*ring));
+    if (!ring) {
+        fprintf(stderr, "shm_ring_create: calloc() failed\n");
+        return NULL;
+    }
+    ring->name = strdup(name);
+    if (!ring->name) {
+        fprintf(stderr, "shm_ring_create: strdup() failed\n");
+        free(ring);
+        return NULL;
+    }
+
+    // readers of a previous ring keep their mapping and see it closed
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open");
+        free(ring->name);
+        free(ring);
+        return NULL;
+    }
+    ring->map_size = SHM_RING_HEADER_SIZE + (size_t)cap;
+    if (ftruncate(fd, (off_t)ring->map_size) != 0) {
+        perror("ftruncate");
+        close(fd);
+        shm_unlink(name);
+        free(ring->name);
+        free(ring);
+        return NULL;
+    }
+    void *map = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name);
+        free(ring->name);
+        free(ring);
+        return NULL;
+    }
+
+    ring->hdr  = map;
+    ring->data = (uint8_t *)map + SHM_RING_HEADER_SIZE;
+    ring->mask = cap - 1;
+
+    shm_ring_header_t *hdr = ring->hdr;
+    hdr->version      = SHM_RING_VERSION;
+    hdr->format       = (uint32_t)format;
+    hdr->capacity     = cap;
+    hdr->producer_pid = (uint32_t)getpid();
+    // the magic is written last, readers don't attach to a half initialized ring
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(hdr->magic, SHM_RING_MAGIC, sizeof(hdr->magic));
+
+    return ring;
+}
+
+uint64_t shm_ring_write(shm_ring_t *ring, void const *buf, size_t len)
+{
+    shm_ring_header_t *hdr = ring->hdr;
+    uint64_t cap  = ring->mask + 1;
+    uint64_t need = ALIGN8(SHM_RING_RECORD_HDR + (uint64_t)len);
+    if (len > UINT32_MAX || need > cap / 2)
+        return 0;
+
+    uint64_t pos     = hdr->head;
+    uint64_t reserve = pos + need;
+    uint64_t seq     = hdr->seq + 1;
+
+    // drop the records that will be overwritten
+    uint64_t tail = hdr->tail;
+    while (reserve - tail > cap) {
+        uint32_t old_len;
+        ring_get(ring->data, ring->mask, tail, &old_len, sizeof(old_len));
+        tail += ALIGN8(SHM_RING_RECORD_HDR + (uint64_t)old_len);
+    }
+    STORE_RELEASE(&hdr->tail, tail);
+
+    // announce the overwrite before touching the data, readers recheck reserve after copying
+    STORE_RELAXED(&hdr->reserve, reserve);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uint8_t rec[SHM_RING_RECORD_HDR] = {0};
+    uint32_t len32 = (uint32_t)len;
+    memcpy(&rec[0], &len32, sizeof(len32));
+    memcpy(&rec[8], &seq, sizeof(seq));
+    ring_put(ring->data, ring->mask, pos, rec, sizeof(rec));
+    ring_put(ring->data, ring->mask, pos + SHM_RING_RECORD_HDR, buf, len);
+
+    STORE_RELAXED(&hdr->seq, seq);
+    STORE_RELEASE(&hdr->head, reserve);
+    return seq;
+}
+
+void shm_ring_destroy(shm_ring_t *ring)
+{
+    if (!ring)
+        return;
+
+    STORE_RELEASE(&ring->hdr->closed, 1);
+    munmap(ring->hdr, ring->map_size);
+    shm_unlink(ring->name);
+    free(ring->name);
+    free(ring);
+}
+
+/// Start after the last complete record, no write may be in progress for a consistent sequence number.
+static void reader_attach_newest(shm_reader_t *reader)
+{
+    shm_ring_header_t *hdr = reader->hdr;
+    uint64_t head, seq;
+    do {
+        head = LOAD_ACQUIRE(&hdr->head);
+        seq  = LOAD_ACQUIRE(&hdr->seq);
+    } while (LOAD_ACQUIRE(&hdr->reserve) != head);
+    reader->pos      = head;
+    reader->last_seq = seq;
+}
+
+/// Start at the oldest record, returns 0 if the ring is empty.
+static int reader_attach_oldest(shm_reader_t *reader)
+{
+    shm_ring_header_t *hdr = reader->hdr;
+    uint64_t cap = reader->mask + 1;
+    for (;;) {
+        uint64_t tail = LOAD_ACQUIRE(&hdr->tail);
+        if (LOAD_ACQUIRE(&hdr->head) == tail)
+            return 0;
+        uint64_t seq;
+        ring_get(reader->data, reader->mask, tail + 8, &seq, sizeof(seq));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (LOAD_RELAXED(&hdr->reserve) - tail <= cap) {
+            reader->pos      = tail;
+            reader->last_seq = seq - 1;
+            return 1;
+        }
+    }
+}
+
+shm_reader_t *shm_reader_open(char const *name, int from_oldest)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < SHM_RING_HEADER_SIZE) {
+        close(fd);
+        return NULL;
+    }
+    size_t map_size = (size_t)st.st_size;
+    void *map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    shm_ring_header_t *hdr = map;
+    int magic_ok = !memcmp(hdr->magic, SHM_RING_MAGIC, sizeof(hdr->magic));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t cap = hdr->capacity;
+    if (!magic_ok || hdr->version != SHM_RING_VERSION
+            || cap == 0 || (cap & (cap - 1)) || SHM_RING_HEADER_SIZE + cap > map_size) {
+        munmap(map, map_size);
+        return NULL;
+    }
+
+    shm_reader_t *reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        munmap(map, map_size);
+        return NULL;
+    }
+    reader->hdr      = hdr;
+    reader->data     = (uint8_t const *)map + SHM_RING_HEADER_SIZE;
+    reader->map_size = map_size;
+    reader->mask     = cap - 1;
+    if (!from_oldest || !reader_attach_oldest(reader))
+        reader_attach_newest(reader);
+    return reader;
+}
+
+int shm_reader_next(shm_reader_t *reader, void *buf, size_t size, uint64_t *seq)
+{
+    shm_ring_header_t *hdr = reader->hdr;
+    uint64_t cap = reader->mask + 1;
+
+    for (;;) {
+        uint64_t head = LOAD_ACQUIRE(&hdr->head);
+        if (reader->pos == head)
+            return LOAD_ACQUIRE(&hdr->closed) ? SHM_RING_CLOSED : SHM_RING_EMPTY;
+
+        uint64_t pos = reader->pos;
+        int valid    = head - pos <= cap;
+        uint8_t rec[SHM_RING_RECORD_HDR];
+        uint32_t len     = 0;
+        uint64_t rec_seq = 0;
+        if (valid) {
+            ring_get(reader->data, reader->mask, pos, rec, sizeof(rec));
+            memcpy(&len, &rec[0], sizeof(len));
+            memcpy(&rec_seq, &rec[8], sizeof(rec_seq));
+            // a torn header from a concurrent overwrite also fails the reserve check below
+            valid = rec_seq != 0 && ALIGN8(SHM_RING_RECORD_HDR + (uint64_t)len) <= head - pos;
+            if (valid && len <= size)
+                ring_get(reader->data, reader->mask, pos + SHM_RING_RECORD_HDR, buf, len);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            valid = valid && LOAD_RELAXED(&hdr->reserve) - pos <= cap;
+        }
+        if (!valid) {
+            // overwritten while we were behind, continue at the oldest record
+            reader->pos = LOAD_ACQUIRE(&hdr->tail);
+            continue;
+        }
+
+        if (rec_seq > reader->last_seq + 1)
+            reader->lost += rec_seq - reader->last_seq - 1;
+        reader->last_seq = rec_seq;
+        reader->pos      = pos + ALIGN8(SHM_RING_RECORD_HDR + (uint64_t)len);
+        if (len > size) {
+            reader->lost++;
+            continue;
+        }
+        if (seq)
+            *seq = rec_seq;
+        return (int)len;
+    }
+}
+
+uint64_t shm_reader_lost(shm_reader_t const *reader)
+{
+    return reader->lost;
+}
+
+int shm_reader_format(shm_reader_t const *reader)
+{
+    return (int)reader->hdr->format;
+}
+
+void shm_reader_close(shm_reader_t *reader)
+{
+    if (!reader)
+        return;
+
+    munmap((void *)reader->hdr, reader->map_size);
+    free(reader);
+}
+
+#else /* _WIN32 */
+
+shm_ring_t *shm_ring_create(char const *name, size_t capacity, int format)
+{
+    (void)name;
+    (void)capacity;
+    (void)format;
+    fprintf(stderr, "shm_ring_create: POSIX shared memory is not available on this platform\n");
+    return NULL;
+}
+
+uint64_t shm_ring_write(shm_ring_t *ring, void const *buf, size_t len)
+{
+    (void)ring;
+    (void)buf;
+    (void)len;
+    return 0;
+}
+
+void shm_ring_destroy(shm_ring_t *ring)
+{
+    (void)ring;
+}
+
+shm_reader_t *shm_reader_open(char const *name, int from_oldest)
+{
+    (void)name;
+    (void)from_oldest;
+    return NULL;
+}
+
+int shm_reader_next(shm_reader_t *reader, void *buf, size_t size, uint64_t *seq)
+{
+    (void)reader;
+    (void)buf;
+    (void)size;
+    (void)seq;
+    return SHM_RING_CLOSED;
+}
+
+uint64_t shm_reader_lost(shm_reader_t const *reader)
+{
+    (void)reader;
+    return 0;
+}
+
+int shm_reader_format(shm_reader_t const *reader)
+{
+    (void)reader;
+    return SHM_RING_FORMAT_JSON;
+}
+
+void shm_reader_close(shm_reader_t *reader)
+{
+    (void)reader;
+}
+
+#endif /* _WIN32 */
@@ -0,0 +1,296 @@
+/** @file
+    Live spectrum frames for the web UI.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "spectrum.h"
+#include "hydrasdr_lfft.h"
+#include "compat_pthread.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#ifdef THREADS
+#define SPECTRUM_LOCK(sp)   pthread_mutex_lock(&(sp)->lock)
+#define SPECTRUM_UNLOCK(sp) pthread_mutex_unlock(&(sp)->lock)
+#else
+#define SPECTRUM_LOCK(sp)
+#define SPECTRUM_UNLOCK(sp)
+#endif
+
+/* window, power and levels share one allocation, in and out another */
+struct spectrum {
+    hlfft_plan_t *plan;
+    unsigned size;
+    float *window;     ///< Hann window
+    float window_gain; ///< squared sum of the window, the power of a full scale tone
+    hlfft_complex_t *in;
+    hlfft_complex_t *out;
+    float *power;      ///< averaged power per FFT bin
+    double next;
+    // shared with the readers, under the lock
+#ifdef THREADS
+    pthread_mutex_t lock;
+#endif
+    float *levels;     ///< dBFS, lowest frequency first
+    uint32_t seq;
+    uint32_t center_hz; ///< tuning of the next frame
+    uint32_t samp_rate;
+    int wideband;
+    uint32_t levels_center_hz; ///< tuning of the levels
+    uint32_t levels_span_hz;
+    double interval;
+    unsigned channels;
+    float channel_freqs[SPECTRUM_MAX_CHANNELS];
+    float channel_power[SPECTRUM_MAX_CHANNELS];
+};
+
+spectrum_t *spectrum_create(unsigned fft_size)
+{
+    if (!hlfft_size_valid(fft_size))
+        return NULL;
+    spectrum_t *sp = calloc(1, sizeof(*sp));
+    if (!sp)
+        return NULL;
+    sp->size = fft_size;
+#ifdef THREADS
+    pthread_mutex_init(&sp->lock, NULL);
+#endif
+    sp->plan = hlfft_plan_create(fft_size, NULL);
+    sp->in   = hlfft_aligned_alloc(2 * fft_size * sizeof(*sp->in));
+    if (!sp->plan || !sp->in) {
+        spectrum_free(sp);
+        return NULL;
+    }
+    sp->window = malloc(3 * fft_size * sizeof(*sp->window));
+    if (!sp->window) {
+        spectrum_free(sp);
+        return NULL;
+    }
+    sp->out    = sp->in + fft_size;
+    sp->power  = sp->window + fft_size;
+    sp->levels = sp->window + 2 * fft_size;
+
+    double sum = 0.0;
+    for (unsigned i = 0; i < fft_size; ++i) {
+        sp->window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / fft_size));
+        sum += sp->window[i];
+    }
+    sp->window_gain = (float)(sum * sum);
+    for (unsigned i = 0; i < fft_size; ++i)
+        sp->levels[i] = (float)SPECTRUM_FLOOR_DB;
+    return sp;
+}
+
+void spectrum_free(spectrum_t *sp)
+{
+    if (!sp)
+        return;
+    hlfft_plan_destroy(sp->plan);
+    hlfft_aligned_free(sp->in);
+    free(sp->window);
+#ifdef THREADS
+    pthread_mutex_destroy(&sp->lock);
+#endif
+    free(sp);
+}
+
+void spectrum_set_interval(spectrum_t *sp, double seconds)
+{
+    SPECTRUM_LOCK(sp);
+    sp->interval = seconds;
+    SPECTRUM_UNLOCK(sp);
+}
+
+void spectrum_set_tuning(spectrum_t *sp, uint32_t center_hz, uint32_t samp_rate, int wideband)
+{
+    SPECTRUM_LOCK(sp);
+    sp->center_hz = center_hz;
+    sp->samp_rate = samp_rate;
+    sp->wideband  = wideband;
+    SPECTRUM_UNLOCK(sp);
+}
+
+/// Window one FFT input block of the sample buffer, converted to float.
+static void load_block(spectrum_t *sp, void const *iq, unsigned start, unsigned sample_size)
+{
+    hlfft_complex_t *in = sp->in;
+    float const *w      = sp->window;
+    unsigned n          = sp->size;
+
+    if (sample_size == 8) {
+        float const *s = (float const *)iq + 2 * (size_t)start;
+        for (unsigned i = 0; i < n; ++i) {
+            in[i].re = s[2 * i] * w[i];
+            in[i].im = s[2 * i + 1] * w[i];
+        }
+    }
+    else if (sample_size == 4) {
+        int16_t const *s = (int16_t const *)iq + 2 * (size_t)start;
+        for (unsigned i = 0; i < n; ++i) {
+            in[i].re = s[2 * i] * (w[i] / 32768.0f);
+            in[i].im = s[2 * i + 1] * (w[i] / 32768.0f);
+        }
+    }
+    else {
+        uint8_t const *s = (uint8_t const *)iq + 2 * (size_t)start;
+        for (unsigned i = 0; i < n; ++i) {
+            in[i].re = (s[2 * i] - 127.5f) * (w[i] / 127.5f);
+            in[i].im = (s[2 * i + 1] - 127.5f) * (w[i] / 127.5f);
+        }
+    }
+}
+
+int spectrum_feed(spectrum_t *sp, void const *iq, unsigned n_samples, unsigned sample_size, double now)
+{
+    if (!sp || now < sp->next || n_samples < sp->size)
+        return 0;
+    SPECTRUM_LOCK(sp);
+    double interval = sp->interval;
+    SPECTRUM_UNLOCK(sp);
+    if (interval <= 0.0)
+        return 0;
+    // keep the cadence, unless the input stalled
+    sp->next = now - sp->next > interval ? now + interval : sp->next + interval;
+
+    // average blocks spread over the whole buffer
+    unsigned n      = sp->size;
+    unsigned blocks = n_samples / n;
+    if (blocks > SPECTRUM_AVERAGE)
+        blocks = SPECTRUM_AVERAGE;
+    memset(sp->power, 0, n * sizeof(*sp->power));
+    for (unsigned b = 0; b < blocks; ++b) {
+        unsigned start = blocks > 1 ? (unsigned)((uint64_t)b * (n_samples - n) / (blocks - 1)) : 0;
+        load_block(sp, iq, start, sample_size);
+        hlfft_forward(sp->plan, sp->in, sp->out);
+        for (unsigned i = 0; i < n; ++i)
+            sp->power[i] += sp->out[i].re * sp->out[i].re + sp->out[i].im * sp->out[i].im;
+    }
+
+    // the levels are computed in place, DC to the middle, then published
+    float scale = 1.0f / (blocks * sp->window_gain);
+    for (unsigned i = 0; i < n; ++i)
+        sp->power[i] = 10.0f * log10f(sp->power[i] * scale + 1e-20f);
+    SPECTRUM_LOCK(sp);
+    memcpy(sp->levels, sp->power + n / 2, n / 2 * sizeof(*sp->levels));
+    memcpy(sp->levels + n / 2, sp->power, n / 2 * sizeof(*sp->levels));
+    sp->levels_center_hz = sp->center_hz;
+    sp->levels_span_hz   = sp->samp_rate;
+    if (!++sp->seq)
+        sp->seq = 1;
+    SPECTRUM_UNLOCK(sp);
+    return 1;
+}
+
+unsigned spectrum_size(spectrum_t const *sp)
+{
+    return sp->size;
+}
+
+uint32_t spectrum_read(spectrum_t *sp, float *levels, uint32_t since, uint32_t *center_hz, uint32_t *span_hz)
+{
+    SPECTRUM_LOCK(sp);
+    uint32_t seq = sp->seq;
+    if (seq && seq != since)
+        memcpy(levels, sp->levels, sp->size * sizeof(*levels));
+    if (center_hz)
+        *center_hz = sp->levels_center_hz;
+    if (span_hz)
+        *span_hz = sp->levels_span_hz;
+    SPECTRUM_UNLOCK(sp);
+    return seq;
+}
+
+void spectrum_set_channels(spectrum_t *sp, float const *freqs, float const *power, unsigned n)
+{
+    if (n > SPECTRUM_MAX_CHANNELS)
+        n = SPECTRUM_MAX_CHANNELS;
+    SPECTRUM_LOCK(sp);
+    memcpy(sp->channel_freqs, freqs, n * sizeof(*freqs));
+    memcpy(sp->channel_power, power, n * sizeof(*power));
+    sp->channels = n;
+    SPECTRUM_UNLOCK(sp);
+}
+
+unsigned spectrum_read_channels(spectrum_t *sp, float *freqs, float *power)
+{
+    SPECTRUM_LOCK(sp);
+    unsigned n = sp->wideband ? sp->channels : 0;
+    memcpy(freqs, sp->channel_freqs, n * sizeof(*freqs));
+    memcpy(power, sp->channel_power, n * sizeof(*power));
+    SPECTRUM_UNLOCK(sp);
+
+    // insertion sort by frequency, there are only a few channels
+    for (unsigned c = 1; c < n; ++c) {
+        float f = freqs[c];
+        float p = power[c];
+        unsigned i = c;
+        for (; i > 0 && freqs[i - 1] > f; --i) {
+            freqs[i] = freqs[i - 1];
+            power[i] = power[i - 1];
+        }
+        freqs[i] = f;
+        power[i] = p;
+    }
+    return n;
+}
+
+unsigned spectrum_quantize(float const *levels, unsigned n, uint8_t *out, unsigned bins)
+{
+    if (bins > n)
+        bins = n;
+    for (unsigned b = 0; b < bins; ++b) {
+        unsigned lo = (unsigned)((uint64_t)b * n / bins);
+        unsigned hi = (unsigned)((uint64_t)(b + 1) * n / bins);
+        float peak  = levels[lo];
+        for (unsigned i = lo + 1; i < hi; ++i) {
+            if (levels[i] > peak)
+                peak = levels[i];
+        }
+        float q = (peak - SPECTRUM_FLOOR_DB) * 100.0f / SPECTRUM_STEP_CDB + 0.5f;
+        out[b]  = q <= 0.0f ? 0 : q >= 255.0f ? 255 : (uint8_t)q;
+    }
+    return bins;
+}
+
+static void put_le16(uint8_t *p, unsigned v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, v & 0xffff);
+    put_le16(p + 2, v >> 16);
+}
+
+size_t spectrum_frame(uint8_t *buf, size_t size, int source, uint32_t seq,
+        uint32_t center_hz, uint32_t span_hz, float const *levels, unsigned n, unsigned bins)
+{
+    if (bins > n)
+        bins = n;
+    if (size < SPECTRUM_HEADER_LEN + (size_t)bins)
+        return 0;
+    bins = spectrum_quantize(levels, n, buf + SPECTRUM_HEADER_LEN, bins);
+    buf[0] = 1;
+    buf[1] = (uint8_t)source;
+    put_le16(buf + 2, bins);
+    put_le32(buf + 4, seq);
+    put_le32(buf + 8, center_hz);
+    put_le32(buf + 12, span_hz);
+    put_le16(buf + 16, (unsigned)(int16_t)SPECTRUM_FLOOR_DB);
+    put_le16(buf + 18, SPECTRUM_STEP_CDB);
+    return SPECTRUM_HEADER_LEN + bins;
+}
@@ -0,0 +1,264 @@
+/** @file
+    Pipeline trace recorder writing Chrome Trace Event JSON.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "trace.h"
+#include "metrics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+/* volatile accesses have acquire/release semantics with /volatile:ms */
+#define LOAD_ACQUIRE(p)     (*(volatile uint64_t *)(p))
+#define STORE_RELEASE(p, v) (*(volatile uint64_t *)(p) = (v))
+#else
+/* GCC/Clang __atomic builtins (works in C99 mode) */
+#define LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+enum trace_kind {
+    TRACE_SPAN,
+    TRACE_FLOW_START,
+    TRACE_FLOW_END,
+};
+
+typedef struct trace_event {
+    uint64_t start_ns;
+    uint64_t value;   ///< duration of a span or id of a flow
+    char const *name;
+    int32_t arg;
+    uint8_t kind;
+    char detail[TRACE_DETAIL_LEN + 1];
+} trace_event_t;
+
+typedef struct trace_buffer {
+    trace_event_t *events;
+    uint64_t mask;
+    uint64_t head;  ///< only written by the owning thread
+    uint64_t start; ///< head at the start of the window
+} trace_buffer_t;
+
+static struct trace_recorder {
+    uint64_t recording; ///< 64 bit for the atomic macros
+    uint64_t start_ns;
+    double seconds;
+    double input_seconds;
+    char *path;
+    trace_buffer_t buf[TRACE_THREADS];
+} rec;
+
+static char const *const thread_names[TRACE_THREADS] = {
+        "demod",
+        "acquire",
+};
+
+static unsigned const thread_events[TRACE_THREADS] = {
+        TRACE_DEMOD_EVENTS,
+        TRACE_ACQUIRE_EVENTS,
+};
+
+int trace_start(double seconds, char const *path)
+{
+    if (LOAD_ACQUIRE(&rec.recording))
+        return -1;
+
+    // the buffers are kept until trace_free(), a late writer never sees them go away
+    for (int t = 0; t < TRACE_THREADS; ++t) {
+        trace_buffer_t *b = &rec.buf[t];
+        if (!b->events) {
+            b->events = calloc(thread_events[t], sizeof(*b->events));
+            if (!b->events)
+                return -1;
+            b->mask = thread_events[t] - 1;
+        }
+        b->start = LOAD_ACQUIRE(&b->head);
+    }
+
+    char *p = strdup(path);
+    if (!p)
+        return -1;
+    free(rec.path);
+    rec.path          = p;
+    rec.seconds       = seconds;
+    rec.input_seconds = 0.0;
+    rec.start_ns      = metrics_time_ns();
+    STORE_RELEASE(&rec.recording, 1);
+    return 0;
+}
+
+int trace_recording(void)
+{
+    return LOAD_ACQUIRE(&rec.recording) != 0;
+}
+
+uint64_t trace_begin(void)
+{
+    return LOAD_ACQUIRE(&rec.recording) ? metrics_time_ns() : 0;
+}
+
+static trace_event_t *trace_next(int thread)
+{
+    if (!LOAD_ACQUIRE(&rec.recording))
+        return NULL;
+    trace_buffer_t *b = &rec.buf[thread];
+    return &b->events[b->head & b->mask];
+}
+
+static void trace_commit(int thread)
+{
+    trace_buffer_t *b = &rec.buf[thread];
+    STORE_RELEASE(&b->head, b->head + 1);
+}
+
+void trace_span(int thread, char const *name, char const *detail, int arg, uint64_t start_ns)
+{
+    if (!start_ns)
+        return;
+    trace_event_t *ev = trace_next(thread);
+    if (!ev)
+        return;
+    ev->start_ns = start_ns;
+    ev->value    = metrics_time_ns() - start_ns;
+    ev->name     = name;
+    ev->arg      = arg;
+    ev->kind     = TRACE_SPAN;
+    if (detail) {
+        strncpy(ev->detail, detail, TRACE_DETAIL_LEN);
+        ev->detail[TRACE_DETAIL_LEN] = '\0';
+    }
+    else {
+        ev->detail[0] = '\0';
+    }
+    trace_commit(thread);
+}
+
+void trace_flow(int thread, int end, uint64_t id)
+{
+    trace_event_t *ev = trace_next(thread);
+    if (!ev)
+        return;
+    ev->start_ns  = metrics_time_ns();
+    ev->value     = id;
+    ev->name      = "buffer";
+    ev->arg       = -1;
+    ev->kind      = end ? TRACE_FLOW_END : TRACE_FLOW_START;
+    ev->detail[0] = '\0';
+    trace_commit(thread);
+}
+
+int trace_input(double seconds)
+{
+    if (!LOAD_ACQUIRE(&rec.recording))
+        return 0;
+    rec.input_seconds += seconds;
+    return rec.input_seconds >= rec.seconds;
+}
+
+static void print_escaped(FILE *f, char const *s)
+{
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            fprintf(f, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20)
+            fprintf(f, "\\u%04x", (unsigned char)*s);
+        else
+            fputc(*s, f);
+    }
+}
+
+static void print_event(FILE *f, int thread, trace_event_t const *ev)
+{
+    double ts = (double)(ev->start_ns - rec.start_ns) / 1000.0;
+    fprintf(f, ",\n{\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"name\":\"%s\"", thread + 1, ts, ev->name);
+    if (ev->kind == TRACE_SPAN) {
+        fprintf(f, ",\"ph\":\"X\",\"dur\":%.3f", (double)ev->value / 1000.0);
+        if (ev->arg >= 0 || ev->detail[0]) {
+            fprintf(f, ",\"args\":{");
+            if (ev->arg >= 0)
+                fprintf(f, "\"index\":%d%s", (int)ev->arg, ev->detail[0] ? "," : "");
+            if (ev->detail[0]) {
+                fprintf(f, "\"detail\":\"");
+                print_escaped(f, ev->detail);
+                fprintf(f, "\"");
+            }
+            fprintf(f, "}");
+        }
+    }
+    else {
+        // a flow end binds to the next span starting on its thread, i.e. the frame
+        fprintf(f, ",\"cat\":\"handoff\",\"ph\":\"%s\",\"id\":%llu", ev->kind == TRACE_FLOW_START ? "s" : "f",
+                (unsigned long long)ev->value);
+    }
+    fprintf(f, "}");
+}
+
+long trace_stop(void)
+{
+    if (!LOAD_ACQUIRE(&rec.recording))
+        return -1;
+    STORE_RELEASE(&rec.recording, 0);
+
+    FILE *f = fopen(rec.path, "w");
+    if (!f)
+        return -1;
+
+    long written  = 0;
+    uint64_t lost = 0;
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(f, "{\"pid\":1,\"ph\":\"M\",\"name\":\"process_name\",\"args\":{\"name\":\"hydrasdr_433\"}}");
+    for (int t = 0; t < TRACE_THREADS; ++t) {
+        fprintf(f, ",\n{\"pid\":1,\"tid\":%d,\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+                t + 1, thread_names[t]);
+    }
+    for (int t = 0; t < TRACE_THREADS; ++t) {
+        trace_buffer_t *b = &rec.buf[t];
+        uint64_t end      = LOAD_ACQUIRE(&b->head);
+        uint64_t begin    = b->start;
+        // a writer that saw the recording flag just before the stop may still
+        // fill the slot after the end, which is the oldest once the ring wrapped
+        if (end - begin > b->mask) {
+            lost += end - begin - b->mask;
+            begin = end - b->mask;
+        }
+        for (uint64_t i = begin; i < end; ++i) {
+            trace_event_t const *ev = &b->events[i & b->mask];
+            if (ev->start_ns < rec.start_ns)
+                continue; // a late event of the previous window
+            print_event(f, t, ev);
+            written++;
+        }
+    }
+    fprintf(f, "\n],\"otherData\":{\"input_seconds\":%.3f,\"lost_events\":%llu}}\n",
+            rec.input_seconds, (unsigned long long)lost);
+
+    if (fclose(f))
+        return -1;
+    return written;
+}
+
+char const *trace_path(void)
+{
+    return rec.path;
+}
+
+void trace_free(void)
+{
+    STORE_RELEASE(&rec.recording, 0);
+    for (int t = 0; t < TRACE_THREADS; ++t) {
+        free(rec.buf[t].events);
+        rec.buf[t].events = NULL;
+    }
+    free(rec.path);
+    rec.path = NULL;
+}
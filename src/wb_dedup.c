@@ -1,69 +1,62 @@
 /** @file
     Wideband cross-channel deduplication.
 
-    Ring buffer of recent decode fingerprints.  Each entry stores an FNV-1a
-    hash of all data_t key-value pairs, the channel center frequency, and a
-    microsecond timestamp.
+    Open-addressing hash index of recent decode keys.  The key is a 64-bit
+    FNV-1a hash of the configured data_t fields, without the fields that
+    differ between channels (RSSI, SNR, frequency, ...).
+
+    Each slot is a single 64-bit word packing a 28-bit key tag, a 28-bit
+    millisecond timestamp of the sample clock and an 8-bit channel, so a
+    lookup and its update are one compare-and-swap and channel workers can
+    share the index without a lock.  Entries older than the window count as
+    free slots, there is no separate expiry pass.
 
     A decode is suppressed (return 1) only when:
-      - the hash matches a recent entry within the time window, AND
-      - the frequencies differ (cross-channel duplicate).
+      - the key matches an entry within the time window, AND
+      - the channels differ (cross-channel duplicate).
 
-    Same-channel repeats (same hash, same freq) are allowed through.
+    Same-channel repeats (same key, same channel) are allowed through.
 */
 
 #include "wb_dedup.h"
+#include "list.h"
 
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 
-#ifdef _WIN32
+#ifdef _MSC_VER
 #include <windows.h>
+#define LOAD_ACQUIRE(p)  (*(volatile uint64_t *)(p))
+#define CAS(p, old, new) ((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)(p), (new), (old)) == (old))
+#define ADD_RELAXED(p)   InterlockedIncrement64((volatile LONG64 *)(p))
 #else
-#include <sys/time.h>
+/* GCC/Clang __atomic builtins (works in C99 mode) */
+#define LOAD_ACQUIRE(p)  __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define CAS(p, old, new) __atomic_compare_exchange_n((p), &(old), (new), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define ADD_RELAXED(p)   __atomic_fetch_add((p), 1, __ATOMIC_RELAXED)
 #endif
 
-/* FNV-1a parameters (32-bit) */
-#define FNV_OFFSET_BASIS  0x811c9dc5u
-#define FNV_PRIME         0x01000193u
-
-/* Minimum frequency difference (Hz) to consider two channels as different */
-#define MIN_FREQ_DIFF     1000.0f
+/* FNV-1a parameters (64-bit) */
+#define FNV_OFFSET_BASIS  0xcbf29ce484222325ull
+#define FNV_PRIME         0x100000001b3ull
 
-struct wb_dedup_entry {
-    uint32_t hash;
-    float    freq;
-    int64_t  timestamp_us;
-};
+/* Slot layout: tag:28 | time_ms:28 | channel:8, zero is an empty slot */
+#define SLOT_TAG_BITS   28
+#define SLOT_TIME_BITS  28
+#define SLOT_TIME_MASK  ((1ull << SLOT_TIME_BITS) - 1)
+#define SLOT_TAG(w)     ((w) >> (SLOT_TIME_BITS + 8))
+#define SLOT_TIME(w)    (((w) >> 8) & SLOT_TIME_MASK)
+#define SLOT_CHANNEL(w) ((w) & 0xff)
 
 struct wb_dedup {
-    struct wb_dedup_entry cache[WB_DEDUP_CACHE_SIZE];
-    int head;   /* next write position */
-    int count;  /* entries in use (up to WB_DEDUP_CACHE_SIZE) */
-    unsigned suppressed_count;  /* total suppressed duplicates */
+    uint64_t slots[WB_DEDUP_SLOTS];
+    uint64_t window_ms;
+    list_t include;  /* key fields, all if empty */
+    list_t exclude;  /* fields never in the key */
+    wb_dedup_stats_t stats;
 };
 
-static int64_t get_timestamp_us(void)
-{
-#ifdef _WIN32
-    FILETIME ft;
-    ULARGE_INTEGER ul;
-
-    GetSystemTimeAsFileTime(&ft);
-    ul.LowPart = ft.dwLowDateTime;
-    ul.HighPart = ft.dwHighDateTime;
-    /* FILETIME is 100-ns intervals since 1601-01-01 */
-    return (int64_t)(ul.QuadPart / 10);
-#else
-    struct timeval tv;
-
-    gettimeofday(&tv, NULL);
-    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
-#endif
-}
-
-static uint32_t fnv1a_hash_bytes(uint32_t h, const void *data, size_t len)
+static uint64_t fnv1a_hash_bytes(uint64_t h, const void *data, size_t len)
 {
     const unsigned char *p = (const unsigned char *)data;
 
@@ -74,7 +67,7 @@ static uint32_t fnv1a_hash_bytes(uint32_t h, const void *data, size_t len)
     return h;
 }
 
-static uint32_t fnv1a_hash_str(uint32_t h, const char *s)
+static uint64_t fnv1a_hash_str(uint64_t h, const char *s)
 {
     if (!s)
         return h;
@@ -85,91 +78,191 @@ static uint32_t fnv1a_hash_str(uint32_t h, const char *s)
     return h;
 }
 
-/** Hash all key-value pairs in data_t linked list. */
-static uint32_t hash_data(data_t *data)
+static uint64_t hash_data(uint64_t h, data_t *data);
+
+static uint64_t hash_value(uint64_t h, data_type_t type, data_value_t value)
 {
-    uint32_t h = FNV_OFFSET_BASIS;
+    switch (type) {
+    case DATA_INT:
+        return fnv1a_hash_bytes(h, &value.v_int, sizeof(value.v_int));
+    case DATA_DOUBLE:
+        return fnv1a_hash_bytes(h, &value.v_dbl, sizeof(value.v_dbl));
+    case DATA_STRING:
+        return fnv1a_hash_str(h, value.v_ptr);
+    case DATA_DATA:
+        return hash_data(h, value.v_ptr);
+    case DATA_ARRAY: {
+        data_array_t *arr = value.v_ptr;
+        if (!arr)
+            return h;
+        h = fnv1a_hash_bytes(h, &arr->num_values, sizeof(arr->num_values));
+        for (int i = 0; i < arr->num_values; i++) {
+            data_value_t v;
+            if (arr->type == DATA_INT)
+                v.v_int = ((int *)arr->values)[i];
+            else if (arr->type == DATA_DOUBLE)
+                v.v_dbl = ((double *)arr->values)[i];
+            else
+                v.v_ptr = ((void **)arr->values)[i];
+            h = hash_value(h, arr->type, v);
+        }
+        return h;
+    }
+    default:
+        return fnv1a_hash_bytes(h, &type, sizeof(type));
+    }
+}
 
+/** Hash all key-value pairs in a nested data_t list. */
+static uint64_t hash_data(uint64_t h, data_t *data)
+{
     for (data_t *d = data; d; d = d->next) {
         h = fnv1a_hash_str(h, d->key);
-        switch (d->type) {
-        case DATA_INT:
-            h = fnv1a_hash_bytes(h, &d->value.v_int, sizeof(d->value.v_int));
-            break;
-        case DATA_DOUBLE:
-            h = fnv1a_hash_bytes(h, &d->value.v_dbl, sizeof(d->value.v_dbl));
-            break;
-        case DATA_STRING:
-            h = fnv1a_hash_str(h, d->value.v_ptr);
-            break;
-        case DATA_ARRAY: {
-            data_array_t *arr = d->value.v_ptr;
-            if (arr) {
-                h = fnv1a_hash_bytes(h, &arr->num_values,
-                                     sizeof(arr->num_values));
-                h = fnv1a_hash_bytes(h, &arr->type,
-                                     sizeof(arr->type));
-            }
-            break;
-        }
-        default:
-            h = fnv1a_hash_bytes(h, &d->type, sizeof(d->type));
-            break;
-        }
+        h = hash_value(h, d->type, d->value);
     }
     return h;
 }
 
-wb_dedup_t *wb_dedup_create(void)
+static int list_has(list_t const *list, char const *key)
+{
+    for (size_t i = 0; i < list->len; i++) {
+        if (!strcmp(list->elems[i], key))
+            return 1;
+    }
+    return 0;
+}
+
+/** Add the comma separated names of spec to include, to exclude if prefixed
+ *  with '-' or if exclude_all is set. */
+static int parse_fields(wb_dedup_t *dedup, char const *spec, int exclude_all)
+{
+    while (spec && *spec) {
+        size_t len = strcspn(spec, ",");
+        size_t skip = *spec == '-';
+        if (len > skip) {
+            char *name = malloc(len + 1 - skip);
+            if (!name)
+                return -1;
+            memcpy(name, spec + skip, len - skip);
+            name[len - skip] = '\0';
+            list_push(skip || exclude_all ? &dedup->exclude : &dedup->include, name);
+        }
+        spec += len;
+        if (*spec == ',')
+            spec++;
+    }
+    return 0;
+}
+
+wb_dedup_t *wb_dedup_create(unsigned window_ms, char const *fields)
 {
     wb_dedup_t *dedup = calloc(1, sizeof(*dedup));
     if (!dedup)
         return NULL;
+    dedup->window_ms = window_ms;
+    if (parse_fields(dedup, WB_DEDUP_VOLATILE_FIELDS, 1) < 0 || parse_fields(dedup, fields, 0) < 0) {
+        wb_dedup_free(dedup);
+        return NULL;
+    }
     return dedup;
 }
 
 void wb_dedup_free(wb_dedup_t *dedup)
 {
+    if (!dedup)
+        return;
+    list_free_elems(&dedup->include, free);
+    list_free_elems(&dedup->exclude, free);
     free(dedup);
 }
 
-int wb_dedup_check(wb_dedup_t *dedup, data_t *data, float chan_freq_hz)
+uint64_t wb_dedup_key(wb_dedup_t const *dedup, data_t *data)
+{
+    uint64_t h = FNV_OFFSET_BASIS;
+
+    for (data_t *d = data; d; d = d->next) {
+        if (list_has(&dedup->exclude, d->key))
+            continue;
+        if (dedup->include.len && !list_has(&dedup->include, d->key))
+            continue;
+        h = fnv1a_hash_str(h, d->key);
+        h = hash_value(h, d->type, d->value);
+    }
+    return h;
+}
+
+int wb_dedup_check(wb_dedup_t *dedup, data_t *data, int channel, uint64_t time_ms)
 {
     if (!dedup || !data)
         return 0;
 
-    uint32_t h = hash_data(data);
-    int64_t now = get_timestamp_us();
-    int64_t window = WB_DEDUP_WINDOW_US;
+    uint64_t h   = wb_dedup_key(dedup, data);
+    uint64_t tag = h >> (64 - SLOT_TAG_BITS);
+    if (!tag)
+        tag = 1; /* keep used slots non-zero */
+    uint64_t now   = time_ms & SLOT_TIME_MASK;
+    uint64_t entry = tag << (SLOT_TIME_BITS + 8) | now << 8 | ((unsigned)channel & 0xff);
 
-    /* Search cache for matching hash within time window */
-    for (int i = 0; i < dedup->count; i++) {
-        struct wb_dedup_entry *e = &dedup->cache[i];
+    for (int retry = 0; retry < WB_DEDUP_PROBES; retry++) {
+        uint64_t *free_slot = NULL;
+        uint64_t free_word  = 0;
+        uint64_t *victim    = NULL;
+        uint64_t victim_word = 0;
+        uint64_t victim_age = 0;
 
-        if (e->hash != h)
-            continue;
-        if ((now - e->timestamp_us) > window)
-            continue;
+        /* Search the probe sequence for the key, note the first free slot */
+        for (int i = 0; i < WB_DEDUP_PROBES; i++) {
+            uint64_t *slot = &dedup->slots[(h + i) & (WB_DEDUP_SLOTS - 1)];
+            uint64_t w     = LOAD_ACQUIRE(slot);
+            /* distance modulo the time bits, channels may be slightly out of order */
+            uint64_t age = (now - SLOT_TIME(w)) & SLOT_TIME_MASK;
+            if (age > SLOT_TIME_MASK / 2)
+                age = SLOT_TIME_MASK + 1 - age;
+            int live     = w && age <= dedup->window_ms;
 
-        /* Hash match within window */
-        if (fabsf(chan_freq_hz - e->freq) > MIN_FREQ_DIFF) {
-            /* Different channel — cross-channel duplicate: suppress */
-            dedup->suppressed_count++;
-            return 1;
+            if (live && SLOT_TAG(w) == tag) {
+                if (SLOT_CHANNEL(w) != ((unsigned)channel & 0xff)) {
+                    /* Different channel — cross-channel duplicate: suppress */
+                    ADD_RELAXED(&dedup->stats.hits);
+                    return 1;
+                }
+                /* Same channel — normal retransmission: allow, restart the window */
+                if (CAS(slot, w, entry)) {
+                    ADD_RELAXED(&dedup->stats.repeats);
+                    return 0;
+                }
+                goto retry; /* raced with another worker on this key */
+            }
+            if (!live && !free_slot) {
+                free_slot = slot;
+                free_word = w;
+            }
+            if (live && age >= victim_age) {
+                victim      = slot;
+                victim_word = w;
+                victim_age  = age;
+            }
         }
-        /* Same channel — normal retransmission: allow */
-    }
-
-    /* No duplicate found — record this decode */
-    struct wb_dedup_entry *slot = &dedup->cache[dedup->head];
-    slot->hash = h;
-    slot->freq = chan_freq_hz;
-    slot->timestamp_us = now;
 
-    dedup->head = (dedup->head + 1) % WB_DEDUP_CACHE_SIZE;
-    if (dedup->count < WB_DEDUP_CACHE_SIZE)
-        dedup->count++;
+        /* No duplicate found — record this decode */
+        if (free_slot) {
+            if (CAS(free_slot, free_word, entry)) {
+                ADD_RELAXED(&dedup->stats.misses);
+                return 0;
+            }
+        }
+        else if (victim) {
+            if (CAS(victim, victim_word, entry)) {
+                ADD_RELAXED(&dedup->stats.misses);
+                ADD_RELAXED(&dedup->stats.evictions);
+                return 0;
+            }
+        }
+    retry:;
+    }
 
+    /* Persistent contention, forward rather than drop */
+    ADD_RELAXED(&dedup->stats.misses);
     return 0;
 }
 
@@ -177,5 +270,16 @@ unsigned wb_dedup_suppressed_count(wb_dedup_t *dedup)
 {
     if (!dedup)
         return 0;
-    return dedup->suppressed_count;
+    return (unsigned)LOAD_ACQUIRE(&dedup->stats.hits);
+}
+
+void wb_dedup_stats(wb_dedup_t *dedup, wb_dedup_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!dedup)
+        return;
+    stats->hits      = LOAD_ACQUIRE(&dedup->stats.hits);
+    stats->repeats   = LOAD_ACQUIRE(&dedup->stats.repeats);
+    stats->misses    = LOAD_ACQUIRE(&dedup->stats.misses);
+    stats->evictions = LOAD_ACQUIRE(&dedup->stats.evictions);
 }
@@ -0,0 +1,299 @@
+/*
+ * Cross-Channel Baseband Filter Test
+ *
+ * Checks that the cross-channel low pass and FM demod (baseband_lanes.h)
+ * give bit-identical output and state to the single channel functions,
+ * for every ISA variant this CPU runs, and times both paths.
+ *
+ * Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "baseband_lanes.h"
+#include "cpu_detect.h"
+#include "logger.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TEST_LEN        4096    /* Samples per channel per call */
+#define TEST_CALLS      3       /* Calls, to carry the state over */
+#define TEST_RATE       250000  /* Per channel sample rate */
+#define BENCH_LEN       8192
+#define BENCH_ROUNDS    200
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+typedef struct {
+    const char *name;
+    baseband_lowpass_lanes_fn_t lowpass;
+    baseband_fm_lowpass_lanes_fn_t fm_lowpass;
+    int level; /* Lowest cpu_detect_isa() level that runs it */
+} lanes_variant_t;
+
+static int variant_supported(lanes_variant_t const *v, enum cpu_isa_level isa)
+{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    if (v->level == CPU_ISA_NEON || v->level == CPU_ISA_SVE)
+        return 0;
+    return (int)isa >= v->level;
+#else
+    if (v->level == CPU_ISA_AVX2 || v->level == CPU_ISA_AVX512)
+        return 0;
+    if (v->level == CPU_ISA_SVE)
+        return isa == CPU_ISA_SVE;
+    if (v->level == CPU_ISA_NEON)
+        return isa == CPU_ISA_NEON || isa == CPU_ISA_SVE;
+    return 1;
+#endif
+}
+
+static lanes_variant_t const variants[] = {
+        {"baseline", baseband_lowpass_lanes_sse2, baseband_fm_lowpass_lanes_sse2, CPU_ISA_BASELINE},
+        {"AVX2", baseband_lowpass_lanes_avx2, baseband_fm_lowpass_lanes_avx2, CPU_ISA_AVX2},
+        {"AVX-512", baseband_lowpass_lanes_avx512, baseband_fm_lowpass_lanes_avx512, CPU_ISA_AVX512},
+        {"NEON", baseband_lowpass_lanes_neon, baseband_fm_lowpass_lanes_neon, CPU_ISA_NEON},
+        {"SVE", baseband_lowpass_lanes_sve, baseband_fm_lowpass_lanes_sve, CPU_ISA_SVE},
+};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Deterministic test signal: an FSK tone per channel plus noise, with
+ * a few full scale and zero samples to hit the atan2 edge cases. */
+static uint32_t rng_state = 12345;
+
+static float frand(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (float)(rng_state >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+static void make_iq(float *iq, unsigned len, unsigned chan, unsigned call)
+{
+    double f = 0.01 + 0.013 * chan;
+    for (unsigned t = 0; t < len; t++) {
+        double n = (double)call * len + t;
+        double ph = 2.0 * M_PI * f * n * ((n / 200.0 - floor(n / 200.0)) < 0.5 ? 1.0 : -1.0);
+        float amp = 0.1f + 0.08f * (float)(chan % 10);
+        iq[2 * t + 0] = amp * (float)cos(ph) + 0.01f * frand();
+        iq[2 * t + 1] = amp * (float)sin(ph) + 0.01f * frand();
+    }
+    if (len > 20) {
+        iq[10] = iq[11] = 0.0f;
+        iq[20] = 1.0f;
+        iq[21] = -1.0f;
+        iq[22] = -1.0f;
+        iq[23] = -1.0f;
+    }
+}
+
+static void test_variant(lanes_variant_t const *v, unsigned channels)
+{
+    char msg[128];
+    float *iq[BASEBAND_LANES_MAX * 2];
+    uint16_t *mag[BASEBAND_LANES_MAX * 2];
+    int16_t *ref_am[BASEBAND_LANES_MAX * 2], *ref_fm[BASEBAND_LANES_MAX * 2];
+    int16_t *lanes_am[BASEBAND_LANES_MAX * 2], *lanes_fm[BASEBAND_LANES_MAX * 2];
+    filter_state_t ref_lp[BASEBAND_LANES_MAX * 2], lanes_lp[BASEBAND_LANES_MAX * 2];
+    demodfm_state_t ref_st[BASEBAND_LANES_MAX * 2] = {{0}}, lanes_st[BASEBAND_LANES_MAX * 2] = {{0}};
+    filter_state_t *lp_ptr[BASEBAND_LANES_MAX * 2];
+    demodfm_state_t *st_ptr[BASEBAND_LANES_MAX * 2];
+    float low_pass[BASEBAND_LANES_MAX * 2];
+    int am_ok = 1, fm_ok = 1, state_ok = 1;
+
+    memset(ref_lp, 0, sizeof(ref_lp));
+    memset(lanes_lp, 0, sizeof(lanes_lp));
+    baseband_lanes_t *lanes = baseband_lanes_create(TEST_LEN);
+    if (!lanes) {
+        TEST_ASSERT(0, "baseband_lanes_create()");
+        return;
+    }
+    /* Pin the variant under test */
+    lanes->lowpass = v->lowpass;
+    lanes->fm_lowpass = v->fm_lowpass;
+
+    for (unsigned c = 0; c < channels; c++) {
+        iq[c] = malloc(2 * TEST_LEN * sizeof(float));
+        mag[c] = malloc(TEST_LEN * sizeof(uint16_t));
+        ref_am[c] = malloc(TEST_LEN * sizeof(int16_t));
+        ref_fm[c] = malloc(TEST_LEN * sizeof(int16_t));
+        lanes_am[c] = malloc(TEST_LEN * sizeof(int16_t));
+        lanes_fm[c] = malloc(TEST_LEN * sizeof(int16_t));
+        if (!iq[c] || !mag[c] || !ref_am[c] || !ref_fm[c] || !lanes_am[c] || !lanes_fm[c]) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        lp_ptr[c] = &lanes_lp[c];
+        st_ptr[c] = &lanes_st[c];
+        low_pass[c] = c & 1 ? 0.2f : 0.1f; /* both FSK pulse detect modes */
+    }
+
+    for (unsigned call = 0; call < TEST_CALLS; call++) {
+        /* Odd lengths on later calls, the state must carry over exactly */
+        unsigned len = TEST_LEN - call * 7;
+        for (unsigned c = 0; c < channels; c++) {
+            make_iq(iq[c], len, c, call);
+            magnitude_est_cf32(iq[c], mag[c], len);
+            baseband_low_pass_filter(&ref_lp[c], mag[c], ref_am[c], len);
+            baseband_demod_FM_cf32(&ref_st[c], iq[c], ref_fm[c], len, TEST_RATE, low_pass[c]);
+        }
+        baseband_low_pass_filter_lanes(lanes, lp_ptr, (uint16_t const *const *)mag, lanes_am, len, channels);
+        baseband_demod_FM_cf32_lanes(lanes, st_ptr, (float const *const *)iq, lanes_fm, len, channels,
+                TEST_RATE, low_pass);
+
+        for (unsigned c = 0; c < channels; c++) {
+            am_ok &= !memcmp(ref_am[c], lanes_am[c], len * sizeof(int16_t));
+            fm_ok &= !memcmp(ref_fm[c], lanes_fm[c], len * sizeof(int16_t));
+            state_ok &= !memcmp(&ref_lp[c], &lanes_lp[c], sizeof(filter_state_t));
+            state_ok &= ref_st[c].xr == lanes_st[c].xr && ref_st[c].xi == lanes_st[c].xi
+                    && ref_st[c].xf == lanes_st[c].xf && ref_st[c].yf == lanes_st[c].yf;
+        }
+    }
+
+    snprintf(msg, sizeof(msg), "%s %u channels: low pass bit-identical", v->name, channels);
+    TEST_ASSERT(am_ok, msg);
+    snprintf(msg, sizeof(msg), "%s %u channels: FM demod bit-identical", v->name, channels);
+    TEST_ASSERT(fm_ok, msg);
+    snprintf(msg, sizeof(msg), "%s %u channels: state carried over", v->name, channels);
+    TEST_ASSERT(state_ok, msg);
+
+    for (unsigned c = 0; c < channels; c++) {
+        free(iq[c]);
+        free(mag[c]);
+        free(ref_am[c]);
+        free(ref_fm[c]);
+        free(lanes_am[c]);
+        free(lanes_fm[c]);
+    }
+    baseband_lanes_free(lanes);
+}
+
+/* Low pass and FM demod time per channel sample, per channel vs lanes */
+static void bench(unsigned channels)
+{
+    float *iq = malloc(2 * BENCH_LEN * sizeof(float));
+    uint16_t *mag = malloc(BENCH_LEN * sizeof(uint16_t));
+    int16_t *out = malloc((size_t)channels * BENCH_LEN * sizeof(int16_t));
+    baseband_lanes_t *lanes = baseband_lanes_create(BENCH_LEN);
+    filter_state_t lp[BASEBAND_LANES_MAX];
+    demodfm_state_t st[BASEBAND_LANES_MAX] = {{0}};
+    filter_state_t *lp_ptr[BASEBAND_LANES_MAX];
+    demodfm_state_t *st_ptr[BASEBAND_LANES_MAX];
+    float const *iq_ptr[BASEBAND_LANES_MAX];
+    uint16_t const *mag_ptr[BASEBAND_LANES_MAX];
+    int16_t *out_ptr[BASEBAND_LANES_MAX];
+    float low_pass[BASEBAND_LANES_MAX];
+    if (!iq || !mag || !out || !lanes) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    memset(lp, 0, sizeof(lp));
+    make_iq(iq, BENCH_LEN, 1, 0);
+    magnitude_est_cf32(iq, mag, BENCH_LEN);
+    for (unsigned c = 0; c < channels; c++) {
+        lp_ptr[c] = &lp[c];
+        st_ptr[c] = &st[c];
+        iq_ptr[c] = iq;
+        mag_ptr[c] = mag;
+        out_ptr[c] = out + (size_t)c * BENCH_LEN;
+        low_pass[c] = 0.1f;
+    }
+    double n = (double)BENCH_ROUNDS * channels * BENCH_LEN;
+
+    double t0 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (unsigned c = 0; c < channels; c++)
+            baseband_low_pass_filter(&lp[c], mag, out_ptr[c], BENCH_LEN);
+    double lp_ref = (now_s() - t0) * 1e9 / n;
+
+    t0 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        baseband_low_pass_filter_lanes(lanes, lp_ptr, mag_ptr, out_ptr, BENCH_LEN, channels);
+    double lp_lanes = (now_s() - t0) * 1e9 / n;
+
+    t0 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        for (unsigned c = 0; c < channels; c++)
+            baseband_demod_FM_cf32(&st[c], iq, out_ptr[c], BENCH_LEN, TEST_RATE, low_pass[c]);
+    double fm_ref = (now_s() - t0) * 1e9 / n;
+
+    t0 = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++)
+        baseband_demod_FM_cf32_lanes(lanes, st_ptr, iq_ptr, out_ptr, BENCH_LEN, channels, TEST_RATE, low_pass);
+    double fm_lanes = (now_s() - t0) * 1e9 / n;
+
+    printf("| %2u | %5.2f | %5.2f | %5.2f | %5.2f |\n", channels, lp_ref, lp_lanes, fm_ref, fm_lanes);
+
+    baseband_lanes_free(lanes);
+    free(iq);
+    free(mag);
+    free(out);
+}
+
+static void quiet_log(log_level_t level, char const *src, char const *msg, void *userdata)
+{
+    (void)level;
+    (void)src;
+    (void)msg;
+    (void)userdata;
+}
+
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+    enum cpu_isa_level isa = cpu_detect_isa();
+
+    /* The coefficient notices are not of interest here */
+    r_logger_set_log_handler(quiet_log, NULL);
+
+    printf("Cross-channel baseband filters, dispatched ISA: %s\n", baseband_lanes_isa_info());
+
+    static unsigned const counts[] = {1, 3, 4, 5, 8, 11, 16, 20};
+    for (size_t i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        if (!variant_supported(&variants[i], isa)) {
+            printf("SKIP: %s not supported by this CPU\n", variants[i].name);
+            continue;
+        }
+        for (size_t j = 0; j < sizeof(counts) / sizeof(counts[0]); j++)
+            test_variant(&variants[i], counts[j]);
+    }
+
+    printf("\nns per channel sample, %s (per channel calls vs lanes):\n", baseband_lanes_isa_info());
+    printf("| Ch | low pass | lanes | FM demod | lanes |\n");
+    bench(4);
+    bench(8);
+    bench(16);
+
+    printf("\n%d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
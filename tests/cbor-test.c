@@ -0,0 +1,195 @@
+/** @file
+    CBOR encoding test.
+
+    Checks the CBOR encoding of data_t structures against known bytes and
+    round-trips nested data through the encoder, the decoder and the CBOR
+    file output, comparing the JSON of both sides.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "data.h"
+#include "data_cbor.h"
+#include "output_file.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static data_t *make_nested(void)
+{
+    /* clang-format off */
+    return data_make(
+            "model",        "",             DATA_STRING, "Acme-Temp",
+            "id",           "",             DATA_INT,    42,
+            "offset",       "",             DATA_INT,    -100000,
+            "big",          "",             DATA_INT,    2147483647,
+            "small",        "",             DATA_INT,    -2147483647 - 1,
+            "temperature_C", "",            DATA_DOUBLE, 21.5,
+            "pressure_hPa", "",             DATA_DOUBLE, 1013.1,
+            "empty",        "",             DATA_STRING, "",
+            "escaped",      "",             DATA_STRING, "a \"quoted\"\nline",
+            "strings",      "",             DATA_ARRAY,  data_array(2, DATA_STRING, (char *[2]){"hello", "world"}),
+            "ints",         "",             DATA_ARRAY,  data_array(3, DATA_INT, (int[3]){-1, 0, 70000}),
+            "dbls",         "",             DATA_ARRAY,  data_array(2, DATA_DOUBLE, (double[2]){0.1, -2.5}),
+            "nested",       "",             DATA_ARRAY,  data_array(2, DATA_ARRAY, (data_array_t *[2]){
+                                                            data_array(2, DATA_INT, (int[2]){4, 2}),
+                                                            data_array(2, DATA_INT, (int[2]){5, 5}) }),
+            "data",         "",             DATA_DATA,   data_make(
+                    "inner",    "", DATA_STRING, "world",
+                    "level",    "", DATA_DATA,   data_make("n", "", DATA_INT, 1, NULL),
+                    NULL),
+            NULL);
+    /* clang-format on */
+}
+
+static int same_json(data_t *a, data_t *b)
+{
+    char ja[4096], jb[4096];
+    data_print_jsons(a, ja, sizeof(ja));
+    data_print_jsons(b, jb, sizeof(jb));
+    if (strcmp(ja, jb)) {
+        printf("  expected: %s\n  got:      %s\n", ja, jb);
+        return 0;
+    }
+    return 1;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_known_bytes(void)
+{
+    printf("\n=== Known encodings ===\n");
+
+    uint8_t buf[64];
+    data_t *data = data_make(
+            "a", "", DATA_INT, 1,
+            "b", "", DATA_INT, -500,
+            "c", "", DATA_DOUBLE, 1.5,
+            NULL);
+    size_t len = data_print_cbor(data, buf, sizeof(buf));
+    uint8_t const expect[] = {
+            0xa3,                                     // map(3)
+            0x61, 'a', 0x01,                          // "a": 1
+            0x61, 'b', 0x39, 0x01, 0xf3,              // "b": -500
+            0x61, 'c', 0xfa, 0x3f, 0xc0, 0x00, 0x00,  // "c": 1.5 as float32
+    };
+    TEST_ASSERT(len == sizeof(expect) && !memcmp(buf, expect, len), "map with shortest integer and float encoding");
+
+    TEST_ASSERT(data_print_cbor(data, buf, 8) == 0, "overflow returns 0");
+    data_free(data);
+
+    data = data_make("x", "", DATA_DOUBLE, 0.1, NULL);
+    len  = data_print_cbor(data, buf, sizeof(buf));
+    TEST_ASSERT(len == 12 && buf[3] == 0xfb, "inexact double encoded as float64");
+    data_free(data);
+}
+
+static void test_round_trip(void)
+{
+    printf("\n=== Round trip ===\n");
+
+    data_t *data = make_nested();
+    uint8_t buf[2048];
+    size_t len = data_print_cbor(data, buf, sizeof(buf));
+    TEST_ASSERT(len > 0, "nested data encodes");
+
+    char json[4096];
+    size_t json_len = data_print_jsons(data, json, sizeof(json));
+    TEST_ASSERT(len < json_len, "CBOR is smaller than JSON");
+
+    size_t used;
+    data_t *back = data_parse_cbor(buf, len, &used);
+    TEST_ASSERT(back && used == len, "nested data decodes");
+    TEST_ASSERT(back && same_json(data, back), "decoded data matches");
+
+    TEST_ASSERT(!data_parse_cbor(buf, len - 1, &used) && used == 0, "truncated input is rejected");
+    uint8_t bad[] = {0xa1, 0x01, 0x01}; // integer key
+    TEST_ASSERT(!data_parse_cbor(bad, sizeof(bad), &used) && used == 0, "non-text key is rejected");
+    uint8_t keep_alive[] = {0xa0};
+    TEST_ASSERT(!data_parse_cbor(keep_alive, 1, &used) && used == 1, "empty map is skipped");
+
+    data_free(back);
+    data_free(data);
+}
+
+static void test_file_output(void)
+{
+    printf("\n=== File output ===\n");
+
+    FILE *file = tmpfile();
+    if (!file) {
+        TEST_ASSERT(0, "tmpfile");
+        return;
+    }
+
+    data_t *data = make_nested();
+    struct data_output *output = data_output_cbor_create(0, file);
+    for (int i = 0; i < 3; ++i)
+        data_output_print(output, data);
+    data_output_free(output);
+
+    uint8_t buf[8192];
+    rewind(file);
+    size_t len = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+
+    int items = 0, match = 1;
+    size_t pos = 0, used;
+    while (pos < len) {
+        data_t *back = data_parse_cbor(buf + pos, len - pos, &used);
+        if (!back)
+            break;
+        match &= same_json(data, back);
+        data_free(back);
+        pos += used;
+        items++;
+    }
+    TEST_ASSERT(items == 3 && pos == len, "file is a sequence of three items");
+    TEST_ASSERT(match, "file items match");
+
+    data_free(data);
+}
+
+int main(void)
+{
+    printf("CBOR Test\n");
+    printf("=========\n");
+
+    test_known_bytes();
+    test_round_trip();
+    test_file_output();
+
+    printf("\n=========\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
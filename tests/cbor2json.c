@@ -0,0 +1,115 @@
+/** @file
+    CBOR-to-JSON converter for the cbor event outputs.
+
+    Reads a CBOR sequence as written by "-F cbor", a HTTP "/stream?format=cbor"
+    capture, or the UDP "format=cbor" datagram records, and prints one JSON
+    object per line.
+
+    Usage: cbor2json [file.cbor]   (reads stdin if no file is given)
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "data.h"
+#include "data_cbor.h"
+
+#define JSON_BUF_SIZE 65536
+
+static uint8_t *read_all(FILE *fin, size_t *len)
+{
+    size_t size = 65536;
+    size_t used = 0;
+    uint8_t *buf = malloc(size);
+    if (!buf)
+        return NULL;
+
+    size_t n;
+    while ((n = fread(buf + used, 1, size - used, fin)) > 0) {
+        used += n;
+        if (used == size) {
+            uint8_t *grown = realloc(buf, size * 2);
+            if (!grown) {
+                free(buf);
+                return NULL;
+            }
+            buf = grown;
+            size *= 2;
+        }
+    }
+    *len = used;
+    return buf;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fin = stdin;
+    if (argc > 2 || (argc == 2 && !strcmp(argv[1], "-h"))) {
+        fprintf(stderr, "Usage: %s [file.cbor]\n", argv[0]);
+        return 1;
+    }
+    if (argc == 2 && strcmp(argv[1], "-")) {
+        fin = fopen(argv[1], "rb");
+        if (!fin) {
+            fprintf(stderr, "Error: cannot open input '%s'\n", argv[1]);
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    else {
+        _setmode(_fileno(stdin), _O_BINARY);
+    }
+#endif
+
+    size_t len = 0;
+    uint8_t *buf = read_all(fin, &len);
+    if (fin != stdin)
+        fclose(fin);
+    if (!buf) {
+        fprintf(stderr, "Error: out of memory\n");
+        return 1;
+    }
+
+    char *json = malloc(JSON_BUF_SIZE);
+    if (!json) {
+        fprintf(stderr, "Error: out of memory\n");
+        free(buf);
+        return 1;
+    }
+
+    int ret = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        size_t used;
+        data_t *data = data_parse_cbor(buf + pos, len - pos, &used);
+        if (!used) {
+            fprintf(stderr, "Error: invalid or truncated CBOR at offset %zu\n", pos);
+            ret = 1;
+            break;
+        }
+        pos += used;
+        if (!data)
+            continue; // keep-alive
+        data_print_jsons(data, json, JSON_BUF_SIZE);
+        printf("%s\n", json);
+        data_free(data);
+    }
+
+    free(json);
+    free(buf);
+    return ret;
+}
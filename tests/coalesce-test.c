@@ -0,0 +1,177 @@
+/** @file
+    Repeated transmission coalescing test.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "data.h"
+#include "coalesce.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+#define MAX_EMITTED 16
+
+static data_t *emitted[MAX_EMITTED];
+static int num_emitted;
+
+static void collect(void *ctx, data_t *data)
+{
+    (void)ctx;
+    if (num_emitted < MAX_EMITTED)
+        emitted[num_emitted++] = data;
+    else
+        data_free(data);
+}
+
+static void clear_emitted(void)
+{
+    for (int i = 0; i < num_emitted; ++i)
+        data_free(emitted[i]);
+    num_emitted = 0;
+}
+
+static data_t *make_event(int id, double temp, double rssi)
+{
+    /* clang-format off */
+    return data_make(
+            "model",            "",             DATA_STRING, "Acme-Temp",
+            "id",               "",             DATA_INT,    id,
+            "temperature_C",    "",             DATA_DOUBLE, temp,
+            "rssi",             "",             DATA_DOUBLE, rssi,
+            NULL);
+    /* clang-format on */
+}
+
+static data_t *find_field(data_t *data, char const *key)
+{
+    for (; data; data = data->next) {
+        if (!strcmp(data->key, key))
+            return data;
+    }
+    return NULL;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_burst(void)
+{
+    printf("\n=== Burst ===\n");
+
+    coalesce_t *co = coalesce_create(500, NULL);
+    if (!co) {
+        TEST_ASSERT(0, "coalesce created");
+        return;
+    }
+
+    TEST_ASSERT(coalesce_add(co, make_event(1, 20.5, -10.0), -1, 12.0f, 1000) == 0, "first copy starts a burst");
+    TEST_ASSERT(coalesce_add(co, make_event(1, 20.5, -12.0), -1, 18.0f, 1100) == 1, "repeat merged");
+    TEST_ASSERT(coalesce_add(co, make_event(2, 20.5, -10.0), -1, 9.0f, 1150) == 0, "other sensor starts a burst");
+    TEST_ASSERT(coalesce_add(co, make_event(1, 20.5, -11.0), -1, 15.0f, 1550) == 1, "gap within the window merged");
+
+    TEST_ASSERT(coalesce_flush(co, 1600, collect, NULL) == 0, "bursts held within the window");
+    TEST_ASSERT(coalesce_flush(co, 1700, collect, NULL) == 1, "completed burst emitted");
+
+    data_t *d = num_emitted ? emitted[0] : NULL;
+    data_t *id      = find_field(d, "id");
+    data_t *repeats = find_field(d, "repeats");
+    data_t *best    = find_field(d, "snr_best");
+    data_t *mean    = find_field(d, "snr_mean");
+    TEST_ASSERT(id && id->value.v_int == 2, "bursts emitted in order of completion");
+    TEST_ASSERT(repeats && repeats->value.v_int == 1, "single copy");
+    TEST_ASSERT(best && mean && best->value.v_dbl == 9.0 && mean->value.v_dbl == 9.0, "single copy SNR");
+    TEST_ASSERT(!find_field(d, "channels"), "no channels in narrowband");
+    clear_emitted();
+
+    TEST_ASSERT(coalesce_flush(co, 2100, collect, NULL) == 1, "last burst emitted");
+    d       = num_emitted ? emitted[0] : NULL;
+    repeats = find_field(d, "repeats");
+    best    = find_field(d, "snr_best");
+    mean    = find_field(d, "snr_mean");
+    data_t *rssi = find_field(d, "rssi");
+    TEST_ASSERT(repeats && repeats->value.v_int == 3, "repeat count");
+    TEST_ASSERT(best && best->value.v_dbl == 18.0, "best SNR");
+    TEST_ASSERT(mean && mean->value.v_dbl == 15.0, "mean SNR");
+    TEST_ASSERT(rssi && rssi->value.v_dbl == -10.0, "first copy kept");
+    clear_emitted();
+
+    uint64_t events, bursts;
+    coalesce_counts(co, &events, &bursts);
+    TEST_ASSERT(events == 4 && bursts == 2, "counts");
+    coalesce_free(co);
+}
+
+static void test_channels(void)
+{
+    printf("\n=== Wideband channels ===\n");
+
+    coalesce_t *co = coalesce_create(300, "model,id");
+    coalesce_add(co, make_event(7, 20.5, -10.0), 5, 10.0f, 1000);
+    coalesce_add(co, make_event(7, 20.6, -20.0), 4, 10.0f, 1002);
+    coalesce_add(co, make_event(7, 20.5, -10.0), 5, 10.0f, 1200);
+    coalesce_add(co, make_event(7, 20.5, -10.0), 5, 10.0f, 1600);
+
+    TEST_ASSERT(coalesce_flush(co, 1550, collect, NULL) == 1, "burst ended by the gap");
+    data_t *chans = find_field(num_emitted ? emitted[0] : NULL, "channels");
+    data_array_t *arr = chans && chans->type == DATA_ARRAY ? chans->value.v_ptr : NULL;
+    TEST_ASSERT(arr && arr->num_values == 2
+            && ((int *)arr->values)[0] == 4 && ((int *)arr->values)[1] == 5, "channels listed");
+    clear_emitted();
+
+    coalesce_add(co, make_event(8, 20.5, -10.0), 1, 10.0f, 1650);
+    TEST_ASSERT(coalesce_flush(co, UINT64_MAX, collect, NULL) == 2, "flush all");
+    data_t *first = find_field(num_emitted ? emitted[0] : NULL, "id");
+    TEST_ASSERT(first && first->value.v_int == 7, "flush all in order");
+    clear_emitted();
+
+    // a restarted sample clock is not a repeat
+    coalesce_add(co, make_event(7, 20.5, -10.0), 5, 10.0f, 90000);
+    TEST_ASSERT(coalesce_add(co, make_event(7, 20.5, -10.0), 5, 10.0f, 100) == 0, "clock restart starts a burst");
+    TEST_ASSERT(coalesce_flush(co, 200, collect, NULL) == 1, "old burst emitted after a clock restart");
+    clear_emitted();
+
+    coalesce_free(co);
+}
+
+int main(void)
+{
+    printf("Coalescing Test\n");
+    printf("===============\n");
+
+    test_burst();
+    test_channels();
+
+    printf("\n===============\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,444 @@
+/** @file
+    Decoder cost ranking.
+
+    Feeds a corpus of pulse packages to every decoder in isolation, through
+    the same pulse_slicer_* entry points run_ook_demods() and run_fsk_demods()
+    use, and ranks the decoders by their time per call. A package is matched
+    by one decoder at most and run past all others, so the ranking is by the
+    time spent on packages a decoder does not match.
+
+    Per decoder it reports:
+    - ns per call on packages it does not match, and on those it matches
+    - decode_fn runs per call, the slicer skips it for packages with no bits
+    - early exits: decode_fn runs ending in DECODE_ABORT_LENGTH or
+      DECODE_ABORT_EARLY, before any checksum or field work
+    - heap allocations per call, with GNU ld (malloc, calloc and realloc
+      wrapped at link time), for non-matching and matching packages
+
+    Usage: decoder-bench [-n reps] [-g packages] [-s sample_rate] [-t top] [FILE.ook...]
+
+    Without files a corpus of PWM, PPM, PCM and noise packages is generated,
+    which exercises the non-matching paths. Matches need real captures, write
+    them with `hydrasdr_433 -r FILE -w FILE.ook`.
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "r_device.h"
+#include "rtl_433_devices.h"
+#include "pulse_data.h"
+#include "pulse_slicer.h"
+#include "data.h"
+#include "metrics.h"
+#include "logger.h"
+
+#ifdef DECODER_BENCH_WRAP_ALLOC
+/* Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc */
+static unsigned long alloc_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    alloc_count++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    alloc_count++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    alloc_count++;
+    return __real_realloc(ptr, size);
+}
+#define ALLOC_COUNT() alloc_count
+#else
+#define ALLOC_COUNT() 0UL
+#endif
+
+/// Cost of one decoder over the corpus.
+typedef struct decoder_cost {
+    r_device *dev;
+    unsigned long miss_calls;   ///< Slicer calls without events
+    unsigned long match_calls;  ///< Slicer calls with events
+    uint64_t miss_ns;
+    uint64_t match_ns;
+    unsigned long miss_allocs;
+    unsigned long match_allocs;
+} decoder_cost_t;
+
+static void bench_output(r_device *decoder, data_t *data)
+{
+    (void)decoder;
+    data_free(data);
+}
+
+static void bench_log(r_device *decoder, int level, data_t *data)
+{
+    (void)decoder;
+    (void)level;
+    data_free(data);
+}
+
+/// Drop the slicer warnings, e.g. "sample rate too low", printed per call.
+static void quiet_log(log_level_t level, char const *src, char const *msg, void *userdata)
+{
+    (void)level;
+    (void)src;
+    (void)msg;
+    (void)userdata;
+}
+
+/// Run one decoder on a package through its slicer, as run_ook_demods() and run_fsk_demods() do.
+static int run_slicer(pulse_data_t const *pulses, r_device *dev)
+{
+    switch (dev->modulation) {
+    case OOK_PULSE_PCM:
+    case FSK_PULSE_PCM:
+        return pulse_slicer_pcm(pulses, dev);
+    case OOK_PULSE_PPM:
+        return pulse_slicer_ppm(pulses, dev);
+    case OOK_PULSE_PWM:
+    case FSK_PULSE_PWM:
+        return pulse_slicer_pwm(pulses, dev);
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        return pulse_slicer_manchester_zerobit(pulses, dev);
+    case OOK_PULSE_PIWM_RAW:
+        return pulse_slicer_piwm_raw(pulses, dev);
+    case OOK_PULSE_PIWM_DC:
+        return pulse_slicer_piwm_dc(pulses, dev);
+    case OOK_PULSE_DMC:
+        return pulse_slicer_dmc(pulses, dev);
+    case OOK_PULSE_PWM_OSV1:
+        return pulse_slicer_osv1(pulses, dev);
+    case OOK_PULSE_NRZS:
+        return pulse_slicer_nrzs(pulses, dev);
+    default:
+        return 0;
+    }
+}
+
+static char const *modulation_name(unsigned modulation)
+{
+    switch (modulation) {
+    case OOK_PULSE_PCM: return "OOK_PCM";
+    case OOK_PULSE_PPM: return "OOK_PPM";
+    case OOK_PULSE_PWM: return "OOK_PWM";
+    case OOK_PULSE_MANCHESTER_ZEROBIT: return "OOK_MC_ZEROBIT";
+    case OOK_PULSE_PIWM_RAW: return "OOK_PIWM_RAW";
+    case OOK_PULSE_PIWM_DC: return "OOK_PIWM_DC";
+    case OOK_PULSE_DMC: return "OOK_DMC";
+    case OOK_PULSE_PWM_OSV1: return "OOK_PWM_OSV1";
+    case OOK_PULSE_NRZS: return "OOK_NRZS";
+    case FSK_PULSE_PCM: return "FSK_PCM";
+    case FSK_PULSE_PWM: return "FSK_PWM";
+    case FSK_PULSE_MANCHESTER_ZEROBIT: return "FSK_MC_ZEROBIT";
+    default: return "?";
+    }
+}
+
+/* Corpus */
+
+static uint32_t rng_state = 0x2545f491;
+
+static uint32_t rng_next(void)
+{
+    // xorshift32, a fixed corpus for every run
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static int rng_range(int lo, int hi)
+{
+    return lo + (int)(rng_next() % (uint32_t)(hi - lo + 1));
+}
+
+static void add_pulse(pulse_data_t *p, double to_sample, int pulse_us, int gap_us)
+{
+    if (p->num_pulses >= PD_MAX_PULSES)
+        return;
+    p->pulse[p->num_pulses] = (int)(to_sample * pulse_us);
+    p->gap[p->num_pulses] = (int)(to_sample * gap_us);
+    p->num_pulses++;
+}
+
+/// Generate a package: kind 0 PWM, 1 PPM, 2 PCM, 3 noise.
+static void generate_package(pulse_data_t *p, int kind, uint32_t sample_rate)
+{
+    double to_sample = sample_rate / 1e6;
+    // FSK-like and OOK-like symbol widths, in us
+    int base = rng_next() & 1 ? rng_range(20, 150) : rng_range(150, 1000);
+    int bits = rng_range(16, 160);
+
+    pulse_data_clear(p);
+    p->sample_rate = sample_rate;
+    for (int i = 0; i < bits; i++) {
+        int bit = rng_next() & 1;
+        switch (kind) {
+        case 0:
+            add_pulse(p, to_sample, bit ? base : 3 * base, bit ? 3 * base : base);
+            break;
+        case 1:
+            add_pulse(p, to_sample, base, bit ? 4 * base : 2 * base);
+            break;
+        case 2:
+            add_pulse(p, to_sample, rng_range(1, 3) * base, rng_range(1, 3) * base);
+            break;
+        default:
+            add_pulse(p, to_sample, rng_range(20, 3000), rng_range(20, 3000));
+            break;
+        }
+    }
+    // End of package gap
+    if (p->num_pulses)
+        p->gap[p->num_pulses - 1] = (int)(to_sample * 20000);
+}
+
+static pulse_data_t *corpus_add(pulse_data_t **corpus, unsigned *len, unsigned *size)
+{
+    if (*len == *size) {
+        unsigned new_size = *size ? *size * 2 : 64;
+        pulse_data_t *grown = realloc(*corpus, new_size * sizeof(**corpus));
+        if (!grown) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        *corpus = grown;
+        *size = new_size;
+    }
+    return &(*corpus)[(*len)++];
+}
+
+static void load_ook_file(char const *path, uint32_t sample_rate, pulse_data_t **corpus, unsigned *len, unsigned *size)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        exit(1);
+    }
+    struct timeval now = {0};
+    for (;;) {
+        pulse_data_t *p = corpus_add(corpus, len, size);
+        pulse_data_load(file, &now, p, sample_rate);
+        if (!p->num_pulses) {
+            (*len)--;
+            break;
+        }
+    }
+    fclose(file);
+}
+
+/* Ranking */
+
+static double miss_ns_per_call(decoder_cost_t const *c)
+{
+    return c->miss_calls ? (double)c->miss_ns / c->miss_calls : 0.0;
+}
+
+static int compare_cost(void const *a, void const *b)
+{
+    double ca = miss_ns_per_call(a);
+    double cb = miss_ns_per_call(b);
+    return (ca < cb) - (ca > cb);
+}
+
+static void bench_decoder(decoder_cost_t *cost, pulse_data_t const *corpus, unsigned corpus_len, int reps)
+{
+    r_device *dev = cost->dev;
+
+    for (unsigned i = 0; i < corpus_len; i++) {
+        int events = 0;
+        unsigned long allocs = ALLOC_COUNT();
+        uint64_t start = metrics_time_ns();
+        for (int r = 0; r < reps; r++)
+            events += run_slicer(&corpus[i], dev);
+        uint64_t elapsed = metrics_time_ns() - start;
+        allocs = ALLOC_COUNT() - allocs;
+
+        if (events > 0) {
+            cost->match_calls += reps;
+            cost->match_ns += elapsed;
+            cost->match_allocs += allocs;
+        }
+        else {
+            cost->miss_calls += reps;
+            cost->miss_ns += elapsed;
+            cost->miss_allocs += allocs;
+        }
+    }
+}
+
+static void print_ranking(decoder_cost_t const *costs, unsigned count, unsigned top)
+{
+    printf("| Rank | Decoder | Modulation | miss ns/call | match ns/call | matches | decode_fn/call | early exit | allocs/miss | allocs/match |\n");
+    printf("|------|---------|------------|--------------|---------------|---------|----------------|------------|-------------|--------------|\n");
+    for (unsigned i = 0; i < count && i < top; i++) {
+        decoder_cost_t const *c = &costs[i];
+        r_device const *dev = c->dev;
+        unsigned long calls = c->miss_calls + c->match_calls;
+        unsigned early = dev->decode_fails[-DECODE_ABORT_LENGTH] + dev->decode_fails[-DECODE_ABORT_EARLY];
+        char match_ns[32] = "-";
+        char match_allocs[32] = "-";
+        char miss_allocs[32] = "-";
+        if (c->match_calls) {
+            snprintf(match_ns, sizeof(match_ns), "%.0f", (double)c->match_ns / c->match_calls);
+#ifdef DECODER_BENCH_WRAP_ALLOC
+            snprintf(match_allocs, sizeof(match_allocs), "%.2f", (double)c->match_allocs / c->match_calls);
+#endif
+        }
+#ifdef DECODER_BENCH_WRAP_ALLOC
+        if (c->miss_calls)
+            snprintf(miss_allocs, sizeof(miss_allocs), "%.2f", (double)c->miss_allocs / c->miss_calls);
+#endif
+        printf("| %u | [%u] %.48s%s | %s | %.0f | %s | %lu | %.2f | %.0f %% | %s | %s |\n",
+                i + 1, dev->protocol_num, dev->name, dev->disabled ? " (disabled)" : "",
+                modulation_name(dev->modulation), miss_ns_per_call(c), match_ns, c->match_calls,
+                calls ? (double)dev->decode_events / calls : 0.0,
+                dev->decode_events ? 100.0 * early / dev->decode_events : 0.0,
+                miss_allocs, match_allocs);
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: decoder-bench [-n reps] [-g packages] [-s sample_rate] [-t top] [FILE.ook...]\n"
+                    "  -n reps         calls per decoder and package (default 5)\n"
+                    "  -g packages     generated packages without files (default 128)\n"
+                    "  -s sample_rate  sample rate for the .ook timings (default 250000)\n"
+                    "  -t top          decoders listed (default all)\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int reps = 5;
+    unsigned generate = 128;
+    uint32_t sample_rate = 250000;
+    unsigned top = 0;
+    pulse_data_t *corpus = NULL;
+    unsigned corpus_len = 0, corpus_size = 0;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (i + 1 >= argc)
+            usage();
+        if (!strcmp(argv[i], "-n"))
+            reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-g"))
+            generate = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s"))
+            sample_rate = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-t"))
+            top = (unsigned)atoi(argv[++i]);
+        else
+            usage();
+    }
+    if (reps < 1 || sample_rate == 0)
+        usage();
+    r_logger_set_log_handler(quiet_log, NULL);
+
+    int from_files = i < argc;
+    for (; i < argc; i++)
+        load_ook_file(argv[i], sample_rate, &corpus, &corpus_len, &corpus_size);
+    if (!corpus_len) {
+        for (unsigned k = 0; k < generate; k++)
+            generate_package(corpus_add(&corpus, &corpus_len, &corpus_size), k % 4, sample_rate);
+    }
+    if (!corpus_len) {
+        fprintf(stderr, "No packages\n");
+        return 1;
+    }
+
+    r_device templates[] = {
+#define DECL(name) name,
+            DEVICES
+#undef DECL
+    };
+    unsigned num_devices = sizeof(templates) / sizeof(*templates);
+    decoder_cost_t *costs = calloc(num_devices, sizeof(*costs));
+    if (!costs) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    // Fresh instances, as register_protocol() creates them
+    unsigned count = 0;
+    for (unsigned k = 0; k < num_devices; k++) {
+        r_device *dev;
+        templates[k].protocol_num = k + 1;
+        if (templates[k].create_fn) {
+            dev = templates[k].create_fn(NULL);
+        }
+        else {
+            dev = malloc(sizeof(*dev));
+            if (dev)
+                *dev = templates[k];
+        }
+        if (!dev) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        dev->protocol_num = k + 1;
+        dev->verbose = 0;
+        dev->verbose_bits = 0;
+        dev->log_fn = bench_log;
+        dev->output_fn = bench_output;
+        costs[count++].dev = dev;
+    }
+
+    uint64_t start = metrics_time_ns();
+    for (unsigned k = 0; k < count; k++)
+        bench_decoder(&costs[k], corpus, corpus_len, reps);
+    double total_s = (metrics_time_ns() - start) / 1e9;
+
+    // Cost of one package nothing matches, over the decoders enabled by default
+    double ook_ns = 0.0, fsk_ns = 0.0;
+    for (unsigned k = 0; k < count; k++) {
+        if (costs[k].dev->disabled)
+            continue;
+        if (costs[k].dev->modulation >= FSK_DEMOD_MIN_VAL)
+            fsk_ns += miss_ns_per_call(&costs[k]);
+        else
+            ook_ns += miss_ns_per_call(&costs[k]);
+    }
+
+    qsort(costs, count, sizeof(*costs), compare_cost);
+
+    printf("%u decoders, %u packages (%s), %d calls each, %.1f s\n\n",
+            count, corpus_len, from_files ? "files" : "generated", reps, total_s);
+    print_ranking(costs, count, top ? top : count);
+    printf("\nNon-matching package, all default decoders: OOK %.1f us, FSK %.1f us\n", ook_ns / 1000.0, fsk_ns / 1000.0);
+#ifndef DECODER_BENCH_WRAP_ALLOC
+    printf("Allocation counts need GNU ld (--wrap), not available in this build\n");
+#endif
+
+    for (unsigned k = 0; k < count; k++) {
+        free(costs[k].dev->decode_ctx);
+        free(costs[k].dev);
+    }
+    free(costs);
+    free(corpus);
+    return 0;
+}
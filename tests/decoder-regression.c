@@ -0,0 +1,1324 @@
+/** @file
+    Decoder regression runner.
+
+    Replays the rtl_433_tests corpus through the decoders in-process and
+    compares the output with the expected JSON, reporting the decode time of
+    every file. The corpus is read into memory first, then the files are
+    decoded by worker threads, each file with fresh decoder instances, pulse
+    detector and filter state, as `hydrasdr_433 -r FILE -F json` would.
+
+    Every *.json found under the given directories is a test, with the input
+    of the same base name (.cu8, .ook, .cs16 or .cf32, in this order), using
+    the conventions of run_comparison.py:
+    - an "ignore" file in the directory skips its tests
+    - a "protocol" file holds the -R argument, e.g. "118", "-118" or
+      "118:arg", names of conf files are not supported and skipped
+    - the "time" field is not compared (-I adds fields)
+    - output lines with a model the expected output does not have are false
+      positives and dropped
+    - results: pass, extra (all expected lines plus duplicates), missing
+      (fewer lines, all correct), mismatch (field values differ), fail
+      (other line count differences) and no output
+
+    With -F each .cu8 input is also replayed converted to CF32, as
+    cu8_to_cf32 writes it, through the CF32 file input path.
+
+    Every replay registers fresh decoder instances, decoder state is kept
+    in the instance (decoder_create()) so replays do not see each other.
+
+    Usage: decoder-regression [-j threads] [-I field] [-F] [-t top] [-o times.csv] [-v] DIR|FILE.json...
+
+    Copyright (C) 2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "rtl_433.h"
+#include "r_device.h"
+#include "rtl_433_devices.h"
+#include "baseband.h"
+#include "pulse_detect.h"
+#include "pulse_data.h"
+#include "pulse_slicer.h"
+#include "fileformat.h"
+#include "optparse.h"
+#include "output_file.h"
+#include "data.h"
+#include "jsmn.h"
+#include "sdr.h"
+#include "list.h"
+#include "metrics.h"
+#include "logger.h"
+#ifdef THREADS
+#include "compat_pthread.h"
+#endif
+
+#define MAX_IGNORE_FIELDS 16
+#define MAX_LINE_LENGTH   65536
+
+enum result {
+    RESULT_PASS,
+    RESULT_EXTRA,
+    RESULT_MISSING,
+    RESULT_MISMATCH,
+    RESULT_FAIL,
+    RESULT_NO_OUTPUT,
+    RESULT_ERROR,
+    RESULT_MISSING_INPUT,
+    RESULT_SKIPPED,
+    RESULT_COUNT,
+};
+
+static char const *const result_names[RESULT_COUNT] = {
+        "pass",
+        "extra",
+        "missing",
+        "mismatch",
+        "fail",
+        "no output",
+        "error",
+        "no input",
+        "skipped",
+};
+
+/// A top-level field of a JSON line, pointing into the line text.
+typedef struct json_field {
+    char const *key;
+    int key_len;
+    char const *val;
+    int val_len;
+    jsmntype_t type;
+} json_field_t;
+
+/// One JSON line, without the ignored fields.
+typedef struct json_line {
+    char *text;
+    json_field_t *fields;
+    int num_fields;
+    json_field_t const *model; ///< The "model" field, if any
+} json_line_t;
+
+typedef struct json_lines {
+    json_line_t *lines;
+    unsigned len;
+    unsigned size;
+} json_lines_t;
+
+/// One replay of an input file.
+typedef struct regress_case {
+    char *name;                ///< Input path relative to the test directory
+    uint32_t format;           ///< CU8_IQ, CS8_IQ, CS16_IQ, CF32_IQ or PULSE_OOK
+    int as_cf32;               ///< Replay the CU8 input converted to CF32
+    int variant;               ///< Shares input and expected output with the previous case
+    uint32_t sample_rate;
+    uint32_t center_frequency;
+    uint8_t *iq;               ///< IQ input
+    size_t iq_len;
+    pulse_data_t *packages;    ///< OOK input
+    unsigned num_packages;
+    int protocol;              ///< -R override: only this decoder if > 0, all defaults but -protocol if < 0
+    char *protocol_arg;        ///< Decoder argument of the override
+    int no_decoders;           ///< -R 0
+    json_lines_t expected;
+    int result;
+    char detail[512];
+    unsigned lines;            ///< Output lines compared
+    unsigned false_positives;  ///< Output lines of other models, dropped
+    uint64_t samples;
+    uint64_t decode_ns;
+} regress_case_t;
+
+typedef struct runner {
+    regress_case_t *cases;
+    unsigned num_cases;
+    unsigned next_case;
+#ifdef THREADS
+    pthread_mutex_t lock;
+#endif
+    r_device *devices;
+    unsigned num_devices;
+    char const *ignore[MAX_IGNORE_FIELDS];
+    unsigned num_ignore;
+} runner_t;
+
+/// Decode state of a worker thread, reset for every file.
+typedef struct worker {
+    runner_t *runner;
+    FILE *out_file;            ///< Decoded events, as -F json writes them
+    data_output_t *json;
+    char *line_buf;
+    list_t r_devs;
+    int enable_FM_demod;
+    unsigned fpdm;
+    unsigned sample_size;
+    uint64_t input_pos;
+    pulse_detect_t *pulse_detect;
+    filter_state_t lowpass_filter_state;
+    demodfm_state_t demod_FM_state;
+    pulse_data_t pulse_data;
+    pulse_data_t fsk_pulse_data;
+    int16_t am_buf[DEFAULT_BUF_LENGTH / 2];
+    union {
+        // as in dm_state: FM demod overwrites the AM magnitudes after the low pass
+        int16_t fm[DEFAULT_BUF_LENGTH / 2];
+        uint16_t temp[DEFAULT_BUF_LENGTH / 2];
+    } buf;
+    uint8_t iq_buf[DEFAULT_BUF_LENGTH];
+} worker_t;
+
+static void regress_log(r_device *decoder, int level, data_t *data)
+{
+    (void)decoder;
+    (void)level;
+    data_free(data);
+}
+
+static void regress_output(r_device *decoder, data_t *data)
+{
+    worker_t *w = decoder->output_ctx;
+    data_output_print(w->json, data);
+    data_free(data);
+}
+
+/// Drop the pulse detector and slicer warnings.
+static void quiet_log(log_level_t level, char const *src, char const *msg, void *userdata)
+{
+    (void)level;
+    (void)src;
+    (void)msg;
+    (void)userdata;
+}
+
+static void *xmalloc(size_t size)
+{
+    void *p = malloc(size);
+    if (!p) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    return p;
+}
+
+static char *xstrndup(char const *s, size_t len)
+{
+    char *p = xmalloc(len + 1);
+    memcpy(p, s, len);
+    p[len] = '\0';
+    return p;
+}
+
+/* JSON lines */
+
+/// Index of the token after the value at @p i, with all its children.
+static int tok_skip(jsmntok_t const *tok, int i)
+{
+    int n = tok[i++].size;
+    while (n--)
+        i = tok_skip(tok, i);
+    return i;
+}
+
+/// Parse a JSON object line, taking ownership of @p text.
+static int json_line_parse(json_line_t *line, char *text, runner_t const *runner)
+{
+    size_t len = strlen(text);
+    jsmn_parser parser;
+
+    *line = (json_line_t){0};
+    line->text = text;
+
+    jsmn_init(&parser);
+    int num_toks = jsmn_parse(&parser, text, len, NULL, 0);
+    if (num_toks < 1)
+        return -1;
+    jsmntok_t *tok = xmalloc(num_toks * sizeof(*tok));
+    jsmn_init(&parser);
+    if (jsmn_parse(&parser, text, len, tok, num_toks) != num_toks || tok[0].type != JSMN_OBJECT) {
+        free(tok);
+        return -1;
+    }
+
+    line->fields = xmalloc((tok[0].size + 1) * sizeof(*line->fields));
+    int i = 1;
+    for (int k = 0; k < tok[0].size; k++) {
+        jsmntok_t const *key = &tok[i];
+        jsmntok_t const *val = &tok[i + 1];
+        i = tok_skip(tok, i + 1);
+
+        int key_len = key->end - key->start;
+        int ignored = 0;
+        for (unsigned f = 0; f < runner->num_ignore; f++) {
+            if ((int)strlen(runner->ignore[f]) == key_len && !memcmp(runner->ignore[f], text + key->start, key_len))
+                ignored = 1;
+        }
+        if (ignored)
+            continue;
+
+        json_field_t *field = &line->fields[line->num_fields++];
+        field->key     = text + key->start;
+        field->key_len = key_len;
+        field->val     = text + val->start;
+        field->val_len = val->end - val->start;
+        field->type    = val->type;
+        if (key_len == 5 && !memcmp(field->key, "model", 5))
+            line->model = field;
+    }
+    free(tok);
+    return 0;
+}
+
+static void json_lines_push(json_lines_t *lines, json_line_t const *line)
+{
+    if (lines->len == lines->size) {
+        unsigned size = lines->size ? lines->size * 2 : 8;
+        json_line_t *grown = realloc(lines->lines, size * sizeof(*grown));
+        if (!grown) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        lines->lines = grown;
+        lines->size  = size;
+    }
+    lines->lines[lines->len++] = *line;
+}
+
+static void json_lines_free(json_lines_t *lines)
+{
+    for (unsigned i = 0; i < lines->len; i++) {
+        free(lines->lines[i].text);
+        free(lines->lines[i].fields);
+    }
+    free(lines->lines);
+    *lines = (json_lines_t){0};
+}
+
+static int is_blank(char const *s)
+{
+    for (; *s; s++) {
+        if (!isspace((unsigned char)*s))
+            return 0;
+    }
+    return 1;
+}
+
+/// Compare compound values with the whitespace outside of strings removed.
+static int compound_equal(char const *a, int a_len, char const *b, int b_len)
+{
+    int i = 0, j = 0, in_a = 0, in_b = 0;
+    for (;;) {
+        while (i < a_len && !in_a && isspace((unsigned char)a[i]))
+            i++;
+        while (j < b_len && !in_b && isspace((unsigned char)b[j]))
+            j++;
+        if (i == a_len || j == b_len)
+            return i == a_len && j == b_len;
+        if (a[i] != b[j])
+            return 0;
+        if (a[i] == '"' && (i == 0 || a[i - 1] != '\\'))
+            in_a = !in_a;
+        if (b[j] == '"' && (j == 0 || b[j - 1] != '\\'))
+            in_b = !in_b;
+        i++;
+        j++;
+    }
+}
+
+static int value_equal(json_field_t const *a, json_field_t const *b)
+{
+    if (a->type != b->type)
+        return 0;
+    if (a->type == JSMN_PRIMITIVE) {
+        // numbers by value, 1 is 1.0 as in run_comparison.py
+        char *end_a, *end_b;
+        double da = strtod(a->val, &end_a);
+        double db = strtod(b->val, &end_b);
+        if (end_a == a->val + a->val_len && end_b == b->val + b->val_len)
+            return da == db;
+    }
+    if (a->type == JSMN_OBJECT || a->type == JSMN_ARRAY)
+        return compound_equal(a->val, a->val_len, b->val, b->val_len);
+    return a->val_len == b->val_len && !memcmp(a->val, b->val, a->val_len);
+}
+
+static json_field_t const *find_field(json_line_t const *line, json_field_t const *key)
+{
+    for (int i = 0; i < line->num_fields; i++) {
+        json_field_t const *f = &line->fields[i];
+        if (f->key_len == key->key_len && !memcmp(f->key, key->key, key->key_len))
+            return f;
+    }
+    return NULL;
+}
+
+static int line_equal(json_line_t const *a, json_line_t const *b)
+{
+    if (a->num_fields != b->num_fields)
+        return 0;
+    for (int i = 0; i < a->num_fields; i++) {
+        json_field_t const *f = find_field(b, &a->fields[i]);
+        if (!f || !value_equal(&a->fields[i], f))
+            return 0;
+    }
+    return 1;
+}
+
+/// Every line of @p sub equals a distinct line of @p all.
+static int lines_contained(json_lines_t const *sub, json_lines_t const *all)
+{
+    unsigned char *used = calloc(all->len + 1, 1);
+    if (!used) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    int found_all = 1;
+    for (unsigned i = 0; i < sub->len && found_all; i++) {
+        found_all = 0;
+        for (unsigned j = 0; j < all->len; j++) {
+            if (!used[j] && line_equal(&sub->lines[i], &all->lines[j])) {
+                used[j] = 1;
+                found_all = 1;
+                break;
+            }
+        }
+    }
+    free(used);
+    return found_all;
+}
+
+static void detail_cat(char *detail, size_t size, char const *fmt, ...)
+#if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format(printf, 3, 4)))
+#endif
+        ;
+
+static void detail_cat(char *detail, size_t size, char const *fmt, ...)
+{
+    size_t len = strlen(detail);
+    if (len + 1 >= size)
+        return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(detail + len, size - len, fmt, ap);
+    va_end(ap);
+}
+
+/// Field differences of the first differing lines, as run_comparison.py lists them.
+static void describe_mismatch(regress_case_t *c, json_lines_t const *actual)
+{
+    unsigned shown = 0;
+    for (unsigned i = 0; i < actual->len && shown < 3; i++) {
+        json_line_t const *exp = &c->expected.lines[i];
+        json_line_t const *act = &actual->lines[i];
+        if (line_equal(exp, act))
+            continue;
+        detail_cat(c->detail, sizeof(c->detail), "%sLine %u:", shown ? "; " : "", i + 1);
+        for (int k = 0; k < exp->num_fields; k++) {
+            json_field_t const *e = &exp->fields[k];
+            json_field_t const *a = find_field(act, e);
+            if (!a)
+                detail_cat(c->detail, sizeof(c->detail), " -%.*s=%.*s", e->key_len, e->key, e->val_len, e->val);
+            else if (!value_equal(e, a))
+                detail_cat(c->detail, sizeof(c->detail), " %.*s: %.*s -> %.*s", e->key_len, e->key,
+                        e->val_len, e->val, a->val_len, a->val);
+        }
+        for (int k = 0; k < act->num_fields; k++) {
+            json_field_t const *a = &act->fields[k];
+            if (!find_field(exp, a))
+                detail_cat(c->detail, sizeof(c->detail), " +%.*s=%.*s", a->key_len, a->key, a->val_len, a->val);
+        }
+        shown++;
+    }
+}
+
+static void compare_output(regress_case_t *c, json_lines_t const *actual)
+{
+    json_lines_t const *expected = &c->expected;
+
+    c->lines = actual->len;
+    if (!actual->len && expected->len) {
+        c->result = RESULT_NO_OUTPUT;
+        snprintf(c->detail, sizeof(c->detail), "No matching output (%u false positive(s))", c->false_positives);
+        return;
+    }
+    if (actual->len == expected->len) {
+        c->result = RESULT_PASS;
+        for (unsigned i = 0; i < actual->len; i++) {
+            if (!line_equal(&expected->lines[i], &actual->lines[i]))
+                c->result = RESULT_MISMATCH;
+        }
+        if (c->result == RESULT_MISMATCH)
+            describe_mismatch(c, actual);
+        return;
+    }
+    if (actual->len > expected->len && lines_contained(expected, actual)) {
+        c->result = RESULT_EXTRA;
+        snprintf(c->detail, sizeof(c->detail), "+%u extra decode(s) (expected %u, got %u)",
+                actual->len - expected->len, expected->len, actual->len);
+        return;
+    }
+    if (actual->len < expected->len && lines_contained(actual, expected)) {
+        c->result = RESULT_MISSING;
+        snprintf(c->detail, sizeof(c->detail), "-%u missing decode(s) (expected %u, got %u)",
+                expected->len - actual->len, expected->len, actual->len);
+        return;
+    }
+    c->result = RESULT_FAIL;
+    snprintf(c->detail, sizeof(c->detail), "Line count: expected %u, got %u", expected->len, actual->len);
+}
+
+static int expected_model(json_lines_t const *expected, json_field_t const *model)
+{
+    for (unsigned i = 0; i < expected->len; i++) {
+        json_field_t const *m = expected->lines[i].model;
+        if (m && value_equal(m, model))
+            return 1;
+    }
+    return 0;
+}
+
+/// Read the lines the decoders wrote since @p start, dropping false positives.
+static void collect_output(worker_t *w, regress_case_t *c, long start, json_lines_t *actual)
+{
+    fflush(w->out_file);
+    fseek(w->out_file, start, SEEK_SET);
+    while (fgets(w->line_buf, MAX_LINE_LENGTH, w->out_file)) {
+        if (is_blank(w->line_buf))
+            continue;
+        json_line_t line;
+        if (json_line_parse(&line, xstrndup(w->line_buf, strlen(w->line_buf)), w->runner) < 0) {
+            free(line.text);
+            continue;
+        }
+        if (line.model && c->expected.len && !expected_model(&c->expected, line.model)) {
+            c->false_positives++;
+            free(line.text);
+            free(line.fields);
+            continue;
+        }
+        json_lines_push(actual, &line);
+    }
+    fseek(w->out_file, 0, SEEK_END);
+}
+
+/* Decoding */
+
+/// Fresh decoder instances, as register_protocol() creates them.
+static void register_decoders(worker_t *w, regress_case_t const *c)
+{
+    runner_t const *runner = w->runner;
+
+    w->enable_FM_demod = 0;
+    for (unsigned i = 0; i < runner->num_devices && !c->no_decoders; i++) {
+        r_device *r_dev = &runner->devices[i];
+        char *arg = NULL;
+        if (c->protocol > 0) {
+            if ((unsigned)c->protocol != i + 1)
+                continue;
+            arg = c->protocol_arg;
+        }
+        else if (r_dev->disabled || (unsigned)-c->protocol == i + 1) {
+            continue;
+        }
+
+        r_device *p;
+        if (r_dev->create_fn) {
+            p = r_dev->create_fn(arg);
+        }
+        else {
+            p = malloc(sizeof(*p));
+            if (p)
+                *p = *r_dev; // copy
+        }
+        if (!p) {
+            fprintf(stderr, "Failed to create decoder [%u] \"%s\"\n", r_dev->protocol_num, r_dev->name);
+            exit(1);
+        }
+        p->verbose      = 0;
+        p->verbose_bits = 0;
+        p->log_fn       = regress_log;
+        p->output_fn    = regress_output;
+        p->output_ctx   = w;
+        list_push(&w->r_devs, p);
+
+        if (p->modulation >= FSK_DEMOD_MIN_VAL)
+            w->enable_FM_demod = 1;
+    }
+}
+
+/// Run one decoder on a package through its slicer, if it takes the package type.
+static int run_slicer(pulse_data_t *pulses, r_device *r_dev, int fsk)
+{
+    if (fsk != (r_dev->modulation >= FSK_DEMOD_MIN_VAL))
+        return 0;
+    switch (r_dev->modulation) {
+    case OOK_PULSE_PCM:
+    case FSK_PULSE_PCM:
+        return pulse_slicer_pcm(pulses, r_dev);
+    case OOK_PULSE_PPM:
+        return pulse_slicer_ppm(pulses, r_dev);
+    case OOK_PULSE_PWM:
+    case FSK_PULSE_PWM:
+        return pulse_slicer_pwm(pulses, r_dev);
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        return pulse_slicer_manchester_zerobit(pulses, r_dev);
+    case OOK_PULSE_PIWM_RAW:
+        return pulse_slicer_piwm_raw(pulses, r_dev);
+    case OOK_PULSE_PIWM_DC:
+        return pulse_slicer_piwm_dc(pulses, r_dev);
+    case OOK_PULSE_DMC:
+        return pulse_slicer_dmc(pulses, r_dev);
+    case OOK_PULSE_PWM_OSV1:
+        return pulse_slicer_osv1(pulses, r_dev);
+    case OOK_PULSE_NRZS:
+        return pulse_slicer_nrzs(pulses, r_dev);
+    default:
+        return 0;
+    }
+}
+
+/// Run the decoders on a package in priority order, as run_ook_demods() and run_fsk_demods() do.
+static void run_demods(list_t *r_devs, pulse_data_t *pulses, int fsk)
+{
+    int p_events = 0;
+    unsigned next_priority = 0; // next smallest on each loop through decoders
+    // run all decoders of each priority, stop if an event is produced
+    for (unsigned priority = 0; !p_events && priority < UINT_MAX; priority = next_priority) {
+        next_priority = UINT_MAX;
+        for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+            r_device *r_dev = *iter;
+            if (r_dev->priority > priority && r_dev->priority < next_priority)
+                next_priority = r_dev->priority;
+            if (r_dev->priority == priority)
+                p_events += run_slicer(pulses, r_dev, fsk);
+        }
+    }
+}
+
+static void free_decoder(void *p)
+{
+    r_device *r_dev = p;
+    free(r_dev->decode_ctx);
+    free(r_dev);
+}
+
+/// Decode one buffer, the non-wideband path of sdr_callback().
+static void process_block(worker_t *w, regress_case_t const *c, uint8_t const *iq_buf, unsigned long len)
+{
+    unsigned long n_samples = len / w->sample_size;
+    if (!n_samples)
+        return;
+
+    if (w->sample_size == SDR_SAMPLE_SIZE_CU8)
+        envelope_detect(iq_buf, w->buf.temp, n_samples);
+    else
+        magnitude_est_cs16((int16_t const *)iq_buf, w->buf.temp, n_samples);
+
+    baseband_low_pass_filter(&w->lowpass_filter_state, w->buf.temp, w->am_buf, n_samples);
+
+    if (w->enable_FM_demod) {
+        float low_pass = w->fpdm ? 0.2f : 0.1f;
+        if (w->sample_size == SDR_SAMPLE_SIZE_CU8)
+            baseband_demod_FM(&w->demod_FM_state, iq_buf, w->buf.fm, n_samples, c->sample_rate, low_pass);
+        else
+            baseband_demod_FM_cs16(&w->demod_FM_state, (int16_t const *)iq_buf, w->buf.fm, n_samples, c->sample_rate, low_pass);
+    }
+
+    int package_type = PULSE_DATA_OOK; // Just to get us started
+    while (package_type) {
+        package_type = pulse_detect_package(w->pulse_detect, w->am_buf, w->buf.fm, n_samples, c->sample_rate,
+                w->input_pos, &w->pulse_data, &w->fsk_pulse_data, w->fpdm);
+        if (package_type == PULSE_DATA_OOK)
+            run_demods(&w->r_devs, &w->pulse_data, 0);
+        else if (package_type == PULSE_DATA_FSK)
+            run_demods(&w->r_devs, &w->fsk_pulse_data, 1);
+    }
+    w->input_pos += n_samples;
+}
+
+/// Next input buffer, converted as the file input loop in main() does.
+static unsigned long read_block(worker_t *w, regress_case_t const *c, size_t *pos, uint8_t const **block)
+{
+    size_t left = c->iq_len - *pos;
+    uint8_t const *src = c->iq + *pos;
+    int16_t *cs16 = (int16_t *)w->iq_buf;
+    unsigned long n;
+
+    if (c->as_cf32) {
+        // cu8_to_cf32, then the CF32 to CS16 conversion of main()
+        n = left < DEFAULT_BUF_LENGTH / 2 ? left : DEFAULT_BUF_LENGTH / 2;
+        for (unsigned long i = 0; i < n; i++) {
+            float f   = ((float)src[i] - 127.4f) / 127.4f;
+            int s_tmp = f * INT16_MAX;
+            cs16[i]   = s_tmp < -INT16_MAX ? -INT16_MAX : s_tmp > INT16_MAX ? INT16_MAX : s_tmp;
+        }
+        *pos += n;
+        *block = w->iq_buf;
+        return n * 2;
+    }
+    if (c->format == CF32_IQ) {
+        n = left / sizeof(float) < DEFAULT_BUF_LENGTH / 2 ? left / sizeof(float) : DEFAULT_BUF_LENGTH / 2;
+        for (unsigned long i = 0; i < n; i++) {
+            float f;
+            memcpy(&f, src + i * sizeof(float), sizeof(f));
+            int s_tmp = f * INT16_MAX;
+            cs16[i]   = s_tmp < -INT16_MAX ? -INT16_MAX : s_tmp > INT16_MAX ? INT16_MAX : s_tmp;
+        }
+        *pos += n * sizeof(float);
+        if (!n)
+            *pos = c->iq_len; // trailing partial float
+        *block = w->iq_buf;
+        return n * 2;
+    }
+
+    n = left < DEFAULT_BUF_LENGTH ? left : DEFAULT_BUF_LENGTH;
+    *pos += n;
+    if (c->format == CS8_IQ) {
+        for (unsigned long i = 0; i < n; i++)
+            w->iq_buf[i] = (uint8_t)(((int8_t)src[i]) + 128);
+        *block = w->iq_buf;
+    }
+    else {
+        *block = src; // CU8 and CS16 are decoded in place
+    }
+    return n;
+}
+
+static void replay_iq(worker_t *w, regress_case_t *c)
+{
+    int cu8 = (c->format == CU8_IQ || c->format == CS8_IQ) && !c->as_cf32;
+    w->sample_size = cu8 ? SDR_SAMPLE_SIZE_CU8 : SDR_SAMPLE_SIZE_CS16;
+
+    // CS16 and CF32 use magnitude estimation, as main() forces it
+    pulse_detect_set_levels(w->pulse_detect, !cu8, 0.0f, -12.1442f, 9.0f, LOG_WARNING);
+
+    size_t pos = 0;
+    while (pos < c->iq_len) {
+        uint8_t const *block;
+        unsigned long len = read_block(w, c, &pos, &block);
+        if (len)
+            process_block(w, c, block, len);
+    }
+    c->samples = w->input_pos;
+
+    // a last buffer of silence to ensure EOP detection
+    memset(w->iq_buf, cu8 ? 128 : 0, DEFAULT_BUF_LENGTH);
+    process_block(w, c, w->iq_buf, DEFAULT_BUF_LENGTH);
+}
+
+static void replay_ook(worker_t *w, regress_case_t *c)
+{
+    for (unsigned i = 0; i < c->num_packages; i++) {
+        pulse_data_t *p = &c->packages[i];
+        run_demods(&w->r_devs, p, p->fsk_f2_est != 0);
+    }
+}
+
+static void run_case(worker_t *w, regress_case_t *c)
+{
+    json_lines_t actual = {0};
+
+    register_decoders(w, c);
+    w->pulse_detect = pulse_detect_create();
+    if (!w->pulse_detect) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    w->lowpass_filter_state = (filter_state_t){0};
+    w->demod_FM_state       = (demodfm_state_t){0};
+    pulse_data_clear(&w->pulse_data);
+    pulse_data_clear(&w->fsk_pulse_data);
+    w->input_pos = 0;
+    // FSK_PULSE_DETECT_AUTO
+    w->fpdm = c->center_frequency > FSK_PULSE_DETECTOR_LIMIT ? FSK_PULSE_DETECT_NEW : FSK_PULSE_DETECT_OLD;
+
+    fseek(w->out_file, 0, SEEK_END);
+    long out_start = ftell(w->out_file);
+
+    uint64_t start = metrics_time_ns();
+    if (c->format == PULSE_OOK)
+        replay_ook(w, c);
+    else
+        replay_iq(w, c);
+    c->decode_ns = metrics_time_ns() - start;
+
+    list_clear(&w->r_devs, free_decoder);
+    pulse_detect_free(w->pulse_detect);
+    w->pulse_detect = NULL;
+
+    collect_output(w, c, out_start, &actual);
+    compare_output(c, &actual);
+    json_lines_free(&actual);
+}
+
+static regress_case_t *next_case(runner_t *runner)
+{
+    regress_case_t *c = NULL;
+#ifdef THREADS
+    pthread_mutex_lock(&runner->lock);
+#endif
+    while (!c && runner->next_case < runner->num_cases) {
+        c = &runner->cases[runner->next_case++];
+        if (c->result != RESULT_PASS)
+            c = NULL; // settled while loading
+    }
+#ifdef THREADS
+    pthread_mutex_unlock(&runner->lock);
+#endif
+    return c;
+}
+
+static void worker_run(worker_t *w)
+{
+    regress_case_t *c;
+    while ((c = next_case(w->runner)))
+        run_case(w, c);
+}
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL worker_thread(void *arg)
+{
+    worker_run(arg);
+    return (THREAD_RETURN)0;
+}
+#endif
+
+/* Corpus */
+
+static int compare_str(void const *a, void const *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static void find_json(char const *dir, list_t *found)
+{
+    DIR *d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "Failed to open %s\n", dir);
+        exit(1);
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d))) {
+        if (entry->d_name[0] == '.')
+            continue;
+        size_t len = strlen(dir) + strlen(entry->d_name) + 2;
+        char *path = xmalloc(len);
+        snprintf(path, len, "%s/%s", dir, entry->d_name);
+        struct stat st;
+        if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+            find_json(path, found);
+            free(path);
+        }
+        else if (strlen(path) > 5 && !strcmp(path + strlen(path) - 5, ".json")) {
+            list_push(found, path);
+        }
+        else {
+            free(path);
+        }
+    }
+    closedir(d);
+}
+
+static char *read_file(char const *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return NULL;
+    }
+    char *buf = xmalloc((size_t)size + 1);
+    *len = fread(buf, 1, (size_t)size, file);
+    buf[*len] = '\0';
+    fclose(file);
+    return buf;
+}
+
+static int file_exists(char const *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+static int load_expected(regress_case_t *c, char const *json_path, runner_t const *runner)
+{
+    size_t len;
+    char *text = read_file(json_path, &len);
+    if (!text)
+        return -1;
+    for (char *line = text; line && *line;) {
+        char *eol = strchr(line, '\n');
+        size_t line_len = eol ? (size_t)(eol - line) : strlen(line);
+        char *copy = xstrndup(line, line_len);
+        line = eol ? eol + 1 : NULL;
+        if (is_blank(copy)) {
+            free(copy);
+            continue;
+        }
+        json_line_t parsed;
+        if (json_line_parse(&parsed, copy, runner) < 0) {
+            free(copy);
+            free(parsed.fields);
+            free(text);
+            return -1;
+        }
+        json_lines_push(&c->expected, &parsed);
+    }
+    free(text);
+    return 0;
+}
+
+static void load_ook(regress_case_t *c, char const *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return;
+    struct timeval now = {0};
+    unsigned size = 0;
+    for (;;) {
+        if (c->num_packages == size) {
+            size = size ? size * 2 : 8;
+            pulse_data_t *grown = realloc(c->packages, size * sizeof(*grown));
+            if (!grown) {
+                fprintf(stderr, "out of memory\n");
+                exit(1);
+            }
+            c->packages = grown;
+        }
+        pulse_data_t *p = &c->packages[c->num_packages];
+        pulse_data_load(file, &now, p, c->sample_rate);
+        if (!p->num_pulses)
+            break;
+        c->num_packages++;
+    }
+    fclose(file);
+}
+
+/// Read the "protocol" file of a test directory, as the -R option.
+static void load_protocol(regress_case_t *c, char const *dir, runner_t const *runner)
+{
+    size_t len = strlen(dir) + 10;
+    char *path = xmalloc(len);
+    snprintf(path, len, "%s/protocol", dir);
+    char *text = read_file(path, &len);
+    free(path);
+    if (!text)
+        return;
+
+    char *eol = strpbrk(text, "\r\n");
+    if (eol)
+        *eol = '\0';
+    char *end;
+    long n = strtol(text, &end, 10);
+    if (end == text || (*end && *end != ':' && *end != ',')) {
+        c->result = RESULT_SKIPPED;
+        snprintf(c->detail, sizeof(c->detail), "Protocol \"%s\" needs a conf file", text);
+    }
+    else if (n > (long)runner->num_devices || -n > (long)runner->num_devices
+            || (n && runner->devices[labs(n) - 1].disabled > 2)) {
+        c->result = RESULT_ERROR;
+        snprintf(c->detail, sizeof(c->detail), "Protocol number %ld is invalid", n);
+    }
+    else {
+        c->protocol    = (int)n;
+        c->no_decoders = n == 0;
+        char *arg      = arg_param(text);
+        if (arg)
+            c->protocol_arg = xstrndup(arg, strlen(arg));
+    }
+    free(text);
+}
+
+static regress_case_t *add_case(regress_case_t **cases, unsigned *len, unsigned *size)
+{
+    if (*len == *size) {
+        unsigned new_size = *size ? *size * 2 : 64;
+        regress_case_t *grown = realloc(*cases, new_size * sizeof(**cases));
+        if (!grown) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+        *cases = grown;
+        *size  = new_size;
+    }
+    regress_case_t *c = &(*cases)[(*len)++];
+    *c = (regress_case_t){0};
+    return c;
+}
+
+/// Set up the test of one expected output file, reading its input into memory.
+static void load_case(runner_t *runner, char const *json_path, char const *root, int with_cf32, unsigned *size)
+{
+    static char const *const exts[] = {".cu8", ".ook", ".cs16", ".cf32"};
+    size_t base_len = strlen(json_path) - 5;
+    size_t root_len = strlen(root);
+    char *input = xmalloc(base_len + 6);
+    char *dir   = xstrndup(json_path, base_len);
+    char *slash = strrchr(dir, '/');
+    if (slash)
+        *slash = '\0';
+    else
+        strcpy(dir, ".");
+
+    int found = 0;
+    for (unsigned i = 0; i < sizeof(exts) / sizeof(*exts) && !found; i++) {
+        memcpy(input, json_path, base_len);
+        strcpy(input + base_len, exts[i]);
+        found = file_exists(input);
+    }
+    if (!found)
+        strcpy(input + base_len, ".json");
+
+    size_t ignore_len = strlen(dir) + 8;
+    char *ignore = xmalloc(ignore_len);
+    snprintf(ignore, ignore_len, "%s/ignore", dir);
+    int ignored = file_exists(ignore);
+    free(ignore);
+    if (ignored) {
+        free(input);
+        free(dir);
+        return;
+    }
+
+    regress_case_t *c = add_case(&runner->cases, &runner->num_cases, size);
+    char const *rel   = input;
+    if (!strncmp(input, root, root_len) && input[root_len] == '/')
+        rel = input + root_len + 1;
+    c->name = xstrndup(rel, strlen(rel));
+
+    file_info_t info = {0};
+    file_info_parse_filename(&info, input);
+    c->format           = info.format;
+    c->sample_rate      = info.sample_rate ? info.sample_rate : DEFAULT_SAMPLE_RATE;
+    c->center_frequency = info.center_frequency ? info.center_frequency : DEFAULT_FREQUENCY;
+
+    if (!found) {
+        c->result = RESULT_MISSING_INPUT;
+        snprintf(c->detail, sizeof(c->detail), "No input file");
+    }
+    else if (c->format != CU8_IQ && c->format != CS8_IQ && c->format != CS16_IQ
+            && c->format != CF32_IQ && c->format != PULSE_OOK) {
+        c->result = RESULT_SKIPPED;
+        snprintf(c->detail, sizeof(c->detail), "Input format \"%s\" not supported", file_info_string(&info));
+    }
+    else if (load_expected(c, json_path, runner) < 0) {
+        c->result = RESULT_ERROR;
+        snprintf(c->detail, sizeof(c->detail), "Invalid reference JSON");
+    }
+    else {
+        load_protocol(c, dir, runner);
+    }
+
+    if (c->result == RESULT_PASS) {
+        if (c->format == PULSE_OOK) {
+            load_ook(c, input);
+        }
+        else {
+            c->iq = (uint8_t *)read_file(input, &c->iq_len);
+            if (!c->iq) {
+                c->result = RESULT_ERROR;
+                snprintf(c->detail, sizeof(c->detail), "Failed to read input");
+            }
+        }
+    }
+
+    if (with_cf32 && c->format == CU8_IQ && c->result == RESULT_PASS) {
+        unsigned cu8 = runner->num_cases - 1;
+        c  = add_case(&runner->cases, &runner->num_cases, size);
+        *c = runner->cases[cu8];
+        size_t name_len = strlen(c->name) + 8;
+        c->name = xmalloc(name_len);
+        snprintf(c->name, name_len, "%s (cf32)", runner->cases[cu8].name);
+        c->as_cf32 = 1;
+        c->variant = 1;
+    }
+
+    free(input);
+    free(dir);
+}
+
+/* Report */
+
+static double signal_seconds(regress_case_t const *c)
+{
+    return c->sample_rate ? (double)c->samples / c->sample_rate : 0.0;
+}
+
+static int compare_time(void const *a, void const *b)
+{
+    regress_case_t const *ca = *(regress_case_t *const *)a;
+    regress_case_t const *cb = *(regress_case_t *const *)b;
+    return (ca->decode_ns < cb->decode_ns) - (ca->decode_ns > cb->decode_ns);
+}
+
+static char const *format_name(regress_case_t const *c)
+{
+    if (c->as_cf32)
+        return "cf32";
+    switch (c->format) {
+    case CU8_IQ: return "cu8";
+    case CS8_IQ: return "cs8";
+    case CS16_IQ: return "cs16";
+    case CF32_IQ: return "cf32";
+    case PULSE_OOK: return "ook";
+    default: return "?";
+    }
+}
+
+static int was_run(regress_case_t const *c)
+{
+    return c->result < RESULT_ERROR;
+}
+
+static void print_slowest(runner_t const *runner, unsigned top)
+{
+    regress_case_t **order = xmalloc((runner->num_cases + 1) * sizeof(*order));
+    unsigned count = 0;
+    for (unsigned i = 0; i < runner->num_cases; i++) {
+        if (was_run(&runner->cases[i]))
+            order[count++] = &runner->cases[i];
+    }
+    qsort(order, count, sizeof(*order), compare_time);
+
+    printf("\n| Decode ms | Signal s | x realtime | Result | File |\n");
+    printf("|-----------|----------|------------|--------|------|\n");
+    for (unsigned i = 0; i < count && i < top; i++) {
+        regress_case_t const *c = order[i];
+        double decode_s = c->decode_ns / 1e9;
+        char speed[32] = "-";
+        if (c->samples && decode_s > 0.0)
+            snprintf(speed, sizeof(speed), "%.0f", signal_seconds(c) / decode_s);
+        printf("| %.2f | %.2f | %s | %s | %s |\n", c->decode_ns / 1e6, signal_seconds(c), speed,
+                result_names[c->result], c->name);
+    }
+    free(order);
+}
+
+static void write_times(runner_t const *runner, char const *path)
+{
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        exit(1);
+    }
+    fprintf(file, "file,format,result,lines,false_positives,signal_s,decode_ms\n");
+    for (unsigned i = 0; i < runner->num_cases; i++) {
+        regress_case_t const *c = &runner->cases[i];
+        fprintf(file, "\"%s\",%s,%s,%u,%u,%.3f,%.3f\n", c->name, format_name(c), result_names[c->result],
+                c->lines, c->false_positives, signal_seconds(c), c->decode_ns / 1e6);
+    }
+    fclose(file);
+}
+
+static int default_threads(void)
+{
+#ifndef THREADS
+    return 1;
+#elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: decoder-regression [-j threads] [-I field] [-F] [-t top] [-o times.csv] [-v] DIR|FILE.json...\n"
+                    "  -j threads   worker threads (default: number of CPUs)\n"
+                    "  -I field     field to ignore in the comparison, repeatable (default: time)\n"
+                    "  -F           also replay each .cu8 input converted to CF32\n"
+                    "  -t top       slowest files listed (default 10)\n"
+                    "  -o file      write result and decode time of every file as CSV\n"
+                    "  -v           list every file, not only the failures\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    runner_t runner = {0};
+    int threads = default_threads();
+    int with_cf32 = 0;
+    int verbose = 0;
+    unsigned top = 10;
+    char const *times_path = NULL;
+    unsigned size = 0;
+
+    runner.ignore[runner.num_ignore++] = "time";
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-F")) {
+            with_cf32 = 1;
+            continue;
+        }
+        if (!strcmp(argv[i], "-v")) {
+            verbose = 1;
+            continue;
+        }
+        if (i + 1 >= argc)
+            usage();
+        if (!strcmp(argv[i], "-j"))
+            threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-I") && runner.num_ignore < MAX_IGNORE_FIELDS)
+            runner.ignore[runner.num_ignore++] = argv[++i];
+        else if (!strcmp(argv[i], "-t"))
+            top = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o"))
+            times_path = argv[++i];
+        else
+            usage();
+    }
+    if (i >= argc || threads < 1)
+        usage();
+#ifndef THREADS
+    threads = 1;
+#endif
+    r_logger_set_log_handler(quiet_log, NULL);
+    baseband_init();
+
+    r_device templates[] = {
+#define DECL(name) name,
+            DEVICES
+#undef DECL
+    };
+    runner.devices     = templates;
+    runner.num_devices = sizeof(templates) / sizeof(*templates);
+    for (unsigned k = 0; k < runner.num_devices; k++)
+        templates[k].protocol_num = k + 1;
+
+    // Read the whole corpus before decoding
+    uint64_t load_start = metrics_time_ns();
+    for (; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            list_t found = {0};
+            find_json(argv[i], &found);
+            if (found.len)
+                qsort(found.elems, found.len, sizeof(*found.elems), compare_str);
+            for (size_t k = 0; k < found.len; k++)
+                load_case(&runner, found.elems[k], argv[i], with_cf32, &size);
+            list_free_elems(&found, free);
+        }
+        else {
+            load_case(&runner, argv[i], "", with_cf32, &size);
+        }
+    }
+    double load_s = (metrics_time_ns() - load_start) / 1e9;
+    if (!runner.num_cases) {
+        fprintf(stderr, "No tests found\n");
+        return 1;
+    }
+    if ((unsigned)threads > runner.num_cases)
+        threads = (int)runner.num_cases;
+
+    worker_t *workers = calloc(threads, sizeof(*workers));
+    if (!workers) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (int k = 0; k < threads; k++) {
+        worker_t *w = &workers[k];
+        w->runner   = &runner;
+        w->out_file = tmpfile();
+        w->line_buf = xmalloc(MAX_LINE_LENGTH);
+        w->json     = w->out_file ? data_output_json_create(0, w->out_file) : NULL;
+        if (!w->json) {
+            fprintf(stderr, "Failed to create the output buffer file\n");
+            return 1;
+        }
+        list_ensure_size(&w->r_devs, runner.num_devices);
+    }
+
+    uint64_t run_start = metrics_time_ns();
+#ifdef THREADS
+    pthread_mutex_init(&runner.lock, NULL);
+    pthread_t *tids = xmalloc(threads * sizeof(*tids));
+    for (int k = 0; k < threads; k++) {
+        if (pthread_create(&tids[k], NULL, worker_thread, &workers[k])) {
+            fprintf(stderr, "Failed to start worker thread\n");
+            return 1;
+        }
+    }
+    for (int k = 0; k < threads; k++)
+        pthread_join(tids[k], NULL);
+    free(tids);
+    pthread_mutex_destroy(&runner.lock);
+#else
+    worker_run(&workers[0]);
+#endif
+    double run_s = (metrics_time_ns() - run_start) / 1e9;
+
+    // Results
+    unsigned totals[RESULT_COUNT] = {0};
+    uint64_t decode_ns = 0;
+    double signal_s = 0.0;
+    for (unsigned k = 0; k < runner.num_cases; k++) {
+        regress_case_t const *c = &runner.cases[k];
+        totals[c->result]++;
+        if (was_run(c)) {
+            decode_ns += c->decode_ns;
+            signal_s += signal_seconds(c);
+        }
+        int failed = c->result >= RESULT_MISSING && c->result <= RESULT_ERROR;
+        if (verbose || failed)
+            printf("%-9s %8.2f ms  %s%s%s\n", result_names[c->result], c->decode_ns / 1e6, c->name,
+                    *c->detail ? ": " : "", c->detail);
+    }
+    if (top)
+        print_slowest(&runner, top);
+    if (times_path)
+        write_times(&runner, times_path);
+
+    printf("\n%u replays, %d threads: load %.1f s, decode %.1f s wall, %.1f s CPU for %.0f s of signal\n",
+            runner.num_cases, threads, load_s, run_s, decode_ns / 1e9, signal_s);
+    for (int r = 0; r < RESULT_COUNT; r++)
+        printf("%s%s %u", r ? ", " : "", result_names[r], totals[r]);
+    printf("\n");
+
+    unsigned failures = totals[RESULT_MISSING] + totals[RESULT_MISMATCH] + totals[RESULT_FAIL] + totals[RESULT_NO_OUTPUT];
+
+    for (int k = 0; k < threads; k++) {
+        data_output_free(workers[k].json);
+        fclose(workers[k].out_file);
+        free(workers[k].line_buf);
+        list_free_elems(&workers[k].r_devs, NULL);
+    }
+    free(workers);
+    for (unsigned k = 0; k < runner.num_cases; k++) {
+        regress_case_t *c = &runner.cases[k];
+        free(c->name);
+        if (c->variant)
+            continue;
+        free(c->iq);
+        free(c->packages);
+        free(c->protocol_arg);
+        json_lines_free(&c->expected);
+    }
+    free(runner.cases);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,239 @@
+/** @file
+    Wideband cross-channel deduplication test.
+
+    Checks the key fields, the sample clock window, same-channel repeats,
+    eviction and, with concurrent channel workers, that exactly one copy of
+    each transmission is forwarded.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <pthread.h>
+
+#include "data.h"
+#include "wb_dedup.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static data_t *make_event(int id, double temp, double rssi, int counter)
+{
+    /* clang-format off */
+    return data_make(
+            "model",            "",             DATA_STRING, "Acme-Temp",
+            "id",               "",             DATA_INT,    id,
+            "counter",          "",             DATA_INT,    counter,
+            "temperature_C",    "",             DATA_DOUBLE, temp,
+            "rssi",             "",             DATA_DOUBLE, rssi,
+            NULL);
+    /* clang-format on */
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_key(void)
+{
+    printf("\n=== Key ===\n");
+
+    wb_dedup_t *all = wb_dedup_create(500, NULL);
+    wb_dedup_t *ids = wb_dedup_create(500, "model,id");
+    wb_dedup_t *nocnt = wb_dedup_create(500, "-counter");
+    if (!all || !ids || !nocnt) {
+        TEST_ASSERT(0, "dedup created");
+        return;
+    }
+
+    data_t *a = make_event(1, 20.5, -10.0, 1);
+    data_t *b = make_event(1, 20.5, -25.0, 1); // other channel, other RSSI
+    data_t *c = make_event(1, 21.0, -10.0, 2); // next transmission
+    data_t *d = make_event(2, 20.5, -10.0, 1); // other sensor
+
+    TEST_ASSERT(wb_dedup_key(all, a) == wb_dedup_key(all, b), "volatile fields ignored");
+    TEST_ASSERT(wb_dedup_key(all, a) != wb_dedup_key(all, c), "payload in the key");
+    TEST_ASSERT(wb_dedup_key(all, a) != wb_dedup_key(all, d), "id in the key");
+    TEST_ASSERT(wb_dedup_key(ids, a) == wb_dedup_key(ids, c), "only the configured fields");
+    TEST_ASSERT(wb_dedup_key(ids, a) != wb_dedup_key(ids, d), "configured id field");
+    data_t *e = make_event(1, 20.5, -10.0, 7);
+    TEST_ASSERT(wb_dedup_key(nocnt, a) == wb_dedup_key(nocnt, e), "excluded field");
+
+    data_free(a);
+    data_free(b);
+    data_free(c);
+    data_free(d);
+    data_free(e);
+    wb_dedup_free(all);
+    wb_dedup_free(ids);
+    wb_dedup_free(nocnt);
+}
+
+static void test_window(void)
+{
+    printf("\n=== Window ===\n");
+
+    wb_dedup_t *dedup = wb_dedup_create(500, NULL);
+    data_t *ev = make_event(1, 20.5, -10.0, 1);
+
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 3, 10000) == 0, "first copy forwarded");
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 4, 10002) == 1, "adjacent channel copy suppressed");
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 2, 9999) == 1, "slightly earlier copy suppressed");
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 3, 10100) == 0, "same channel repeat forwarded");
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 4, 10550) == 1, "repeat restarts the window");
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 4, 11000) == 0, "copy after the window forwarded");
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 3, 0) == 0, "reset sample clock is not a duplicate");
+
+    wb_dedup_stats_t stats;
+    wb_dedup_stats(dedup, &stats);
+    TEST_ASSERT(stats.hits == 3 && wb_dedup_suppressed_count(dedup) == 3, "hits counted");
+    TEST_ASSERT(stats.repeats == 1 && stats.misses == 3 && stats.evictions == 0, "repeats and misses counted");
+
+    data_free(ev);
+    wb_dedup_free(dedup);
+}
+
+static void test_evict(void)
+{
+    printf("\n=== Eviction ===\n");
+
+    wb_dedup_t *dedup = wb_dedup_create(500, NULL);
+    int const total = WB_DEDUP_SLOTS * 2;
+    for (int i = 0; i < total; ++i) {
+        data_t *ev = make_event(i, 20.5, -10.0, 1);
+        wb_dedup_check(dedup, ev, 0, 1000 + i / 100);
+        data_free(ev);
+    }
+    wb_dedup_stats_t stats;
+    wb_dedup_stats(dedup, &stats);
+    TEST_ASSERT(stats.misses == (uint64_t)total && stats.evictions > 0, "full index evicts");
+
+    // the newest entries survive
+    data_t *ev = make_event(total - 1, 20.5, -10.0, 1);
+    TEST_ASSERT(wb_dedup_check(dedup, ev, 1, 1000 + total / 100) == 1, "newest entry kept");
+    data_free(ev);
+    wb_dedup_free(dedup);
+}
+
+/* Concurrent channel workers */
+
+#define WORKERS 4
+#define ROUNDS 200
+#define KEYS 256 /* per round, well below the index size */
+
+typedef struct {
+    wb_dedup_t *dedup;
+    data_t **events;
+    int channel;
+    int forwarded;
+} worker_t;
+
+static int arrived;
+
+/* All workers finish a round before the sample clock moves on, like the
+   channels of one frame. */
+static void round_barrier(int round)
+{
+    __atomic_fetch_add(&arrived, 1, __ATOMIC_ACQ_REL);
+    while (__atomic_load_n(&arrived, __ATOMIC_ACQUIRE) < WORKERS * (round + 1))
+        ;
+}
+
+static void *worker_run(void *arg)
+{
+    worker_t *w = arg;
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (int i = 0; i < KEYS; ++i) {
+            // channels see the transmission a few ms apart
+            uint64_t t = (uint64_t)r * 1000 + (unsigned)(i + w->channel) % 8;
+            w->forwarded += !wb_dedup_check(w->dedup, w->events[r * KEYS + i], w->channel, t);
+        }
+        round_barrier(r);
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    printf("\n=== Concurrent workers ===\n");
+
+    int const total = ROUNDS * KEYS;
+    wb_dedup_t *dedup = wb_dedup_create(500, NULL);
+    data_t **events   = calloc(total, sizeof(*events));
+    if (!dedup || !events) {
+        TEST_ASSERT(0, "setup");
+        return;
+    }
+    for (int i = 0; i < total; ++i)
+        events[i] = make_event(i, 20.5, -10.0, i);
+
+    // every worker sees every transmission, as if all channels decoded it
+    worker_t workers[WORKERS];
+    pthread_t threads[WORKERS];
+    for (int i = 0; i < WORKERS; ++i) {
+        workers[i].dedup     = dedup;
+        workers[i].events    = events;
+        workers[i].channel   = i;
+        workers[i].forwarded = 0;
+        pthread_create(&threads[i], NULL, worker_run, &workers[i]);
+    }
+    int forwarded = 0;
+    for (int i = 0; i < WORKERS; ++i) {
+        pthread_join(threads[i], NULL);
+        forwarded += workers[i].forwarded;
+    }
+
+    wb_dedup_stats_t stats;
+    wb_dedup_stats(dedup, &stats);
+    printf("  forwarded %d, hits %llu, evictions %llu\n", forwarded,
+            (unsigned long long)stats.hits, (unsigned long long)stats.evictions);
+    TEST_ASSERT(forwarded == total, "exactly one copy forwarded");
+    TEST_ASSERT(stats.hits == (uint64_t)(WORKERS - 1) * total, "all other copies suppressed");
+
+    for (int i = 0; i < total; ++i)
+        data_free(events[i]);
+    free(events);
+    wb_dedup_free(dedup);
+}
+
+int main(void)
+{
+    printf("Wideband Dedup Test\n");
+    printf("===================\n");
+
+    test_key();
+    test_window();
+    test_evict();
+    test_concurrent();
+
+    printf("\n===================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
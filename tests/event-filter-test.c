@@ -0,0 +1,133 @@
+/** @file
+    Event selection and rate limit test.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "event_filter.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_match(void)
+{
+    printf("\n--- Lists ---\n");
+    TEST_ASSERT(event_filter_match("", "Acme-Temp") && event_filter_match("", NULL), "empty list matches anything");
+    TEST_ASSERT(event_filter_match("Acme-Temp", "Acme-Temp"), "single value");
+    TEST_ASSERT(event_filter_match("Acme-Rain,Acme-Temp", "Acme-Temp"), "last of a list");
+    TEST_ASSERT(event_filter_match("Acme-Temp,Acme-Rain", "Acme-Temp"), "first of a list");
+    TEST_ASSERT(!event_filter_match("Acme-Temp", "Acme"), "no prefix match");
+    TEST_ASSERT(!event_filter_match("Acme", "Acme-Temp"), "no longer value match");
+    TEST_ASSERT(!event_filter_match("1,2,3", NULL), "missing value never matches a list");
+    TEST_ASSERT(event_filter_match("1,,3", "3") && !event_filter_match("1,,3", "2"), "empty entries skipped");
+}
+
+static void test_wants(void)
+{
+    printf("\n--- Selection ---\n");
+    event_filter_t f;
+
+    event_filter_init(&f);
+    TEST_ASSERT(event_filter_wants(&f, "Acme-Temp", NULL, NULL, NAN), "default passes everything");
+
+    snprintf(f.model, sizeof(f.model), "Acme-Temp,Acme-Rain");
+    snprintf(f.id, sizeof(f.id), "42");
+    TEST_ASSERT(event_filter_wants(&f, "Acme-Rain", "42", NULL, NAN), "model and id selected");
+    TEST_ASSERT(!event_filter_wants(&f, "Other", "42", NULL, NAN), "other model dropped");
+    TEST_ASSERT(!event_filter_wants(&f, "Acme-Temp", "7", NULL, NAN), "other id dropped");
+    TEST_ASSERT(!event_filter_wants(&f, "Acme-Temp", NULL, NULL, NAN), "missing id dropped");
+    TEST_ASSERT(event_filter_wants(&f, NULL, NULL, NULL, NAN), "messages without a model pass");
+
+    event_filter_init(&f);
+    snprintf(f.channel, sizeof(f.channel), "1,3");
+    TEST_ASSERT(event_filter_wants(&f, "Acme-Temp", NULL, "3", NAN), "channel selected");
+    TEST_ASSERT(!event_filter_wants(&f, "Acme-Temp", NULL, "2", NAN), "other channel dropped");
+
+    event_filter_init(&f);
+    f.min_snr = 10.0;
+    TEST_ASSERT(event_filter_wants(&f, "Acme-Temp", NULL, NULL, 10.0), "SNR at the minimum passes");
+    TEST_ASSERT(!event_filter_wants(&f, "Acme-Temp", NULL, NULL, 9.5), "SNR below the minimum dropped");
+    TEST_ASSERT(!event_filter_wants(&f, "Acme-Temp", NULL, NULL, NAN), "no SNR never passes a minimum");
+}
+
+static void test_rate(void)
+{
+    printf("\n--- Rate limit ---\n");
+    event_filter_t f;
+    int sent;
+
+    event_filter_init(&f);
+    sent = 0;
+    for (int i = 0; i < 1000; ++i)
+        sent += event_filter_take(&f, 100.0);
+    TEST_ASSERT(sent == 1000, "unlimited without a rate");
+
+    // 5 per second: a burst of 5, then one every 0.2 s
+    event_filter_set_rate(&f, 5.0, 100.0);
+    sent = 0;
+    for (int i = 0; i < 20; ++i)
+        sent += event_filter_take(&f, 100.0);
+    TEST_ASSERT(sent == 5, "burst of one second of events");
+    TEST_ASSERT(!event_filter_take(&f, 100.1), "over the limit within the refill time");
+    TEST_ASSERT(event_filter_take(&f, 100.2), "one event after the refill time");
+
+    sent = 0;
+    for (int i = 1; i <= 1000; ++i)
+        sent += event_filter_take(&f, 100.2 + i * 0.01); // 100 per second offered for 10 s
+    TEST_ASSERT(sent >= 49 && sent <= 51, "sustained rate holds");
+
+    event_filter_set_rate(&f, 5.0, 200.0);
+    for (int i = 0; i < 5; ++i)
+        event_filter_take(&f, 200.0);
+    sent = 0;
+    for (int i = 0; i < 20; ++i)
+        sent += event_filter_take(&f, 3600.0);
+    TEST_ASSERT(sent == 5, "idle time does not build up more than the burst");
+
+    // below one per second the burst is a single event
+    event_filter_set_rate(&f, 0.5, 0.0);
+    TEST_ASSERT(event_filter_take(&f, 0.0) && !event_filter_take(&f, 0.0), "burst of one below one per second");
+    TEST_ASSERT(!event_filter_take(&f, 1.5) && event_filter_take(&f, 2.0), "one event every 2 s");
+}
+
+int main(void)
+{
+    printf("Event Filter Test\n");
+    printf("=================\n");
+
+    test_match();
+    test_wants();
+    test_rate();
+
+    printf("\n=================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
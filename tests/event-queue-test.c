@@ -0,0 +1,167 @@
+/** @file
+    Lock-free event handoff queue test.
+
+    Checks the order, a full queue, wrapping around and, with concurrent
+    producers, that every item arrives exactly once and in the order of
+    its producer.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "event_queue.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+#define PRODUCERS 4
+#define ITEMS     100000
+
+/// Items are encoded as producer index and a count from 1, never NULL.
+#define ITEM(p, n)     ((void *)(uintptr_t)(((uintptr_t)(p) << 24) | (uintptr_t)(n)))
+#define ITEM_PROD(i)   ((int)((uintptr_t)(i) >> 24))
+#define ITEM_COUNT(i)  ((unsigned)((uintptr_t)(i) & 0xffffff))
+
+typedef struct {
+    event_queue_t *q;
+    int index;
+    unsigned full; ///< pushes retried on a full queue
+} producer_t;
+
+static void *producer_run(void *arg)
+{
+    producer_t *p = arg;
+    for (unsigned n = 1; n <= ITEMS; ++n) {
+        while (event_queue_push(p->q, ITEM(p->index, n)) < 0) {
+            p->full++;
+            sched_yield(); // let the consumer run on a single core
+        }
+    }
+    return NULL;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_order(void)
+{
+    printf("\n=== Order ===\n");
+
+    event_queue_t *q = event_queue_create(5);
+    if (!q) {
+        TEST_ASSERT(0, "queue created");
+        return;
+    }
+
+    TEST_ASSERT(event_queue_pop(q) == NULL, "empty queue");
+
+    int ok = 1;
+    for (unsigned n = 1; n <= 8; ++n)
+        ok &= event_queue_push(q, ITEM(0, n)) == 0;
+    TEST_ASSERT(ok, "capacity rounded up to 8");
+    TEST_ASSERT(event_queue_push(q, ITEM(0, 9)) < 0, "full queue rejects");
+
+    TEST_ASSERT(ITEM_COUNT(event_queue_pop(q)) == 1, "first in, first out");
+    TEST_ASSERT(event_queue_push(q, ITEM(0, 9)) == 0, "slot freed by a pop");
+
+    // wrap around the ring several times
+    ok = 1;
+    unsigned next = 2;
+    for (unsigned n = 10; n < 100; ++n) {
+        ok &= ITEM_COUNT(event_queue_pop(q)) == next++;
+        ok &= event_queue_push(q, ITEM(0, n)) == 0;
+    }
+    TEST_ASSERT(ok, "order kept when wrapping");
+
+    unsigned left = 0;
+    while (event_queue_pop(q))
+        left++;
+    TEST_ASSERT(left == 8, "drained");
+
+    event_queue_free(q);
+}
+
+static void test_concurrent(void)
+{
+    printf("\n=== Concurrent producers ===\n");
+
+    event_queue_t *q = event_queue_create(256);
+    producer_t producers[PRODUCERS];
+    pthread_t threads[PRODUCERS];
+    for (int i = 0; i < PRODUCERS; ++i) {
+        producers[i] = (producer_t){.q = q, .index = i};
+        pthread_create(&threads[i], NULL, producer_run, &producers[i]);
+    }
+
+    unsigned last[PRODUCERS] = {0};
+    unsigned received        = 0;
+    int in_order             = 1;
+    while (received < PRODUCERS * ITEMS) {
+        void *item = event_queue_pop(q);
+        if (!item) {
+            sched_yield();
+            continue;
+        }
+        int p = ITEM_PROD(item);
+        if (p >= PRODUCERS || ITEM_COUNT(item) != last[p] + 1)
+            in_order = 0;
+        else
+            last[p] = ITEM_COUNT(item);
+        received++;
+    }
+    for (int i = 0; i < PRODUCERS; ++i)
+        pthread_join(threads[i], NULL);
+
+    unsigned full = 0;
+    for (int i = 0; i < PRODUCERS; ++i)
+        full += producers[i].full;
+    printf("  %u items, %u pushes retried on a full queue\n", received, full);
+
+    TEST_ASSERT(in_order, "each item once, in the order of its producer");
+    TEST_ASSERT(event_queue_pop(q) == NULL, "nothing left");
+    event_queue_free(q);
+}
+
+int main(void)
+{
+    printf("Event Queue Test\n");
+    printf("================\n");
+
+    test_order();
+    test_concurrent();
+
+    printf("\n================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/** @file
+    In-memory event store test.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "data.h"
+#include "event_store.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static char out[1 << 16];
+
+static void add_event(event_store_t *es, char const *model, int id, double temp, double time)
+{
+    /* clang-format off */
+    data_t *data = data_make(
+            "model",            "",             DATA_STRING, model,
+            "id",               "",             DATA_INT,    id,
+            "battery_ok",       "",             DATA_STRING, temp < 0 ? "LOW" : "OK",
+            "temperature_C",    "",             DATA_DOUBLE, temp,
+            NULL);
+    /* clang-format on */
+    event_store_add(es, data, time);
+    data_free(data);
+}
+
+static int count_of(char const *s, char const *what)
+{
+    int n = 0;
+    for (s = strstr(s, what); s; s = strstr(s + 1, what))
+        n++;
+    return n;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_latest(void)
+{
+    printf("\n=== Last value per sensor ===\n");
+    event_store_t *es = event_store_create(64);
+    TEST_ASSERT(es != NULL, "store created");
+
+    add_event(es, "Acme-Temp", 1, 20.5, 1000.0);
+    add_event(es, "Acme-Temp", 2, 18.0, 1001.0);
+    add_event(es, "Acme-Temp", 1, 21.5, 1002.0);
+    add_event(es, "Other-Rain", 1, -1.0, 1003.0);
+
+    data_t *no_model = data_make("id", "", DATA_INT, 3, NULL);
+    TEST_ASSERT(event_store_add(es, no_model, 1004.0) == 0, "event without a model ignored");
+    data_free(no_model);
+
+    unsigned events, sensors;
+    event_store_counts(es, &events, &sensors);
+    TEST_ASSERT(events == 4 && sensors == 3, "events and sensors counted");
+
+    event_store_latest(es, NULL, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 3, "one entry per sensor");
+    TEST_ASSERT(strstr(out, "{\"model\":\"Acme-Temp\",\"id\":\"1\",\"time\":1002.000,\"count\":2,"
+                            "\"fields\":{\"battery_ok\":\"OK\",\"temperature_C\":21.5}}") != NULL,
+            "last value of a sensor");
+    TEST_ASSERT(strstr(out, "\"battery_ok\":\"LOW\"") != NULL, "string fields kept");
+
+    event_store_latest(es, "Other-Rain", out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 1, "latest of one model");
+    event_store_latest(es, "Unknown", out, sizeof(out));
+    TEST_ASSERT(!strcmp(out, "{\"sensors\":[]}"), "unknown model is empty");
+
+    event_store_free(es);
+}
+
+static void test_events(void)
+{
+    printf("\n=== Events by sensor and time ===\n");
+    event_store_t *es = event_store_create(1000);
+
+    for (int i = 0; i < 300; ++i)
+        add_event(es, i % 3 ? "Acme-Temp" : "Other-Rain", i % 5, i * 0.1, 10000.0 + i * 20.0);
+
+    event_store_events(es, "Acme-Temp", "4", 0.0, 1000, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 40, "all events of a sensor");
+    char const *first = strstr(out, "\"time\":");
+    TEST_ASSERT(first && !strncmp(first, "\"time\":15980.000", 16), "newest first");
+
+    event_store_events(es, "Acme-Temp", "4", 10000.0 + 240 * 20.0, 1000, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 8, "events of a sensor since a time");
+
+    event_store_events(es, "Acme-Temp", NULL, 10000.0 + 270 * 20.0, 1000, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 20, "events of a model since a time");
+
+    event_store_events(es, NULL, "2", 0.0, 1000, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"id\":\"2\"") == 60 && count_of(out, "\"model\"") == 60, "events of an id");
+
+    event_store_events(es, NULL, NULL, 0.0, 7, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 7, "limit honored");
+
+    size_t len = event_store_events(es, NULL, NULL, 0.0, 1000, out, 1000);
+    TEST_ASSERT(len < 1000 && !strcmp(out + len - 3, "}]}"), "cut short to the buffer, still valid");
+
+    event_store_minutes(es, NULL, 0.0, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"time\"") == 101, "one entry per minute");
+    TEST_ASSERT(strstr(out, "{\"time\":10020,\"counts\":{\"Acme-Temp\":2,\"Other-Rain\":1}}") != NULL,
+            "counts per model per minute");
+    event_store_minutes(es, "Other-Rain", 15900.0, out, sizeof(out));
+    TEST_ASSERT(!strcmp(out, "{\"minutes\":[{\"time\":15900,\"counts\":{\"Other-Rain\":1}}]}"),
+            "counts of a model since a time");
+
+    event_store_free(es);
+}
+
+static void test_eviction(void)
+{
+    printf("\n=== Eviction ===\n");
+    event_store_t *es = event_store_create(100);
+
+    for (int i = 0; i < 250; ++i)
+        add_event(es, "Acme-Temp", i % 2, i, 5000.0 + i);
+
+    unsigned events;
+    event_store_counts(es, &events, NULL);
+    TEST_ASSERT(events == 100, "oldest events dropped");
+    event_store_events(es, "Acme-Temp", "0", 0.0, 1000, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 50, "sensor index stops at the oldest event");
+    event_store_latest(es, NULL, out, sizeof(out));
+    TEST_ASSERT(strstr(out, "\"count\":125") != NULL, "sensor count kept");
+    event_store_minutes(es, NULL, 0.0, out, sizeof(out));
+    TEST_ASSERT(strstr(out, "{\"time\":4980,\"counts\":{\"Acme-Temp\":40}}") != NULL,
+            "minute counts outlive the events");
+
+    event_store_free(es);
+}
+
+static void test_string_values(void)
+{
+    printf("\n=== String values ===\n");
+    event_store_t *es = event_store_create(100);
+    char value[64];
+
+    // more distinct values than can be interned, all dropped with their events
+    for (int i = 0; i < EVENT_STORE_MAX_STRINGS + 1000; ++i) {
+        snprintf(value, sizeof(value), "code-%08d", i);
+        data_t *data = data_make(
+                "model", "", DATA_STRING, "Acme-Remote",
+                "code",  "", DATA_STRING, value,
+                NULL);
+        event_store_add(es, data, 1000.0 + i);
+        data_free(data);
+    }
+    add_event(es, "New-Model", 1, 20.0, 1e6);
+    event_store_latest(es, "New-Model", out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"model\"") == 1, "new model stored after many values");
+    event_store_events(es, "Acme-Remote", NULL, 0.0, 1, out, sizeof(out));
+    snprintf(value, sizeof(value), "\"code\":\"code-%08d\"", EVENT_STORE_MAX_STRINGS + 999);
+    TEST_ASSERT(strstr(out, value) != NULL, "string value of the last event");
+    event_store_events(es, "Acme-Remote", NULL, 0.0, 1000, out, sizeof(out));
+    TEST_ASSERT(count_of(out, "\"code\":\"code-") == count_of(out, "\"model\""), "string values held with their events");
+
+    // a value longer than the text of the store is dropped, the event kept
+    static char big[100 * EVENT_STORE_AVG_TEXT + 1];
+    memset(big, 'x', sizeof(big) - 1);
+    data_t *data = data_make(
+            "model", "", DATA_STRING, "Acme-Remote",
+            "code",  "", DATA_STRING, big,
+            "count", "", DATA_INT,    7,
+            NULL);
+    TEST_ASSERT(event_store_add(es, data, 2e6) == 1, "event with an oversized value stored");
+    data_free(data);
+    event_store_events(es, "Acme-Remote", NULL, 0.0, 1, out, sizeof(out));
+    TEST_ASSERT(strstr(out, "\"fields\":{\"count\":7}") != NULL, "oversized value dropped");
+
+    event_store_free(es);
+}
+
+static void test_speed(void)
+{
+    printf("\n=== Query speed ===\n");
+    enum { EVENTS = 300000, SENSORS = 2000, QUERIES = 200 };
+    event_store_t *es = event_store_create(EVENTS);
+    char name[32];
+
+    for (int i = 0; i < EVENTS; ++i) {
+        snprintf(name, sizeof(name), "Model-%d", i % 50);
+        add_event(es, name, i % SENSORS, i % 40, 1.7e9 + i * 0.5);
+    }
+    unsigned events, sensors;
+    event_store_counts(es, &events, &sensors);
+    TEST_ASSERT(events == EVENTS && sensors == SENSORS, "store filled");
+
+    clock_t start = clock();
+    size_t len    = 0;
+    for (int q = 0; q < QUERIES; ++q) {
+        snprintf(name, sizeof(name), "%d", (q * 50 + 7) % SENSORS); // sensors of Model-7
+        len += event_store_events(es, "Model-7", name, 1.7e9 + EVENTS * 0.5 - 3600.0, 100, out, sizeof(out));
+    }
+    double us = (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / QUERIES;
+    printf("events of a sensor in the last hour: %.1f us\n", us);
+    TEST_ASSERT(len > 0 && count_of(out, "\"model\"") >= 3 && us < 1000.0, "sensor query is fast");
+
+    start = clock();
+    for (int q = 0; q < QUERIES; ++q)
+        event_store_minutes(es, "Model-7", 1.7e9 + EVENTS * 0.5 - 3600.0, out, sizeof(out));
+    us = (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / QUERIES;
+    printf("counts per minute in the last hour: %.1f us\n", us);
+    TEST_ASSERT(count_of(out, "\"time\"") >= 60 && us < 1000.0, "minute counts are fast");
+
+    event_store_free(es);
+}
+
+int main(void)
+{
+    printf("Event Store Test\n");
+    printf("================\n");
+
+    test_latest();
+    test_events();
+    test_eviction();
+    test_string_values();
+    test_speed();
+
+    printf("\n================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
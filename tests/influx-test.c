@@ -0,0 +1,276 @@
+/** @file
+    InfluxDB output test.
+
+    Runs the InfluxDB output against an in-process HTTP stand-in on the
+    loopback interface and checks batching, gzip bodies and retries.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_influx.h"
+#include "mongoose.h"
+
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * HTTP stand-in
+ *============================================================================*/
+
+#define SERVER_MAX_REQS 16
+
+typedef struct {
+    int fail_count;         /* answer this many requests with 503 */
+    int num_reqs;
+    int lines[SERVER_MAX_REQS];
+    int gzipped[SERVER_MAX_REQS];
+    int status[SERVER_MAX_REQS];
+    int total_lines;        /* lines of accepted requests */
+    int body_ok;
+} server_t;
+
+static server_t server;
+
+static int count_lines(char const *body, size_t len)
+{
+    int n = 0;
+    for (size_t i = 0; i < len; ++i)
+        if (body[i] == '\n')
+            n++;
+    return n;
+}
+
+static int check_body(char const *body, size_t len)
+{
+    return len > 0 && body[len - 1] == '\n' && !strncmp(body, "Acme-Temp,id=", 13);
+}
+
+static void server_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    struct http_message *hm = (struct http_message *)ev_data;
+
+    if (ev != MG_EV_HTTP_REQUEST)
+        return;
+
+    int status = server.fail_count > 0 ? 503 : 204;
+    if (server.fail_count > 0)
+        server.fail_count--;
+
+    struct mg_str *enc = mg_get_http_header(hm, "Content-Encoding");
+    int gzipped = enc && !mg_vcmp(enc, "gzip");
+    char const *body = hm->body.p;
+    size_t body_len = hm->body.len;
+
+#ifdef ZLIB
+    static char plain[1 << 20];
+    if (gzipped) {
+        z_stream zs = {0};
+        inflateInit2(&zs, 15 + 16);
+        zs.next_in   = (Bytef *)hm->body.p;
+        zs.avail_in  = (uInt)hm->body.len;
+        zs.next_out  = (Bytef *)plain;
+        zs.avail_out = sizeof(plain);
+        int ret = inflate(&zs, Z_FINISH);
+        body     = plain;
+        body_len = ret == Z_STREAM_END ? zs.total_out : 0;
+        inflateEnd(&zs);
+    }
+#endif
+
+    if (server.num_reqs < SERVER_MAX_REQS) {
+        int i = server.num_reqs++;
+        server.lines[i]   = count_lines(body, body_len);
+        server.gzipped[i] = gzipped;
+        server.status[i]  = status;
+    }
+    if (status == 204)
+        server.total_lines += count_lines(body, body_len);
+    if (!check_body(body, body_len))
+        server.body_ok = 0;
+
+    mg_printf(nc, "HTTP/1.1 %d %s\r\nContent-Length: 0\r\n\r\n", status, status == 204 ? "No Content" : "Service Unavailable");
+    nc->flags |= MG_F_SEND_AND_CLOSE;
+}
+
+static void poll_for(struct mg_mgr *mgr, double seconds)
+{
+    double end = mg_time() + seconds;
+    while (mg_time() < end)
+        mg_mgr_poll(mgr, 5);
+}
+
+static struct data_output *start_client(struct mg_mgr *mgr, char const *port, char const *opts)
+{
+    char param[256];
+    snprintf(param, sizeof(param), "influx://127.0.0.1:%s/api/v2/write?org=test&bucket=test,token=secret,%s", port, opts);
+
+    memset(&server, 0, sizeof(server));
+    server.body_ok = 1;
+    return data_output_influx_create(mgr, param);
+}
+
+static void send_events(struct data_output *output, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        /* clang-format off */
+        data_t *data = data_make(
+                "model",            "",             DATA_STRING, "Acme-Temp",
+                "id",               "",             DATA_INT,    i,
+                "temperature_C",    "",             DATA_DOUBLE, 20.0 + i,
+                NULL);
+        /* clang-format on */
+        data_output_print(output, data);
+        data_free(data);
+    }
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_batch_lines(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== Batch by line count ===\n");
+
+    struct data_output *output = start_client(mgr, port, "batch_lines=10,batch_delay=60000");
+    send_events(output, 25);
+    poll_for(mgr, 0.3);
+
+    TEST_ASSERT(server.num_reqs == 2, "full batches are written");
+    TEST_ASSERT(server.lines[0] == 10 && server.lines[1] == 10, "batches hold batch_lines lines");
+    TEST_ASSERT(server.total_lines == 20, "partial batch is held back");
+    TEST_ASSERT(server.body_ok, "line protocol body");
+
+    data_output_free(output);
+    poll_for(mgr, 0.05);
+}
+
+static void test_batch_delay(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== Batch by delay ===\n");
+
+    struct data_output *output = start_client(mgr, port, "batch_delay=200");
+    send_events(output, 3);
+    poll_for(mgr, 0.05);
+    TEST_ASSERT(server.num_reqs == 0, "partial batch is held back");
+
+    poll_for(mgr, 0.5);
+    TEST_ASSERT(server.num_reqs == 1, "partial batch is written after the delay");
+    TEST_ASSERT(server.lines[0] == 3, "all lines in one write");
+
+    data_output_free(output);
+    poll_for(mgr, 0.05);
+}
+
+static void test_gzip(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== gzip bodies ===\n");
+
+    struct data_output *output = start_client(mgr, port, "batch_lines=20,gzip");
+    send_events(output, 20);
+    poll_for(mgr, 0.3);
+
+    TEST_ASSERT(server.num_reqs == 1, "batch is written");
+#ifdef ZLIB
+    TEST_ASSERT(server.gzipped[0], "body is gzip encoded");
+#else
+    TEST_ASSERT(!server.gzipped[0], "body is sent plain without zlib");
+#endif
+    TEST_ASSERT(server.total_lines == 20, "all lines decoded");
+    TEST_ASSERT(server.body_ok, "line protocol body");
+
+    data_output_free(output);
+    poll_for(mgr, 0.05);
+}
+
+static void test_shutdown(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== Pending lines on shutdown ===\n");
+
+    struct data_output *output = start_client(mgr, port, "batch_lines=10,batch_delay=60000");
+    send_events(output, 25);
+    poll_for(mgr, 0.3);
+    TEST_ASSERT(server.total_lines == 20, "partial batch is held back");
+
+    data_output_free(output);
+    TEST_ASSERT(server.total_lines == 25, "partial batch is written on shutdown");
+    TEST_ASSERT(server.body_ok, "line protocol body");
+    poll_for(mgr, 0.05);
+}
+
+static void test_retry(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== Retry on server error ===\n");
+
+    struct data_output *output = start_client(mgr, port, "batch_lines=5");
+    server.fail_count = 1;
+    send_events(output, 5);
+    poll_for(mgr, 0.3);
+
+    TEST_ASSERT(server.num_reqs == 2, "failed write is retried");
+    TEST_ASSERT(server.status[0] == 503 && server.status[1] == 204, "retry after 503");
+    TEST_ASSERT(server.lines[1] == 5, "retry holds the same lines");
+    TEST_ASSERT(server.total_lines == 5, "no lines lost or duplicated");
+
+    data_output_free(output);
+    poll_for(mgr, 0.05);
+}
+
+int main(void)
+{
+    printf("InfluxDB Output Test\n");
+    printf("====================\n");
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+
+    struct mg_connection *listener = mg_bind(&mgr, "127.0.0.1:0", server_handler);
+    if (!listener) {
+        printf("FAIL: could not bind server\n");
+        return 1;
+    }
+    mg_set_protocol_http_websocket(listener);
+
+    char port[16];
+    mg_conn_addr_to_str(listener, port, sizeof(port), MG_SOCK_STRINGIFY_PORT);
+
+    test_batch_lines(&mgr, port);
+    test_batch_delay(&mgr, port);
+    test_gzip(&mgr, port);
+    test_retry(&mgr, port);
+    test_shutdown(&mgr, port);
+
+    mg_mgr_free(&mgr);
+
+    printf("\n====================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
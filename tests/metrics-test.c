@@ -0,0 +1,220 @@
+/** @file
+    Metrics registry test.
+
+    Checks histogram bucketing, latency percentiles and tracing, the
+    pipeline stage accounting and the OpenMetrics text rendering, including output larger than the writer
+    buffer and label escaping.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "metrics.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+typedef struct {
+    char text[65536];
+    size_t len;
+    int flushes;
+} sink_t;
+
+static void sink_flush(void *ctx, char const *buf, size_t len)
+{
+    sink_t *sink = ctx;
+    if (sink->len + len < sizeof(sink->text)) {
+        memcpy(sink->text + sink->len, buf, len);
+        sink->len += len;
+        sink->text[sink->len] = '\0';
+    }
+    sink->flushes++;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_histogram(void)
+{
+    printf("\n=== Histogram ===\n");
+
+    metrics_histogram_t h;
+    memset(&h, 0, sizeof(h));
+    metrics_histogram_observe(&h, 5000);       // 5 us
+    metrics_histogram_observe(&h, 10000);      // 10 us, on the first bound
+    metrics_histogram_observe(&h, 15000);      // 15 us
+    metrics_histogram_observe(&h, 1000000000); // 1 s
+
+    TEST_ASSERT(h.bucket[0] == 2, "values up to the first bound");
+    TEST_ASSERT(h.bucket[1] == 1, "value in the second bucket");
+    TEST_ASSERT(h.bucket[METRICS_HISTOGRAM_BUCKETS] == 1, "large value in +Inf");
+    TEST_ASSERT(h.count == 4 && h.sum > 1.00002 && h.sum < 1.00004, "count and sum");
+}
+
+static void test_latency(void)
+{
+    printf("\n=== Latency ===\n");
+
+    metrics_latency_t h;
+    memset(&h, 0, sizeof(h));
+    TEST_ASSERT(metrics_latency_percentile(&h, 0.5) == 0.0, "empty histogram");
+
+    // 1 ms to 100 ms in 1 ms steps
+    for (int i = 1; i <= 100; ++i)
+        metrics_latency_observe(&h, (uint64_t)i * 1000000);
+    double p50 = metrics_latency_percentile(&h, 0.5);
+    double p99 = metrics_latency_percentile(&h, 0.99);
+    TEST_ASSERT(h.count == 100 && h.max_ns == 100000000, "count and max");
+    TEST_ASSERT(p50 >= 0.050 && p50 < 0.050 * 1.13, "p50 within the bucket resolution");
+    TEST_ASSERT(p99 >= 0.099 && p99 <= 0.100, "p99 capped to the max");
+    TEST_ASSERT(metrics_latency_percentile(&h, 1.0) == 0.1, "p100 is the max");
+
+    metrics_latency_observe(&h, 500);          // below 1 us
+    metrics_latency_observe(&h, 1000000000000); // beyond the last octave
+    TEST_ASSERT(h.bucket[0] == 1 && h.bucket[METRICS_LATENCY_BUCKETS - 1] == 1, "out of range values clamped");
+
+    metrics_pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    metrics_frame_begin(&p);
+    TEST_ASSERT(metrics_trace_latency(&p, &h) == 0, "no trace without a pulse train");
+
+    // pulse train ended 1000 samples at 1 MHz (1 ms) before the frame
+    metrics_trace_burst(&p, 3, 12345, 1000, 1000000, 5000000);
+    TEST_ASSERT(p.trace.offset == 12345 && p.trace.burst_ns + 1000000 == p.frame_start_ns, "burst time from the sample clock");
+    TEST_ASSERT(p.trace.channel == 3 && p.trace.stream_ms == 4999, "stream time of the burst");
+    memset(&h, 0, sizeof(h));
+    TEST_ASSERT(metrics_trace_latency(&p, &h) > 0 && h.count == 1 && h.max_ns >= 1000000, "latency includes the time before the frame");
+
+    metrics_frame_begin(&p);
+    TEST_ASSERT(p.trace.burst_ns == 0, "trace cleared for each frame");
+}
+
+static void test_pipeline(void)
+{
+    printf("\n=== Pipeline ===\n");
+
+    metrics_pipeline_t p;
+    memset(&p, 0, sizeof(p));
+    metrics_frame_begin(&p);
+    uint64_t t = metrics_time_ns();
+    t = metrics_stage(&p, METRICS_STAGE_AM_DEMOD, t);
+    metrics_stage(&p, METRICS_STAGE_AM_DEMOD, t);
+    // a frame of 1 sample at 1 Hz lasts a second
+    metrics_frame_end(&p, 1, 1);
+
+    TEST_ASSERT(p.stage[METRICS_STAGE_FRAME].count == 1, "frame observed");
+    TEST_ASSERT(p.stage[METRICS_STAGE_AM_DEMOD].count == 1, "stage observed once per frame");
+    TEST_ASSERT(p.stage[METRICS_STAGE_CHANNELIZER].count == 0, "idle stage not observed");
+    TEST_ASSERT(p.realtime_margin > 0.9 && p.frames_late == 0, "faster than realtime");
+
+    // a frame of 1 sample at 1 GHz lasts a nanosecond
+    metrics_frame_begin(&p);
+    metrics_frame_end(&p, 1, 1000000000);
+    TEST_ASSERT(p.realtime_margin < 0.0 && p.frames_late == 1, "slower than realtime");
+
+    // outputs run inside the decoders and are taken out of the decode time
+    metrics_frame_begin(&p);
+    p.stage_ns[METRICS_STAGE_DECODE] = 5000;
+    p.stage_ns[METRICS_STAGE_OUTPUT] = 2000;
+    metrics_frame_end(&p, 1000, 1000);
+    TEST_ASSERT(p.stage_ns[METRICS_STAGE_DECODE] == 3000, "decode time excludes outputs");
+
+    metrics_profile_t *prof = &p.profile;
+    TEST_ASSERT(prof->blocks == 3 && prof->late_blocks == 1, "profile counts the blocks");
+    TEST_ASSERT(prof->stage_ns[METRICS_STAGE_OUTPUT] == 2000 && prof->input_seconds > 2.0, "profile sums the stages");
+    TEST_ASSERT(prof->max_load > 1.0, "profile keeps the highest load");
+
+    prof->enabled = 1;
+    metrics_profile_reset(prof);
+    TEST_ASSERT(prof->enabled && prof->blocks == 0 && prof->stage_ns[METRICS_STAGE_FRAME] == 0, "profile reset keeps the enabled state");
+}
+
+static void test_render(void)
+{
+    printf("\n=== Rendering ===\n");
+
+    static sink_t sink;
+    metrics_writer_t w;
+    metrics_writer_init(&w, sink_flush, &sink);
+
+    char labels[128] = "";
+    metrics_label(labels, sizeof(labels), "protocol", "42");
+    metrics_label(labels, sizeof(labels), "name", "Acme \"Quote\" \\ Sensor");
+    TEST_ASSERT(!strcmp(labels, "protocol=\"42\",name=\"Acme \\\"Quote\\\" \\\\ Sensor\""), "label escaping");
+
+    metrics_family(&w, "decoder_ok", METRICS_COUNTER, NULL, "Decodes.");
+    for (int i = 0; i < 500; ++i)
+        metrics_counter(&w, "decoder_ok", labels, i);
+
+    metrics_histogram_t h;
+    memset(&h, 0, sizeof(h));
+    metrics_histogram_observe(&h, 5000);
+    metrics_histogram_observe(&h, 30000);
+    metrics_family(&w, "stage_seconds", METRICS_HISTOGRAM, "seconds", NULL);
+    metrics_histogram(&w, "stage_seconds", "stage=\"demod\"", &h);
+    metrics_gauge(&w, "margin", NULL, 0.25);
+
+    metrics_latency_t lat;
+    memset(&lat, 0, sizeof(lat));
+    metrics_latency_observe(&lat, 2000000);
+    metrics_family(&w, "latency_seconds", METRICS_SUMMARY, "seconds", NULL);
+    metrics_summary(&w, "latency_seconds", "output=\"0\"", &lat);
+    metrics_finish(&w);
+
+    TEST_ASSERT(sink.flushes > 1, "output flushed incrementally");
+    TEST_ASSERT(strstr(sink.text, "# TYPE decoder_ok counter\n# HELP decoder_ok Decodes.\n"), "family header");
+    TEST_ASSERT(strstr(sink.text, "decoder_ok_total{protocol=\"42\",name=\"Acme \\\"Quote\\\" \\\\ Sensor\"} 499\n"), "last counter sample intact");
+    TEST_ASSERT(strstr(sink.text, "# UNIT stage_seconds seconds\n"), "unit line");
+    TEST_ASSERT(strstr(sink.text, "stage_seconds_bucket{stage=\"demod\",le=\"1e-05\"} 1\n")
+            && strstr(sink.text, "stage_seconds_bucket{stage=\"demod\",le=\"4e-05\"} 2\n")
+            && strstr(sink.text, "stage_seconds_bucket{stage=\"demod\",le=\"+Inf\"} 2\n"), "cumulative buckets");
+    TEST_ASSERT(strstr(sink.text, "stage_seconds_count{stage=\"demod\"} 2\n"), "histogram count");
+    TEST_ASSERT(strstr(sink.text, "\nmargin 0.25\n"), "gauge without labels");
+    TEST_ASSERT(strstr(sink.text, "# TYPE latency_seconds summary\n")
+            && strstr(sink.text, "latency_seconds{output=\"0\",quantile=\"0.99\"} 0.002\n")
+            && strstr(sink.text, "latency_seconds_count{output=\"0\"} 1\n"), "summary quantiles");
+    TEST_ASSERT(sink.len > 6 && !strcmp(sink.text + sink.len - 6, "# EOF\n"), "ends with EOF");
+}
+
+int main(void)
+{
+    printf("Metrics Test\n");
+    printf("============\n");
+
+    test_histogram();
+    test_latency();
+    test_pipeline();
+    test_render();
+
+    printf("\n============\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+/** @file
+    MQTT output test.
+
+    Runs the MQTT output against a minimal in-process broker on the
+    loopback interface and checks the published topics, the topic cache
+    and the QoS 1 in-flight window.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "output_mqtt.h"
+#include "mongoose.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Broker stand-in
+ *============================================================================*/
+
+#define BROKER_MAX_MSGS 64
+
+typedef struct {
+    struct mg_connection *client;
+    int connected;
+    int hold_acks;          /* withhold PUBACK for QoS 1 messages */
+    int num_msgs;
+    char topic[BROKER_MAX_MSGS][128];
+    char payload[BROKER_MAX_MSGS][256];
+    int qos[BROKER_MAX_MSGS];
+    int num_pending;        /* received QoS 1 messages not yet acked */
+    uint16_t pending[BROKER_MAX_MSGS];
+} broker_t;
+
+static broker_t broker;
+
+static void broker_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    struct mg_mqtt_message *msg = (struct mg_mqtt_message *)ev_data;
+
+    switch (ev) {
+    case MG_EV_MQTT_CONNECT:
+        broker.client = nc;
+        broker.connected = 1;
+        mg_mqtt_connack(nc, MG_EV_MQTT_CONNACK_ACCEPTED);
+        break;
+    case MG_EV_MQTT_PUBLISH:
+        if (broker.num_msgs < BROKER_MAX_MSGS) {
+            int i = broker.num_msgs++;
+            snprintf(broker.topic[i], sizeof(broker.topic[i]), "%.*s", (int)msg->topic.len, msg->topic.p);
+            snprintf(broker.payload[i], sizeof(broker.payload[i]), "%.*s", (int)msg->payload.len, msg->payload.p);
+            broker.qos[i] = msg->qos;
+        }
+        if (msg->qos == 1) {
+            if (broker.hold_acks)
+                broker.pending[broker.num_pending++] = msg->message_id;
+            else
+                mg_mqtt_puback(nc, msg->message_id);
+        }
+        break;
+    case MG_EV_CLOSE:
+        if (nc == broker.client) {
+            broker.client = NULL;
+            broker.connected = 0;
+        }
+        break;
+    }
+}
+
+static void broker_ack_pending(void)
+{
+    for (int i = 0; i < broker.num_pending; ++i)
+        mg_mqtt_puback(broker.client, broker.pending[i]);
+    broker.num_pending = 0;
+}
+
+static void poll_for(struct mg_mgr *mgr, int rounds)
+{
+    for (int i = 0; i < rounds; ++i)
+        mg_mgr_poll(mgr, 5);
+}
+
+static int count_topic(char const *topic)
+{
+    int n = 0;
+    for (int i = 0; i < broker.num_msgs; ++i)
+        if (!strcmp(broker.topic[i], topic))
+            n++;
+    return n;
+}
+
+static int count_prefix(char const *prefix)
+{
+    int n = 0;
+    for (int i = 0; i < broker.num_msgs; ++i)
+        if (!strncmp(broker.topic[i], prefix, strlen(prefix)))
+            n++;
+    return n;
+}
+
+static data_t *make_event(char const *model, int channel, int id, double temp)
+{
+    /* clang-format off */
+    return data_make(
+            "model",            "",             DATA_STRING, model,
+            "channel",          "",             DATA_INT,    channel,
+            "id",               "",             DATA_INT,    id,
+            "temperature_C",    "",             DATA_DOUBLE, temp,
+            NULL);
+    /* clang-format on */
+}
+
+static struct data_output *start_client(struct mg_mgr *mgr, char const *port, char const *opts)
+{
+    char param[256];
+    snprintf(param, sizeof(param), "mqtt://127.0.0.1:%s,%s", port, opts);
+
+    memset(&broker, 0, sizeof(broker));
+    struct data_output *output = data_output_mqtt_create(mgr, param, "mqtt-test");
+    for (int i = 0; i < 200 && !count_topic("t/avail"); ++i)
+        mg_mgr_poll(mgr, 5);
+    return output;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_qos0_topics(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== QoS 0 topics and topic cache ===\n");
+
+    struct data_output *output = start_client(mgr, port,
+            "availability=t/avail,events=t/events[/model],devices=t/dev[/model][/channel][/id]");
+    TEST_ASSERT(broker.connected, "client connected to broker");
+
+    /* same device twice (cache hit), then a different device (cache miss) */
+    for (int i = 0; i < 2; ++i) {
+        data_t *data = make_event("Acme-Temp", 1, 42, 21.5 + i);
+        data_output_print(output, data);
+        data_free(data);
+    }
+    data_t *data = make_event("Acme-Temp", 2, 7, 18.0);
+    data_output_print(output, data);
+    data_free(data);
+    poll_for(mgr, 20);
+
+    TEST_ASSERT(count_topic("t/events/Acme-Temp") == 3, "events topic expanded");
+    TEST_ASSERT(count_topic("t/dev/Acme-Temp/1/42/temperature_C") == 2, "devices topic reused from cache");
+    TEST_ASSERT(count_topic("t/dev/Acme-Temp/2/7/temperature_C") == 1, "devices topic for a new device");
+    TEST_ASSERT(count_topic("t/dev/Acme-Temp/1/42/id") == 2, "id field published");
+    TEST_ASSERT(count_topic("t/dev/Acme-Temp/1/42/model") == 0, "model field not published");
+
+    int found = 0;
+    for (int i = 0; i < broker.num_msgs; ++i)
+        if (!strcmp(broker.topic[i], "t/dev/Acme-Temp/2/7/temperature_C") && !strcmp(broker.payload[i], "18.0"))
+            found = 1;
+    TEST_ASSERT(found, "devices payload formatted");
+
+    data_output_free(output);
+    poll_for(mgr, 10);
+}
+
+static void test_qos1_window(struct mg_mgr *mgr, char const *port)
+{
+    printf("\n=== QoS 1 in-flight window ===\n");
+
+    struct data_output *output = start_client(mgr, port,
+            "qos=1,inflight=2,availability=t/avail,events=t/events");
+    TEST_ASSERT(broker.connected, "client connected to broker");
+
+    broker.hold_acks = 1;
+    for (int i = 0; i < 5; ++i) {
+        data_t *data = make_event("Acme-Temp", 1, i, 20.0);
+        data_output_print(output, data);
+        data_free(data);
+    }
+    poll_for(mgr, 20);
+    TEST_ASSERT(count_prefix("t/events") == 2, "only the in-flight window is sent");
+
+    int rounds = 0;
+    while (broker.num_pending && rounds++ < 10) {
+        broker_ack_pending();
+        poll_for(mgr, 20);
+        TEST_ASSERT(broker.num_pending <= 2, "window limit held after acks");
+    }
+    TEST_ASSERT(count_prefix("t/events") == 5, "all messages delivered after acks");
+
+    int qos1 = 1;
+    for (int i = 0; i < broker.num_msgs; ++i)
+        if (!strncmp(broker.topic[i], "t/events", 8) && broker.qos[i] != 1)
+            qos1 = 0;
+    TEST_ASSERT(qos1, "messages published with QoS 1");
+
+    data_output_free(output);
+    poll_for(mgr, 10);
+}
+
+int main(void)
+{
+    printf("MQTT Output Test\n");
+    printf("================\n");
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+
+    struct mg_connection *listener = mg_bind(&mgr, "127.0.0.1:0", broker_handler);
+    if (!listener) {
+        printf("FAIL: could not bind broker\n");
+        return 1;
+    }
+    mg_set_protocol_mqtt(listener);
+
+    char port[16];
+    mg_conn_addr_to_str(listener, port, sizeof(port), MG_SOCK_STRINGIFY_PORT);
+
+    test_qos0_topics(&mgr, port);
+    test_qos1_window(&mgr, port);
+
+    mg_mgr_free(&mgr);
+
+    printf("\n================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/** @file
+    Replay speed governor test.
+
+    Drives the governor with a simulated clock: each buffer is delivered
+    at its due time or as soon as the previous one is done, and takes a
+    fixed processing time, so the fastest sustainable speed is known.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "replay.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+#define BLOCK_LEN 0.5 // seconds of signal per buffer, a CU8 buffer at 250 kHz
+
+/// Replay @p blocks buffers taking @p cost_ns each, starting at block @p first.
+static uint64_t simulate(replay_t *r, uint64_t now, unsigned first, unsigned blocks, uint64_t cost_ns, int *changes)
+{
+    for (unsigned i = first; i < first + blocks; ++i) {
+        double end = (i + 1) * BLOCK_LEN;
+        uint64_t due = replay_due(r, end);
+        if (now < due)
+            now = due;
+        uint64_t begin = now;
+        now += cost_ns;
+        if (replay_block(r, end, BLOCK_LEN, begin, now) && changes)
+            (*changes)++;
+    }
+    return now;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_schedule(void)
+{
+    printf("\n--- Schedule ---\n");
+    replay_t r;
+
+    replay_init(&r, REPLAY_FIXED, 2.0, 0, 0.0);
+    replay_start(&r, 1000);
+    TEST_ASSERT(replay_due(&r, 0.0) == 1000, "position 0 due at the start");
+    TEST_ASSERT(replay_due(&r, 1.0) == 1000 + 500000000, "1 s of signal due after 0.5 s at 2x");
+    TEST_ASSERT(replay_due(&r, 3600.0) == 1000 + 1800000000000ull, "no drift after an hour of signal");
+
+    replay_init(&r, REPLAY_FIXED, 0.5, 0, 0.0);
+    replay_start(&r, 0);
+    TEST_ASSERT(replay_due(&r, 1.0) == 2000000000, "1 s of signal due after 2 s at 0.5x");
+
+    replay_init(&r, REPLAY_MAX, 1.0, 0, 0.0);
+    replay_start(&r, 42);
+    TEST_ASSERT(replay_due(&r, 100.0) == 42, "as fast as possible is always due");
+    TEST_ASSERT(replay_block(&r, 1.0, BLOCK_LEN, 42, 1000000042) == 0 && r.peak_queue == 0.0, "as fast as possible is not measured");
+}
+
+static void test_fixed(void)
+{
+    printf("\n--- Fixed speed ---\n");
+    replay_t r;
+    int changes = 0;
+
+    // 0.1 s per 0.5 s buffer: 5x is the limit
+    replay_init(&r, REPLAY_FIXED, 4.0, 0, 0.0);
+    replay_start(&r, 0);
+    simulate(&r, 0, 0, 64, 100000000, &changes);
+    TEST_ASSERT(changes == 0 && r.speed == 4.0, "fixed speed is kept");
+    TEST_ASSERT(r.peak_queue == 0.0, "no queue below the limit");
+    TEST_ASSERT(r.peak_latency > 0.099 && r.peak_latency < 0.101, "latency is the processing time");
+
+    replay_init(&r, REPLAY_FIXED, 10.0, 0, 0.0);
+    replay_start(&r, 0);
+    simulate(&r, 0, 0, 11, 100000000, NULL);
+    // each buffer starts 0.05 s later than the one before, a buffer is 0.05 s at 10x
+    TEST_ASSERT(r.peak_queue > 9.99 && r.peak_queue < 10.01, "queue grows one buffer per buffer at twice the limit");
+    TEST_ASSERT(r.peak_latency > 0.599 && r.peak_latency < 0.601, "latency includes the queue");
+}
+
+static void test_auto(void)
+{
+    printf("\n--- Auto speed ---\n");
+    replay_t r;
+    int changes = 0;
+
+    // 0.1 s per 0.5 s buffer: 5x is the limit. A window of 16 buffers may
+    // pass up to 4 / 15 faster than that, the backlog kept at a settled
+    // speed fails it later.
+    replay_init(&r, REPLAY_AUTO, 1.0, REPLAY_AUTO_QUEUE, 0.0);
+    replay_start(&r, 0);
+    uint64_t now = simulate(&r, 0, 0, 16 * 64, 100000000, &changes);
+    TEST_ASSERT(replay_settled(&r), "auto speed settles");
+    TEST_ASSERT(r.passed <= 5.0 && r.passed * REPLAY_AUTO_RESOLUTION >= 5.0, "fastest passed speed at the limit");
+    TEST_ASSERT(r.failed > 5.0 && r.failed <= r.passed * REPLAY_AUTO_RESOLUTION, "slowest failed speed just above");
+    TEST_ASSERT(r.speed == r.passed, "replays at the fastest passed speed");
+    TEST_ASSERT(changes > 2 && changes < 32, "bounded number of speed changes");
+    double speed = r.speed;
+
+    // the next input is twice as expensive, the search starts again below
+    replay_start(&r, now);
+    simulate(&r, now, 0, 16 * 64, 200000000, NULL);
+    TEST_ASSERT(replay_settled(&r) && r.passed <= 2.5 && r.passed * REPLAY_AUTO_RESOLUTION >= 2.5, "slower input settles lower");
+
+    // the same input gives the same speeds
+    replay_t r2;
+    int changes2 = 0;
+    replay_init(&r2, REPLAY_AUTO, 1.0, REPLAY_AUTO_QUEUE, 0.0);
+    replay_start(&r2, 0);
+    simulate(&r2, 0, 0, 16 * 64, 100000000, &changes2);
+    TEST_ASSERT(changes2 == changes && r2.speed == speed, "same ramp on the same input");
+
+    // a latency target of 0.15 s: a window fails once 0.05 s behind
+    replay_init(&r, REPLAY_AUTO, 1.0, 1000.0, 0.15);
+    replay_start(&r, 0);
+    simulate(&r, 0, 0, 16 * 64, 100000000, NULL);
+    TEST_ASSERT(replay_settled(&r), "latency target settles");
+    TEST_ASSERT(r.passed <= 5.0 && r.passed * REPLAY_AUTO_RESOLUTION >= 5.0, "latency target settles at the limit");
+
+    // processing slower than the minimum speed
+    replay_init(&r, REPLAY_AUTO, 1.0, REPLAY_AUTO_QUEUE, 0.0);
+    replay_start(&r, 0);
+    simulate(&r, 0, 0, 16 * 16, 60000000000ull, NULL);
+    TEST_ASSERT(r.passed == 0.0 && r.speed == REPLAY_SPEED_MIN, "stops slowing down at the minimum");
+}
+
+int main(void)
+{
+    printf("Replay Governor Test\n");
+    printf("====================\n");
+
+    test_schedule();
+    test_fixed();
+    test_auto();
+
+    printf("\n====================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
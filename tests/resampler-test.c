@@ -32,6 +32,7 @@
 
 /* Include the actual resampler implementation from the shared header */
 #include "cf32_resampler.h"
+#include "cpu_detect.h"
 #include "build_info.h"
 
 /*============================================================================
@@ -1070,6 +1071,698 @@ static void test_zero_rates(void)
     TEST_ASSERT(ret == -1, "Reject both rates zero");
 }
 
+/*============================================================================
+ * ISA Variant Tests
+ *============================================================================*/
+
+typedef struct {
+    const char *name;
+    cf32_resampler_process_fn_t fn;
+    cf32_resampler_process_fn_t arbitrary;
+    cf32_halfband_process_fn_t halfband;
+    int runnable;
+} isa_variant_t;
+
+/* The variants this CPU can run, the baseline always */
+static int isa_variants(isa_variant_t *v)
+{
+    enum cpu_isa_level isa = cpu_detect_isa();
+    int n = 0;
+    v[n++] = (isa_variant_t){"baseline", cf32_resampler_process_sse2, cf32_resampler_process_arb_sse2,
+                             cf32_halfband_process_sse2, 1};
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    v[n++] = (isa_variant_t){"AVX2+FMA", cf32_resampler_process_avx2, cf32_resampler_process_arb_avx2,
+                             cf32_halfband_process_avx2,
+                             isa == CPU_ISA_AVX2 || isa == CPU_ISA_AVX512};
+    v[n++] = (isa_variant_t){"AVX-512", cf32_resampler_process_avx512, cf32_resampler_process_arb_avx512,
+                             cf32_halfband_process_avx512,
+                             isa == CPU_ISA_AVX512};
+#else
+    v[n++] = (isa_variant_t){"NEON", cf32_resampler_process_neon, cf32_resampler_process_arb_neon,
+                             cf32_halfband_process_neon,
+                             isa == CPU_ISA_NEON || isa == CPU_ISA_SVE};
+    v[n++] = (isa_variant_t){"SVE", cf32_resampler_process_sve, cf32_resampler_process_arb_sve,
+                             cf32_halfband_process_sve, isa == CPU_ISA_SVE};
+#endif
+    return n;
+}
+
+/* Scalar reference: the circular history and backwards MAC of the
+ * original implementation, on the same prototype filter */
+typedef struct {
+    int L, M, T, phase, write_pos;
+    float *branches;  /* [L][T], tap k on the k-th newest sample */
+    float hist_i[64], hist_q[64];
+} ref_resampler_t;
+
+static int ref_init(ref_resampler_t *r, uint32_t in_rate, uint32_t out_rate)
+{
+    memset(r, 0, sizeof(*r));
+    int g = cf32_resampler_gcd((int)out_rate, (int)in_rate);
+    r->L = (int)out_rate / g;
+    r->M = (int)in_rate / g;
+    r->T = RESAMPLER_TAPS_PER_BRANCH;
+    int num_taps = r->T * r->L;
+    float *proto = (float *)malloc((size_t)num_taps * sizeof(float));
+    r->branches = (float *)calloc((size_t)num_taps, sizeof(float));
+    if (!proto || !r->branches) {
+        free(proto);
+        free(r->branches);
+        return -1;
+    }
+    cf32_resampler_design_filter(proto, num_taps, r->L > r->M ? r->L : r->M);
+    for (int m = 0; m < r->L; m++)
+        for (int k = 0; k < r->T; k++)
+            r->branches[m * r->T + k] = proto[m + k * r->L] * (float)r->L;
+    free(proto);
+    return 0;
+}
+
+static int ref_process(ref_resampler_t *r, const float *in, int n_in, float *out, int max_out)
+{
+    int out_idx = 0;
+    for (int n = 0; n < n_in && out_idx < max_out; n++) {
+        r->hist_i[r->write_pos & 63] = in[2 * n];
+        r->hist_q[r->write_pos & 63] = in[2 * n + 1];
+        r->write_pos++;
+        while (r->phase < r->L && out_idx < max_out) {
+            const float *b = r->branches + r->phase * r->T;
+            float acc_i = 0.0f, acc_q = 0.0f;
+            for (int k = 0; k < r->T; k++) {
+                acc_i += r->hist_i[(r->write_pos - 1 - k) & 63] * b[k];
+                acc_q += r->hist_q[(r->write_pos - 1 - k) & 63] * b[k];
+            }
+            out[2 * out_idx] = acc_i;
+            out[2 * out_idx + 1] = acc_q;
+            out_idx++;
+            r->phase += r->M;
+        }
+        r->phase -= r->L;
+    }
+    return out_idx;
+}
+
+/* Every variant matches the scalar reference, fed in uneven blocks that
+ * cross the history moves, within float reordering error */
+static void test_isa_bit_closeness(void)
+{
+    printf("\n=== ISA Variant Bit-Closeness ===\n");
+    printf("INFO: Dispatched ISA: %s\n", cf32_resampler_isa_info());
+
+    static const uint32_t rates[][2] = {
+        {TEST_RATE_HYDRASDR, TEST_RATE_TARGET},
+        {TEST_RATE_AUDIO_IN, TEST_RATE_AUDIO_OUT},
+        {TEST_RATE_TARGET, TEST_RATE_HYDRASDR},
+        {TEST_RATE_TARGET_HF, 1024000},
+    };
+    static const int blocks[] = {1, 7, 31, 32, 33, 1000, 4095, 4096, 4097, 10000};
+    const int total = 40000;
+    isa_variant_t variants[3];
+    int num_variants = isa_variants(variants);
+    char msg[128];
+
+    float *input = (float *)malloc((size_t)total * 2 * sizeof(float));
+    float *ref_out = (float *)malloc((size_t)total * 2 * 2 * sizeof(float));
+    if (!input || !ref_out) {
+        printf("FAIL: Failed to allocate bit-closeness buffers\n");
+        free(input);
+        free(ref_out);
+        return;
+    }
+    /* Noise plus two tones, full scale */
+    uint32_t lcg = 12345;
+    for (int i = 0; i < total; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        float noise = ((float)(lcg >> 8) / 16777216.0f - 0.5f) * 0.2f;
+        input[2 * i] = 0.5f * cosf(0.05f * (float)i) + 0.3f * cosf(1.3f * (float)i) + noise;
+        input[2 * i + 1] = 0.5f * sinf(0.05f * (float)i) - 0.3f * sinf(1.3f * (float)i) - noise;
+    }
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        ref_resampler_t ref;
+        if (ref_init(&ref, rates[r][0], rates[r][1]) != 0)
+            continue;
+        int ref_n = ref_process(&ref, input, total, ref_out, total * 2);
+        free(ref.branches);
+
+        for (int v = 0; v < num_variants; v++) {
+            if (!variants[v].runnable) {
+                printf("INFO: %s not supported by this CPU, skipped\n", variants[v].name);
+                continue;
+            }
+            cf32_resampler_t res;
+            cf32_resampler_init(&res, rates[r][0], rates[r][1], 10000);
+            res.process = variants[v].fn;
+
+            double max_err = 0.0;
+            int out_n = 0;
+            for (int n = 0, b = 0; n < total; b++) {
+                int len = blocks[b % (int)(sizeof(blocks) / sizeof(blocks[0]))];
+                if (len > total - n)
+                    len = total - n;
+                float *out;
+                int got = cf32_resampler_process(&res, input + 2 * n, len, &out, (int)res.output_buf_size);
+                for (int i = 0; i < got && out_n + i < ref_n; i++) {
+                    double ei = fabs(out[2 * i] - ref_out[2 * (out_n + i)]);
+                    double eq = fabs(out[2 * i + 1] - ref_out[2 * (out_n + i) + 1]);
+                    if (ei > max_err)
+                        max_err = ei;
+                    if (eq > max_err)
+                        max_err = eq;
+                }
+                out_n += got;
+                n += len;
+            }
+            snprintf(msg, sizeof(msg), "%s %u->%u Hz matches reference (%d samples, max error %.2e)",
+                     variants[v].name, rates[r][0], rates[r][1], out_n, max_err);
+            TEST_ASSERT(out_n == ref_n && max_err < 1e-5, msg);
+            cf32_resampler_free(&res);
+        }
+    }
+
+    /* An output limit stops at the same sample as the reference */
+    {
+        ref_resampler_t ref;
+        cf32_resampler_t res;
+        float *out;
+        ref_init(&ref, TEST_RATE_HYDRASDR, TEST_RATE_TARGET);
+        cf32_resampler_init(&res, TEST_RATE_HYDRASDR, TEST_RATE_TARGET, 10000);
+        int ref_n = ref_process(&ref, input, 5000, ref_out, 1001);
+        int got = cf32_resampler_process(&res, input, 5000, &out, 1001);
+        ref_n += ref_process(&ref, input + 10000, 3000, ref_out + 2 * ref_n, total);
+        got += cf32_resampler_process(&res, input + 10000, 3000, &out, (int)res.output_buf_size);
+        TEST_ASSERT(got == ref_n && fabsf(out[0] - ref_out[2 * 1001]) < 1e-5f,
+                    "Output limit keeps the state of the reference");
+        free(ref.branches);
+        cf32_resampler_free(&res);
+    }
+
+    /* Reset restores the state after init */
+    {
+        cf32_resampler_t res;
+        float *out;
+        cf32_resampler_init(&res, TEST_RATE_HYDRASDR, TEST_RATE_TARGET, 10000);
+        int n1 = cf32_resampler_process(&res, input, 10000, &out, (int)res.output_buf_size);
+        float first = out[100];
+        cf32_resampler_process(&res, input + 20000, 7000, &out, (int)res.output_buf_size);
+        cf32_resampler_reset(&res);
+        int n2 = cf32_resampler_process(&res, input, 10000, &out, (int)res.output_buf_size);
+        TEST_ASSERT(n1 == n2 && out[100] == first, "Reset restores the initial state");
+        cf32_resampler_free(&res);
+    }
+
+    free(input);
+    free(ref_out);
+}
+
+/*============================================================================
+ * Half-Band Chain Tests
+ *============================================================================*/
+
+/* The planner splits large decimations, small ratios stay single stage */
+static void test_plan(void)
+{
+    printf("\n=== Resampler Planner ===\n");
+
+    static const uint32_t rates[][2] = {
+        {TEST_RATE_HYDRASDR, TEST_RATE_TARGET},
+        {TEST_RATE_TARGET, TEST_RATE_HYDRASDR},
+        {1000000, TEST_RATE_TARGET},
+        {2500000, TEST_RATE_TARGET},
+        {10000000, TEST_RATE_TARGET},
+        {20000000, TEST_RATE_TARGET_HF},
+        {2500001, TEST_RATE_TARGET},
+    };
+    cf32_resampler_plan_t plan;
+    char msg[128];
+
+    printf("  %-20s %3s %-18s %16s %10s %10s\n", "Rate", "K", "Half-band taps", "L/M", "MACs/out", "1 stage");
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        if (cf32_resampler_plan(rates[r][0], rates[r][1], &plan) != 0) {
+            snprintf(msg, sizeof(msg), "Plan %u->%u", rates[r][0], rates[r][1]);
+            TEST_ASSERT(0, msg);
+            continue;
+        }
+        char taps[64] = "-";
+        for (int k = 0, len = 0; k < plan.num_halfbands; k++)
+            len += snprintf(taps + len, sizeof(taps) - (size_t)len, "%s%d", k ? "," : "", plan.halfband_taps[k]);
+        char rate[32], lm[32];
+        snprintf(rate, sizeof(rate), "%u->%u", rates[r][0], rates[r][1]);
+        snprintf(lm, sizeof(lm), "%d/%d", plan.up_factor, plan.down_factor);
+        printf("  %-20s %3d %-18s %16s %10.1f %10.1f\n", rate, plan.num_halfbands, taps, lm,
+               plan.macs_per_output, plan.single_stage_macs);
+    }
+
+    cf32_resampler_plan(TEST_RATE_HYDRASDR, TEST_RATE_TARGET, &plan);
+    TEST_ASSERT(plan.num_halfbands == 0 && plan.taps_per_branch == RESAMPLER_TAPS_PER_BRANCH
+                && plan.macs_per_output == RESAMPLER_TAPS_PER_BRANCH,
+                "312500->250000 stays a single 32-tap polyphase stage");
+
+    cf32_resampler_plan(10000000, TEST_RATE_TARGET, &plan);
+    TEST_ASSERT(plan.num_halfbands >= 3 && plan.macs_per_output * 2.5 < plan.single_stage_macs,
+                "10M->250k uses half-bands at less than 40% of the single stage MACs");
+    TEST_ASSERT((plan.polyphase_rate << plan.num_halfbands) == 10000000 && plan.polyphase_rate > TEST_RATE_TARGET,
+                "Half-bands halve down to the polyphase rate");
+
+    int lengths_ok = 1;
+    for (int k = 0; k < plan.num_halfbands; k++)
+        lengths_ok &= plan.halfband_taps[k] % 4 == 3;
+    TEST_ASSERT(lengths_ok, "Half-band lengths are 4j+3");
+
+    cf32_resampler_plan(2500001, TEST_RATE_TARGET, &plan);
+    TEST_ASSERT(plan.num_halfbands == 0 && plan.macs_per_output == plan.single_stage_macs,
+                "Odd input rate cannot halve, single stage");
+
+    TEST_ASSERT(cf32_resampler_plan(TEST_RATE_TARGET, TEST_RATE_TARGET, &plan) == -1,
+                "Equal rates have no plan");
+}
+
+/* The half-band design: zero even taps, unity DC gain, symmetric */
+static void test_halfband_design(void)
+{
+    printf("\n=== Half-Band Design ===\n");
+
+    const int num_taps = 23;
+    const int center = (num_taps - 1) / 2;
+    float coeffs[23];
+    cf32_resampler_design_halfband(coeffs, num_taps);
+
+    int zeros = 1;
+    double sum = 0.0, asym = 0.0;
+    for (int i = 0; i < num_taps; i++) {
+        if (i != center && (i - center) % 2 == 0 && coeffs[i] != 0.0f)
+            zeros = 0;
+        sum += coeffs[i];
+        if (fabs(coeffs[i] - coeffs[num_taps - 1 - i]) > asym)
+            asym = fabs(coeffs[i] - coeffs[num_taps - 1 - i]);
+    }
+    TEST_ASSERT(zeros, "Every other tap is zero");
+    TEST_ASSERT_NEAR(sum, 1.0, 1e-6, "Half-band DC gain = 1.0");
+    TEST_ASSERT_NEAR(coeffs[center], 0.5, 0.01, "Center tap is 1/2");
+    TEST_ASSERT(asym < 1e-7, "Half-band is symmetric");
+    TEST_ASSERT_NEAR(compute_freq_response(coeffs, num_taps, 0.25), 0.5, 0.01,
+                     "Half gain at a quarter of the rate");
+}
+
+/* Amplitude of the tone at f Hz in the output, as a fraction of the input */
+static double tone_level(const float *out, int n, double f, uint32_t rate)
+{
+    double re = 0.0, im = 0.0;
+    for (int i = 0; i < n; i++) {
+        double ph = -2.0 * M_PI * f * i / rate;
+        re += out[2 * i] * cos(ph) - out[2 * i + 1] * sin(ph);
+        im += out[2 * i] * sin(ph) + out[2 * i + 1] * cos(ph);
+    }
+    return sqrt(re * re + im * im) / n;
+}
+
+/* 10M->250k through the chain: ratio, passband, and aliases suppressed */
+static void test_halfband_chain(void)
+{
+    printf("\n=== Half-Band Chain ===\n");
+
+    const uint32_t in_rate = 10000000;
+    const uint32_t out_rate = TEST_RATE_TARGET;
+    const int num_in = 400000;
+    const int skip = 1000;  /* Filter settling, in outputs */
+    /* A passband tone and tones that alias onto 30 kHz at each stage */
+    static const double tones[] = {30000.0, 2530000.0, 4780000.0, 1280000.0, 280000.0};
+    char msg[128];
+
+    float *input = (float *)malloc((size_t)num_in * 2 * sizeof(float));
+    if (!input) {
+        printf("FAIL: Failed to allocate chain input buffer\n");
+        test_count++;
+        return;
+    }
+
+    for (size_t t = 0; t < sizeof(tones) / sizeof(tones[0]); t++) {
+        for (int i = 0; i < num_in; i++) {
+            double ph = 2.0 * M_PI * tones[t] * i / in_rate;
+            input[2 * i] = (float)cos(ph);
+            input[2 * i + 1] = (float)sin(ph);
+        }
+
+        cf32_resampler_t res;
+        float *out;
+        if (cf32_resampler_init(&res, in_rate, out_rate, 65536) != 0) {
+            TEST_ASSERT(0, "Init 10M->250k");
+            break;
+        }
+        float *all = (float *)malloc((size_t)num_in * sizeof(float));
+        if (!all) {
+            cf32_resampler_free(&res);
+            break;
+        }
+        int total = 0;
+        /* Odd blocks keep a pending sample in the half-bands */
+        for (int n = 0, len; n < num_in; n += len) {
+            len = num_in - n < 65535 ? num_in - n : 65535;
+            int got = cf32_resampler_process(&res, input + 2 * (size_t)n, len, &out, (int)res.output_buf_size);
+            memcpy(all + 2 * (size_t)total, out, (size_t)got * 2 * sizeof(float));
+            total += got;
+        }
+
+        double level = tone_level(all + 2 * skip, total - skip, 30000.0, out_rate);
+        if (t == 0) {
+            snprintf(msg, sizeof(msg), "%d in -> %d out (ratio 1/40)", num_in, total);
+            TEST_ASSERT(abs(total - num_in / 40) <= 1, msg);
+            snprintf(msg, sizeof(msg), "30 kHz passband tone level %.4f", level);
+            TEST_ASSERT(fabs(level - 1.0) < 0.01, msg);
+        } else {
+            double db = 20.0 * log10(level + 1e-12);
+            snprintf(msg, sizeof(msg), "%.0f kHz alias suppressed (%.1f dB)", tones[t] / 1000.0, db);
+            TEST_ASSERT(db < -RESAMPLER_STOPBAND_DB + 6.0, msg);
+        }
+        free(all);
+        cf32_resampler_free(&res);
+    }
+    free(input);
+}
+
+/* Every half-band variant matches a direct convolution with the full
+ * filter, fed in odd and even blocks across the history moves */
+static void test_halfband_isa_closeness(void)
+{
+    printf("\n=== Half-Band ISA Bit-Closeness ===\n");
+
+    static const int blocks[] = {1, 2, 3, 7, 8191, 4096, 33, 10000, 9};
+    const int total = 40000;
+    isa_variant_t variants[3];
+    int num_variants = isa_variants(variants);
+    char msg[128];
+
+    cf32_resampler_t res;
+    if (cf32_resampler_init(&res, 10000000, TEST_RATE_TARGET, 10000) != 0 || res.plan.num_halfbands < 2) {
+        TEST_ASSERT(0, "Init a half-band chain");
+        cf32_resampler_free(&res);
+        return;
+    }
+    const int num_taps = res.halfbands[1].num_taps;
+    cf32_resampler_free(&res);
+
+    float *h = (float *)malloc((size_t)num_taps * sizeof(float));
+    float *input = (float *)malloc((size_t)total * 2 * sizeof(float));
+    float *ref_out = (float *)malloc((size_t)total * sizeof(float));
+    if (!h || !input || !ref_out) {
+        printf("FAIL: Failed to allocate half-band buffers\n");
+        test_count++;
+        free(h);
+        free(input);
+        free(ref_out);
+        return;
+    }
+    cf32_resampler_design_halfband(h, num_taps);
+
+    uint32_t lcg = 4321;
+    for (int i = 0; i < 2 * total; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        input[i] = (float)(lcg >> 8) / 16777216.0f - 0.5f;
+    }
+    /* y[n] = sum h[k] x[2n + 1 - k], zeros before the start */
+    for (int n = 0; n < total / 2; n++) {
+        double acc_i = 0.0, acc_q = 0.0;
+        for (int k = 0; k < num_taps && k <= 2 * n + 1; k++) {
+            acc_i += h[k] * input[2 * (2 * n + 1 - k)];
+            acc_q += h[k] * input[2 * (2 * n + 1 - k) + 1];
+        }
+        ref_out[2 * n] = (float)acc_i;
+        ref_out[2 * n + 1] = (float)acc_q;
+    }
+
+    for (int v = 0; v < num_variants; v++) {
+        if (!variants[v].runnable)
+            continue;
+        cf32_resampler_init(&res, 10000000, TEST_RATE_TARGET, 10000);
+        cf32_halfband_t *hb = &res.halfbands[1];
+
+        double max_err = 0.0;
+        int out_n = 0;
+        for (int n = 0, b = 0; n < total; b++) {
+            int len = blocks[b % (int)(sizeof(blocks) / sizeof(blocks[0]))];
+            if (len > total - n)
+                len = total - n;
+            if (len > hb->max_input)
+                len = hb->max_input;
+            int got = variants[v].halfband(hb, input + 2 * n, len);
+            for (int i = 0; i < 2 * got; i++) {
+                double e = fabs(hb->output_buf[i] - ref_out[2 * out_n + i]);
+                if (e > max_err)
+                    max_err = e;
+            }
+            out_n += got;
+            n += len;
+        }
+        snprintf(msg, sizeof(msg), "%s half-band of %d taps matches reference (%d samples, max error %.2e)",
+                 variants[v].name, num_taps, out_n, max_err);
+        TEST_ASSERT(out_n == total / 2 && max_err < 1e-5, msg);
+        cf32_resampler_free(&res);
+    }
+
+    free(h);
+    free(input);
+    free(ref_out);
+}
+
+/*============================================================================
+ * Arbitrary Ratio Tests
+ *============================================================================*/
+
+/* Tone to noise and distortion ratio (dB) of a complex tone at f Hz */
+static double tone_snr(const float *out, int n, double f, double rate)
+{
+    double re = 0.0, im = 0.0, power = 0.0;
+    for (int i = 0; i < n; i++) {
+        double ph = -2.0 * M_PI * f * i / rate;
+        re += out[2 * i] * cos(ph) - out[2 * i + 1] * sin(ph);
+        im += out[2 * i] * sin(ph) + out[2 * i + 1] * cos(ph);
+        power += out[2 * i] * out[2 * i] + out[2 * i + 1] * out[2 * i + 1];
+    }
+    double tone = (re * re + im * im) / ((double)n * n);
+    double rest = power / n - tone;
+    return 10.0 * log10(tone / (rest > 1e-12 ? rest : 1e-12));
+}
+
+/* Resample a unit tone of num_in samples in blocks, returns the output count */
+static int resample_tone(cf32_resampler_t *res, double f, double in_rate, int num_in, float *all, int max_all)
+{
+    float block[2 * 1000];
+    int total = 0;
+    for (int n = 0; n < num_in; n += 1000) {
+        int len = num_in - n < 1000 ? num_in - n : 1000;
+        for (int i = 0; i < len; i++) {
+            double ph = 2.0 * M_PI * f * (n + i) / in_rate;
+            block[2 * i] = (float)cos(ph);
+            block[2 * i + 1] = (float)sin(ph);
+        }
+        float *out;
+        int got = cf32_resampler_process(res, block, len, &out, (int)res->output_buf_size);
+        if (got > max_all - total)
+            got = max_all - total;
+        memcpy(all + 2 * (size_t)total, out, (size_t)got * 2 * sizeof(float));
+        total += got;
+    }
+    return total;
+}
+
+/* Rates the rational bank cannot take, with a fixed size bank */
+static void test_arbitrary_ratio(void)
+{
+    printf("\n=== Arbitrary Ratio ===\n");
+
+    static const uint32_t rates[][2] = {
+        {300000017, 300000007},  /* Coprime, L * 32 overflows */
+        {TEST_RATE_HYDRASDR, 250007},
+        {1000003, TEST_RATE_TARGET},
+        {TEST_RATE_AUDIO_IN, TEST_RATE_AUDIO_OUT},
+        {TEST_RATE_TARGET, 312499},
+    };
+    const int num_in = 200000;
+    char msg[160];
+
+    float *all = (float *)malloc((size_t)num_in * 2 * 2 * sizeof(float));
+    if (!all) {
+        printf("FAIL: Failed to allocate arbitrary ratio buffer\n");
+        test_count++;
+        return;
+    }
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        uint32_t in_rate = rates[r][0];
+        uint32_t out_rate = rates[r][1];
+        cf32_resampler_t res;
+        if (cf32_resampler_init_arbitrary(&res, in_rate, out_rate, 1000) != 0) {
+            snprintf(msg, sizeof(msg), "Init arbitrary %u->%u", in_rate, out_rate);
+            TEST_ASSERT(0, msg);
+            continue;
+        }
+        /* A tone at a tenth of the lower rate, about 10 kHz in the small cases */
+        double f = 0.1 * (in_rate < out_rate ? in_rate : out_rate);
+        int got = resample_tone(&res, f, in_rate, num_in, all, num_in * 2);
+        double expected = (double)num_in * out_rate / in_rate;
+        double snr = tone_snr(all + 2 * 500, got - 500, f, out_rate);
+        snprintf(msg, sizeof(msg), "%u->%u: %d out (expected %.1f), %d taps, %.1f dB SNR", in_rate, out_rate,
+                 got, expected, res.num_taps, snr);
+        TEST_ASSERT(fabs(got - expected) <= 2.0 && res.num_taps <= RESAMPLER_ARB_PHASES * res.taps_per_branch
+                    && snr > 55.0, msg);
+        cf32_resampler_free(&res);
+    }
+
+    cf32_resampler_t res;
+    TEST_ASSERT(cf32_resampler_init(&res, 300000017, 300000007, 1000) == -1
+                && cf32_resampler_init_arbitrary(&res, 300000017, 300000007, 1000) == 0,
+                "Coprime rates rejected by the rational bank, taken by the arbitrary one");
+    cf32_resampler_free(&res);
+
+    cf32_resampler_init_arbitrary(&res, 10000000, TEST_RATE_TARGET, 1000);
+    TEST_ASSERT(res.plan.num_halfbands > 0 && res.plan.arbitrary, "Arbitrary ratio after half-bands");
+    cf32_resampler_free(&res);
+
+    cf32_resampler_init_arbitrary(&res, TEST_RATE_TARGET, TEST_RATE_TARGET, 1000);
+    TEST_ASSERT(res.initialized && res.arbitrary, "Equal rates resample, ready for a trim");
+    cf32_resampler_free(&res);
+
+    free(all);
+}
+
+/* A runtime trim moves the ratio without a glitch in a tone */
+static void test_arbitrary_trim(void)
+{
+    printf("\n=== Arbitrary Ratio Trim ===\n");
+
+    const double in_rate = TEST_RATE_HYDRASDR;
+    const double out_rate = TEST_RATE_TARGET;
+    const double f = 20000.0;
+    const int num_in = 100000;
+    char msg[160];
+
+    cf32_resampler_t res;
+    cf32_resampler_init_arbitrary(&res, (uint32_t)in_rate, (uint32_t)out_rate, 1000);
+    TEST_ASSERT(cf32_resampler_set_rate(&res, in_rate * 1.02, out_rate) == -1, "Trim beyond the limit rejected");
+
+    float *all = (float *)malloc((size_t)num_in * 2 * 2 * sizeof(float));
+    if (!all) {
+        printf("FAIL: Failed to allocate trim buffer\n");
+        test_count++;
+        cf32_resampler_free(&res);
+        return;
+    }
+
+    /* First half nominal, then the input clock is found 500 ppm fast */
+    int n1 = resample_tone(&res, f, in_rate, num_in / 2, all, num_in * 2);
+    TEST_ASSERT(cf32_resampler_set_rate(&res, in_rate * (1.0 + 500e-6), out_rate) == 0, "Trim by 500 ppm");
+    float block[2 * 1000];
+    int n2 = 0;
+    for (int n = num_in / 2; n < num_in; n += 1000) {
+        for (int i = 0; i < 1000; i++) {
+            double ph = 2.0 * M_PI * f * (n + i) / in_rate;
+            block[2 * i] = (float)cos(ph);
+            block[2 * i + 1] = (float)sin(ph);
+        }
+        float *out;
+        int got = cf32_resampler_process(&res, block, 1000, &out, (int)res.output_buf_size);
+        memcpy(all + 2 * (size_t)(n1 + n2), out, (size_t)got * 2 * sizeof(float));
+        n2 += got;
+    }
+
+    double expected = (num_in / 2) * out_rate / (in_rate * (1.0 + 500e-6));
+    snprintf(msg, sizeof(msg), "Trimmed ratio: %d out (expected %.1f)", n2, expected);
+    TEST_ASSERT(fabs(n2 - expected) <= 2.0, msg);
+
+    /* The tone advances by a steady phase per output, only the step
+     * changes at the trim: no jump in phase or amplitude */
+    double max_jump = 0.0, max_amp_err = 0.0, prev_dph = 0.0;
+    for (int i = 500; i < n1 + n2; i++) {
+        double ph0 = atan2(all[2 * i - 1], all[2 * i - 2]);
+        double ph1 = atan2(all[2 * i + 1], all[2 * i]);
+        double dph = remainder(ph1 - ph0, 2.0 * M_PI);
+        if (i > 500 && fabs(dph - prev_dph) > max_jump)
+            max_jump = fabs(dph - prev_dph);
+        prev_dph = dph;
+        double amp = hypot(all[2 * i], all[2 * i + 1]);
+        if (fabs(amp - 1.0) > max_amp_err)
+            max_amp_err = fabs(amp - 1.0);
+    }
+    double step_change = 2.0 * M_PI * f / out_rate * 500e-6;
+    snprintf(msg, sizeof(msg), "No glitch at the trim (phase step jump %.2e rad, amplitude error %.2e)",
+             max_jump, max_amp_err);
+    TEST_ASSERT(max_jump < step_change + 1e-3 && max_amp_err < 2e-3, msg);
+
+    /* The rational bank has no trim */
+    cf32_resampler_t rational;
+    cf32_resampler_init(&rational, (uint32_t)in_rate, (uint32_t)out_rate, 1000);
+    TEST_ASSERT(cf32_resampler_set_rate(&rational, in_rate * (1.0 + 500e-6), out_rate) == -1,
+                "Rational resampler rejects a trim");
+    cf32_resampler_free(&rational);
+
+    free(all);
+    cf32_resampler_free(&res);
+}
+
+/* Every arbitrary ratio variant matches the baseline one */
+static void test_arbitrary_isa_closeness(void)
+{
+    printf("\n=== Arbitrary Ratio ISA Bit-Closeness ===\n");
+
+    static const int blocks[] = {1, 7, 4095, 33, 10000, 4097};
+    const int total = 40000;
+    isa_variant_t variants[3];
+    int num_variants = isa_variants(variants);
+    char msg[128];
+
+    float *input = (float *)malloc((size_t)total * 2 * sizeof(float));
+    float *ref_out = (float *)malloc((size_t)total * 2 * 2 * sizeof(float));
+    if (!input || !ref_out) {
+        printf("FAIL: Failed to allocate arbitrary ratio buffers\n");
+        test_count++;
+        free(input);
+        free(ref_out);
+        return;
+    }
+    uint32_t lcg = 777;
+    for (int i = 0; i < 2 * total; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        input[i] = (float)(lcg >> 8) / 16777216.0f - 0.5f;
+    }
+
+    int ref_n = 0;
+    for (int v = 0; v < num_variants; v++) {
+        if (!variants[v].runnable)
+            continue;
+        cf32_resampler_t res;
+        cf32_resampler_init_arbitrary(&res, 1000003, 312517, 10000);
+        res.process = variants[v].arbitrary;
+        res.halfband_process = variants[v].halfband;
+
+        double max_err = 0.0;
+        int out_n = 0;
+        for (int n = 0, b = 0; n < total; b++) {
+            int len = blocks[b % (int)(sizeof(blocks) / sizeof(blocks[0]))];
+            if (len > total - n)
+                len = total - n;
+            float *out;
+            int got = cf32_resampler_process(&res, input + 2 * n, len, &out, (int)res.output_buf_size);
+            for (int i = 0; i < 2 * got; i++) {
+                if (v == 0)
+                    ref_out[2 * out_n + i] = out[i];
+                else if (fabs(out[i] - ref_out[2 * out_n + i]) > max_err)
+                    max_err = fabs(out[i] - ref_out[2 * out_n + i]);
+            }
+            out_n += got;
+            n += len;
+        }
+        if (v == 0)
+            ref_n = out_n;
+        snprintf(msg, sizeof(msg), "%s arbitrary 1000003->312517 Hz matches baseline (%d samples, max error %.2e)",
+                 variants[v].name, out_n, max_err);
+        TEST_ASSERT(out_n == ref_n && max_err < 1e-5, msg);
+        cf32_resampler_free(&res);
+    }
+
+    free(input);
+    free(ref_out);
+}
+
 /*============================================================================
  * Benchmark Tests
  *============================================================================*/
@@ -1125,10 +1818,7 @@ static void benchmark_resampler_throughput(void)
     for (int i = 0; i < 5; i++) {
         cf32_resampler_process(&res, input, num_samples, &output, num_samples);
         /* Reset resampler state for consistent results */
-        res.phase_idx = 0;
-        res.write_pos = 0;
-        memset(res.hist_i, 0, (size_t)res.hist_size * sizeof(float));
-        memset(res.hist_q, 0, (size_t)res.hist_size * sizeof(float));
+        cf32_resampler_reset(&res);
     }
 
     /* Benchmark */
@@ -1139,10 +1829,7 @@ static void benchmark_resampler_throughput(void)
         int num_out = cf32_resampler_process(&res, input, num_samples, &output, num_samples);
         total_samples += num_samples;
         /* Reset for next iteration */
-        res.phase_idx = 0;
-        res.write_pos = 0;
-        memset(res.hist_i, 0, (size_t)res.hist_size * sizeof(float));
-        memset(res.hist_q, 0, (size_t)res.hist_size * sizeof(float));
+        cf32_resampler_reset(&res);
         (void)num_out;
     }
 
@@ -1163,6 +1850,63 @@ static void benchmark_resampler_throughput(void)
     cf32_resampler_free(&res);
 }
 
+/* Throughput per ISA variant, one line each as in channelizer-bench */
+static void benchmark_isa_variants(void)
+{
+    printf("\n=== Resampler Throughput per ISA ===\n");
+
+    static const uint32_t rates[][2] = {
+        {TEST_RATE_HYDRASDR, TEST_RATE_TARGET},
+        {2500000, TEST_RATE_TARGET},
+        {10000000, TEST_RATE_TARGET},
+    };
+    const int num_samples = 65536;
+    const int num_iterations = 50;
+    isa_variant_t variants[3];
+    int num_variants = isa_variants(variants);
+
+    float *input = (float *)malloc((size_t)num_samples * 2 * sizeof(float));
+    if (!input) {
+        printf("FAIL: Failed to allocate benchmark input buffer\n");
+        return;
+    }
+    for (int i = 0; i < num_samples; i++) {
+        input[2 * i] = cosf(0.01f * (float)i);
+        input[2 * i + 1] = sinf(0.01f * (float)i);
+    }
+
+    printf("  %-10s %-20s %12s %12s %10s\n", "ISA", "Rate", "Msps in", "x realtime", "MACs/out");
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (int v = 0; v < num_variants; v++) {
+            if (!variants[v].runnable)
+                continue;
+            cf32_resampler_t res;
+            float *out;
+            cf32_resampler_init(&res, rates[r][0], rates[r][1], (size_t)num_samples);
+            res.process = variants[v].fn;
+            res.halfband_process = variants[v].halfband;
+            cf32_resampler_process(&res, input, num_samples, &out, (int)res.output_buf_size);
+
+            double start = get_time_ms();
+            for (int it = 0; it < num_iterations; it++)
+                cf32_resampler_process(&res, input, num_samples, &out, (int)res.output_buf_size);
+            double elapsed_s = (get_time_ms() - start) / 1000.0;
+            double sps = (double)num_samples * num_iterations / elapsed_s;
+
+            char rate[32];
+            snprintf(rate, sizeof(rate), "%u->%u", rates[r][0], rates[r][1]);
+            printf("  %-10s %-20s %12.2f %12.1f %10.1f\n", variants[v].name, rate, sps / 1e6, sps / rates[r][0],
+                   res.plan.macs_per_output);
+            cf32_resampler_free(&res);
+        }
+    }
+    free(input);
+
+    test_count++;
+    test_passed++;
+    printf("PASS: ISA throughput benchmark completed\n");
+}
+
 /* Benchmark filter design time */
 static void benchmark_filter_design(void)
 {
@@ -1266,8 +2010,23 @@ int main(int argc, char *argv[])
     test_overflow_large_buffer();
     test_zero_rates();
 
+    /* ISA variant tests */
+    test_isa_bit_closeness();
+
+    /* Half-band chain tests */
+    test_plan();
+    test_halfband_design();
+    test_halfband_chain();
+    test_halfband_isa_closeness();
+
+    /* Arbitrary ratio tests */
+    test_arbitrary_ratio();
+    test_arbitrary_trim();
+    test_arbitrary_isa_closeness();
+
     /* Benchmark tests */
     benchmark_resampler_throughput();
+    benchmark_isa_variants();
     benchmark_filter_design();
     benchmark_init_free();
 
@@ -33,7 +33,8 @@ foreach(CU8_FILE ${CU8_FILES})
     # Derive paths
     get_filename_component(CU8_DIR "${CU8_FILE}" DIRECTORY)
     get_filename_component(CU8_NAME "${CU8_FILE}" NAME)
-    get_filename_component(CU8_NAME_WE "${CU8_FILE}" NAME_WE)
+    # NAME_WE would stop at the first dot of "g001_433.92M_250k.cu8"
+    string(REGEX REPLACE "\\.cu8$" "" CU8_NAME_WE "${CU8_NAME}")
 
     # Look for expected JSON output
     # rtl_433_tests uses convention: same directory, same base name or
@@ -0,0 +1,283 @@
+/** @file
+    Shared-memory event ring test.
+
+    Runs the ring producer and several readers in-process, checks ordering,
+    catch-up after being lapped, the closed state and, with a producer
+    thread, that concurrent readers never see a torn record.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "data.h"
+#include "data_cbor.h"
+#include "output_shm.h"
+#include "shm_ring.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static char ring_name[64];
+
+/* Fill a record with a pattern derived from its sequence number. */
+static size_t make_record(uint8_t *buf, uint64_t seq)
+{
+    size_t len = 8 + (size_t)(seq * 7 % 300);
+    memcpy(buf, &seq, sizeof(seq));
+    for (size_t i = 8; i < len; ++i)
+        buf[i] = (uint8_t)(seq + i);
+    return len;
+}
+
+static int check_record(uint8_t const *buf, size_t len, uint64_t seq)
+{
+    uint8_t expect[512];
+    return make_record(expect, seq) == len && !memcmp(buf, expect, len);
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_basic(void)
+{
+    printf("\n=== Basic ===\n");
+
+    shm_ring_t *ring = shm_ring_create(ring_name, 65536, SHM_RING_FORMAT_JSON);
+    TEST_ASSERT(ring, "ring created");
+    if (!ring)
+        return;
+
+    shm_reader_t *early = shm_reader_open(ring_name, 0);
+    TEST_ASSERT(early, "reader attached");
+
+    uint8_t buf[512];
+    TEST_ASSERT(shm_reader_next(early, buf, sizeof(buf), NULL) == SHM_RING_EMPTY, "empty ring");
+
+    for (uint64_t s = 1; s <= 10; ++s) {
+        size_t len = make_record(buf, s);
+        shm_ring_write(ring, buf, len);
+    }
+
+    shm_reader_t *late = shm_reader_open(ring_name, 1);
+    shm_reader_t *fresh = shm_reader_open(ring_name, 0);
+
+    int ok = 1;
+    uint64_t seq;
+    for (uint64_t s = 1; s <= 10; ++s) {
+        int len = shm_reader_next(early, buf, sizeof(buf), &seq);
+        ok &= len > 0 && seq == s && check_record(buf, (size_t)len, s);
+    }
+    TEST_ASSERT(ok, "records read in order");
+    TEST_ASSERT(shm_reader_next(early, buf, sizeof(buf), NULL) == SHM_RING_EMPTY, "reader caught up");
+
+    int count = 0;
+    while (shm_reader_next(late, buf, sizeof(buf), NULL) > 0)
+        count++;
+    TEST_ASSERT(count == 10, "late reader starts at the oldest record");
+    TEST_ASSERT(shm_reader_next(fresh, buf, sizeof(buf), NULL) == SHM_RING_EMPTY, "new reader starts at the head");
+
+    static uint8_t big[40000];
+    TEST_ASSERT(shm_ring_write(ring, big, sizeof(big)) == 0, "oversized record rejected");
+
+    shm_reader_close(early);
+    shm_reader_close(late);
+    shm_reader_close(fresh);
+    shm_ring_destroy(ring);
+}
+
+static void test_lapped(void)
+{
+    printf("\n=== Lapped reader ===\n");
+
+    shm_ring_t *ring = shm_ring_create(ring_name, 4096, SHM_RING_FORMAT_JSON);
+    shm_reader_t *reader = shm_reader_open(ring_name, 0);
+    if (!ring || !reader) {
+        TEST_ASSERT(0, "ring and reader");
+        return;
+    }
+
+    uint8_t buf[512];
+    int const total = 1000;
+    for (uint64_t s = 1; s <= (uint64_t)total; ++s) {
+        size_t len = make_record(buf, s);
+        shm_ring_write(ring, buf, len);
+    }
+
+    int count = 0, ok = 1, len;
+    uint64_t seq, last = 0;
+    while ((len = shm_reader_next(reader, buf, sizeof(buf), &seq)) > 0) {
+        ok &= seq > last && check_record(buf, (size_t)len, seq);
+        last = seq;
+        count++;
+    }
+    TEST_ASSERT(count > 0 && count < total, "only recent records remain");
+    TEST_ASSERT(ok, "records intact and ordered");
+    TEST_ASSERT(last == (uint64_t)total, "caught up to the newest record");
+    TEST_ASSERT(count + shm_reader_lost(reader) == (uint64_t)total, "lost records are counted");
+
+    shm_ring_destroy(ring);
+    TEST_ASSERT(shm_reader_next(reader, buf, sizeof(buf), NULL) == SHM_RING_CLOSED, "reader sees the ring closed");
+    TEST_ASSERT(!shm_reader_open(ring_name, 0), "closed ring is unlinked");
+    shm_reader_close(reader);
+}
+
+/* Concurrent producer and readers */
+
+#define STRESS_RECORDS 200000
+#define STRESS_READERS 3
+
+typedef struct {
+    shm_reader_t *reader;
+    int count;
+    int bad;
+} stress_reader_t;
+
+static void *stress_read(void *arg)
+{
+    stress_reader_t *sr = arg;
+    uint8_t buf[512];
+    uint64_t seq, last = 0;
+    int len;
+    while ((len = shm_reader_next(sr->reader, buf, sizeof(buf), &seq)) != SHM_RING_CLOSED) {
+        if (len == SHM_RING_EMPTY) {
+            sched_yield();
+            continue;
+        }
+        if (seq <= last || !check_record(buf, (size_t)len, seq))
+            sr->bad++;
+        last = seq;
+        sr->count++;
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    printf("\n=== Concurrent readers ===\n");
+
+    shm_ring_t *ring = shm_ring_create(ring_name, 16384, SHM_RING_FORMAT_JSON);
+    if (!ring) {
+        TEST_ASSERT(0, "ring created");
+        return;
+    }
+
+    stress_reader_t readers[STRESS_READERS] = {{0}};
+    pthread_t threads[STRESS_READERS];
+    for (int i = 0; i < STRESS_READERS; ++i) {
+        readers[i].reader = shm_reader_open(ring_name, 1);
+        pthread_create(&threads[i], NULL, stress_read, &readers[i]);
+    }
+
+    uint8_t buf[512];
+    for (uint64_t s = 1; s <= STRESS_RECORDS; ++s) {
+        size_t len = make_record(buf, s);
+        shm_ring_write(ring, buf, len);
+        if (s % 1024 == 0)
+            sched_yield(); // let the readers keep up some of the time
+    }
+    shm_ring_destroy(ring);
+
+    int bad = 0, complete = 1;
+    for (int i = 0; i < STRESS_READERS; ++i) {
+        pthread_join(threads[i], NULL);
+        bad += readers[i].bad;
+        if (readers[i].count + shm_reader_lost(readers[i].reader) != STRESS_RECORDS)
+            complete = 0;
+        printf("  reader %d: %d read, %d lost\n", i, readers[i].count, (int)shm_reader_lost(readers[i].reader));
+        shm_reader_close(readers[i].reader);
+    }
+    TEST_ASSERT(bad == 0, "no torn or reordered records");
+    TEST_ASSERT(complete, "every record read or counted as lost");
+}
+
+static void test_output(void)
+{
+    printf("\n=== Data output ===\n");
+
+    struct data_output *output = data_output_shm_create(0, ring_name, 65536, SHM_RING_FORMAT_CBOR);
+    shm_reader_t *reader = shm_reader_open(ring_name, 0);
+    if (!output || !reader) {
+        TEST_ASSERT(0, "output and reader");
+        return;
+    }
+    TEST_ASSERT(shm_reader_format(reader) == SHM_RING_FORMAT_CBOR, "ring format advertised");
+
+    for (int i = 0; i < 3; ++i) {
+        /* clang-format off */
+        data_t *data = data_make(
+                "model",            "",             DATA_STRING, "Acme-Temp",
+                "id",               "",             DATA_INT,    i,
+                "temperature_C",    "",             DATA_DOUBLE, 20.5,
+                NULL);
+        /* clang-format on */
+        data_output_print(output, data);
+        data_free(data);
+    }
+
+    uint8_t buf[2048];
+    int len, count = 0, ok = 1;
+    while ((len = shm_reader_next(reader, buf, sizeof(buf), NULL)) > 0) {
+        size_t used;
+        data_t *data = data_parse_cbor(buf, (size_t)len, &used);
+        char json[256];
+        if (data)
+            data_print_jsons(data, json, sizeof(json));
+        ok &= data && used == (size_t)len && strstr(json, "\"Acme-Temp\"") != NULL;
+        data_free(data);
+        count++;
+    }
+    TEST_ASSERT(count == 3, "all events published");
+    TEST_ASSERT(ok, "events decode");
+
+    data_output_free(output);
+    shm_reader_close(reader);
+}
+
+int main(void)
+{
+    printf("Shared-Memory Ring Test\n");
+    printf("=======================\n");
+
+    snprintf(ring_name, sizeof(ring_name), "/hydrasdr_433_test_%d", (int)getpid());
+
+    test_basic();
+    test_lapped();
+    test_concurrent();
+    test_output();
+
+    printf("\n=======================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/** @file
+    Live spectrum frame test.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "spectrum.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+#define FFT_SIZE  256
+#define N_SAMPLES (4 * FFT_SIZE)
+#define TONE_BIN  32
+
+static float tone[2 * N_SAMPLES];
+static int16_t tone_cs16[2 * N_SAMPLES];
+
+/// A full scale tone centered on an FFT bin above DC.
+static void make_tone(void)
+{
+    for (int i = 0; i < N_SAMPLES; ++i) {
+        double phase    = 2.0 * M_PI * TONE_BIN * i / FFT_SIZE;
+        tone[2 * i]     = (float)cos(phase);
+        tone[2 * i + 1] = (float)sin(phase);
+        tone_cs16[2 * i]     = (int16_t)(cos(phase) * 32767.0);
+        tone_cs16[2 * i + 1] = (int16_t)(sin(phase) * 32767.0);
+    }
+}
+
+static unsigned peak_bin(float const *levels, unsigned n)
+{
+    unsigned peak = 0;
+    for (unsigned i = 1; i < n; ++i) {
+        if (levels[i] > levels[peak])
+            peak = i;
+    }
+    return peak;
+}
+
+static unsigned get_le16(uint8_t const *p)
+{
+    return p[0] | (unsigned)p[1] << 8;
+}
+
+static uint32_t get_le32(uint8_t const *p)
+{
+    return get_le16(p) | (uint32_t)get_le16(p + 2) << 16;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_tone(void)
+{
+    printf("\n=== Tone ===\n");
+
+    spectrum_t *sp = spectrum_create(FFT_SIZE);
+    if (!sp) {
+        TEST_ASSERT(0, "spectrum created");
+        return;
+    }
+    TEST_ASSERT(!spectrum_create(FFT_SIZE + 1), "size not a power of two rejected");
+
+    static float levels[FFT_SIZE];
+    TEST_ASSERT(spectrum_size(sp) == FFT_SIZE, "size");
+    TEST_ASSERT(spectrum_read(sp, levels, 0, NULL, NULL) == 0, "no frame before the first feed");
+
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 1.0) == 0, "no frame without a viewer");
+    spectrum_set_interval(sp, 0.1);
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 1.0) == 1, "frame computed");
+
+    TEST_ASSERT(spectrum_read(sp, levels, 0, NULL, NULL) == 1, "sequence number");
+    unsigned peak = peak_bin(levels, FFT_SIZE);
+    TEST_ASSERT(peak == FFT_SIZE / 2 + TONE_BIN, "tone above the center bin");
+    TEST_ASSERT(fabsf(levels[peak]) < 0.1f, "full scale tone at 0 dBFS");
+    TEST_ASSERT(levels[FFT_SIZE / 2 - TONE_BIN] < -60.0f, "no image below the center");
+
+    TEST_ASSERT(spectrum_feed(sp, tone_cs16, N_SAMPLES, 4, 1.1) == 1, "CS16 frame computed");
+    levels[0] = 1000.0f;
+    TEST_ASSERT(spectrum_read(sp, levels, 2, NULL, NULL) == 2 && levels[0] == 1000.0f, "known frame not copied");
+    TEST_ASSERT(spectrum_read(sp, levels, 1, NULL, NULL) == 2, "new frame copied");
+    uint32_t center, span;
+    spectrum_read(sp, levels, 0, &center, &span);
+    TEST_ASSERT(center == 0 && span == 0, "no tuning set");
+    peak = peak_bin(levels, FFT_SIZE);
+    TEST_ASSERT(peak == FFT_SIZE / 2 + TONE_BIN && fabsf(levels[peak]) < 0.1f, "CS16 tone");
+
+    // the tuning is taken with the frame, not when read
+    spectrum_set_tuning(sp, 433920000, 250000, 0);
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 1.3) == 1, "tuned frame computed");
+    spectrum_set_tuning(sp, 868000000, 1000000, 0);
+    spectrum_read(sp, levels, 0, &center, &span);
+    TEST_ASSERT(center == 433920000 && span == 250000, "tuning of the frame");
+
+    spectrum_free(sp);
+}
+
+static void test_cadence(void)
+{
+    printf("\n=== Cadence ===\n");
+
+    spectrum_t *sp = spectrum_create(FFT_SIZE);
+    spectrum_set_interval(sp, 0.1);
+
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 10.0) == 1, "first frame");
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 10.05) == 0, "not due");
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 10.12) == 1, "due");
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 10.2) == 1, "cadence kept");
+    TEST_ASSERT(spectrum_feed(sp, tone, FFT_SIZE - 1, 8, 11.0) == 0, "short buffer skipped");
+    spectrum_set_interval(sp, 0.0);
+    TEST_ASSERT(spectrum_feed(sp, tone, N_SAMPLES, 8, 12.0) == 0, "stopped");
+
+    spectrum_free(sp);
+}
+
+static void test_channels(void)
+{
+    printf("\n=== Channels ===\n");
+
+    spectrum_t *sp = spectrum_create(FFT_SIZE);
+    float freqs[SPECTRUM_MAX_CHANNELS];
+    float power[SPECTRUM_MAX_CHANNELS];
+    TEST_ASSERT(spectrum_read_channels(sp, freqs, power) == 0, "no channels");
+
+    // channelizer order, center first
+    float in_freqs[4] = {434.0e6f, 434.5e6f, 433.0e6f, 433.5e6f};
+    float in_power[4] = {-10.0f, -20.0f, -30.0f, -40.0f};
+    spectrum_set_channels(sp, in_freqs, in_power, 4);
+    TEST_ASSERT(spectrum_read_channels(sp, freqs, power) == 0, "no channels unless wideband");
+    spectrum_set_tuning(sp, 433750000, 2500000, 1);
+    TEST_ASSERT(spectrum_read_channels(sp, freqs, power) == 4, "channel count");
+    TEST_ASSERT(freqs[0] == 433.0e6f && freqs[3] == 434.5e6f, "sorted by frequency");
+    TEST_ASSERT(power[0] == -30.0f && power[1] == -40.0f && power[2] == -10.0f && power[3] == -20.0f,
+            "power follows its channel");
+
+    spectrum_free(sp);
+}
+
+static void test_quantize(void)
+{
+    printf("\n=== Quantize ===\n");
+
+    float levels[8] = {-128.0f, -100.0f, -60.0f, -80.0f, 0.0f, -1.0f, -200.0f, 10.0f};
+    uint8_t out[8];
+
+    TEST_ASSERT(spectrum_quantize(levels, 8, out, 8) == 8, "all bins");
+    TEST_ASSERT(out[0] == 0 && out[1] == 56 && out[4] == 255 && out[5] == 254, "levels in half dB steps");
+    TEST_ASSERT(out[6] == 0 && out[7] == 255, "levels clamped");
+
+    TEST_ASSERT(spectrum_quantize(levels, 8, out, 4) == 4, "reduced bins");
+    TEST_ASSERT(out[0] == 56 && out[1] == 136 && out[2] == 255 && out[3] == 255, "peak of each group");
+
+    TEST_ASSERT(spectrum_quantize(levels, 8, out, 16) == 8, "no more bins than levels");
+}
+
+static void test_frame(void)
+{
+    printf("\n=== Frame ===\n");
+
+    float levels[4] = {-128.0f, -64.0f, -32.0f, -0.5f};
+    uint8_t buf[SPECTRUM_HEADER_LEN + 4];
+
+    TEST_ASSERT(spectrum_frame(buf, sizeof(buf) - 1, SPECTRUM_SOURCE_FFT, 7, 433920000, 2000000, levels, 4, 4) == 0,
+            "short buffer rejected");
+    size_t len = spectrum_frame(buf, sizeof(buf), SPECTRUM_SOURCE_CHANNELS, 0x01020304, 433920000, 2000000, levels, 4, 4);
+    TEST_ASSERT(len == SPECTRUM_HEADER_LEN + 4, "frame length");
+    TEST_ASSERT(buf[0] == 1 && buf[1] == SPECTRUM_SOURCE_CHANNELS, "version and source");
+    TEST_ASSERT(get_le16(buf + 2) == 4 && get_le32(buf + 4) == 0x01020304, "bins and sequence");
+    TEST_ASSERT(get_le32(buf + 8) == 433920000 && get_le32(buf + 12) == 2000000, "center and span");
+    TEST_ASSERT((int16_t)get_le16(buf + 16) == SPECTRUM_FLOOR_DB && get_le16(buf + 18) == SPECTRUM_STEP_CDB, "scale");
+    TEST_ASSERT(buf[20] == 0 && buf[21] == 128 && buf[22] == 192 && buf[23] == 255, "levels");
+}
+
+int main(void)
+{
+    printf("Spectrum Test\n");
+    printf("=============\n");
+
+    make_tone();
+    test_tone();
+    test_cadence();
+    test_channels();
+    test_quantize();
+    test_frame();
+
+    printf("\n=============\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
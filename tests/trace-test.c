@@ -0,0 +1,183 @@
+/** @file
+    Pipeline trace recorder test.
+
+    Records spans and flows, checks the Chrome Trace Event JSON output, the
+    input time window, ring overflow and, with a second recording thread,
+    that stopping a trace while another thread records is safe.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "trace.h"
+#include "metrics.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Helpers
+ *============================================================================*/
+
+static char trace_file[64];
+static char text[1 << 24];
+
+static size_t read_trace(void)
+{
+    text[0] = '\0';
+    FILE *f = fopen(trace_file, "r");
+    if (!f)
+        return 0;
+    size_t len = fread(text, 1, sizeof(text) - 1, f);
+    text[len] = '\0';
+    fclose(f);
+    return len;
+}
+
+static int count_str(char const *needle)
+{
+    int n = 0;
+    for (char const *p = text; (p = strstr(p, needle)); p += strlen(needle))
+        n++;
+    return n;
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_record(void)
+{
+    printf("\n=== Record ===\n");
+
+    TEST_ASSERT(!trace_recording() && trace_begin() == 0, "idle recorder");
+    trace_span(TRACE_THREAD_DEMOD, "lost", NULL, -1, metrics_time_ns());
+
+    TEST_ASSERT(trace_start(1.0, trace_file) == 0, "trace started");
+    TEST_ASSERT(trace_start(1.0, trace_file) < 0, "second start rejected");
+
+    uint64_t t = trace_begin();
+    TEST_ASSERT(t != 0, "clock while recording");
+    trace_flow(TRACE_THREAD_ACQUIRE, 0, 1);
+    trace_flow(TRACE_THREAD_DEMOD, 1, 1);
+    trace_span(TRACE_THREAD_DEMOD, "am_demod", NULL, 3, t);
+    trace_span(TRACE_THREAD_DEMOD, "decode", "Acme \"Quote\" Sensor with a long name", 42, t);
+    trace_span(TRACE_THREAD_DEMOD, "skipped", NULL, -1, 0);
+
+    TEST_ASSERT(trace_input(0.6) == 0, "window open");
+    TEST_ASSERT(trace_input(0.6) == 1, "window complete after 1 s of input");
+    TEST_ASSERT(trace_stop() == 4, "events written");
+    TEST_ASSERT(!trace_recording() && trace_stop() < 0, "stopped");
+
+    read_trace();
+    TEST_ASSERT(!strncmp(text, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 38), "trace header");
+    TEST_ASSERT(strstr(text, "\"args\":{\"name\":\"acquire\"}"), "thread names");
+    TEST_ASSERT(strstr(text, "\"name\":\"am_demod\",\"ph\":\"X\""), "span");
+    TEST_ASSERT(strstr(text, "\"args\":{\"index\":42,\"detail\":\"Acme \\\"Quote\\\" Sensor \"}"), "detail escaped and truncated");
+    TEST_ASSERT(strstr(text, "\"ph\":\"s\",\"id\":1") && strstr(text, "\"ph\":\"f\",\"id\":1"), "flow start and end");
+    TEST_ASSERT(!strstr(text, "\"lost\"") && !strstr(text, "\"skipped\""), "nothing recorded outside the window");
+    TEST_ASSERT(strstr(text, "\"lost_events\":0}}\n"), "trace footer");
+}
+
+static void test_overflow(void)
+{
+    printf("\n=== Overflow ===\n");
+
+    trace_start(1.0, trace_file);
+    int const total = TRACE_ACQUIRE_EVENTS + 100;
+    for (int i = 0; i < total; ++i)
+        trace_span(TRACE_THREAD_ACQUIRE, "broadcast", NULL, i, metrics_time_ns());
+    long written = trace_stop();
+    TEST_ASSERT(written == TRACE_ACQUIRE_EVENTS - 1, "ring keeps the newest events");
+
+    read_trace();
+    TEST_ASSERT(strstr(text, "\"lost_events\":101}}"), "lost events counted");
+    char newest[64];
+    snprintf(newest, sizeof(newest), "\"index\":%d}", total - 1);
+    TEST_ASSERT(strstr(text, newest) && !strstr(text, "\"index\":0}"), "oldest events dropped");
+}
+
+/* Concurrent recording thread */
+
+static volatile int stop_writer;
+
+static void *acquire_writer(void *arg)
+{
+    long *spans = arg;
+    while (!stop_writer) {
+        trace_span(TRACE_THREAD_ACQUIRE, "broadcast", NULL, -1, trace_begin());
+        (*spans)++;
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    printf("\n=== Concurrent ===\n");
+
+    long spans = 0;
+    pthread_t thread;
+    pthread_create(&thread, NULL, acquire_writer, &spans);
+
+    int ok = 1;
+    for (int round = 0; round < 20; ++round) {
+        ok &= trace_start(1.0, trace_file) == 0;
+        for (int i = 0; i < 1000; ++i)
+            trace_span(TRACE_THREAD_DEMOD, "decode", "Acme", i, trace_begin());
+        usleep(1000);
+        ok &= trace_stop() >= 1000;
+        read_trace();
+        ok &= count_str("\"name\":\"decode\"") == 1000;
+        ok &= strstr(text, "}}\n") != NULL;
+    }
+    stop_writer = 1;
+    pthread_join(thread, NULL);
+
+    printf("  %ld spans attempted by the writer thread\n", spans);
+    TEST_ASSERT(ok, "traces complete while another thread records");
+}
+
+int main(void)
+{
+    printf("Trace Recorder Test\n");
+    printf("===================\n");
+
+    snprintf(trace_file, sizeof(trace_file), "trace-test-%d.json", (int)getpid());
+
+    test_record();
+    test_overflow();
+    test_concurrent();
+
+    trace_free();
+    remove(trace_file);
+
+    printf("\n===================\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
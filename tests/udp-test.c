@@ -0,0 +1,297 @@
+/** @file
+    UDP output test.
+
+    Sends events through the syslog and binary UDP outputs to a loopback
+    socket and checks batching and the binary datagram layout.
+
+    Copyright (C) 2025-2026 Benjamin Vernoux <bvernoux@hydrasdr.com>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "data.h"
+#include "data_cbor.h"
+#include "output_udp.h"
+#include "mongoose.h"
+
+/*============================================================================
+ * Test Framework
+ *============================================================================*/
+
+static int test_count = 0;
+static int test_passed = 0;
+
+#define TEST_ASSERT(cond, msg) do { \
+    test_count++; \
+    if (!(cond)) { \
+        printf("FAIL: %s\n", msg); \
+    } else { \
+        test_passed++; \
+        printf("PASS: %s\n", msg); \
+    } \
+} while(0)
+
+/*============================================================================
+ * Loopback receiver
+ *============================================================================*/
+
+typedef struct {
+    sock_t sock;
+    char port[16];
+    int datagrams;
+    int events;     /* syslog lines or binary records */
+    int bad;        /* malformed datagrams */
+    int cbor;       /* datagrams flagged as CBOR */
+} receiver_t;
+
+static int receiver_open(receiver_t *rx)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rx->sock == INVALID_SOCKET)
+        return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+    socklen_t len        = sizeof(addr);
+    if (bind(rx->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0
+            || getsockname(rx->sock, (struct sockaddr *)&addr, &len) != 0)
+        return -1;
+    snprintf(rx->port, sizeof(rx->port), "%u", ntohs(addr.sin_port));
+    return 0;
+}
+
+/* Wait up to 10 ms for a datagram. */
+static int receiver_ready(receiver_t *rx)
+{
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    FD_SET(rx->sock, &rfds);
+    struct timeval tv = {0, 10000};
+    return select((int)rx->sock + 1, &rfds, NULL, NULL, &tv) > 0;
+}
+
+static void receiver_close(receiver_t *rx)
+{
+    closesocket(rx->sock);
+    rx->sock = INVALID_SOCKET;
+}
+
+static unsigned get_be16(unsigned char const *p)
+{
+    return (unsigned)p[0] << 8 | p[1];
+}
+
+/* Read all pending datagrams. */
+static void receiver_drain(receiver_t *rx, int binary)
+{
+    unsigned char buf[2048];
+    int n;
+    while (receiver_ready(rx) && (n = (int)recv(rx->sock, (char *)buf, sizeof(buf), 0)) > 0) {
+        rx->datagrams++;
+        if (!binary) {
+            if (strncmp((char *)buf, "<165>1 ", 7) || !memchr(buf, '{', n))
+                rx->bad++;
+            rx->events++;
+            continue;
+        }
+        if (n < UDP_BINARY_HEADER || memcmp(buf, UDP_BINARY_MAGIC, 4) || buf[4] != UDP_BINARY_VERSION) {
+            rx->bad++;
+            continue;
+        }
+        int is_cbor = buf[5] & UDP_BINARY_FLAG_CBOR;
+        if (is_cbor)
+            rx->cbor++;
+        unsigned count = get_be16(&buf[6]);
+        int pos = UDP_BINARY_HEADER;
+        for (unsigned i = 0; i < count; ++i) {
+            if (pos + 2 > n) {
+                rx->bad++;
+                break;
+            }
+            unsigned len = get_be16(&buf[pos]);
+            if (pos + 2 + (int)len > n) {
+                rx->bad++;
+                break;
+            }
+            if (is_cbor) {
+                size_t used;
+                data_t *data = data_parse_cbor(&buf[pos + 2], len, &used);
+                data_free(data);
+                if (!data || used != len) {
+                    rx->bad++;
+                    break;
+                }
+            }
+            else if (buf[pos + 2] != '{' || buf[pos + 1 + len] != '}') {
+                rx->bad++;
+                break;
+            }
+            pos += 2 + len;
+            rx->events++;
+        }
+        if (pos != n)
+            rx->bad++;
+    }
+}
+
+static void send_events(struct data_output *output, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        /* clang-format off */
+        data_t *data = data_make(
+                "model",            "",             DATA_STRING, "Acme-Temp",
+                "id",               "",             DATA_INT,    i,
+                "temperature_C",    "",             DATA_DOUBLE, 20.0 + i,
+                NULL);
+        /* clang-format on */
+        data_output_print(output, data);
+        data_free(data);
+    }
+}
+
+static void poll_for(struct mg_mgr *mgr, double seconds)
+{
+    double end = mg_time() + seconds;
+    while (mg_time() < end)
+        mg_mgr_poll(mgr, 5);
+}
+
+/*============================================================================
+ * Tests
+ *============================================================================*/
+
+static void test_syslog_unbatched(struct mg_mgr *mgr, receiver_t *rx)
+{
+    printf("\n=== Syslog, no batching ===\n");
+
+    struct data_output *output = data_output_syslog_create(mgr, 0, "127.0.0.1", rx->port, 1, 50, 0);
+    send_events(output, 5);
+    poll_for(mgr, 0.05);
+    receiver_drain(rx, 0);
+
+    TEST_ASSERT(rx->datagrams == 5, "one datagram per event");
+    TEST_ASSERT(rx->bad == 0, "syslog lines well-formed");
+
+    data_output_free(output);
+}
+
+static void test_syslog_batched(struct mg_mgr *mgr, receiver_t *rx)
+{
+    printf("\n=== Syslog, batched ===\n");
+
+    struct data_output *output = data_output_syslog_create(mgr, 0, "127.0.0.1", rx->port, 8, 60000, 0);
+    send_events(output, 20);
+    receiver_drain(rx, 0);
+    TEST_ASSERT(rx->datagrams == 16, "full batches are sent");
+
+    data_output_free(output);
+    receiver_drain(rx, 0);
+    TEST_ASSERT(rx->datagrams == 20, "pending datagrams sent on close");
+    TEST_ASSERT(rx->bad == 0, "syslog lines well-formed");
+}
+
+static void test_batch_delay(struct mg_mgr *mgr, receiver_t *rx)
+{
+    printf("\n=== Batch delay ===\n");
+
+    struct data_output *output = data_output_syslog_create(mgr, 0, "127.0.0.1", rx->port, 32, 50, 0);
+    send_events(output, 3);
+    receiver_drain(rx, 0);
+    TEST_ASSERT(rx->datagrams == 0, "events are held back");
+
+    poll_for(mgr, 0.3);
+    receiver_drain(rx, 0);
+    TEST_ASSERT(rx->datagrams == 3, "events sent after the delay");
+
+    data_output_free(output);
+}
+
+static void test_binary(struct mg_mgr *mgr, receiver_t *rx)
+{
+    printf("\n=== Binary datagrams ===\n");
+
+    struct data_output *output = data_output_syslog_create(mgr, 0, "127.0.0.1", rx->port, 4, 60000, UDP_FORMAT_BINARY);
+    send_events(output, 100);
+    data_output_free(output);
+    receiver_drain(rx, 1);
+
+    TEST_ASSERT(rx->events == 100, "all events received");
+    TEST_ASSERT(rx->datagrams < 20, "several events per datagram");
+    TEST_ASSERT(rx->bad == 0, "binary datagrams well-formed");
+}
+
+static void test_binary_default(struct mg_mgr *mgr, receiver_t *rx)
+{
+    printf("\n=== Binary datagrams, default batch ===\n");
+
+    struct data_output *output = data_output_syslog_create(mgr, 0, "127.0.0.1", rx->port, 1, 50, UDP_FORMAT_BINARY);
+    send_events(output, 100);
+    receiver_drain(rx, 1);
+    TEST_ASSERT(rx->datagrams > 0 && rx->events < 100, "full datagrams are sent");
+    TEST_ASSERT(rx->datagrams < 20, "several events per datagram");
+
+    poll_for(mgr, 0.3);
+    receiver_drain(rx, 1);
+    TEST_ASSERT(rx->events == 100, "pending events sent after the delay");
+    TEST_ASSERT(rx->bad == 0, "binary datagrams well-formed");
+
+    data_output_free(output);
+}
+
+static void test_cbor(struct mg_mgr *mgr, receiver_t *rx)
+{
+    printf("\n=== CBOR datagrams ===\n");
+
+    struct data_output *output = data_output_syslog_create(mgr, 0, "127.0.0.1", rx->port, 4, 60000, UDP_FORMAT_CBOR);
+    send_events(output, 100);
+    data_output_free(output);
+    receiver_drain(rx, 1);
+
+    TEST_ASSERT(rx->events == 100, "all events received");
+    TEST_ASSERT(rx->cbor == rx->datagrams, "datagrams flagged as CBOR");
+    TEST_ASSERT(rx->bad == 0, "CBOR records decode");
+}
+
+int main(void)
+{
+    printf("UDP Output Test\n");
+    printf("===============\n");
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+
+    void (*tests[])(struct mg_mgr *, receiver_t *) = {
+            test_syslog_unbatched,
+            test_syslog_batched,
+            test_batch_delay,
+            test_binary,
+            test_binary_default,
+            test_cbor,
+    };
+    for (unsigned i = 0; i < sizeof(tests) / sizeof(*tests); ++i) {
+        receiver_t rx;
+        if (receiver_open(&rx) != 0) {
+            printf("FAIL: could not open receiver\n");
+            return 1;
+        }
+        tests[i](&mgr, &rx);
+        receiver_close(&rx);
+    }
+
+    mg_mgr_free(&mgr);
+
+    printf("\n===============\n");
+    printf("Results: %d/%d tests passed\n", test_passed, test_count);
+    return test_passed == test_count ? 0 : 1;
+}
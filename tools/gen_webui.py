@@ -40,6 +40,7 @@ JS_MODULES = [
 	'js/stats.js',
 	'js/syslog.js',
 	'js/debug.js',
+	'js/spectrum.js',
 	'js/init.js',
 ]
 
@@ -394,6 +394,10 @@ var elStatsContent = $('stats-content');
 var elSysDev   = $('sys-dev');
 var elSysMeta  = $('sys-meta');
 var elSysFreqs = $('sys-freqs');
+var elSpecCanvas = $('spec-canvas');
+var elSpecSource = $('spec-source');
+var elSpecFps    = $('spec-fps');
+var elSpecInfo   = $('spec-info');
 var elSyslogBody   = $('syslog-body');
 var elSyslogCount  = $('syslog-count');
 var elSyslogSearch = $('syslog-search');
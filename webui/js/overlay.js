@@ -24,6 +24,7 @@ function switchTab(name) {
 	if (devicesTabActive) scheduleDevicesRender();
 	if (name === 'monitor' || name === 'devices') chartDirty = true;
 	if (name === 'monitor') renderAllCharts();
+	setSpectrumActive(name === 'spectrum');
 	/* Restore dock layout for the newly active tab */
 	restoreDockLayout(name);
 }
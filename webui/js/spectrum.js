@@ -0,0 +1,161 @@
+/* SPECTRUM TAB — live spectrum and waterfall from the /spectrum websocket.
+   The stream is only open while the tab is active, the server computes
+   the FFT only while a viewer is due a frame. */
+
+var SPEC_HEADER_LEN = 20;
+var SPEC_TRACE_FRAC = 0.35;  /* share of the canvas height for the trace */
+var SPEC_RETRY_MS = 2000;
+
+var specWs = null;
+var specActive = false;
+var specRetryTimer = null;
+var specBins = 0;
+var specPalette = null;
+var specRow = null;  /* ImageData of one waterfall row */
+
+/* 256 entry color map, black - blue - cyan - yellow - red */
+function buildSpecPalette() {
+	var stops = [[0, 0, 0], [0, 0, 160], [0, 200, 220], [240, 230, 0], [255, 40, 0]];
+	var pal = new Uint8Array(256 * 3);
+	for (var i = 0; i < 256; i++) {
+		var x = i / 255 * (stops.length - 1);
+		var k = Math.min(Math.floor(x), stops.length - 2);
+		var f = x - k;
+		for (var c = 0; c < 3; c++)
+			pal[i * 3 + c] = Math.round(stops[k][c] + (stops[k + 1][c] - stops[k][c]) * f);
+	}
+	return pal;
+}
+
+/* Request one bin per device pixel, the server reduces by the peak */
+function specWantedBins() {
+	var w = Math.round(elSpecCanvas.clientWidth * (window.devicePixelRatio || 1));
+	return Math.max(16, Math.min(2048, w || 512));
+}
+
+function specQuery() {
+	specBins = specWantedBins();
+	return 'source=' + elSpecSource.value + '&fps=' + elSpecFps.value + '&bins=' + specBins;
+}
+
+function specResize() {
+	var dpr = window.devicePixelRatio || 1;
+	var w = Math.round(elSpecCanvas.clientWidth * dpr);
+	var h = Math.round(elSpecCanvas.clientHeight * dpr);
+	if (!w || !h || (elSpecCanvas.width === w && elSpecCanvas.height === h)) return;
+	elSpecCanvas.width = w;
+	elSpecCanvas.height = h;
+	specRow = null;
+	if (specWs && specWs.readyState === 1 && specWantedBins() !== specBins)
+		specWs.send(specQuery());
+}
+
+function specOpen() {
+	if (specWs) return;
+	var proto = location.protocol === 'https:' ? 'wss:' : 'ws:';
+	specResize();
+	specWs = new WebSocket(proto + '//' + location.host + '/spectrum?' + specQuery());
+	specWs.binaryType = 'arraybuffer';
+	specWs.onmessage = function (e) {
+		if (typeof e.data === 'string') return;  /* granted settings */
+		drawSpecFrame(e.data);
+	};
+	specWs.onclose = function () {
+		specWs = null;
+		if (specActive && !specRetryTimer)
+			specRetryTimer = setTimeout(function () {
+				specRetryTimer = null;
+				if (specActive) specOpen();
+			}, SPEC_RETRY_MS);
+	};
+}
+
+function specClose() {
+	if (specRetryTimer) {
+		clearTimeout(specRetryTimer);
+		specRetryTimer = null;
+	}
+	if (specWs) {
+		var ws = specWs;
+		specWs = null;
+		ws.onclose = null;
+		ws.close();
+	}
+}
+
+function setSpectrumActive(on) {
+	if (on === specActive) return;
+	specActive = on;
+	if (on) specOpen();
+	else specClose();
+}
+
+function drawSpecFrame(buf) {
+	if (buf.byteLength < SPEC_HEADER_LEN) return;
+	var dv = new DataView(buf);
+	if (dv.getUint8(0) !== 1) return;
+	var bins = dv.getUint16(2, true);
+	var center = dv.getUint32(8, true);
+	var span = dv.getUint32(12, true);
+	var floorDb = dv.getInt16(16, true);
+	var step = dv.getUint16(18, true) / 100;
+	if (buf.byteLength < SPEC_HEADER_LEN + bins || !bins) return;
+	var lv = new Uint8Array(buf, SPEC_HEADER_LEN, bins);
+
+	var cv = elSpecCanvas;
+	var w = cv.width, h = cv.height;
+	if (!w || !h) return;
+	var ctx = cv.getContext('2d');
+	var th = Math.round(h * SPEC_TRACE_FRAC);
+	var wh = h - th;
+	if (!specPalette) specPalette = buildSpecPalette();
+
+	/* Waterfall: scroll down one row, new row on top */
+	if (wh > 1) {
+		ctx.drawImage(cv, 0, th, w, wh - 1, 0, th + 1, w, wh - 1);
+		if (!specRow || specRow.width !== w) specRow = ctx.createImageData(w, 1);
+		var px = specRow.data;
+		for (var x = 0; x < w; x++) {
+			var v = lv[Math.min(bins - 1, Math.floor(x * bins / w))];
+			px[x * 4] = specPalette[v * 3];
+			px[x * 4 + 1] = specPalette[v * 3 + 1];
+			px[x * 4 + 2] = specPalette[v * 3 + 2];
+			px[x * 4 + 3] = 255;
+		}
+		ctx.putImageData(specRow, 0, th);
+	}
+
+	/* Trace */
+	ctx.fillStyle = '#000';
+	ctx.fillRect(0, 0, w, th);
+	ctx.strokeStyle = '#333';
+	ctx.beginPath();
+	for (var g = 1; g < 4; g++) {
+		ctx.moveTo(0, Math.round(th * g / 4) + 0.5);
+		ctx.lineTo(w, Math.round(th * g / 4) + 0.5);
+	}
+	ctx.stroke();
+	ctx.strokeStyle = '#569cd6';
+	ctx.beginPath();
+	for (var i = 0; i < bins; i++) {
+		var tx = (i + 0.5) * w / bins;
+		var ty = th - 1 - lv[i] * (th - 2) / 255;
+		if (i) ctx.lineTo(tx, ty);
+		else ctx.moveTo(tx, ty);
+	}
+	ctx.stroke();
+
+	elSpecInfo.textContent = fmtFreq(center) + ' \u00b1 ' + fmtBW(span / 2)
+		+ '  ' + bins + ' bins  ' + floorDb + '..' + (floorDb + Math.round(255 * step)) + ' dB';
+}
+
+function specReconfigure() {
+	if (specWs && specWs.readyState === 1)
+		specWs.send(specQuery());
+}
+
+elSpecSource.addEventListener('change', specReconfigure);
+elSpecFps.addEventListener('change', specReconfigure);
+window.addEventListener('resize', function () {
+	if (specActive) specResize();
+});